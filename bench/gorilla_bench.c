@@ -0,0 +1,191 @@
+/**
+ * @file gorilla_bench.c
+ * @brief Benchmark del formato Gorilla sobre trazas grabadas: bytes por muestra y velocidad de codificación y
+ * decodificación por columna.
+ *
+ * La traza es un CSV con encabezado cuya primera columna es timestamp_ms y cada columna siguiente una serie, tal como
+ * bench/traces/host.csv (CPU, red y disco de un host a 1 muestra por segundo).
+ *
+ * Uso: gorilla-bench [traza.csv]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "gorilla.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_TRACE "bench/traces/host.csv"
+#define MAX_COLUMNS 16
+#define MAX_ROWS 1000000
+#define LINE_SIZE 1024
+#define NAME_SIZE 64
+#define REPETITIONS 200
+#define NANOSECONDS_PER_SECOND 1e9
+#define RAW_SAMPLE_BYTES 16.0
+#define SAMPLES_PER_MILLION 1e6
+
+typedef struct
+{
+    char names[MAX_COLUMNS][NAME_SIZE];
+    size_t columns;
+    size_t rows;
+    int64_t* timestamps;
+    double* values[MAX_COLUMNS];
+} trace_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / NANOSECONDS_PER_SECOND;
+}
+
+static int load_trace(const char* path, trace_t* trace)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char line[LINE_SIZE];
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        fclose(file);
+        return -1;
+    }
+    trace->columns = 0;
+    char* saveptr = NULL;
+    strtok_r(line, ",\n", &saveptr);
+    for (char* name = strtok_r(NULL, ",\n", &saveptr); name != NULL && trace->columns < MAX_COLUMNS;
+         name = strtok_r(NULL, ",\n", &saveptr))
+    {
+        snprintf(trace->names[trace->columns++], NAME_SIZE, "%s", name);
+    }
+
+    trace->timestamps = malloc(MAX_ROWS * sizeof(int64_t));
+    for (size_t c = 0; c < trace->columns; c++)
+    {
+        trace->values[c] = malloc(MAX_ROWS * sizeof(double));
+    }
+    trace->rows = 0;
+    while (trace->rows < MAX_ROWS && fgets(line, sizeof(line), file) != NULL)
+    {
+        char* cursor = line;
+        trace->timestamps[trace->rows] = strtoll(cursor, &cursor, 10);
+        for (size_t c = 0; c < trace->columns; c++)
+        {
+            trace->values[c][trace->rows] = strtod(cursor + 1, &cursor);
+        }
+        trace->rows++;
+    }
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief Codifica una columna en chunks consecutivos; devuelve la cantidad de chunks usados.
+ */
+static size_t encode_column(const trace_t* trace, const double* values, gorilla_chunk_t* chunks)
+{
+    size_t used = 0;
+    gorilla_chunk_init(&chunks[0]);
+    for (size_t r = 0; r < trace->rows; r++)
+    {
+        if (gorilla_chunk_append(&chunks[used], trace->timestamps[r], values[r]) == GORILLA_FULL)
+        {
+            gorilla_chunk_seal(&chunks[used]);
+            gorilla_chunk_init(&chunks[++used]);
+            gorilla_chunk_append(&chunks[used], trace->timestamps[r], values[r]);
+        }
+    }
+    gorilla_chunk_seal(&chunks[used]);
+    return used + 1;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = argc > 1 ? argv[1] : DEFAULT_TRACE;
+    trace_t trace;
+    if (load_trace(path, &trace) != 0 || trace.rows == 0)
+    {
+        fprintf(stderr, "Error loading trace %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    size_t max_chunks = trace.rows / GORILLA_CHUNK_SAMPLES + 2;
+    gorilla_chunk_t* chunks = malloc(max_chunks * sizeof(gorilla_chunk_t));
+
+    printf("trace %s: %zu samples per series (raw %.0f bytes/sample)\n", path, trace.rows, RAW_SAMPLE_BYTES);
+    printf("%-24s %10s %12s %14s %14s\n", "series", "bytes", "bytes/sample", "encode Ms/s", "decode Ms/s");
+
+    size_t total_bytes = 0;
+    for (size_t c = 0; c < trace.columns; c++)
+    {
+        size_t used = 0;
+        double start = now_seconds();
+        for (int rep = 0; rep < REPETITIONS; rep++)
+        {
+            if (rep > 0)
+            {
+                for (size_t i = 0; i < used; i++)
+                {
+                    gorilla_chunk_free(&chunks[i]);
+                }
+            }
+            used = encode_column(&trace, trace.values[c], chunks);
+        }
+        double encode_seconds = now_seconds() - start;
+
+        size_t bytes = 0;
+        for (size_t i = 0; i < used; i++)
+        {
+            bytes += gorilla_chunk_size(&chunks[i]);
+        }
+
+        size_t mismatches = 0;
+        start = now_seconds();
+        for (int rep = 0; rep < REPETITIONS; rep++)
+        {
+            size_t row = 0;
+            for (size_t i = 0; i < used; i++)
+            {
+                gorilla_iter_t iter;
+                gorilla_iter_init(&iter, chunks[i].data, chunks[i].count);
+                int64_t timestamp;
+                double value;
+                while (gorilla_iter_next(&iter, &timestamp, &value))
+                {
+                    // Comparar bit a bit: la compresión no tiene pérdida
+                    mismatches += timestamp != trace.timestamps[row] ||
+                                  memcmp(&value, &trace.values[c][row], sizeof(double)) != 0;
+                    row++;
+                }
+            }
+        }
+        double decode_seconds = now_seconds() - start;
+
+        double samples = (double)trace.rows * REPETITIONS / SAMPLES_PER_MILLION;
+        printf("%-24s %10zu %12.2f %14.1f %14.1f%s\n", trace.names[c], bytes, (double)bytes / (double)trace.rows,
+               samples / encode_seconds, samples / decode_seconds, mismatches ? "  MISMATCH" : "");
+        total_bytes += bytes;
+
+        for (size_t i = 0; i < used; i++)
+        {
+            gorilla_chunk_free(&chunks[i]);
+        }
+        if (mismatches)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    printf("%-24s %10zu %12.2f\n", "total", total_bytes,
+           (double)total_bytes / (double)(trace.rows * trace.columns));
+
+    free(chunks);
+    return EXIT_SUCCESS;
+}
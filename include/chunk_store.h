@@ -0,0 +1,73 @@
+/**
+ * @file chunk_store.h
+ * @brief Almacén en memoria de horas de historial por serie, comprimido en chunks Gorilla (ver gorilla.h).
+ *
+ * Cada serie tiene un chunk abierto donde se agregan las muestras nuevas; al llenarse se cierra y pasa a un anillo de
+ * chunks cerrados preasignado según la retención. Los chunks más antiguos que la retención se liberan.
+ *
+ * Con un archivo de historial (ver history_file.h) cada chunk cerrado se copia al archivo y el anillo pasa a apuntar
+ * al mapeo, de modo que las consultas leen directamente del archivo; al reiniciar, los chunks cerrados se recuperan de
+ * él. El chunk abierto de cada serie (hasta GORILLA_CHUNK_SAMPLES muestras) solo vive en memoria.
+ */
+
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Recibe cada muestra recorrida por chunk_store_scan.
+ * @param timestamp_ms Marca de tiempo de la muestra (ms desde epoch).
+ * @param value Valor de la muestra.
+ * @param ctx Contexto pasado a chunk_store_scan.
+ */
+typedef void (*chunk_store_visitor_t)(long long timestamp_ms, double value, void* ctx);
+
+/**
+ * @brief Prepara el almacén para las series registradas.
+ * @param retention_hours Horas de historial a conservar; 0 desactiva el almacén.
+ * @return 0 si se inicializó, -1 en caso de error.
+ */
+int chunk_store_init(unsigned int retention_hours);
+
+/**
+ * @brief Persiste los chunks cerrados en un archivo y carga los que ya contenga; requiere el almacén activo.
+ * @param path Ruta del archivo.
+ * @param size Tamaño del archivo en bytes.
+ * @return 0 si el archivo quedó abierto, -1 en caso de error.
+ */
+int chunk_store_open_file(const char* path, size_t size);
+
+/**
+ * @brief Agrega la última lectura de cada serie, si es posterior a la ya almacenada.
+ *
+ * Se llama una vez por ciclo de recolección, después de actualizar las series. Con archivo de historial, además
+ * sincroniza periódicamente las escrituras con el disco.
+ */
+void chunk_store_record(void);
+
+/**
+ * @brief Indica si el almacén está activo.
+ * @return 1 si conserva historial, 0 si fue desactivado.
+ */
+int chunk_store_enabled(void);
+
+/**
+ * @brief Recorre en orden las muestras de una serie dentro de (since_ms, until_ms].
+ * @param series_index Índice de la serie en la tabla de series.
+ * @param since_ms Límite inferior, excluido.
+ * @param until_ms Límite superior, incluido.
+ * @param visitor Función llamada con cada muestra; se ejecuta con el almacén bloqueado.
+ * @param ctx Contexto para visitor.
+ * @return Cantidad de muestras visitadas.
+ */
+size_t chunk_store_scan(size_t series_index, long long since_ms, long long until_ms, chunk_store_visitor_t visitor,
+                        void* ctx);
+
+/**
+ * @brief Bytes ocupados por los flujos comprimidos de todas las series.
+ * @return Bytes usados.
+ */
+size_t chunk_store_bytes(void);
+
+#endif // CHUNK_STORE_H
@@ -0,0 +1,52 @@
+/**
+ * @file collector_runner.h
+ * @brief Ejecución de cada grupo de métricas en su propio hilo, con un plazo por ciclo.
+ *
+ * Leer los archivos de /proc/<pid> puede bloquearse varios segundos si un proceso está en estado D o su mmap_sem
+ * está disputado. Cada grupo se actualiza en un hilo propio y el ciclo espera como mucho el plazo configurado: si
+ * vence, el ciclo sigue con los demás grupos, las métricas del grupo se ocultan del render (Prometheus las marca
+ * stale) y se cuenta en collector_timeouts_total{collector} del collector "self". Mientras el hilo siga bloqueado el
+ * grupo no se vuelve a lanzar; cada ciclo perdido cuenta como otro vencimiento. La primera actualización que termina
+ * a tiempo vuelve a mostrar el grupo. collector_stale{collector} vale 1 mientras el grupo está oculto. Las métricas
+ * del grupo que mantiene al día otro hilo, agregadas con collector_runner_add_sampled_metric, siguen a la vista.
+ *
+ * El hilo de un grupo no escribe la tabla de series ni el estado de tasas, que el hilo de recolección lee sin locks:
+ * trabaja sobre una copia del estado y acumula sus series_set en un lote. El hilo de recolección los aplica cuando
+ * la actualización termina a tiempo; los de una actualización vencida se descartan.
+ */
+
+#ifndef COLLECTOR_RUNNER_H
+#define COLLECTOR_RUNNER_H
+
+#include <prom.h>
+
+/**
+ * @brief Crea las métricas de vencimientos; debe llamarse después de self_metrics_init.
+ * @param deadline_ms Milisegundos que el ciclo espera a cada grupo, o 0 para actualizarlos en el propio ciclo.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int collector_runner_init(unsigned int deadline_ms);
+
+/**
+ * @brief Agrega al collector de un grupo una métrica que mantiene al día otro hilo y no la función de actualización
+ *        del grupo, de modo que sigue a la vista mientras el grupo está vencido.
+ *
+ * Debe llamarse después de collector_runner_init y antes del primer collector_run del grupo.
+ *
+ * @param collector Nombre del grupo; si no tiene collector propio, la métrica se registra en el collector por defecto.
+ * @param metric Métrica a agregar.
+ * @return 0 si se agregó, -1 en caso de error; entonces la métrica sigue siendo de quien llama.
+ */
+int collector_runner_add_sampled_metric(const char* collector, prom_metric_t* metric);
+
+/**
+ * @brief Actualiza un grupo de métricas, si le toca según el regulador de CPU, y registra cuánto tardó.
+ *
+ * El hilo del grupo se crea en la primera llamada; si no puede crearse, el grupo se actualiza en el propio ciclo.
+ *
+ * @param collector Nombre del grupo; debe seguir siendo válido mientras el programa corre.
+ * @param update Función que actualiza las métricas del grupo.
+ */
+void collector_run(const char* collector, void (*update)(void));
+
+#endif // COLLECTOR_RUNNER_H
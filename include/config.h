@@ -0,0 +1,184 @@
+/**
+ * @file config.h
+ * @brief Configuración del monitor a partir de los argumentos de línea de comandos.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/**
+ * @brief Puerto HTTP por defecto.
+ */
+#define DEFAULT_HTTP_PORT 8000
+
+/**
+ * @brief Cantidad de hilos del pool HTTP por defecto (modo epoll).
+ */
+#define DEFAULT_HTTP_THREADS 4
+
+/**
+ * @brief Conexiones simultáneas atendidas normalmente por defecto; por encima se responde 503.
+ */
+#define DEFAULT_MAX_CONNECTIONS 256
+
+/**
+ * @brief Conexiones aceptadas por encima de max_connections solo para responder 503, por defecto.
+ */
+#define DEFAULT_OVERLOAD_HEADROOM 64
+
+/**
+ * @brief Conexiones simultáneas por dirección IP por defecto (0 = sin límite).
+ */
+#define DEFAULT_MAX_CONNECTIONS_PER_IP 0
+
+/**
+ * @brief Segundos que una conexión keep-alive inactiva se mantiene abierta por defecto.
+ */
+#define DEFAULT_KEEPALIVE_TIMEOUT 15
+
+/**
+ * @brief Horas de historial comprimido que se conservan por defecto.
+ */
+#define DEFAULT_HISTORY_HOURS 6
+
+/**
+ * @brief Tamaño por defecto del archivo de historial en MiB.
+ */
+#define DEFAULT_HISTORY_FILE_MB 64
+
+/**
+ * @brief Segundos de lecturas por lote de remote_write por defecto.
+ */
+#define DEFAULT_REMOTE_WRITE_INTERVAL 15
+
+/**
+ * @brief Lotes de remote_write que pueden esperar envío por defecto (una hora con el intervalo por defecto).
+ */
+#define DEFAULT_REMOTE_WRITE_QUEUE 240
+
+/**
+ * @brief Eventos pendientes por cliente de /stream por defecto antes de desconectarlo.
+ */
+#define DEFAULT_STREAM_QUEUE 16
+
+/**
+ * @brief Lecturas por segundo por defecto de la CPU, la cola de ejecución y la red dentro de cada ciclo.
+ */
+#define DEFAULT_SUBSAMPLE_HZ 20
+
+/**
+ * @brief Segundos por defecto de lecturas que cubren los cuantiles de las distribuciones; con cuatro tramos de
+ * antigüedad un scrape ve al menos tres cuartos de la ventana, así que 20 s abarcan un scrape cada 15 s.
+ */
+#define DEFAULT_SUBSAMPLE_WINDOW 20
+
+/**
+ * @brief Milisegundos por defecto entre lecturas de los contadores de sysfs para detectar microrráfagas.
+ */
+#define DEFAULT_MICROBURST_INTERVAL_MS 5
+
+/**
+ * @brief Milisegundos por defecto que el ciclo espera a cada grupo de métricas antes de darlo por vencido.
+ */
+#define DEFAULT_COLLECTOR_DEADLINE_MS 500
+
+/**
+ * @brief MTU por defecto del camino hacia el destino UDP; los datagramas se arman para no fragmentarse.
+ */
+#define DEFAULT_UDP_MTU 1500
+
+/**
+ * @brief Permisos por defecto del socket Unix (lectura y escritura para el dueño y el grupo).
+ */
+#define DEFAULT_UNIX_SOCKET_MODE 0660
+
+/**
+ * @brief Prefijo de --unix-socket que selecciona el espacio de nombres abstracto de Linux.
+ */
+#define ABSTRACT_SOCKET_PREFIX '@'
+
+/**
+ * @brief Modo de atención de conexiones del servidor HTTP.
+ */
+typedef enum
+{
+    HTTP_MODE_SELECT, /**< Un único hilo con select(), limitado por FD_SETSIZE. */
+    HTTP_MODE_EPOLL   /**< Pool de hilos con epoll. */
+} http_mode_t;
+
+/**
+ * @brief Formato de los registros enviados por UDP.
+ */
+typedef enum
+{
+    UDP_FORMAT_STATSD, /**< Gauges StatsD: nombre:valor|g. */
+    UDP_FORMAT_INFLUX  /**< Protocolo de líneas de InfluxDB, con la etiqueta host y marca de tiempo en ns. */
+} udp_format_t;
+
+/**
+ * @brief Configuración del monitor.
+ */
+typedef struct
+{
+    unsigned int http_port;              /**< Puerto en el que se exponen las métricas. */
+    http_mode_t http_mode;               /**< Modo de atención de conexiones. */
+    unsigned int http_threads;           /**< Hilos del pool HTTP. */
+    unsigned int max_connections;        /**< Conexiones atendidas normalmente; por encima se responde 503. */
+    unsigned int overload_headroom;      /**< Conexiones extra aceptadas solo para responder 503. */
+    unsigned int max_connections_per_ip; /**< Conexiones por dirección IP (0 = sin límite). */
+    unsigned int keepalive_timeout;      /**< Segundos de inactividad antes de cerrar una conexión keep-alive. */
+    const char* unix_socket_path;        /**< Socket Unix adicional, NULL si no se usa; '@' inicial = abstracto. */
+    unsigned int unix_socket_mode;       /**< Permisos del socket Unix en el sistema de archivos. */
+    const char* unix_socket_group;       /**< Grupo dueño del socket Unix, NULL para el grupo del proceso. */
+    const char* shm_export_path;         /**< Segmento de memoria compartida con los valores, NULL si no se usa. */
+    unsigned int history_hours;          /**< Horas de historial comprimido por serie (0 = desactivado). */
+    const char* history_file_path;       /**< Archivo donde persiste el historial comprimido, NULL si no se usa. */
+    unsigned int history_file_mb;        /**< Tamaño del archivo de historial en MiB. */
+    const char* state_file_path;         /**< Archivo de estado para reinicios en caliente, NULL si no se usa. */
+    const char* remote_write_url;        /**< Receptor remote_write al que se envían las series, NULL si no se usa. */
+    unsigned int remote_write_interval;  /**< Segundos de lecturas por lote de remote_write. */
+    unsigned int remote_write_queue;     /**< Lotes de remote_write en espera antes de descartar el más antiguo. */
+    const char* udp_target;              /**< Destino host:puerto de los registros UDP, NULL si no se usa. */
+    udp_format_t udp_format;             /**< Formato de los registros UDP. */
+    unsigned int udp_mtu;                /**< MTU del camino hacia el destino UDP. */
+    unsigned int stream_queue;           /**< Eventos pendientes por cliente de /stream antes de desconectarlo. */
+    unsigned int subsample_hz;           /**< Lecturas por segundo de las distribuciones por ciclo (0 = desactivado). */
+    unsigned int subsample_window;       /**< Segundos de lecturas que cubren los cuantiles de las distribuciones. */
+    const char* microburst_interfaces;   /**< Interfaces separadas por comas para detectar microrráfagas, o NULL. */
+    unsigned int microburst_interval_ms; /**< Milisegundos entre lecturas de los contadores de microrráfagas. */
+    unsigned int microburst_threshold;   /**< Umbral de ráfaga en Mbit/s (0 = 80% de la velocidad del enlace). */
+    int microburst_cpu;                  /**< CPU a la que se fija el hilo de microrráfagas, -1 para ninguna. */
+    unsigned int cpu_budget_millicores;  /**< Presupuesto de CPU de los grupos en milésimas de núcleo (0 = sin límite). */
+    unsigned int collector_deadline_ms;  /**< Plazo de cada grupo en su propio hilo (0 = en el hilo del ciclo). */
+} monitor_config_t;
+
+/**
+ * @brief Carga los valores por defecto en la configuración.
+ * @param config Configuración a inicializar.
+ */
+void config_set_defaults(monitor_config_t* config);
+
+/**
+ * @brief Interpreta los argumentos de línea de comandos sobre la configuración.
+ *
+ * Opciones reconocidas: --port, --http-mode (select|epoll), --http-threads, --max-connections,
+ * --overload-headroom, --max-connections-per-ip, --keepalive-timeout, --unix-socket, --unix-socket-mode,
+ * --unix-socket-group, --shm-export, --history-hours, --history-file, --history-file-size, --state-file,
+ * --remote-write-url, --remote-write-interval, --remote-write-queue, --udp-target, --udp-format (statsd|influx),
+ * --udp-mtu, --stream-queue, --subsample-hz, --subsample-window, --microburst, --microburst-interval-ms,
+ * --microburst-threshold-mbps, --microburst-cpu, --cpu-budget-millicores, --collector-deadline-ms y --help.
+ *
+ * @param config Configuración a completar, previamente inicializada con config_set_defaults.
+ * @param argc Cantidad de argumentos.
+ * @param argv Lista de argumentos.
+ * @return 0 si los argumentos son válidos, 1 si se pidió la ayuda, -1 en caso de error.
+ */
+int config_parse_args(monitor_config_t* config, int argc, char* argv[]);
+
+/**
+ * @brief Imprime el uso del programa.
+ * @param program Nombre del ejecutable.
+ */
+void config_print_usage(const char* program);
+
+#endif // CONFIG_H
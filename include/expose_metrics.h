@@ -7,14 +7,24 @@
 #ifndef EXPOSE_METRICS_H
 #define EXPOSE_METRICS_H
 
+#include "config.h"
 #include "metrics.h"
+#include "rate_state.h"
+#include "series.h"
+#include "timing.h"
 #include <errno.h>
+#include <grp.h>
 #include <prom.h>
 #include <promhttp.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <time.h>
 #include <unistd.h> // Para sleep
 
@@ -23,6 +33,16 @@
  */
 #define BUFFER_SIZE 256
 
+/**
+ * @brief Nombres de los collectors de cada grupo de métricas, seleccionables con /metrics?collect[]=NOMBRE.
+ */
+#define CPU_COLLECTOR "cpu"
+#define MEMORY_COLLECTOR "memory"
+#define DISK_COLLECTOR "disk"
+#define NETWORK_COLLECTOR "network"
+#define PROCESSES_COLLECTOR "processes"
+#define CONTEXT_COLLECTOR "context"
+
 /**
  * @brief Actualiza la métrica de uso de CPU.
  */
@@ -79,9 +99,26 @@ void init_context_metrics(void);
 void update_context_metrics(void);
 
 /**
- * @brief Función del hilo para exponer las métricas vía HTTP en el puerto 8000.
- * @param arg Argumento no utilizado.
- * @return NULL
+ * @brief Crea el socket Unix de escucha configurado en config->unix_socket_path.
+ *
+ * Una ruta que empieza con '@' se crea en el espacio de nombres abstracto de Linux, que no tiene permisos de sistema
+ * de archivos. En otro caso el socket se crea con los permisos config->unix_socket_mode y, si se indica, el grupo
+ * config->unix_socket_group; un socket que haya quedado de una ejecución anterior se reemplaza.
+ *
+ * @param config Configuración del monitor.
+ * @return Descriptor del socket en estado de escucha, o -1 en caso de error.
+ */
+int open_unix_listen_socket(const monitor_config_t* config);
+
+/**
+ * @brief Inicia el servidor HTTP que expone las métricas según la configuración.
+ *
+ * El servidor atiende las conexiones en sus propios hilos (pool con epoll o un hilo con select), por lo que la
+ * función retorna en cuanto queda escuchando. Si se configuró un socket Unix, se inicia un segundo daemon sobre él
+ * que sirve el mismo snapshot.
+ *
+ * @param arg Puntero a la configuración del monitor (monitor_config_t).
+ * @return Puntero al daemon de microhttpd, o NULL si no pudo iniciarse.
  */
 void* expose_metrics(void* arg);
 
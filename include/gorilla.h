@@ -0,0 +1,123 @@
+/**
+ * @file gorilla.h
+ * @brief Compresión de series temporales al estilo Gorilla (Facebook TSDB): delta de deltas para las marcas de tiempo
+ * y XOR contra el valor anterior para los valores.
+ *
+ * Un chunk guarda la primera muestra completa (64 bits de marca de tiempo y 64 de valor) y cada muestra siguiente como:
+ * - marca de tiempo: delta de deltas D en milisegundos, '0' si D = 0, '10' + 7 bits, '110' + 9 bits, '1110' + 12 bits
+ *   o '1111' + 32 bits (complemento a dos);
+ * - valor: XOR X con el anterior, '0' si X = 0, '10' + bits significativos si caben en la ventana de ceros
+ *   iniciales/finales anterior, o '11' + 5 bits de ceros iniciales + 6 bits de largo + bits significativos.
+ */
+
+#ifndef GORILLA_H
+#define GORILLA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Muestras por chunk; al llegar a este número el chunk se cierra.
+ */
+#define GORILLA_CHUNK_SAMPLES 120
+
+/**
+ * @brief La muestra se agregó al chunk.
+ */
+#define GORILLA_OK 0
+
+/**
+ * @brief El chunk está lleno (o la muestra no es representable en él): hay que cerrarlo y empezar otro.
+ */
+#define GORILLA_FULL 1
+
+/**
+ * @brief La muestra no es posterior a la última del chunk, o no hubo memoria.
+ */
+#define GORILLA_ERROR -1
+
+/**
+ * @brief Chunk comprimido con su estado de escritura.
+ */
+typedef struct
+{
+    uint8_t* data;            /**< Flujo de bits, del bit más significativo al menos significativo de cada byte. */
+    size_t capacity;          /**< Bytes reservados en data. */
+    size_t bit_len;           /**< Bits escritos. */
+    uint32_t count;           /**< Muestras en el chunk. */
+    int64_t first_timestamp;  /**< Marca de tiempo de la primera muestra (ms). */
+    int64_t last_timestamp;   /**< Marca de tiempo de la última muestra (ms). */
+    int64_t last_delta;       /**< Delta entre las dos últimas marcas de tiempo (ms). */
+    uint64_t last_value_bits; /**< Representación binaria del último valor. */
+    uint8_t leading;          /**< Ceros iniciales de la ventana XOR vigente. */
+    uint8_t trailing;         /**< Ceros finales de la ventana XOR vigente. */
+} gorilla_chunk_t;
+
+/**
+ * @brief Lector secuencial de un chunk.
+ */
+typedef struct
+{
+    const uint8_t* data;  /**< Flujo de bits del chunk. */
+    size_t bit_pos;       /**< Próximo bit a leer. */
+    uint32_t remaining;   /**< Muestras por leer. */
+    uint32_t read;        /**< Muestras leídas. */
+    int64_t timestamp;    /**< Última marca de tiempo leída. */
+    int64_t delta;        /**< Último delta leído. */
+    uint64_t value_bits;  /**< Último valor leído. */
+    uint8_t leading;      /**< Ceros iniciales de la ventana XOR vigente. */
+    uint8_t trailing;     /**< Ceros finales de la ventana XOR vigente. */
+} gorilla_iter_t;
+
+/**
+ * @brief Inicializa un chunk vacío.
+ * @param chunk Chunk a inicializar.
+ */
+void gorilla_chunk_init(gorilla_chunk_t* chunk);
+
+/**
+ * @brief Agrega una muestra al chunk.
+ * @param chunk Chunk abierto.
+ * @param timestamp_ms Marca de tiempo, estrictamente posterior a la última del chunk.
+ * @param value Valor.
+ * @return GORILLA_OK, GORILLA_FULL (la muestra no se agregó) o GORILLA_ERROR.
+ */
+int gorilla_chunk_append(gorilla_chunk_t* chunk, int64_t timestamp_ms, double value);
+
+/**
+ * @brief Ajusta la memoria del chunk a los bytes usados; después no deben agregarse más muestras.
+ * @param chunk Chunk a cerrar.
+ */
+void gorilla_chunk_seal(gorilla_chunk_t* chunk);
+
+/**
+ * @brief Bytes ocupados por el flujo de bits del chunk.
+ * @param chunk Chunk.
+ * @return Bytes usados.
+ */
+size_t gorilla_chunk_size(const gorilla_chunk_t* chunk);
+
+/**
+ * @brief Libera la memoria del chunk y lo deja vacío.
+ * @param chunk Chunk a liberar.
+ */
+void gorilla_chunk_free(gorilla_chunk_t* chunk);
+
+/**
+ * @brief Prepara la lectura de un flujo de bits con count muestras.
+ * @param iter Lector a inicializar.
+ * @param data Flujo de bits, p. ej. gorilla_chunk_t::data.
+ * @param count Cantidad de muestras del flujo.
+ */
+void gorilla_iter_init(gorilla_iter_t* iter, const uint8_t* data, uint32_t count);
+
+/**
+ * @brief Lee la próxima muestra.
+ * @param iter Lector.
+ * @param timestamp_ms Recibe la marca de tiempo.
+ * @param value Recibe el valor.
+ * @return 1 si se leyó una muestra, 0 al final del chunk.
+ */
+int gorilla_iter_next(gorilla_iter_t* iter, int64_t* timestamp_ms, double* value);
+
+#endif // GORILLA_H
@@ -0,0 +1,51 @@
+/**
+ * @file governor.h
+ * @brief Regulador del intervalo de cada grupo de métricas según un presupuesto de CPU para su actualización.
+ *
+ * Cada actualización de un grupo se mide con CLOCK_THREAD_CPUTIME_ID y cada cierto número de ciclos se compara la
+ * suma de esas mediciones con el presupuesto configurado. Los hilos HTTP y de muestreo no cuentan: su consumo no
+ * depende de los intervalos, así que estirarlos no lo reduciría. Si la suma se pasa, se duplica el intervalo del
+ * grupo que más CPU por segundo cuesta; si queda holgura, se reduce a la mitad el intervalo del grupo estirado cuyo
+ * costo extra sea menor, siempre que el consumo previsto siga dentro del presupuesto. Los intervalos van de un ciclo
+ * a GOVERNOR_MAX_INTERVAL_TICKS y se exponen en el collector "self" como collector_interval_seconds{collector}, junto
+ * con cpu_budget_usage_ratio.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+/**
+ * @brief Intervalo máximo de un grupo, en ciclos de recolección.
+ */
+#define GOVERNOR_MAX_INTERVAL_TICKS 60
+
+/**
+ * @brief Crea las métricas del regulador y lo activa; debe llamarse después de self_metrics_init.
+ * @param budget_millicores Presupuesto en milésimas de núcleo (5 = 0,5% de un núcleo).
+ * @param tick_seconds Segundos de un ciclo de recolección.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int governor_init(unsigned int budget_millicores, unsigned int tick_seconds);
+
+/**
+ * @brief Indica si al grupo le toca actualizarse en este ciclo; sin regulador activo siempre le toca.
+ * @param collector Nombre del grupo.
+ * @return 1 si debe actualizarse, 0 si no.
+ */
+int governor_collector_due(const char* collector);
+
+/**
+ * @brief Registra el tiempo de CPU que costó una actualización del grupo.
+ * @param collector Nombre del grupo.
+ * @param cpu_seconds Segundos de CPU de la actualización, según CLOCK_THREAD_CPUTIME_ID.
+ */
+void governor_collector_done(const char* collector, double cpu_seconds);
+
+/**
+ * @brief Cierra un ciclo de recolección y, cada cierto número de ciclos, ajusta los intervalos.
+ *
+ * No hace nada si el regulador no está activo.
+ */
+void governor_tick(void);
+
+#endif // GOVERNOR_H
@@ -0,0 +1,41 @@
+/**
+ * @file history.h
+ * @brief Historial reciente de cada serie en buffers circulares preasignados, a la resolución del colector.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+
+/**
+ * @brief Muestras que conserva cada serie (10 minutos a 1 muestra por segundo).
+ */
+#define HISTORY_CAPACITY 600
+
+/**
+ * @brief Una muestra del historial.
+ */
+typedef struct
+{
+    long long timestamp_ms; /**< Momento de la lectura (ms desde epoch). */
+    double value;           /**< Valor leído. */
+} history_sample_t;
+
+/**
+ * @brief Agrega al historial la última lectura de cada serie, si es posterior a la ya registrada.
+ *
+ * Se llama una vez por ciclo de recolección, después de actualizar las series.
+ */
+void history_record(void);
+
+/**
+ * @brief Copia las muestras de una serie posteriores a un instante, de la más antigua a la más reciente.
+ * @param series_index Índice de la serie en la tabla de series.
+ * @param since_ms Solo se copian muestras con timestamp_ms > since_ms.
+ * @param out Destino, con lugar para HISTORY_CAPACITY muestras.
+ * @return Cantidad de muestras copiadas.
+ */
+size_t history_query(size_t series_index, long long since_ms, history_sample_t* out);
+
+#endif // HISTORY_H
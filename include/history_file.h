@@ -0,0 +1,148 @@
+/**
+ * @file history_file.h
+ * @brief Archivo de historial persistente: segmento de tamaño fijo mapeado en memoria con los chunks Gorilla cerrados.
+ *
+ * El archivo tiene un encabezado de una página y a continuación una zona de datos dividida en ranuras de
+ * HISTORY_FILE_SLOT_SIZE bytes. Cada chunk cerrado se agrega como un bloque (encabezado con número de secuencia,
+ * serie, rango de marcas de tiempo y CRC-32, seguido del flujo de bits) que ocupa ranuras consecutivas; al llegar al
+ * final la escritura vuelve al principio y pisa los bloques más antiguos. El índice por serie se reconstruye al abrir
+ * el archivo recorriendo las ranuras, así que un bloque a medio escribir por un `kill -9` falla su CRC y la escritura
+ * continúa después del último bloque válido. Las escrituras van al mapeo y se sincronizan con msync cada
+ * HISTORY_FILE_SYNC_INTERVAL segundos.
+ */
+
+#ifndef HISTORY_FILE_H
+#define HISTORY_FILE_H
+
+#include "gorilla.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Identificador del formato del archivo ("SMHF" en little endian).
+ */
+#define HISTORY_FILE_MAGIC 0x46484D53u
+
+/**
+ * @brief Identificador del inicio de un bloque ("SBLK" en little endian).
+ */
+#define HISTORY_FILE_BLOCK_MAGIC 0x4B4C4253u
+
+/**
+ * @brief Versión del formato; un archivo de otra versión se descarta y se crea de nuevo.
+ */
+#define HISTORY_FILE_VERSION 1
+
+/**
+ * @brief Tamaño del encabezado del archivo; la zona de datos empieza a continuación.
+ */
+#define HISTORY_FILE_HEADER_SIZE 4096
+
+/**
+ * @brief Unidad de asignación de la zona de datos; cada bloque empieza al principio de una ranura.
+ */
+#define HISTORY_FILE_SLOT_SIZE 64
+
+/**
+ * @brief Segundos entre sincronizaciones de las escrituras pendientes con el disco.
+ */
+#define HISTORY_FILE_SYNC_INTERVAL 30
+
+/**
+ * @brief Tamaño mínimo del archivo; alcanza de sobra para el bloque más grande posible.
+ */
+#define HISTORY_FILE_MIN_SIZE (1024 * 1024)
+
+/**
+ * @brief Número de secuencia de un chunk que no está en el archivo.
+ */
+#define HISTORY_FILE_NOT_PERSISTED 0
+
+/**
+ * @brief Encabezado del archivo.
+ */
+typedef struct
+{
+    uint32_t magic;             /**< HISTORY_FILE_MAGIC. */
+    uint32_t version;           /**< HISTORY_FILE_VERSION. */
+    uint32_t slot_size;         /**< HISTORY_FILE_SLOT_SIZE. */
+    uint32_t block_header_size; /**< sizeof(history_file_block_t). */
+    uint64_t file_size;         /**< Tamaño total del archivo en bytes. */
+    uint64_t data_offset;       /**< Desplazamiento de la zona de datos. */
+} history_file_header_t;
+
+/**
+ * @brief Encabezado de un bloque; el flujo de bits del chunk sigue inmediatamente.
+ */
+typedef struct
+{
+    uint32_t magic;           /**< HISTORY_FILE_BLOCK_MAGIC; se escribe último. */
+    uint32_t checksum;        /**< CRC-32 desde sequence hasta el final del flujo de bits. */
+    uint64_t sequence;        /**< Número de secuencia creciente, a partir de 1. */
+    uint64_t series_hash;     /**< FNV-1a del nombre de la serie (ver history_file_hash). */
+    int64_t first_timestamp;  /**< Marca de tiempo de la primera muestra (ms). */
+    int64_t last_timestamp;   /**< Marca de tiempo de la última muestra (ms). */
+    uint32_t sample_count;    /**< Muestras del chunk. */
+    uint32_t data_size;       /**< Bytes del flujo de bits. */
+} history_file_block_t;
+
+/**
+ * @brief Recibe cada bloque válido encontrado al abrir el archivo, del más antiguo al más reciente.
+ * @param block Encabezado del bloque dentro del mapeo.
+ * @param data Flujo de bits del chunk dentro del mapeo; sigue siendo válido mientras history_file_block_intact lo
+ * indique.
+ * @param ctx Contexto pasado a history_file_open.
+ */
+typedef void (*history_file_visitor_t)(const history_file_block_t* block, uint8_t* data, void* ctx);
+
+/**
+ * @brief Identificador estable de una serie en el archivo.
+ * @param name Nombre de la serie.
+ * @return Hash FNV-1a de 64 bits del nombre.
+ */
+uint64_t history_file_hash(const char* name);
+
+/**
+ * @brief Abre (o crea) y mapea el archivo, y recupera los bloques válidos.
+ *
+ * Un archivo del historial con otra versión o tamaño se descarta; cualquier otro archivo no vacío se rechaza sin
+ * modificarlo. La escritura continúa después del bloque válido más reciente y
+ * el bloque incompleto que pudiera haber en esa posición se invalida.
+ *
+ * @param path Ruta del archivo.
+ * @param size Tamaño del archivo en bytes, al menos HISTORY_FILE_MIN_SIZE.
+ * @param visitor Función llamada con cada bloque recuperado.
+ * @param ctx Contexto para visitor.
+ * @return 0 si el archivo quedó abierto, -1 en caso de error.
+ */
+int history_file_open(const char* path, size_t size, history_file_visitor_t visitor, void* ctx);
+
+/**
+ * @brief Indica si hay un archivo abierto.
+ * @return 1 si está abierto, 0 en caso contrario.
+ */
+int history_file_active(void);
+
+/**
+ * @brief Agrega un chunk cerrado como bloque nuevo, pisando los bloques más antiguos si hace falta.
+ * @param series_hash Identificador de la serie.
+ * @param chunk Chunk cerrado.
+ * @param sequence Recibe el número de secuencia del bloque.
+ * @return Flujo de bits copiado dentro del mapeo, o NULL si el archivo no está abierto.
+ */
+uint8_t* history_file_append(uint64_t series_hash, const gorilla_chunk_t* chunk, uint64_t* sequence);
+
+/**
+ * @brief Indica si el bloque de un flujo de bits devuelto por el archivo sigue sin pisar.
+ * @param data Flujo de bits dentro del mapeo.
+ * @param sequence Número de secuencia con que se escribió o recuperó.
+ * @return 1 si el bloque sigue intacto, 0 si fue reemplazado.
+ */
+int history_file_block_intact(const uint8_t* data, uint64_t sequence);
+
+/**
+ * @brief Sincroniza con el disco las escrituras pendientes si pasó el intervalo desde la última sincronización.
+ */
+void history_file_sync(void);
+
+#endif // HISTORY_FILE_H
@@ -280,4 +280,14 @@ void calculate_system_performance_metrics(context_stats_t* current_context, cont
                                           process_stats_t* current_process, double time_delta,
                                           system_performance_metrics_t* metrics);
 
+/**
+ * @brief Obtiene el instante actual de CLOCK_REALTIME en milisegundos desde la época Unix.
+ *
+ * Se toma justo después de cada lectura de /proc para que las muestras expuestas en formato OpenMetrics lleven
+ * el momento real de la lectura y no el del scrape.
+ *
+ * @return Milisegundos desde la época Unix
+ */
+long long get_read_timestamp_ms(void);
+
 #endif // METRICS_H
\ No newline at end of file
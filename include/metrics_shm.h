@@ -0,0 +1,169 @@
+/**
+ * @file metrics_shm.h
+ * @brief Formato del segmento de memoria compartida con los valores de las métricas y biblioteca de lectura.
+ *
+ * El segmento tiene un encabezado de tamaño fijo, una tabla de descriptores (uno por métrica) y un arreglo de
+ * valores double en el mismo orden que los descriptores. Los valores y la marca de tiempo se protegen con un seqlock:
+ * el escritor deja el contador de secuencia impar mientras actualiza y lo vuelve par al terminar, de modo que un
+ * lector obtiene una instantánea consistente copiando los valores entre dos lecturas iguales y pares del contador,
+ * sin llamadas al sistema ni bloqueos.
+ */
+
+#ifndef METRICS_SHM_H
+#define METRICS_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @brief Ruta por defecto del segmento.
+ */
+#define METRICS_SHM_DEFAULT_PATH "/dev/shm/system-monitor-metrics"
+
+/**
+ * @brief Identificador del formato ("SMSH" en little endian).
+ */
+#define METRICS_SHM_MAGIC 0x48534D53u
+
+/**
+ * @brief Versión del formato; cambia cuando el diseño deja de ser compatible.
+ */
+#define METRICS_SHM_VERSION 1
+
+/**
+ * @brief Tamaño del nombre en un descriptor, incluyendo el terminador.
+ */
+#define METRICS_SHM_NAME_SIZE 64
+
+/**
+ * @brief Alineación de la tabla de descriptores y del arreglo de valores (una línea de caché).
+ */
+#define METRICS_SHM_ALIGNMENT 64
+
+/**
+ * @brief Tipo de métrica: gauge.
+ */
+#define METRICS_SHM_TYPE_GAUGE 0
+
+/**
+ * @brief Código de retorno: operación exitosa.
+ */
+#define METRICS_SHM_OK 0
+
+/**
+ * @brief Código de retorno: error al abrir o mapear el segmento, o formato desconocido.
+ */
+#define METRICS_SHM_ERROR -1
+
+/**
+ * @brief Código de retorno: el escritor actualizó el segmento durante todos los intentos de lectura.
+ */
+#define METRICS_SHM_BUSY -2
+
+/**
+ * @brief Encabezado del segmento.
+ */
+typedef struct
+{
+    uint32_t magic;              /**< METRICS_SHM_MAGIC una vez que el segmento está inicializado. */
+    uint32_t version;            /**< METRICS_SHM_VERSION. */
+    uint32_t header_size;        /**< sizeof(metrics_shm_header_t). */
+    uint32_t descriptor_size;    /**< sizeof(metrics_shm_descriptor_t). */
+    uint32_t metric_count;       /**< Cantidad de descriptores y de valores. */
+    uint32_t reserved;           /**< Sin uso, en cero. */
+    uint64_t descriptors_offset; /**< Desplazamiento de la tabla de descriptores desde el inicio del segmento. */
+    uint64_t values_offset;      /**< Desplazamiento del arreglo de valores desde el inicio del segmento. */
+    uint64_t total_size;         /**< Tamaño total del segmento en bytes. */
+    uint64_t sequence;           /**< Contador del seqlock: impar mientras el escritor actualiza. */
+    int64_t timestamp_ms;        /**< Momento de la última publicación (ms desde epoch), protegido por el seqlock. */
+} metrics_shm_header_t;
+
+/**
+ * @brief Descriptor de una métrica del segmento.
+ */
+typedef struct
+{
+    char name[METRICS_SHM_NAME_SIZE]; /**< Nombre de la métrica, terminado en '\0'. */
+    uint32_t type;                    /**< Tipo de métrica (METRICS_SHM_TYPE_*). */
+    uint32_t reserved;                /**< Sin uso, en cero. */
+} metrics_shm_descriptor_t;
+
+/**
+ * @brief Segmento abierto para lectura.
+ */
+typedef struct
+{
+    const void* base;                            /**< Inicio del mapeo. */
+    size_t size;                                 /**< Tamaño del mapeo. */
+    const metrics_shm_header_t* header;          /**< Encabezado dentro del mapeo. */
+    const metrics_shm_descriptor_t* descriptors; /**< Tabla de descriptores dentro del mapeo. */
+    const double* values;                        /**< Arreglo de valores dentro del mapeo. */
+    dev_t device;                                /**< Dispositivo del archivo mapeado. */
+    ino_t inode;                                 /**< Inodo del archivo mapeado. */
+} metrics_shm_reader_t;
+
+/**
+ * @brief Tamaño total de un segmento con la cantidad de métricas indicada.
+ * @param metric_count Cantidad de métricas.
+ * @param descriptors_offset Si no es NULL, recibe el desplazamiento de la tabla de descriptores.
+ * @param values_offset Si no es NULL, recibe el desplazamiento del arreglo de valores.
+ * @return Tamaño en bytes.
+ */
+size_t metrics_shm_layout(size_t metric_count, size_t* descriptors_offset, size_t* values_offset);
+
+/**
+ * @brief Abre y mapea en modo solo lectura un segmento publicado por el monitor.
+ * @param reader Lector a inicializar.
+ * @param path Ruta del segmento.
+ * @return METRICS_SHM_OK, o METRICS_SHM_ERROR si no existe, no está inicializado o tiene otro formato.
+ */
+int metrics_shm_open(metrics_shm_reader_t* reader, const char* path);
+
+/**
+ * @brief Cantidad de métricas del segmento.
+ * @param reader Lector abierto.
+ * @return Cantidad de métricas.
+ */
+size_t metrics_shm_count(const metrics_shm_reader_t* reader);
+
+/**
+ * @brief Nombre de una métrica del segmento.
+ * @param reader Lector abierto.
+ * @param index Índice en [0, metrics_shm_count()).
+ * @return Nombre de la métrica, o NULL si el índice está fuera de rango.
+ */
+const char* metrics_shm_name(const metrics_shm_reader_t* reader, size_t index);
+
+/**
+ * @brief Copia una instantánea consistente de todos los valores.
+ *
+ * Reintenta mientras el escritor esté publicando; no realiza llamadas al sistema.
+ *
+ * @param reader Lector abierto.
+ * @param values Destino, con lugar para metrics_shm_count() valores.
+ * @param timestamp_ms Si no es NULL, recibe el momento de la publicación copiada.
+ * @param sequence Si no es NULL, recibe el número de secuencia de la publicación copiada.
+ * @return METRICS_SHM_OK, o METRICS_SHM_BUSY si no se obtuvo una copia consistente.
+ */
+int metrics_shm_read(const metrics_shm_reader_t* reader, double* values, int64_t* timestamp_ms, uint64_t* sequence);
+
+/**
+ * @brief Indica si el segmento mapeado sigue siendo el publicado en la ruta.
+ *
+ * Cuando el monitor se reinicia crea un segmento nuevo; los lectores de larga duración deben volver a abrir la ruta
+ * cuando esta función devuelve 0.
+ *
+ * @param reader Lector abierto.
+ * @param path Ruta con la que se abrió el lector.
+ * @return 1 si el segmento es el actual, 0 en caso contrario.
+ */
+int metrics_shm_is_current(const metrics_shm_reader_t* reader, const char* path);
+
+/**
+ * @brief Libera el mapeo del segmento.
+ * @param reader Lector abierto.
+ */
+void metrics_shm_close(metrics_shm_reader_t* reader);
+
+#endif // METRICS_SHM_H
@@ -0,0 +1,46 @@
+/**
+ * @file microburst.h
+ * @brief Detección de microrráfagas de red a partir de los contadores de bytes de sysfs leídos cada pocos
+ *        milisegundos.
+ *
+ * Un hilo dedicado relee /sys/class/net/<if>/statistics/rx_bytes y tx_bytes de cada interfaz elegida con pread sobre
+ * descriptores abiertos al inicio, sin reservar memoria ni tomar locks. Cada lectura da la tasa desde la anterior; la
+ * más alta de cada sentido y las ráfagas (lecturas consecutivas por encima del umbral, contadas al empezar) se
+ * acumulan con operaciones atómicas hasta el próximo ciclo, que las publica en el grupo network:
+ *
+ * - network_rx_peak_rate_bps{interface} y network_tx_peak_rate_bps{interface}: tasa más alta del intervalo
+ * - network_rx_microbursts{interface} y network_tx_microbursts{interface}: histograma de ráfagas por intervalo
+ *
+ * El umbral por defecto es el 80% de la velocidad del enlace informada en /sys/class/net/<if>/speed; en interfaces
+ * virtuales, que no la informan, hay que indicarlo explícitamente o solo se publican los picos. Algunos drivers
+ * actualizan los contadores cada cierto tiempo y no por paquete: en ellos una lectura acumula todo lo transferido
+ * desde la actualización anterior y el pico no refleja una ráfaga real.
+ */
+
+#ifndef MICROBURST_H
+#define MICROBURST_H
+
+/**
+ * @brief Sin CPU fija para el hilo de muestreo.
+ */
+#define MICROBURST_NO_CPU -1
+
+/**
+ * @brief Abre los contadores de las interfaces, crea las métricas e inicia el hilo de muestreo; debe llamarse después
+ *        de init_metrics.
+ * @param interfaces Nombres de las interfaces separados por comas.
+ * @param interval_ms Milisegundos entre lecturas.
+ * @param threshold_mbps Umbral de ráfaga en Mbit/s, o 0 para el 80% de la velocidad de cada enlace.
+ * @param cpu CPU a la que se fija el hilo, o MICROBURST_NO_CPU.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int microburst_init(const char* interfaces, unsigned int interval_ms, unsigned int threshold_mbps, int cpu);
+
+/**
+ * @brief Publica los picos y las ráfagas acumulados desde el ciclo anterior y los reinicia.
+ *
+ * Se llama una vez por ciclo de recolección; no hace nada si el muestreo no está activo.
+ */
+void microburst_publish(void);
+
+#endif // MICROBURST_H
@@ -0,0 +1,29 @@
+/**
+ * @file range_api.h
+ * @brief Endpoint HTTP de consulta del historial reciente de una serie.
+ */
+
+#ifndef RANGE_API_H
+#define RANGE_API_H
+
+/**
+ * @brief Ruta del endpoint.
+ */
+#define RANGE_API_URL "/api/v1/range"
+
+/**
+ * @brief Registra el endpoint en el servidor HTTP; debe llamarse antes de iniciarlo.
+ *
+ * GET /api/v1/range?metric=NOMBRE[&since=SEGUNDOS][&step=SEGUNDOS] responde, con la forma de una matriz de la API de
+ * Prometheus, las muestras de la serie posteriores a since (segundos desde epoch, admite decimales) o todo el
+ * historial si se omite.
+ *
+ * step elige la resolución: por debajo de 10 s se devuelven las muestras crudas; desde 10 s, los intervalos de 10 s, y
+ * desde 60 s, los de 1 min. En los dos últimos casos el resultado tiene cuatro series con la etiqueta rollup (min, max,
+ * avg y last), con la marca de tiempo del inicio de cada intervalo. data.resolution indica el nivel usado.
+ *
+ * @return 0 si se registró, -1 en caso de error.
+ */
+int range_api_register(void);
+
+#endif // RANGE_API_H
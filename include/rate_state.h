@@ -0,0 +1,112 @@
+/**
+ * @file rate_state.h
+ * @brief Lecturas anteriores de los contadores de disco, red y contexto con las que se calculan las tasas, y su
+ * persistencia en un archivo de estado para reinicios en caliente.
+ *
+ * Cada lectura lleva una marca CLOCK_MONOTONIC, que en Linux cuenta desde el arranque del sistema y no depende del
+ * proceso; junto con el boot id del kernel permite que un proceso nuevo calcule tasas desde el primer ciclo usando
+ * las lecturas de la ejecución anterior, siempre que no haya habido un reinicio del sistema entre ambas.
+ */
+
+#ifndef RATE_STATE_H
+#define RATE_STATE_H
+
+#include "metrics.h"
+
+/**
+ * @brief Identificador del formato del archivo de estado ("SMRS" en little endian).
+ */
+#define RATE_STATE_MAGIC 0x53524D53u
+
+/**
+ * @brief Versión del formato; un archivo de otra versión se ignora.
+ */
+#define RATE_STATE_VERSION 1
+
+/**
+ * @brief Segundos entre escrituras periódicas del archivo de estado.
+ */
+#define RATE_STATE_SAVE_INTERVAL 60
+
+/**
+ * @brief Antigüedad máxima en segundos de un estado para reutilizarlo; uno más viejo daría tasas promediadas sobre
+ * un intervalo demasiado largo.
+ */
+#define RATE_STATE_MAX_AGE 300
+
+/**
+ * @brief Tamaño del boot id del kernel, incluyendo el terminador.
+ */
+#define RATE_STATE_BOOT_ID_SIZE 40
+
+/**
+ * @brief Lectura anterior de los contadores de disco.
+ */
+typedef struct
+{
+    int valid;                /**< Distinto de cero si hay una lectura. */
+    double monotonic_seconds; /**< Momento de la lectura (CLOCK_MONOTONIC). */
+    disk_stats_t stats;       /**< Contadores leídos. */
+} disk_rate_state_t;
+
+/**
+ * @brief Lectura anterior de los contadores de red.
+ */
+typedef struct
+{
+    int valid;                       /**< Distinto de cero si hay una lectura. */
+    double monotonic_seconds;        /**< Momento de la lectura (CLOCK_MONOTONIC). */
+    network_interface_stats_t stats; /**< Contadores leídos. */
+} network_rate_state_t;
+
+/**
+ * @brief Lectura anterior de los contadores de contexto.
+ */
+typedef struct
+{
+    int valid;                /**< Distinto de cero si hay una lectura. */
+    double monotonic_seconds; /**< Momento de la lectura (CLOCK_MONOTONIC). */
+    context_stats_t stats;    /**< Contadores leídos. */
+} context_rate_state_t;
+
+/**
+ * @brief Lecturas anteriores de todos los colectores con tasas.
+ */
+typedef struct
+{
+    disk_rate_state_t disk;       /**< Disco. */
+    network_rate_state_t network; /**< Red. */
+    context_rate_state_t context; /**< Cambios de contexto, procesos creados e interrupciones. */
+} rate_state_t;
+
+/**
+ * @brief Estado del proceso, o la copia ligada al hilo que llama con rate_state_bind.
+ *
+ * Solo el hilo de recolección usa el estado del proceso; un hilo de grupo trabaja sobre una copia que el hilo de
+ * recolección le prepara y, si la actualización termina a tiempo, vuelve a copiar al estado del proceso.
+ *
+ * @return Puntero al estado.
+ */
+rate_state_t* rate_state_get(void);
+
+/**
+ * @brief Liga una copia del estado al hilo que llama: rate_state_get la devuelve en lugar del estado del proceso.
+ * @param state Copia a usar, o NULL para volver al estado del proceso.
+ */
+void rate_state_bind(rate_state_t* state);
+
+/**
+ * @brief Carga el estado guardado si corresponde a este arranque del sistema y no es demasiado viejo.
+ * @param path Ruta del archivo de estado.
+ * @return 0 si se cargó, -1 si no existe, es de otro arranque, es viejo o tiene otro formato.
+ */
+int rate_state_load(const char* path);
+
+/**
+ * @brief Guarda el estado en un archivo temporal y lo renombra sobre la ruta.
+ * @param path Ruta del archivo de estado.
+ * @return 0 si se guardó, -1 en caso de error.
+ */
+int rate_state_save(const char* path);
+
+#endif // RATE_STATE_H
@@ -0,0 +1,41 @@
+/**
+ * @file remote_write.h
+ * @brief Envío de las series a un receptor remote_write de Prometheus, para hosts que Prometheus no puede scrapear.
+ *
+ * Cada ciclo agrega las lecturas nuevas a un lote en memoria; cada cierto intervalo el lote se codifica como un
+ * WriteRequest protobuf (una TimeSeries por serie, con las etiquetas __name__, instance y job), se comprime con
+ * Snappy (ver snappy.h) y pasa a una cola acotada. Un hilo envía los lotes en orden por HTTP/1.1 sobre una conexión
+ * persistente y reintenta con espera exponencial los errores de red, 5xx y 429; los demás 4xx descartan el lote. Si
+ * la cola se llena se descarta el lote más antiguo. Solo se admiten URLs http://.
+ */
+
+#ifndef REMOTE_WRITE_H
+#define REMOTE_WRITE_H
+
+/**
+ * @brief Versión del protocolo informada en X-Prometheus-Remote-Write-Version.
+ */
+#define REMOTE_WRITE_PROTOCOL_VERSION "0.1.0"
+
+/**
+ * @brief Valor de la etiqueta job de las series enviadas.
+ */
+#define REMOTE_WRITE_JOB "system-monitor"
+
+/**
+ * @brief Prepara el envío e inicia el hilo emisor; debe llamarse después de registrar todas las series.
+ * @param url Receptor, de la forma http://host[:puerto][/ruta].
+ * @param interval_seconds Segundos de lecturas acumuladas en cada lote.
+ * @param queue_batches Lotes que pueden esperar envío antes de descartar el más antiguo.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int remote_write_init(const char* url, unsigned int interval_seconds, unsigned int queue_batches);
+
+/**
+ * @brief Agrega al lote la última lectura de cada serie, si es nueva, y cierra el lote cuando vence el intervalo.
+ *
+ * Se llama una vez por ciclo de recolección; no hace nada si el envío no está activo.
+ */
+void remote_write_record(void);
+
+#endif // REMOTE_WRITE_H
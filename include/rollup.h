@@ -0,0 +1,75 @@
+/**
+ * @file rollup.h
+ * @brief Niveles de agregación del historial (10 s y 1 min) con mínimo, máximo, promedio y último valor por
+ * intervalo.
+ *
+ * Los agregados se calculan incrementalmente a medida que llegan las lecturas y cada nivel ocupa un anillo de tamaño
+ * fijo por serie, de modo que consultar un día completo no requiere decodificar las muestras crudas.
+ */
+
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stddef.h>
+
+/**
+ * @brief Niveles de agregación, de menor a mayor resolución temporal.
+ */
+typedef enum
+{
+    ROLLUP_TIER_10S, /**< Intervalos de 10 segundos, 6 horas. */
+    ROLLUP_TIER_1M,  /**< Intervalos de 1 minuto, 24 horas. */
+    ROLLUP_TIER_COUNT
+} rollup_tier_t;
+
+/**
+ * @brief Agregado de las lecturas de un intervalo.
+ */
+typedef struct
+{
+    long long start_ms; /**< Inicio del intervalo (ms desde epoch), múltiplo del ancho del nivel. */
+    double min;         /**< Valor mínimo. */
+    double max;         /**< Valor máximo. */
+    double sum;         /**< Suma de los valores, para el promedio. */
+    double last;        /**< Último valor. */
+    unsigned int count; /**< Cantidad de lecturas. */
+} rollup_bucket_t;
+
+/**
+ * @brief Reserva los anillos de cada nivel para las series registradas.
+ * @return 0 si se inicializó, -1 en caso de error.
+ */
+int rollup_init(void);
+
+/**
+ * @brief Agrega la última lectura de cada serie a cada nivel, si es posterior a la ya agregada.
+ *
+ * Se llama una vez por ciclo de recolección, después de actualizar las series.
+ */
+void rollup_record(void);
+
+/**
+ * @brief Ancho de los intervalos de un nivel.
+ * @param tier Nivel.
+ * @return Ancho en milisegundos.
+ */
+long long rollup_tier_width_ms(rollup_tier_t tier);
+
+/**
+ * @brief Cantidad de intervalos que conserva un nivel por serie.
+ * @param tier Nivel.
+ * @return Capacidad del anillo.
+ */
+size_t rollup_tier_capacity(rollup_tier_t tier);
+
+/**
+ * @brief Copia los intervalos de una serie que terminan después de since_ms, del más antiguo al más reciente.
+ * @param series_index Índice de la serie en la tabla de series.
+ * @param tier Nivel.
+ * @param since_ms Solo se copian intervalos con start_ms + ancho > since_ms.
+ * @param out Destino, con lugar para rollup_tier_capacity(tier) intervalos.
+ * @return Cantidad de intervalos copiados.
+ */
+size_t rollup_query(size_t series_index, rollup_tier_t tier, long long since_ms, rollup_bucket_t* out);
+
+#endif // ROLLUP_H
@@ -0,0 +1,38 @@
+/**
+ * @file self_metrics.h
+ * @brief Autoinstrumentación: cuánto tarda el propio agente en recolectar las métricas y en responder los scrapes.
+ *
+ * Las duraciones se miden con CLOCK_MONOTONIC y se registran en histogramas del collector "self":
+ * collector_duration_seconds{collector} por cada actualización de un grupo, scrape_render_seconds y scrape_bytes por
+ * cada render del registro, y tick_lag_seconds con el retraso del inicio de cada ciclo respecto del previsto. Cada
+ * medición son dos lecturas del reloj, que no entran al kernel, y una observación en un histograma.
+ */
+
+#ifndef SELF_METRICS_H
+#define SELF_METRICS_H
+
+/**
+ * @brief Nombre del collector de la autoinstrumentación, seleccionable con /metrics?collect[]=self.
+ */
+#define SELF_COLLECTOR "self"
+
+/**
+ * @brief Crea y registra los histogramas y empieza a medir los renders; debe llamarse después de init_metrics.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int self_metrics_init(void);
+
+/**
+ * @brief Registra la duración de la actualización de un grupo de métricas.
+ * @param collector Nombre del grupo, usado como valor de la etiqueta collector.
+ * @param start Instante en que empezó la actualización, según timing_now.
+ */
+void self_metrics_collector_done(const char* collector, double start);
+
+/**
+ * @brief Registra el retraso con que empieza un ciclo de recolección.
+ * @param scheduled Instante previsto para el inicio del ciclo, según timing_now.
+ */
+void self_metrics_tick_started(double scheduled);
+
+#endif // SELF_METRICS_H
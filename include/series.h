@@ -0,0 +1,95 @@
+/**
+ * @file series.h
+ * @brief Tabla de las series publicadas por el monitor, compartida por los distintos exportadores.
+ *
+ * Cada gauge creado con series_gauge_new queda registrado con su nombre, y series_set actualiza a la vez el gauge de
+ * Prometheus y el último valor de la tabla, de modo que los exportadores que no pasan por el registro (memoria
+ * compartida, historial, etc.) recorren la tabla en lugar de conocer cada métrica.
+ *
+ * La tabla solo se escribe en el hilo de recolección, que es también el que la recorre. Un hilo de grupo llama a
+ * series_defer para que sus series_set se acumulen en un lote, y el hilo de recolección aplica el lote con
+ * series_apply cuando la actualización termina a tiempo, o lo descarta.
+ */
+
+#ifndef SERIES_H
+#define SERIES_H
+
+#include <prom.h>
+#include <stddef.h>
+
+/**
+ * @brief Cantidad máxima de series registradas.
+ */
+#define MAX_SERIES 64
+
+/**
+ * @brief Una serie publicada por el monitor.
+ */
+typedef struct
+{
+    prom_gauge_t* gauge;     /**< Gauge de Prometheus asociado. */
+    const char* name;        /**< Nombre de la métrica. */
+    const char* help;        /**< Descripción de la métrica. */
+    double value;            /**< Último valor publicado. */
+    long long timestamp_ms;  /**< Momento de la lectura del último valor (ms desde epoch), 0 si aún no hay lectura. */
+} series_t;
+
+/**
+ * @brief Escrituras de series acumuladas por un hilo de grupo, a aplicar en el hilo de recolección.
+ */
+typedef struct
+{
+    struct
+    {
+        prom_gauge_t* gauge;    /**< Gauge de la serie. */
+        double value;           /**< Valor leído. */
+        long long timestamp_ms; /**< Momento de la lectura (ms desde epoch). */
+    } updates[MAX_SERIES];      /**< Última escritura de cada serie, en el orden de la primera. */
+    size_t count;               /**< Cantidad de escrituras en updates. */
+} series_batch_t;
+
+/**
+ * @brief Crea un gauge sin etiquetas y lo registra en la tabla de series.
+ *
+ * El gauge no se registra en el registro de Prometheus; eso sigue a cargo de quien lo crea.
+ *
+ * @param name Nombre de la métrica; debe permanecer válido mientras viva el programa.
+ * @param help Descripción de la métrica; debe permanecer válida mientras viva el programa.
+ * @return El gauge creado, o NULL en caso de error o si la tabla está llena.
+ */
+prom_gauge_t* series_gauge_new(const char* name, const char* help);
+
+/**
+ * @brief Publica un valor: actualiza el gauge de Prometheus y la tabla de series.
+ * @param gauge Gauge creado con series_gauge_new.
+ * @param value Valor leído.
+ * @param timestamp_ms Momento de la lectura (ms desde epoch).
+ */
+void series_set(prom_gauge_t* gauge, double value, long long timestamp_ms);
+
+/**
+ * @brief Hace que los series_set del hilo que llama se acumulen en un lote en lugar de publicarse.
+ * @param batch Lote donde acumularlos, o NULL para volver a publicarlos directamente.
+ */
+void series_defer(series_batch_t* batch);
+
+/**
+ * @brief Publica las escrituras de un lote; debe llamarse en el hilo de recolección.
+ * @param batch Lote acumulado con series_defer.
+ */
+void series_apply(const series_batch_t* batch);
+
+/**
+ * @brief Cantidad de series registradas.
+ * @return Número de series en la tabla.
+ */
+size_t series_count(void);
+
+/**
+ * @brief Devuelve una serie de la tabla.
+ * @param index Índice en [0, series_count()).
+ * @return Puntero a la serie, o NULL si el índice está fuera de rango.
+ */
+const series_t* series_get(size_t index);
+
+#endif // SERIES_H
@@ -0,0 +1,27 @@
+/**
+ * @file shm_export.h
+ * @brief Publicación de los valores de las series en un segmento de memoria compartida (ver metrics_shm.h).
+ */
+
+#ifndef SHM_EXPORT_H
+#define SHM_EXPORT_H
+
+/**
+ * @brief Crea el segmento con un descriptor por cada serie registrada.
+ *
+ * El segmento se arma completo en un archivo temporal y se renombra sobre la ruta, de modo que un lector nunca ve uno
+ * a medio inicializar y los lectores de una ejecución anterior detectan el reemplazo con metrics_shm_is_current.
+ * Debe llamarse después de registrar todas las series.
+ *
+ * @param path Ruta del segmento, normalmente bajo /dev/shm.
+ * @return 0 si el segmento quedó publicado, -1 en caso de error.
+ */
+int shm_export_init(const char* path);
+
+/**
+ * @brief Copia los últimos valores de las series al segmento bajo el seqlock.
+ * @param timestamp_ms Momento de la publicación (ms desde epoch).
+ */
+void shm_export_publish(long long timestamp_ms);
+
+#endif // SHM_EXPORT_H
@@ -0,0 +1,61 @@
+/**
+ * @file snappy.h
+ * @brief Compresión Snappy en formato de bloque (sin framing), el que exige remote_write de Prometheus.
+ *
+ * El bloque empieza con el largo sin comprimir como varint y sigue con elementos literales o copias de hasta 64 bytes
+ * con desplazamientos de 1 o 2 bytes. El compresor procesa la entrada en fragmentos de 64 KiB con una tabla hash de
+ * secuencias de 4 bytes, como la implementación de referencia; no busca la mejor coincidencia sino la más barata.
+ */
+
+#ifndef SNAPPY_H
+#define SNAPPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Operación exitosa.
+ */
+#define SNAPPY_OK 0
+
+/**
+ * @brief Bloque comprimido inválido o destino demasiado chico.
+ */
+#define SNAPPY_ERROR -1
+
+/**
+ * @brief Tamaño máximo que puede ocupar la compresión de length bytes.
+ * @param length Bytes sin comprimir.
+ * @return Cota superior del tamaño comprimido.
+ */
+size_t snappy_max_compressed_length(size_t length);
+
+/**
+ * @brief Comprime un bloque.
+ * @param input Datos a comprimir.
+ * @param length Bytes de input.
+ * @param output Destino, con lugar para snappy_max_compressed_length(length) bytes.
+ * @return Bytes escritos en output.
+ */
+size_t snappy_compress(const uint8_t* input, size_t length, uint8_t* output);
+
+/**
+ * @brief Lee el largo sin comprimir declarado al principio de un bloque.
+ * @param input Bloque comprimido.
+ * @param length Bytes de input.
+ * @param uncompressed Recibe el largo sin comprimir.
+ * @return SNAPPY_OK o SNAPPY_ERROR.
+ */
+int snappy_uncompressed_length(const uint8_t* input, size_t length, size_t* uncompressed);
+
+/**
+ * @brief Descomprime un bloque.
+ * @param input Bloque comprimido.
+ * @param length Bytes de input.
+ * @param output Destino, con lugar para el largo que indica snappy_uncompressed_length.
+ * @param capacity Bytes disponibles en output.
+ * @return SNAPPY_OK o SNAPPY_ERROR.
+ */
+int snappy_uncompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity);
+
+#endif // SNAPPY_H
@@ -0,0 +1,42 @@
+/**
+ * @file stream_api.h
+ * @brief Endpoint HTTP que envía en vivo, como Server-Sent Events, las series que cambiaron en cada ciclo.
+ *
+ * GET /stream responde text/event-stream. El primer evento (snapshot) trae el último valor de todas las series; los
+ * siguientes (update), uno por ciclo, solo las que cambiaron de valor. Los datos de cada evento son
+ * {"timestamp":SEGUNDOS,"values":{"NOMBRE":"VALOR",...}}, con los valores como texto al igual que la API de rango.
+ *
+ * Cada ciclo el evento se arma una sola vez y se comparte entre todos los clientes. Cada cliente tiene una cola
+ * acotada de eventos pendientes; si se llena porque el cliente no lee a tiempo, se lo desconecta en lugar de demorar
+ * la recolección. Mientras un cliente no tiene eventos pendientes su conexión queda suspendida, sin ocupar los hilos
+ * del servidor; aun así cuenta para los límites de conexiones.
+ */
+
+#ifndef STREAM_API_H
+#define STREAM_API_H
+
+/**
+ * @brief Ruta del endpoint.
+ */
+#define STREAM_API_URL "/stream"
+
+/**
+ * @brief Clientes simultáneos del endpoint; por encima se responde 503.
+ */
+#define STREAM_MAX_CLIENTS 64
+
+/**
+ * @brief Registra el endpoint en el servidor HTTP; debe llamarse antes de iniciarlo.
+ * @param queue_events Eventos que pueden esperar en la cola de un cliente antes de desconectarlo.
+ * @return 0 si se registró, -1 en caso de error.
+ */
+int stream_api_register(unsigned int queue_events);
+
+/**
+ * @brief Arma el evento con las series que cambiaron desde el ciclo anterior y lo encola para cada cliente.
+ *
+ * Se llama una vez por ciclo de recolección, después de actualizar las series.
+ */
+void stream_api_publish(void);
+
+#endif // STREAM_API_H
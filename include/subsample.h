@@ -0,0 +1,37 @@
+/**
+ * @file subsample.h
+ * @brief Muestreo de alta frecuencia de la CPU, la cola de ejecución y la red, para ver las ráfagas que el promedio de
+ *        cada ciclo esconde.
+ *
+ * Un hilo lee varias veces por segundo solo los campos necesarios: la línea "cpu" de /proc/stat, los procesos en
+ * ejecución de /proc/loadavg y los bytes recibidos y enviados de la interfaz principal en /proc/net/dev. Los archivos
+ * quedan abiertos y se releen con pread, sin fopen ni stdio por muestra. Cada lectura se observa en un summary de
+ * Prometheus con los cuantiles 0 (mínimo), 0.5, 0.99 y 1 (máximo) del último intervalo de exposición, estimados en
+ * streaming con una precisión relativa del 1%:
+ *
+ * - cpu_usage_percentage_distribution en el grupo cpu
+ * - processes_running_distribution en el grupo processes
+ * - network_rx_rate_bps_distribution y network_tx_rate_bps_distribution en el grupo network
+ *
+ * A 20 Hz el muestreo cuesta unas pocas decenas de microsegundos por lectura, por lo que está activo por defecto. La
+ * CPU se mide en jiffies (normalmente 100 por segundo y por núcleo), así que con pocos núcleos y frecuencias altas
+ * cada lectura tiene una resolución gruesa.
+ */
+
+#ifndef SUBSAMPLE_H
+#define SUBSAMPLE_H
+
+/**
+ * @brief Crea los summaries en los grupos de sus métricas e inicia el hilo de muestreo; debe llamarse después de
+ *        init_metrics.
+ *
+ * Las fuentes que no pueden abrirse se omiten con un aviso.
+ *
+ * @param rate_hz Lecturas por segundo.
+ * @param window_seconds Segundos de lecturas que cubren los cuantiles; un scrape ve entre los últimos tres cuartos de
+ * la ventana y la ventana completa.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int subsample_init(unsigned int rate_hz, unsigned int window_seconds);
+
+#endif // SUBSAMPLE_H
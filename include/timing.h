@@ -0,0 +1,73 @@
+/**
+ * @file timing.h
+ * @brief Lectura de los relojes del sistema, compartida por todos los módulos del programa.
+ *
+ * El programa lee todos sus relojes a través de este módulo. Los intervalos, plazos y esperas usan CLOCK_MONOTONIC,
+ * que en Linux cuenta desde el arranque del sistema y no depende de cambios en la hora: timing_now lo lee en segundos
+ * y timing_monotonic como instante absoluto para clock_nanosleep y pthread_cond_timedwait. Las marcas de tiempo de
+ * las muestras (series, chunks, rollups, envío remoto y exposición) son hora de pared en milisegundos, leída con
+ * timing_wall_ms. Los relojes de CPU (CLOCK_THREAD_CPUTIME_ID, CLOCK_PROCESS_CPUTIME_ID) se leen con
+ * timing_clock_seconds.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <time.h>
+
+/**
+ * @brief Nanosegundos en un segundo.
+ */
+#define TIMING_NANOSECONDS_PER_SECOND 1000000000LL
+
+/**
+ * @brief Nanosegundos en un milisegundo.
+ */
+#define TIMING_NANOSECONDS_PER_MILLISECOND 1000000LL
+
+/**
+ * @brief Lee un reloj en nanosegundos.
+ * @param clock Reloj a leer.
+ * @return Nanosegundos del reloj.
+ */
+long long timing_clock_ns(clockid_t clock);
+
+/**
+ * @brief Lee un reloj en segundos.
+ * @param clock Reloj a leer.
+ * @return Segundos del reloj.
+ */
+double timing_clock_seconds(clockid_t clock);
+
+/**
+ * @brief Momento actual en segundos según CLOCK_MONOTONIC.
+ * @return Segundos desde el arranque del sistema.
+ */
+double timing_now(void);
+
+/**
+ * @brief Lee CLOCK_MONOTONIC como instante absoluto.
+ * @param time Instante actual.
+ */
+void timing_monotonic(struct timespec* time);
+
+/**
+ * @brief Hora de pared actual según CLOCK_REALTIME.
+ * @return Milisegundos desde la época Unix.
+ */
+long long timing_wall_ms(void);
+
+/**
+ * @brief Espera hasta un momento de CLOCK_MONOTONIC; vuelve antes si llega una señal.
+ * @param when Momento en segundos, como los que devuelve timing_now.
+ */
+void timing_sleep_until(double when);
+
+/**
+ * @brief Adelanta un instante absoluto, como los que reciben clock_nanosleep y pthread_cond_timedwait.
+ * @param time Instante a adelantar.
+ * @param ns Nanosegundos a sumar.
+ */
+void timing_add_ns(struct timespec* time, long long ns);
+
+#endif // TIMING_H
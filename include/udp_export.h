@@ -0,0 +1,31 @@
+/**
+ * @file udp_export.h
+ * @brief Envío de cada ciclo por UDP como registros StatsD o del protocolo de líneas de InfluxDB.
+ *
+ * Las lecturas nuevas de cada ciclo se formatean una vez, se empaquetan en datagramas que no superan el MTU
+ * configurado (sin cortar registros, separados por saltos de línea) y se envían todos con un único sendmmsg. El envío
+ * no bloquea: si el socket no acepta más datagramas, los que faltan se descartan y se cuentan.
+ */
+
+#ifndef UDP_EXPORT_H
+#define UDP_EXPORT_H
+
+#include "config.h"
+
+/**
+ * @brief Resuelve el destino y abre el socket; debe llamarse después de registrar todas las series.
+ * @param target Destino host:puerto, o [dirección IPv6]:puerto.
+ * @param format Formato de los registros.
+ * @param mtu MTU del camino hacia el destino; se descuentan los encabezados IP y UDP.
+ * @return 0 si se inició, -1 en caso de error.
+ */
+int udp_export_init(const char* target, udp_format_t format, unsigned int mtu);
+
+/**
+ * @brief Envía las lecturas nuevas de las series desde el ciclo anterior.
+ *
+ * Se llama una vez por ciclo de recolección; no hace nada si el envío no está activo.
+ */
+void udp_export_publish(void);
+
+#endif // UDP_EXPORT_H
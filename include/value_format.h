@@ -0,0 +1,27 @@
+/**
+ * @file value_format.h
+ * @brief Texto de un valor double con la menor precisión que lo reproduce exactamente.
+ *
+ * Todas las salidas de texto del programa y de metrics-shm-dump escriben los valores con esta función, para que un
+ * mismo valor se lea igual en cualquiera de ellas.
+ */
+
+#ifndef VALUE_FORMAT_H
+#define VALUE_FORMAT_H
+
+#include <stddef.h>
+
+/**
+ * @brief Tamaño de buffer suficiente para cualquier valor escrito por value_format.
+ */
+#define VALUE_FORMAT_BUFFER_SIZE 32
+
+/**
+ * @brief Escribe un valor con la menor precisión, entre 15 y 17 dígitos, que lo reproduce exactamente.
+ * @param value Valor a escribir.
+ * @param buffer Destino, de al menos VALUE_FORMAT_BUFFER_SIZE bytes.
+ * @param size Tamaño de buffer.
+ */
+void value_format(double value, char* buffer, size_t size);
+
+#endif // VALUE_FORMAT_H
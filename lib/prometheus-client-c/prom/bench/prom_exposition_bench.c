@@ -0,0 +1,114 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file prom_exposition_bench.c
+ * @brief Compares render time and payload size of the text and delimited protobuf exposition formats.
+ *
+ * The registry holds labelled gauges, labelled counters and a labelled histogram, split evenly by series count.
+ *
+ * Usage: prom_exposition_bench [series] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "prom.h"
+
+#define DEFAULT_SERIES 30000
+#define DEFAULT_ITERATIONS 20
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char* name, prom_collector_registry_t* registry, prom_exposition_format_t format, int iterations)
+{
+    double* times = malloc(sizeof(double) * iterations);
+    size_t bytes = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        double start = now_seconds();
+        const char* out = prom_collector_registry_bridge_format(registry, format, &bytes);
+        times[i] = now_seconds() - start;
+        free((void*)out);
+    }
+    qsort(times, iterations, sizeof(double), compare_doubles);
+    printf("%-9s median %8.3f ms  best %8.3f ms  %10zu bytes\n", name, times[iterations / 2] * 1e3, times[0] * 1e3,
+           bytes);
+    free(times);
+}
+
+int main(int argc, const char** argv)
+{
+    int series = argc > 1 ? atoi(argv[1]) : DEFAULT_SERIES;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    const char* keys[] = {"device", "instance"};
+
+    prom_collector_registry_t* registry = prom_collector_registry_new("bench");
+    prom_gauge_t* gauge = prom_gauge_new("bench_usage_percentage", "gauge under benchmark", 2, keys);
+    prom_counter_t* counter = prom_counter_new("bench_bytes_total", "counter under benchmark", 2, keys);
+    prom_histogram_t* histogram =
+        prom_histogram_new("bench_latency_seconds", "histogram under benchmark", NULL, 2, keys);
+    prom_collector_t* collector = prom_collector_new("bench");
+    prom_collector_add_metric(collector, gauge);
+    prom_collector_add_metric(collector, counter);
+    prom_collector_add_metric(collector, histogram);
+    prom_collector_registry_register_collector(registry, collector);
+
+    srand(42);
+    for (int i = 0; i < series; i++)
+    {
+        char device[16];
+        char instance[16];
+        snprintf(device, sizeof(device), "dev%d", i % 64);
+        snprintf(instance, sizeof(instance), "%d", i);
+        const char* values[] = {device, instance};
+        switch (i % 3)
+        {
+        case 0:
+            prom_gauge_set(gauge, 100.0 * rand() / RAND_MAX, values);
+            break;
+        case 1:
+            prom_counter_add(counter, (double)((unsigned long long)rand() * 4096ULL), values);
+            break;
+        default:
+            for (int j = 0; j < 8; j++)
+                prom_histogram_observe(histogram, (double)rand() / RAND_MAX, values);
+            break;
+        }
+    }
+
+    printf("%d series, %d iterations\n", series, iterations);
+    run("text", registry, PROM_EXPOSITION_TEXT, iterations);
+    run("protobuf", registry, PROM_EXPOSITION_PROTOBUF, iterations);
+
+    prom_collector_registry_destroy(registry);
+    return 0;
+}
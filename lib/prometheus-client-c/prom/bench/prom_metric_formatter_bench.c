@@ -0,0 +1,157 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file prom_metric_formatter_bench.c
+ * @brief Compares the text render of a 100k-sample metric using prom_dtoa against the former sprintf("%.17g").
+ *
+ * Usage: prom_metric_formatter_bench [samples] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "prom.h"
+#include "prom_linked_list_t.h"
+#include "prom_map_i.h"
+#include "prom_map_t.h"
+#include "prom_metric_formatter_i.h"
+#include "prom_metric_formatter_t.h"
+#include "prom_metric_i.h"
+#include "prom_metric_sample_i.h"
+#include "prom_metric_sample_t.h"
+#include "prom_metric_t.h"
+#include "prom_string_builder_i.h"
+
+#define DEFAULT_SAMPLES 100000
+#define DEFAULT_ITERATIONS 20
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief The sample loader as it was before prom_dtoa, kept here as the baseline
+ */
+static int load_sample_printf(prom_metric_formatter_t* self, prom_metric_sample_t* sample)
+{
+    int r = prom_string_builder_add_str(self->string_builder, sample->l_value);
+    if (r)
+        return r;
+    r = prom_string_builder_add_char(self->string_builder, ' ');
+    if (r)
+        return r;
+    char buffer[50];
+    sprintf(buffer, "%.17g", sample->r_value);
+    r = prom_string_builder_add_str(self->string_builder, buffer);
+    if (r)
+        return r;
+    return prom_string_builder_add_char(self->string_builder, '\n');
+}
+
+static size_t render_printf(prom_metric_formatter_t* mf, prom_metric_t* metric)
+{
+    prom_metric_formatter_load_help(mf, metric->name, metric->help);
+    prom_metric_formatter_load_type(mf, metric->name, metric->type);
+    for (prom_linked_list_node_t* node = metric->samples->keys->head; node != NULL; node = node->next)
+    {
+        prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(metric->samples, (const char*)node->item);
+        load_sample_printf(mf, sample);
+    }
+    char* out = prom_metric_formatter_dump(mf);
+    size_t len = strlen(out);
+    free(out);
+    return len;
+}
+
+static size_t render_dtoa(prom_metric_formatter_t* mf, prom_metric_t* metric)
+{
+    prom_metric_formatter_load_metric(mf, metric);
+    char* out = prom_metric_formatter_dump(mf);
+    size_t len = strlen(out);
+    free(out);
+    return len;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char* name, size_t (*render)(prom_metric_formatter_t*, prom_metric_t*),
+                prom_metric_formatter_t* mf, prom_metric_t* metric, int samples, int iterations)
+{
+    double* times = malloc(sizeof(double) * iterations);
+    size_t bytes = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        double start = now_seconds();
+        bytes = render(mf, metric);
+        times[i] = now_seconds() - start;
+    }
+    qsort(times, iterations, sizeof(double), compare_doubles);
+    double median = times[iterations / 2];
+    printf("%-8s median %8.3f ms  best %8.3f ms  %6.1f ns/sample  %zu bytes\n", name, median * 1e3, times[0] * 1e3,
+           median * 1e9 / samples, bytes);
+    free(times);
+}
+
+int main(int argc, const char** argv)
+{
+    int samples = argc > 1 ? atoi(argv[1]) : DEFAULT_SAMPLES;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+
+    prom_metric_t* metric =
+        prom_metric_new(PROM_GAUGE, "bench_gauge", "gauge under benchmark", 1, (const char*[]){"series"});
+    srand(42);
+    for (int i = 0; i < samples; i++)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "%d", i);
+        prom_metric_sample_t* sample = prom_metric_sample_from_labels(metric, (const char*[]){label});
+        double value;
+        switch (i % 3)
+        {
+        case 0: // byte and process counts
+            value = (double)((unsigned long long)rand() * 4096ULL);
+            break;
+        case 1: // percentages
+            value = 100.0 * rand() / RAND_MAX;
+            break;
+        default: // per-second rates
+            value = (double)rand() / 3.0;
+            break;
+        }
+        prom_metric_sample_set(sample, value);
+    }
+
+    prom_metric_formatter_t* mf = prom_metric_formatter_new();
+    printf("%d samples, %d iterations\n", samples, iterations);
+    run("%.17g", render_printf, mf, metric, samples, iterations);
+    run("dtoa", render_dtoa, mf, metric, samples, iterations);
+
+    prom_metric_formatter_destroy(mf);
+    prom_metric_destroy(metric);
+    return 0;
+}
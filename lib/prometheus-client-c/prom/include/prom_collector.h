@@ -97,4 +97,12 @@ int prom_collector_add_metric(prom_collector_t* self, prom_metric_t* metric);
  */
 int prom_collector_set_collect_fn(prom_collector_t* self, prom_collect_fn* fn);
 
+/**
+ * @brief The collect function set on every collector created with prom_collector_new. It returns the metrics added to
+ *        the collector, so a custom collect function may delegate to it.
+ * @param self The target prom_collector_t*
+ * @return The prom_map_t* containing the metrics added to the collector
+ */
+prom_map_t* prom_collector_default_collect(prom_collector_t* self);
+
 #endif // PROM_COLLECTOR_H
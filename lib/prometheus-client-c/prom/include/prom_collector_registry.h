@@ -22,6 +22,9 @@ limitations under the License.
 #ifndef PROM_REGISTRY_H
 #define PROM_REGISTRY_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "prom_collector.h"
 #include "prom_metric.h"
 
@@ -30,6 +33,30 @@ limitations under the License.
  */
 typedef struct prom_collector_registry prom_collector_registry_t;
 
+/**
+ * @brief The exposition formats a prom_collector_registry_t can be bridged to
+ */
+typedef enum prom_exposition_format
+{
+    PROM_EXPOSITION_TEXT,       /**< The text based format, version 0.0.4 */
+    PROM_EXPOSITION_PROTOBUF,   /**< Length-delimited io.prometheus.client.MetricFamily protobuf messages */
+    PROM_EXPOSITION_OPENMETRICS /**< OpenMetrics text, version 1.0.0, with the sample timestamps that were set */
+} prom_exposition_format_t;
+
+/**
+ * @brief Restricts a bridge to some of the registered collectors. Collectors left out are neither collected nor
+ * formatted.
+ *
+ * A collector is selected when its name is one of names, or names_count is 0, and it starts with prefix, or prefix is
+ * NULL.
+ */
+typedef struct prom_collector_selection
+{
+    const char* const* names; /**< names       Collector names to render */
+    size_t names_count;       /**< names_count Number of entries in names; 0 selects every name */
+    const char* prefix;       /**< prefix      Collector name prefix to render; NULL selects every name */
+} prom_collector_selection_t;
+
 /**
  * @brief Initialize the default registry by calling prom_collector_registry_init within your program. You MUST NOT
  * modify this value.
@@ -95,6 +122,14 @@ int prom_collector_registry_register_metric(prom_metric_t* metric);
  */
 int prom_collector_registry_register_collector(prom_collector_registry_t* self, prom_collector_t* collector);
 
+/**
+ * @brief Returns the collector registered under name
+ * @param self The target prom_collector_registry_t*
+ * @param name The collector name
+ * @return The prom_collector_t* or NULL if no collector is registered under name
+ */
+prom_collector_t* prom_collector_registry_get_collector(prom_collector_registry_t* self, const char* name);
+
 /**
  * @brief Returns a string in the default metric exposition format. The string MUST be freed to avoid unnecessary heap
  * memory growth.
@@ -106,6 +141,66 @@ int prom_collector_registry_register_collector(prom_collector_registry_t* self,
  */
 const char* prom_collector_registry_bridge(prom_collector_registry_t* self);
 
+/**
+ * @brief Returns the metrics of the registry in the given exposition format. The result MUST be freed to avoid
+ * unnecessary heap memory growth.
+ *
+ * The protobuf format is binary and may contain '\0' bytes, so its length MUST be taken from len rather than strlen.
+ * The result is '\0' terminated in every format.
+ *
+ * Reference: https://prometheus.io/docs/instrumenting/exposition_formats/
+ *
+ * @param self The target prom_collector_registry_t*
+ * @param format The exposition format to render
+ * @param len Set to the length of the result in bytes when non-NULL
+ * @return The rendered metrics or NULL upon failure
+ */
+const char* prom_collector_registry_bridge_format(prom_collector_registry_t* self, prom_exposition_format_t format,
+                                                  size_t* len);
+
+/**
+ * @brief Same as prom_collector_registry_bridge_format, rendering only the collectors in selection. The result MUST be
+ * freed to avoid unnecessary heap memory growth.
+ *
+ * @param self The target prom_collector_registry_t*
+ * @param format The exposition format to render
+ * @param selection The collectors to render, or NULL for every collector
+ * @param len Set to the length of the result in bytes when non-NULL
+ * @return The rendered metrics or NULL upon failure
+ */
+const char* prom_collector_registry_bridge_select(prom_collector_registry_t* self, prom_exposition_format_t format,
+                                                  const prom_collector_selection_t* selection, size_t* len);
+
+/**
+ * @brief Returns the current change version.
+ *
+ * Every sample records the version at which its value last changed, taken from a counter that is global to the
+ * process, so versions order changes across every registry. Setting a sample to the value it already holds is not a
+ * change.
+ *
+ * @return The latest version handed out, or 0 if no sample exists yet
+ */
+uint64_t prom_collector_registry_version(void);
+
+/**
+ * @brief Returns, in the text exposition format, only the samples whose value changed after version since. The result
+ * MUST be freed to avoid unnecessary heap memory growth.
+ *
+ * Metrics without such samples are left out entirely, HELP and TYPE lines included. The version is read before
+ * rendering starts and waits for changes that already took a version to store it, so passing it back as since on the
+ * next call never misses a change; a sample that changes while rendering may be returned twice.
+ *
+ * @param self The target prom_collector_registry_t*
+ * @param since A version returned earlier, or 0 for every sample
+ * @param selection The collectors to render, or NULL for every collector
+ * @param version Set to the version to pass as since on the next call
+ * @param len Set to the length of the result in bytes when non-NULL
+ * @return The rendered samples or NULL upon failure
+ */
+const char* prom_collector_registry_bridge_since(prom_collector_registry_t* self, uint64_t since,
+                                                 const prom_collector_selection_t* selection, uint64_t* version,
+                                                 size_t* len);
+
 /**
  *@brief Validates that the given metric name complies with the specification:
  *
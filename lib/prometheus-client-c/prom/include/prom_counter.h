@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef PROM_COUNTER_H
 #define PROM_COUNTER_H
 
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "prom_metric.h"
@@ -100,4 +101,19 @@ int prom_counter_inc(prom_counter_t* self, const char** label_values);
  */
 int prom_counter_add(prom_counter_t* self, double r_value, const char** label_values);
 
+/**
+ * @brief Add the value to the prom_counter_t* and record the time the underlying total was read.
+ *
+ * The timestamp is exposed in the OpenMetrics exposition format only.
+ * @param self The target prom_counter_t*
+ * @param r_value The double to add to the prom_counter_t passed as self. The value MUST be greater than or equal to 0.
+ * @param timestamp_ms Milliseconds since the Unix epoch at which the new total was read
+ * @param label_values The label values associated with the metric sample being updated. The number of labels must
+ *                     match the value passed to label_key_count in the counter's constructor. If no label values are
+ *                     necessary, pass NULL. Otherwise, It may be convenient to pass this value as a literal.
+ * @return A non-zero integer value upon failure.
+ */
+int prom_counter_add_with_timestamp(prom_counter_t* self, double r_value, int64_t timestamp_ms,
+                                    const char** label_values);
+
 #endif // PROM_COUNTER_H
@@ -22,6 +22,7 @@ limitations under the License.
 #ifndef PROM_GAUGE_H
 #define PROM_GAUGE_H
 
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "prom_metric.h"
@@ -152,4 +153,26 @@ int prom_gauge_sub(prom_gauge_t* self, double r_value, const char** label_values
  */
 int prom_gauge_set(prom_gauge_t* self, double r_value, const char** label_values);
 
+/**
+ * @brief Set the value for the prom_gauge_t* along with the time the value was read.
+ *
+ * The timestamp is exposed in the OpenMetrics exposition format only, so scrapers can place the sample at the moment
+ * it was observed instead of at scrape time.
+ * @param self The target prom_gauge_t*
+ * @param r_value The double to which the prom_gauge_t* passed as self will be set
+ * @param timestamp_ms Milliseconds since the Unix epoch at which r_value was read
+ * @param label_values The label values associated with the metric sample being updated. The number of labels must
+ *                     match the value passed to label_key_count in the gauge's constructor. If no label values are
+ *                     necessary, pass NULL. Otherwise, It may be convenient to pass this value as a literal.
+ * @return A non-zero integer value upon failure.
+ *
+ * *Example*
+ *
+ *     struct timespec ts;
+ *     clock_gettime(CLOCK_REALTIME, &ts);
+ *     prom_gauge_set_with_timestamp(foo_gauge, 22, ts.tv_sec * 1000LL + ts.tv_nsec / 1000000, NULL);
+ */
+int prom_gauge_set_with_timestamp(prom_gauge_t* self, double r_value, int64_t timestamp_ms,
+                                  const char** label_values);
+
 #endif // PROM_GAUGE_H
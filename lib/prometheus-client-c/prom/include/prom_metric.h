@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "prom_metric_sample.h"
 #include "prom_metric_sample_histogram.h"
+#include "prom_metric_sample_summary.h"
 
 struct prom_metric;
 /**
@@ -64,4 +65,19 @@ prom_metric_sample_t* prom_metric_sample_from_labels(prom_metric_t* self, const
 prom_metric_sample_histogram_t* prom_metric_sample_histogram_from_labels(prom_metric_t* self,
                                                                          const char** label_values);
 
+/**
+ * @brief Returns a prom_metric_sample_summary_t*. The order of label_values is significant.
+ *
+ * You may use this function to cache metric samples to avoid sample lookup. Metric samples are stored in a hash map
+ * with O(1) lookups in average case; nonethless, caching metric samples and updating them directly might be
+ * preferrable in performance-sensitive situations.
+ *
+ * @param self The target prom_summary_t*
+ * @param label_values The label values associated with the metric sample being updated. The number of labels must
+ *                     match the value passed to label_key_count in the summary's constructor. If no label values are
+ *                     necessary, pass NULL. Otherwise, It may be convenient to pass this value as a literal.
+ * @return prom_metric_sample_summary_t*
+ */
+prom_metric_sample_summary_t* prom_metric_sample_summary_from_labels(prom_metric_t* self, const char** label_values);
+
 #endif // PROM_METRIC_H
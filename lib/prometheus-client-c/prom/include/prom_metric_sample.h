@@ -22,6 +22,8 @@ limitations under the License.
 #ifndef PROM_METRIC_SAMPLE_H
 #define PROM_METRIC_SAMPLE_H
 
+#include <stdint.h>
+
 struct prom_metric_sample;
 /**
  * @brief Contains the specific metric and value given the name and label set
@@ -57,4 +59,15 @@ int prom_metric_sample_sub(prom_metric_sample_t* self, double r_value);
  */
 int prom_metric_sample_set(prom_metric_sample_t* self, double r_value);
 
+/**
+ * @brief Set the time at which the current r_value of the sample was observed.
+ *
+ * The timestamp is only exposed by the OpenMetrics exposition format. Pass 0 to expose the sample without a timestamp,
+ * which is the default.
+ * @param self The target prom_metric_sample_t*
+ * @param timestamp_ms Milliseconds since the Unix epoch, e.g. from CLOCK_REALTIME, or 0
+ * @return Non-zero integer value upon failure
+ */
+int prom_metric_sample_set_timestamp(prom_metric_sample_t* self, int64_t timestamp_ms);
+
 #endif // PROM_METRIC_SAMPLE_H
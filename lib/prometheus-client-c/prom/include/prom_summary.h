@@ -0,0 +1,103 @@
+/*
+Copyright 2019-2020 DigitalOcean Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * @file prom_summary.h
+ * @brief https://prometheus.io/docs/concepts/metric_types/#summary
+ */
+
+#ifndef PROM_SUMMARY_H
+#define PROM_SUMMARY_H
+
+#include <stdlib.h>
+
+#include "prom_metric.h"
+
+/**
+ * @brief A prometheus summary.
+ *
+ * Quantiles are estimated with a DDSketch: every reported quantile is within relative_accuracy of the exact quantile
+ * of the values observed in the sliding window, whatever their distribution, and each observation is O(1). The 0 and 1
+ * quantiles are the exact minimum and maximum of the window. The _sum and _count samples cover every observation since
+ * the summary was created.
+ *
+ * References
+ * * See https://prometheus.io/docs/concepts/metric_types/#summary
+ * * See https://arxiv.org/abs/1908.10693
+ */
+typedef prom_metric_t prom_summary_t;
+
+/**
+ * @brief The configuration of a prom_summary_t
+ */
+typedef struct prom_summary_options
+{
+    const double* quantiles;  /**< The quantiles to expose, each between 0 and 1 */
+    size_t quantile_count;    /**< Number of quantiles */
+    double relative_accuracy; /**< Bound of the relative error of the quantiles, between 0 and 1 exclusive */
+    double max_age;           /**< Seconds of observations the quantiles cover. Pass 0 to cover every observation. */
+    size_t age_buckets;       /**< Parts max_age is split into. The quantiles cover between max_age * (age_buckets - 1)
+                                   / age_buckets and max_age seconds, as the oldest part is dropped as a whole.
+                                   Ignored when max_age is 0. */
+} prom_summary_options_t;
+
+/**
+ * @brief The options used when NULL is passed to prom_summary_new: the 0.5, 0.9 and 0.99 quantiles with a 1% relative
+ *        accuracy over the last 10 minutes, split into 5 parts
+ */
+extern const prom_summary_options_t prom_summary_default_options;
+
+/**
+ * @brief Construct a prom_summary_t*
+ * @param name The name of the metric
+ * @param help The metric description
+ * @param options The prom_summary_options_t*, or NULL for prom_summary_default_options. The options are copied.
+ * @param label_key_count is the number of labels associated with the given metric. Pass 0 if the metric does not
+ *                        require labels.
+ * @param label_keys A collection of label keys. The number of keys MUST match the value passed as label_key_count. If
+ *                   no labels are required, pass NULL. Otherwise, it may be convenient to pass this value as a
+ *                   literal.
+ * @return The constructed prom_summary_t*, or NULL if the options are invalid
+ *
+ * *Example*
+ *
+ *     // The median and the 99th percentile over the last minute, within 0.5%
+ *     static const double quantiles[] = {0.5, 0.99};
+ *     prom_summary_options_t options = {quantiles, 2, 0.005, 60.0, 6};
+ *     prom_summary_new("foo", "foo is a summary without labels", &options, 0, NULL);
+ */
+prom_summary_t* prom_summary_new(const char* name, const char* help, const prom_summary_options_t* options,
+                                 size_t label_key_count, const char** label_keys);
+
+/**
+ * @brief Destroy a prom_summary_t*. self MUST be set to NULL after destruction. Returns a non-zero integer value upon
+ *        failure.
+ * @return Non-zero value upon failure.
+ */
+int prom_summary_destroy(prom_summary_t* self);
+
+/**
+ * @brief Observe the prom_summary_t given the value and labels
+ * @param self The target prom_summary_t*
+ * @param value The value to observe
+ * @param label_values The label values associated with the metric sample being updated. The number of labels must
+ *                     match the value passed to label_key_count in the summary's constructor. If no label values are
+ *                     necessary, pass NULL. Otherwise, It may be convenient to pass this value as a literal.
+ * @return Non-zero value upon failure
+ */
+int prom_summary_observe(prom_summary_t* self, double value, const char** label_values);
+
+#endif // PROM_SUMMARY_H
@@ -32,6 +32,7 @@
 #include "prom_map_i.h"
 #include "prom_metric_formatter_i.h"
 #include "prom_metric_i.h"
+#include "prom_metric_sample_i.h"
 #include "prom_metric_t.h"
 #include "prom_process_limits_i.h"
 #include "prom_string_builder_i.h"
@@ -223,6 +224,44 @@ int prom_collector_registry_register_collector(prom_collector_registry_t* self,
     return 0;
 }
 
+prom_collector_t* prom_collector_registry_get_collector(prom_collector_registry_t* self, const char* name)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return NULL;
+    return (prom_collector_t*)prom_map_get(self->collectors, name);
+}
+
+uint64_t prom_collector_registry_version(void)
+{
+    return prom_metric_sample_current_version();
+}
+
+const char* prom_collector_registry_bridge_since(prom_collector_registry_t* self, uint64_t since,
+                                                 const prom_collector_selection_t* selection, uint64_t* version,
+                                                 size_t* len)
+{
+    PROM_ASSERT(self != NULL);
+    PROM_ASSERT(version != NULL);
+    prom_metric_formatter_clear(self->metric_formatter);
+    prom_metric_formatter_select(self->metric_formatter, selection);
+    // Histogram samples only change when synced, so syncing after reading the version would report them twice
+    int r = prom_metric_formatter_sync_histograms(self->metric_formatter, self->collectors);
+    *version = prom_metric_sample_current_version();
+    if (r == 0)
+        r = prom_metric_formatter_load_metrics_since(self->metric_formatter, self->collectors, since);
+    prom_metric_formatter_select(self->metric_formatter, NULL);
+    if (r)
+    {
+        // A partial delta would silently lose changes once the client moves on to the new version
+        prom_metric_formatter_clear(self->metric_formatter);
+        return NULL;
+    }
+    if (len != NULL)
+        *len = prom_metric_formatter_len(self->metric_formatter);
+    return (const char*)prom_metric_formatter_dump(self->metric_formatter);
+}
+
 int prom_collector_registry_validate_metric_name(prom_collector_registry_t* self, const char* metric_name)
 {
     regex_t r;
@@ -248,7 +287,42 @@ int prom_collector_registry_validate_metric_name(prom_collector_registry_t* self
 
 const char* prom_collector_registry_bridge(prom_collector_registry_t* self)
 {
+    return prom_collector_registry_bridge_format(self, PROM_EXPOSITION_TEXT, NULL);
+}
+
+const char* prom_collector_registry_bridge_format(prom_collector_registry_t* self, prom_exposition_format_t format,
+                                                  size_t* len)
+{
+    return prom_collector_registry_bridge_select(self, format, NULL, len);
+}
+
+const char* prom_collector_registry_bridge_select(prom_collector_registry_t* self, prom_exposition_format_t format,
+                                                  const prom_collector_selection_t* selection, size_t* len)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
     prom_metric_formatter_clear(self->metric_formatter);
-    prom_metric_formatter_load_metrics(self->metric_formatter, self->collectors);
+    prom_metric_formatter_select(self->metric_formatter, selection);
+    switch (format)
+    {
+    case PROM_EXPOSITION_PROTOBUF:
+        r = prom_metric_formatter_load_metrics_protobuf(self->metric_formatter, self->collectors);
+        break;
+    case PROM_EXPOSITION_OPENMETRICS:
+        r = prom_metric_formatter_load_metrics_openmetrics(self->metric_formatter, self->collectors);
+        break;
+    default:
+        r = prom_metric_formatter_load_metrics(self->metric_formatter, self->collectors);
+        break;
+    }
+    prom_metric_formatter_select(self->metric_formatter, NULL);
+    if (r && format != PROM_EXPOSITION_TEXT)
+    {
+        // Truncated protobuf or OpenMetrics output is invalid as a whole, unlike partial text output
+        prom_metric_formatter_clear(self->metric_formatter);
+        return NULL;
+    }
+    if (len != NULL)
+        *len = prom_metric_formatter_len(self->metric_formatter);
     return (const char*)prom_metric_formatter_dump(self->metric_formatter);
 }
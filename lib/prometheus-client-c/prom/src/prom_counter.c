@@ -75,3 +75,23 @@ int prom_counter_add(prom_counter_t* self, double r_value, const char** label_va
         return 1;
     return prom_metric_sample_add(sample, r_value);
 }
+
+int prom_counter_add_with_timestamp(prom_counter_t* self, double r_value, int64_t timestamp_ms,
+                                    const char** label_values)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+    if (self->type != PROM_COUNTER)
+    {
+        PROM_LOG(PROM_METRIC_INCORRECT_TYPE);
+        return 1;
+    }
+    prom_metric_sample_t* sample = prom_metric_sample_from_labels(self, label_values);
+    if (sample == NULL)
+        return 1;
+    int r = prom_metric_sample_add(sample, r_value);
+    if (r)
+        return r;
+    return prom_metric_sample_set_timestamp(sample, timestamp_ms);
+}
@@ -0,0 +1,429 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reference: Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010)
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Private
+#include "prom_dtoa_i.h"
+
+// Integral values below this bound are exactly representable and printed without the Grisu machinery
+#define PROM_DTOA_INTEGER_LIMIT 1e17
+
+// Fixed notation is used while the decimal exponent is within [PROM_DTOA_MIN_FIXED_EXP, PROM_DTOA_MAX_FIXED_EXP)
+#define PROM_DTOA_MIN_FIXED_EXP -4
+#define PROM_DTOA_MAX_FIXED_EXP 17
+
+#define PROM_DTOA_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define PROM_DTOA_EXPONENT_MASK 0x7FF0000000000000ULL
+#define PROM_DTOA_HIDDEN_BIT 0x0010000000000000ULL
+#define PROM_DTOA_SIGNIFICAND_SIZE 52
+#define PROM_DTOA_EXPONENT_BIAS (0x3FF + PROM_DTOA_SIGNIFICAND_SIZE)
+#define PROM_DTOA_DIY_SIGNIFICAND_SIZE 64
+
+/**
+ * @brief A "do it yourself" floating point number: f * 2^e
+ */
+typedef struct prom_dtoa_diy_fp
+{
+    uint64_t f;
+    int e;
+} prom_dtoa_diy_fp_t;
+
+// Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340
+static const uint64_t prom_dtoa_cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t prom_dtoa_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066,
+};
+
+static const uint64_t prom_dtoa_pow10[] = {1ULL,
+                                           10ULL,
+                                           100ULL,
+                                           1000ULL,
+                                           10000ULL,
+                                           100000ULL,
+                                           1000000ULL,
+                                           10000000ULL,
+                                           100000000ULL,
+                                           1000000000ULL,
+                                           10000000000ULL,
+                                           100000000000ULL,
+                                           1000000000000ULL,
+                                           10000000000000ULL,
+                                           100000000000000ULL,
+                                           1000000000000000ULL,
+                                           10000000000000000ULL,
+                                           100000000000000000ULL,
+                                           1000000000000000000ULL,
+                                           10000000000000000000ULL};
+
+static const char prom_dtoa_digit_pairs[] = "00010203040506070809"
+                                            "10111213141516171819"
+                                            "20212223242526272829"
+                                            "30313233343536373839"
+                                            "40414243444546474849"
+                                            "50515253545556575859"
+                                            "60616263646566676869"
+                                            "70717273747576777879"
+                                            "80818283848586878889"
+                                            "90919293949596979899";
+
+static prom_dtoa_diy_fp_t prom_dtoa_diy_fp_mul(prom_dtoa_diy_fp_t x, prom_dtoa_diy_fp_t y)
+{
+    const uint64_t m32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & m32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & m32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += 1ULL << 31; // round
+    prom_dtoa_diy_fp_t r = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+    return r;
+}
+
+static prom_dtoa_diy_fp_t prom_dtoa_diy_fp_normalize(prom_dtoa_diy_fp_t x)
+{
+    int shift = __builtin_clzll(x.f);
+    prom_dtoa_diy_fp_t r = {x.f << shift, x.e - shift};
+    return r;
+}
+
+static prom_dtoa_diy_fp_t prom_dtoa_diy_fp_from_double(double value)
+{
+    uint64_t u = 0;
+    memcpy(&u, &value, sizeof(u));
+    int biased_e = (int)((u & PROM_DTOA_EXPONENT_MASK) >> PROM_DTOA_SIGNIFICAND_SIZE);
+    uint64_t significand = u & PROM_DTOA_SIGNIFICAND_MASK;
+    prom_dtoa_diy_fp_t r;
+    if (biased_e != 0)
+    {
+        r.f = significand + PROM_DTOA_HIDDEN_BIT;
+        r.e = biased_e - PROM_DTOA_EXPONENT_BIAS;
+    }
+    else
+    {
+        r.f = significand;
+        r.e = 1 - PROM_DTOA_EXPONENT_BIAS;
+    }
+    return r;
+}
+
+/**
+ * @brief Computes the normalized upper and lower boundaries of v; the lower one shares the exponent of the upper one
+ */
+static void prom_dtoa_normalized_boundaries(prom_dtoa_diy_fp_t v, prom_dtoa_diy_fp_t* minus, prom_dtoa_diy_fp_t* plus)
+{
+    prom_dtoa_diy_fp_t pl = {(v.f << 1) + 1, v.e - 1};
+    while (!(pl.f & (PROM_DTOA_HIDDEN_BIT << 1)))
+    {
+        pl.f <<= 1;
+        pl.e--;
+    }
+    pl.f <<= PROM_DTOA_DIY_SIGNIFICAND_SIZE - PROM_DTOA_SIGNIFICAND_SIZE - 2;
+    pl.e -= PROM_DTOA_DIY_SIGNIFICAND_SIZE - PROM_DTOA_SIGNIFICAND_SIZE - 2;
+
+    prom_dtoa_diy_fp_t mi;
+    if (v.f == PROM_DTOA_HIDDEN_BIT)
+    {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    }
+    else
+    {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *plus = pl;
+    *minus = mi;
+}
+
+/**
+ * @brief Returns the cached power c_k = 10^-K such that the product with a number of binary exponent e lands in the
+ * [-60, -32] window required by the digit generation
+ */
+static prom_dtoa_diy_fp_t prom_dtoa_cached_power(int e, int* K)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive, so can do ceiling in positive
+    int k = (int)dk;
+    if (dk - k > 0.0)
+        k++;
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+    prom_dtoa_diy_fp_t r = {prom_dtoa_cached_powers_f[index], prom_dtoa_cached_powers_e[index]};
+    return r;
+}
+
+static int prom_dtoa_count_digits32(uint32_t n)
+{
+    int digits = 1;
+    while (digits < 10 && n >= prom_dtoa_pow10[digits])
+        digits++;
+    return digits;
+}
+
+static void prom_dtoa_grisu_round(char* buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa,
+                                  uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static void prom_dtoa_digit_gen(prom_dtoa_diy_fp_t W, prom_dtoa_diy_fp_t Mp, uint64_t delta, char* buffer, int* len,
+                                int* K)
+{
+    const prom_dtoa_diy_fp_t one = {1ULL << -Mp.e, Mp.e};
+    const uint64_t wp_w = Mp.f - W.f;
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = prom_dtoa_count_digits32(p1);
+    *len = 0;
+
+    while (kappa > 0)
+    {
+        uint32_t divisor = (uint32_t)prom_dtoa_pow10[kappa - 1];
+        uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || *len)
+            buffer[(*len)++] = (char)('0' + d);
+        kappa--;
+        uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+        if (tmp <= delta)
+        {
+            *K += kappa;
+            prom_dtoa_grisu_round(buffer, *len, delta, tmp, prom_dtoa_pow10[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || *len)
+            buffer[(*len)++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            int index = -kappa;
+            prom_dtoa_grisu_round(buffer, *len, delta, p2, one.f, wp_w * (index < 20 ? prom_dtoa_pow10[index] : 0));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Produces the shortest digit string for a positive finite value; value = digits * 10^K
+ */
+static void prom_dtoa_grisu2(double value, char* buffer, int* len, int* K)
+{
+    const prom_dtoa_diy_fp_t v = prom_dtoa_diy_fp_from_double(value);
+    prom_dtoa_diy_fp_t w_m, w_p;
+    prom_dtoa_normalized_boundaries(v, &w_m, &w_p);
+
+    const prom_dtoa_diy_fp_t c_mk = prom_dtoa_cached_power(w_p.e, K);
+    const prom_dtoa_diy_fp_t W = prom_dtoa_diy_fp_mul(prom_dtoa_diy_fp_normalize(v), c_mk);
+    prom_dtoa_diy_fp_t Wp = prom_dtoa_diy_fp_mul(w_p, c_mk);
+    prom_dtoa_diy_fp_t Wm = prom_dtoa_diy_fp_mul(w_m, c_mk);
+    Wm.f++;
+    Wp.f--;
+    prom_dtoa_digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
+
+/**
+ * @brief Writes n in decimal and returns the number of characters written
+ */
+static size_t prom_dtoa_u64(uint64_t n, char* buffer)
+{
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
+    while (n >= 100)
+    {
+        unsigned pair = (unsigned)(n % 100) * 2;
+        n /= 100;
+        *--p = prom_dtoa_digit_pairs[pair + 1];
+        *--p = prom_dtoa_digit_pairs[pair];
+    }
+    if (n >= 10)
+    {
+        unsigned pair = (unsigned)n * 2;
+        *--p = prom_dtoa_digit_pairs[pair + 1];
+        *--p = prom_dtoa_digit_pairs[pair];
+    }
+    else
+    {
+        *--p = (char)('0' + n);
+    }
+    size_t len = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(buffer, p, len);
+    return len;
+}
+
+/**
+ * @brief Lays out the digits produced by Grisu2 in fixed or exponent notation
+ */
+static size_t prom_dtoa_layout(const char* digits, int len, int K, char* buffer)
+{
+    int exp10 = len + K - 1;
+    char* p = buffer;
+
+    if (exp10 >= PROM_DTOA_MIN_FIXED_EXP && exp10 < PROM_DTOA_MAX_FIXED_EXP)
+    {
+        int point = len + K;
+        if (point <= 0)
+        {
+            // 0.000ddd
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', (size_t)-point);
+            p += -point;
+            memcpy(p, digits, (size_t)len);
+            p += len;
+        }
+        else if (point < len)
+        {
+            // ddd.ddd
+            memcpy(p, digits, (size_t)point);
+            p += point;
+            *p++ = '.';
+            memcpy(p, digits + point, (size_t)(len - point));
+            p += len - point;
+        }
+        else
+        {
+            // ddd000
+            memcpy(p, digits, (size_t)len);
+            p += len;
+            memset(p, '0', (size_t)(point - len));
+            p += point - len;
+        }
+    }
+    else
+    {
+        // d.ddde+XX, with at least two exponent digits like printf
+        *p++ = digits[0];
+        if (len > 1)
+        {
+            *p++ = '.';
+            memcpy(p, digits + 1, (size_t)(len - 1));
+            p += len - 1;
+        }
+        *p++ = 'e';
+        if (exp10 < 0)
+        {
+            *p++ = '-';
+            exp10 = -exp10;
+        }
+        else
+        {
+            *p++ = '+';
+        }
+        if (exp10 < 10)
+            *p++ = '0';
+        p += prom_dtoa_u64((uint64_t)exp10, p);
+    }
+    *p = '\0';
+    return (size_t)(p - buffer);
+}
+
+size_t prom_dtoa(double value, char* buffer)
+{
+    if (isnan(value))
+    {
+        memcpy(buffer, "NaN", 4);
+        return 3;
+    }
+    if (isinf(value))
+    {
+        memcpy(buffer, value > 0 ? "+Inf" : "-Inf", 5);
+        return 4;
+    }
+
+    char* p = buffer;
+    if (signbit(value))
+    {
+        *p++ = '-';
+        value = -value;
+    }
+
+    // Fast path: byte counts, process counts and other integral values
+    if (value < PROM_DTOA_INTEGER_LIMIT && value == (double)(uint64_t)value)
+    {
+        p += prom_dtoa_u64((uint64_t)value, p);
+        *p = '\0';
+        return (size_t)(p - buffer);
+    }
+
+    char digits[PROM_DTOA_BUFFER_SIZE];
+    int len = 0;
+    int K = 0;
+    prom_dtoa_grisu2(value, digits, &len, &K);
+    return (size_t)(p - buffer) + prom_dtoa_layout(digits, len, K, p);
+}
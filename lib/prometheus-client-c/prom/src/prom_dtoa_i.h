@@ -0,0 +1,41 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROM_DTOA_I_H
+#define PROM_DTOA_I_H
+
+#include <stddef.h>
+
+/**
+ * @brief API PRIVATE The minimum size of the buffer handed to prom_dtoa, including the terminating '\0'
+ */
+#define PROM_DTOA_BUFFER_SIZE 32
+
+/**
+ * @brief API PRIVATE Writes the shortest decimal representation of value that parses back to the same double.
+ *
+ * Integral values below 1e17 take a fast path and are written as plain integers. Other finite values are converted
+ * with Grisu2 and written in fixed notation when the decimal exponent is in [-4, 17), in exponent notation otherwise.
+ * NaN and infinities are written as "NaN", "+Inf" and "-Inf" as required by the exposition formats. The output does
+ * not depend on the current locale.
+ *
+ * @param value The value to format
+ * @param buffer Destination of at least PROM_DTOA_BUFFER_SIZE bytes
+ * @return The number of characters written, not counting the terminating '\0'
+ */
+size_t prom_dtoa(double value, char* buffer);
+
+#endif // PROM_DTOA_I_H
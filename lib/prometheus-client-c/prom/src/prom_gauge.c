@@ -121,3 +121,22 @@ int prom_gauge_set(prom_gauge_t* self, double r_value, const char** label_values
         return 1;
     return prom_metric_sample_set(sample, r_value);
 }
+
+int prom_gauge_set_with_timestamp(prom_gauge_t* self, double r_value, int64_t timestamp_ms, const char** label_values)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+    if (self->type != PROM_GAUGE)
+    {
+        PROM_LOG(PROM_METRIC_INCORRECT_TYPE);
+        return 1;
+    }
+    prom_metric_sample_t* sample = prom_metric_sample_from_labels(self, label_values);
+    if (sample == NULL)
+        return 1;
+    int r = prom_metric_sample_set(sample, r_value);
+    if (r)
+        return r;
+    return prom_metric_sample_set_timestamp(sample, timestamp_ms);
+}
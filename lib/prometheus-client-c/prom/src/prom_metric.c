@@ -29,6 +29,7 @@
 #include "prom_metric_i.h"
 #include "prom_metric_sample_histogram_i.h"
 #include "prom_metric_sample_i.h"
+#include "prom_metric_sample_summary_i.h"
 
 char* prom_metric_type_map[4] = {"counter", "gauge", "histogram", "summary"};
 
@@ -41,6 +42,7 @@ prom_metric_t* prom_metric_new(prom_metric_type_t metric_type, const char* name,
     self->name = name;
     self->help = help;
     self->buckets = NULL;
+    self->summary = NULL;
 
     const char** k = (const char**)prom_malloc(sizeof(const char*) * label_key_count);
 
@@ -73,6 +75,15 @@ prom_metric_t* prom_metric_new(prom_metric_type_t metric_type, const char* name,
             return NULL;
         }
     }
+    else if (metric_type == PROM_SUMMARY)
+    {
+        r = prom_map_set_free_value_fn(self->samples, &prom_metric_sample_summary_free_generic);
+        if (r)
+        {
+            prom_metric_destroy(self);
+            return NULL;
+        }
+    }
     else
     {
         r = prom_map_set_free_value_fn(self->samples, &prom_metric_sample_free_generic);
@@ -121,6 +132,14 @@ int prom_metric_destroy(prom_metric_t* self)
     if (r)
         ret = r;
 
+    // The samples point at the summary options, so they go first
+    if (self->summary != NULL)
+    {
+        prom_free((void*)self->summary->quantiles);
+        prom_free(self->summary);
+        self->summary = NULL;
+    }
+
     r = prom_metric_formatter_destroy(self->formatter);
     self->formatter = NULL;
     if (r)
@@ -271,3 +290,59 @@ prom_metric_sample_histogram_t* prom_metric_sample_histogram_from_labels(prom_me
     prom_free((void*)l_value);
     return sample;
 }
+
+prom_metric_sample_summary_t* prom_metric_sample_summary_from_labels(prom_metric_t* self, const char** label_values)
+{
+    PROM_ASSERT(self != NULL);
+
+    int r = 0;
+    r = pthread_rwlock_wrlock(self->rwlock);
+    if (r)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_LOCK_ERROR);
+        return NULL;
+    }
+
+#define PROM_METRIC_SAMPLE_SUMMARY_FROM_LABELS_HANDLE_UNLOCK()                                                         \
+    r = pthread_rwlock_unlock(self->rwlock);                                                                           \
+    if (r)                                                                                                             \
+        PROM_LOG(PROM_PTHREAD_RWLOCK_UNLOCK_ERROR);                                                                    \
+    return NULL;
+
+    // Load the l_value
+    r = prom_metric_formatter_load_l_value(self->formatter, self->name, NULL, self->label_key_count, self->label_keys,
+                                           label_values);
+    if (r)
+    {
+        PROM_METRIC_SAMPLE_SUMMARY_FROM_LABELS_HANDLE_UNLOCK();
+    }
+
+    // This must be freed before returning
+    const char* l_value = prom_metric_formatter_dump(self->formatter);
+    if (l_value == NULL)
+    {
+        PROM_METRIC_SAMPLE_SUMMARY_FROM_LABELS_HANDLE_UNLOCK();
+    }
+
+    // Get sample
+    prom_metric_sample_summary_t* sample = (prom_metric_sample_summary_t*)prom_map_get(self->samples, l_value);
+    if (sample == NULL)
+    {
+        sample = prom_metric_sample_summary_new(self->name, self->summary, self->label_key_count, self->label_keys,
+                                                label_values);
+        if (sample == NULL)
+        {
+            prom_free((void*)l_value);
+            PROM_METRIC_SAMPLE_SUMMARY_FROM_LABELS_HANDLE_UNLOCK();
+        }
+        r = prom_map_set(self->samples, l_value, sample);
+        if (r)
+        {
+            prom_free((void*)l_value);
+            PROM_METRIC_SAMPLE_SUMMARY_FROM_LABELS_HANDLE_UNLOCK();
+        }
+    }
+    pthread_rwlock_unlock(self->rwlock);
+    prom_free((void*)l_value);
+    return sample;
+}
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 // Public
 #include "prom_alloc.h"
@@ -22,17 +26,65 @@
 // Private
 #include "prom_assert.h"
 #include "prom_collector_t.h"
+#include "prom_dtoa_i.h"
 #include "prom_linked_list_t.h"
 #include "prom_map_i.h"
 #include "prom_metric_formatter_i.h"
+#include "prom_metric_sample_histogram_i.h"
 #include "prom_metric_sample_histogram_t.h"
+#include "prom_metric_sample_summary_i.h"
+#include "prom_metric_sample_summary_t.h"
 #include "prom_metric_sample_t.h"
 #include "prom_metric_t.h"
+#include "prom_protobuf_i.h"
 #include "prom_string_builder_i.h"
 
+// Field numbers and enum values of the io.prometheus.client messages in metrics.proto
+#define PROM_PROTOBUF_FAMILY_NAME 1
+#define PROM_PROTOBUF_FAMILY_HELP 2
+#define PROM_PROTOBUF_FAMILY_TYPE 3
+#define PROM_PROTOBUF_FAMILY_METRIC 4
+#define PROM_PROTOBUF_METRIC_LABEL 1
+#define PROM_PROTOBUF_METRIC_GAUGE 2
+#define PROM_PROTOBUF_METRIC_COUNTER 3
+#define PROM_PROTOBUF_METRIC_SUMMARY 4
+#define PROM_PROTOBUF_METRIC_UNTYPED 5
+#define PROM_PROTOBUF_METRIC_HISTOGRAM 7
+#define PROM_PROTOBUF_LABEL_NAME 1
+#define PROM_PROTOBUF_LABEL_VALUE 2
+#define PROM_PROTOBUF_VALUE 1
+#define PROM_PROTOBUF_HISTOGRAM_SAMPLE_COUNT 1
+#define PROM_PROTOBUF_HISTOGRAM_SAMPLE_SUM 2
+#define PROM_PROTOBUF_HISTOGRAM_BUCKET 3
+#define PROM_PROTOBUF_BUCKET_CUMULATIVE_COUNT 1
+#define PROM_PROTOBUF_BUCKET_UPPER_BOUND 2
+#define PROM_PROTOBUF_SUMMARY_SAMPLE_COUNT 1
+#define PROM_PROTOBUF_SUMMARY_SAMPLE_SUM 2
+#define PROM_PROTOBUF_SUMMARY_QUANTILE 3
+#define PROM_PROTOBUF_QUANTILE_QUANTILE 1
+#define PROM_PROTOBUF_QUANTILE_VALUE 2
+
+#define PROM_PROTOBUF_TYPE_COUNTER 0
+#define PROM_PROTOBUF_TYPE_GAUGE 1
+#define PROM_PROTOBUF_TYPE_SUMMARY 2
+#define PROM_PROTOBUF_TYPE_UNTYPED 3
+#define PROM_PROTOBUF_TYPE_HISTOGRAM 4
+
+#define PROM_OPENMETRICS_COUNTER_SUFFIX "_total"
+#define PROM_OPENMETRICS_BUCKET_SUFFIX "_bucket"
+
+typedef int (*prom_metric_formatter_load_metric_fn)(prom_metric_formatter_t* self, prom_metric_t* metric);
+
 prom_metric_formatter_t* prom_metric_formatter_new()
 {
     prom_metric_formatter_t* self = (prom_metric_formatter_t*)prom_malloc(sizeof(prom_metric_formatter_t));
+    self->string_builder = NULL;
+    self->err_builder = NULL;
+    self->family_builder = NULL;
+    self->metric_builder = NULL;
+    self->value_builder = NULL;
+    self->since = 0;
+    self->selection = NULL;
     self->string_builder = prom_string_builder_new();
     if (self->string_builder == NULL)
     {
@@ -67,6 +119,17 @@ int prom_metric_formatter_destroy(prom_metric_formatter_t* self)
     if (r)
         ret = r;
 
+    prom_string_builder_t** scratch[] = {&self->family_builder, &self->metric_builder, &self->value_builder};
+    for (size_t i = 0; i < sizeof(scratch) / sizeof(scratch[0]); i++)
+    {
+        if (*scratch[i] == NULL)
+            continue;
+        r = prom_string_builder_destroy(*scratch[i]);
+        *scratch[i] = NULL;
+        if (r)
+            ret = r;
+    }
+
     prom_free(self);
     self = NULL;
     return ret;
@@ -213,8 +276,8 @@ int prom_metric_formatter_load_sample(prom_metric_formatter_t* self, prom_metric
     if (r)
         return r;
 
-    char buffer[50];
-    sprintf(buffer, "%.17g", sample->r_value);
+    char buffer[PROM_DTOA_BUFFER_SIZE];
+    prom_dtoa(sample->r_value, buffer);
     r = prom_string_builder_add_str(self->string_builder, buffer);
     if (r)
         return r;
@@ -246,13 +309,61 @@ char* prom_metric_formatter_dump(prom_metric_formatter_t* self)
     return data;
 }
 
+/**
+ * @brief API PRIVATE Brings the rendered samples of every histogram or summary sample of the metric up to date; other
+ * metric types are left alone
+ */
+static int prom_metric_formatter_sync_metric(prom_metric_t* metric)
+{
+    if (metric->type != PROM_HISTOGRAM && metric->type != PROM_SUMMARY)
+        return 0;
+    for (prom_linked_list_node_t* current_node = metric->samples->keys->head; current_node != NULL;
+         current_node = current_node->next)
+    {
+        void* item = prom_map_get(metric->samples, (const char*)current_node->item);
+        if (item == NULL)
+            return 1;
+        int r = metric->type == PROM_HISTOGRAM
+                    ? prom_metric_sample_histogram_sync((prom_metric_sample_histogram_t*)item)
+                    : prom_metric_sample_summary_sync((prom_metric_sample_summary_t*)item);
+        if (r)
+            return r;
+    }
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Returns the samples rendered for the sample key of a histogram or summary, setting *l_value_list
+ * to their order. Returns NULL for a missing key.
+ */
+static prom_map_t* prom_metric_formatter_child_samples(prom_metric_t* metric, const char* key,
+                                                       prom_linked_list_t** l_value_list)
+{
+    if (metric->type == PROM_HISTOGRAM)
+    {
+        prom_metric_sample_histogram_t* hist_sample =
+            (prom_metric_sample_histogram_t*)prom_map_get(metric->samples, key);
+        if (hist_sample == NULL)
+            return NULL;
+        *l_value_list = hist_sample->l_value_list;
+        return hist_sample->samples;
+    }
+    prom_metric_sample_summary_t* summary_sample = (prom_metric_sample_summary_t*)prom_map_get(metric->samples, key);
+    if (summary_sample == NULL)
+        return NULL;
+    *l_value_list = summary_sample->l_value_list;
+    return summary_sample->samples;
+}
+
 int prom_metric_formatter_load_metric(prom_metric_formatter_t* self, prom_metric_t* metric)
 {
     PROM_ASSERT(self != NULL);
     if (self == NULL)
         return 1;
 
-    int r = 0;
+    int r = prom_metric_formatter_sync_metric(metric);
+    if (r)
+        return r;
 
     r = prom_metric_formatter_load_help(self, metric->name, metric->help);
     if (r)
@@ -266,22 +377,638 @@ int prom_metric_formatter_load_metric(prom_metric_formatter_t* self, prom_metric
          current_node = current_node->next)
     {
         const char* key = (const char*)current_node->item;
+        if (metric->type == PROM_HISTOGRAM || metric->type == PROM_SUMMARY)
+        {
+            prom_linked_list_t* l_value_list = NULL;
+            prom_map_t* samples = prom_metric_formatter_child_samples(metric, key, &l_value_list);
+            if (samples == NULL)
+                return 1;
+
+            for (prom_linked_list_node_t* current_hist_node = l_value_list->head; current_hist_node != NULL;
+                 current_hist_node = current_hist_node->next)
+            {
+                const char* hist_key = (const char*)current_hist_node->item;
+                prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(samples, hist_key);
+                if (sample == NULL)
+                    return 1;
+                r = prom_metric_formatter_load_sample(self, sample);
+                if (r)
+                    return r;
+            }
+        }
+        else
+        {
+            prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(metric->samples, key);
+            if (sample == NULL)
+                return 1;
+            r = prom_metric_formatter_load_sample(self, sample);
+            if (r)
+                return r;
+        }
+    }
+    return prom_string_builder_add_char(self->string_builder, '\n');
+}
+
+/**
+ * @brief API PRIVATE Calls fn on every sample of the metric, histogram and summary samples included, until fn returns
+ * non-zero
+ */
+static int prom_metric_formatter_each_sample(prom_metric_formatter_t* self, prom_metric_t* metric,
+                                             int (*fn)(prom_metric_formatter_t* self, prom_metric_sample_t* sample))
+{
+    int r = 0;
+    for (prom_linked_list_node_t* current_node = metric->samples->keys->head; current_node != NULL;
+         current_node = current_node->next)
+    {
+        const char* key = (const char*)current_node->item;
+        if (metric->type == PROM_HISTOGRAM || metric->type == PROM_SUMMARY)
+        {
+            prom_linked_list_t* l_value_list = NULL;
+            prom_map_t* samples = prom_metric_formatter_child_samples(metric, key, &l_value_list);
+            if (samples == NULL)
+                return 1;
+            for (prom_linked_list_node_t* current_hist_node = l_value_list->head; current_hist_node != NULL;
+                 current_hist_node = current_hist_node->next)
+            {
+                const char* hist_key = (const char*)current_hist_node->item;
+                prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(samples, hist_key);
+                if (sample == NULL)
+                    return 1;
+                r = fn(self, sample);
+                if (r)
+                    return r;
+            }
+        }
+        else
+        {
+            prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(metric->samples, key);
+            if (sample == NULL)
+                return 1;
+            r = fn(self, sample);
+            if (r)
+                return r;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Returns 1, stopping the iteration, for a sample changed after self->since
+ */
+static int prom_metric_formatter_sample_changed(prom_metric_formatter_t* self, prom_metric_sample_t* sample)
+{
+    return atomic_load(&sample->version) > self->since ? 1 : 0;
+}
+
+/**
+ * @brief API PRIVATE Loads the sample in the text exposition format if it changed after self->since
+ */
+static int prom_metric_formatter_load_sample_since(prom_metric_formatter_t* self, prom_metric_sample_t* sample)
+{
+    if (atomic_load(&sample->version) <= self->since)
+        return 0;
+    return prom_metric_formatter_load_sample(self, sample);
+}
+
+/**
+ * @brief API PRIVATE Loads the samples of a metric changed after self->since, with its HELP and TYPE lines
+ */
+static int prom_metric_formatter_load_metric_since(prom_metric_formatter_t* self, prom_metric_t* metric)
+{
+    PROM_ASSERT(self != NULL);
+    // Histograms were synced before the version was read. Syncing again catches those returned by a custom collect_fn;
+    // observations made in between are reported now and, under the next version, once more.
+    if (prom_metric_formatter_sync_metric(metric))
+        return 1;
+
+    // Unchanged metrics are skipped entirely, without even their HELP and TYPE lines
+    if (!prom_metric_formatter_each_sample(self, metric, prom_metric_formatter_sample_changed))
+        return 0;
+
+    int r = prom_metric_formatter_load_help(self, metric->name, metric->help);
+    if (r)
+        return r;
+    r = prom_metric_formatter_load_type(self, metric->name, metric->type);
+    if (r)
+        return r;
+    r = prom_metric_formatter_each_sample(self, metric, prom_metric_formatter_load_sample_since);
+    if (r)
+        return r;
+    return prom_string_builder_add_char(self->string_builder, '\n');
+}
+
+/**
+ * @brief API PRIVATE Clears the scratch builder at *builder, creating it first if this formatter has not needed it yet
+ */
+static int prom_metric_formatter_scratch(prom_string_builder_t** builder)
+{
+    if (*builder == NULL)
+    {
+        *builder = prom_string_builder_new();
+        return *builder == NULL;
+    }
+    return prom_string_builder_clear(*builder);
+}
+
+/**
+ * @brief API PRIVATE Appends the builder contents to sb as the length-delimited field number field
+ */
+static int prom_metric_formatter_add_message_field(prom_string_builder_t* sb, uint32_t field,
+                                                   prom_string_builder_t* message)
+{
+    return prom_protobuf_add_bytes_field(sb, field, prom_string_builder_str(message),
+                                         prom_string_builder_len(message));
+}
+
+/**
+ * @brief API PRIVATE Appends a LabelPair message to sb
+ */
+static int prom_metric_formatter_add_label_pair(prom_string_builder_t* sb, const char* name, size_t name_len,
+                                                const char* value, size_t value_len)
+{
+    int r = 0;
+    // Both fields are strings with one byte tags
+    size_t len =
+        1 + prom_protobuf_varint_len(name_len) + name_len + 1 + prom_protobuf_varint_len(value_len) + value_len;
+
+    r = prom_protobuf_add_tag(sb, PROM_PROTOBUF_METRIC_LABEL, PROM_PROTOBUF_WIRE_LENGTH_DELIMITED);
+    if (r)
+        return r;
+
+    r = prom_protobuf_add_varint(sb, len);
+    if (r)
+        return r;
+
+    r = prom_protobuf_add_bytes_field(sb, PROM_PROTOBUF_LABEL_NAME, name, name_len);
+    if (r)
+        return r;
+
+    return prom_protobuf_add_bytes_field(sb, PROM_PROTOBUF_LABEL_VALUE, value, value_len);
+}
+
+/**
+ * @brief API PRIVATE Appends the labels of a sample to sb, recovering the values from its l_value.
+ *
+ * Samples only keep the rendered l_value, name{key="value",...}, with the label keys in metric->label_keys order.
+ * Label values are not escaped, so a value ends at the first '"' followed by the next expected key rather than at the
+ * first '"'.
+ */
+static int prom_metric_formatter_add_label_pairs(prom_string_builder_t* sb, prom_metric_t* metric, const char* l_value)
+{
+    int r = 0;
+    const char* cursor = l_value + strlen(metric->name);
+    if (*cursor != '{')
+        return 0;
+    cursor++;
+
+    for (size_t i = 0; i < metric->label_key_count; i++)
+    {
+        const char* key = metric->label_keys[i];
+        size_t key_len = strlen(key);
+        if (strncmp(cursor, key, key_len) != 0 || cursor[key_len] != '=' || cursor[key_len + 1] != '"')
+            return 1;
+
+        const char* value = cursor + key_len + 2;
+        const char* end = NULL;
+        if (i == metric->label_key_count - 1)
+        {
+            end = value + strlen(value) - 2;
+            if (end < value || end[0] != '"' || end[1] != '}')
+                return 1;
+        }
+        else
+        {
+            const char* next_key = metric->label_keys[i + 1];
+            size_t next_key_len = strlen(next_key);
+            for (end = strchr(value, '"'); end != NULL; end = strchr(end + 1, '"'))
+            {
+                if (end[1] == ',' && strncmp(end + 2, next_key, next_key_len) == 0 && end[2 + next_key_len] == '=' &&
+                    end[3 + next_key_len] == '"')
+                    break;
+            }
+            if (end == NULL)
+                return 1;
+        }
+
+        r = prom_metric_formatter_add_label_pair(sb, key, key_len, value, end - value);
+        if (r)
+            return r;
+        cursor = end + 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Appends a Gauge, Counter or Untyped message holding value as the field number field
+ */
+static int prom_metric_formatter_add_value_field(prom_string_builder_t* sb, uint32_t field, double value)
+{
+    int r = 0;
+
+    r = prom_protobuf_add_tag(sb, field, PROM_PROTOBUF_WIRE_LENGTH_DELIMITED);
+    if (r)
+        return r;
+
+    // One byte tag plus the fixed64 payload
+    r = prom_protobuf_add_varint(sb, 1 + sizeof(double));
+    if (r)
+        return r;
+
+    return prom_protobuf_add_double_field(sb, PROM_PROTOBUF_VALUE, value);
+}
+
+/**
+ * @brief API PRIVATE Loads a Histogram message for hist_sample into the value builder
+ *
+ * The +Inf bucket is left out; its cumulative count is the sample count.
+ */
+static int prom_metric_formatter_load_histogram_protobuf(prom_metric_formatter_t* self,
+                                                         prom_metric_sample_histogram_t* hist_sample)
+{
+    int r = 0;
+    prom_string_builder_t* sb = self->value_builder;
+
+    // l_value_list holds the bucket l_values in upper_bounds order followed by +Inf, count and sum, which saves the
+    // l_values lookups. Fields may come in any order on the wire, so count and sum are written after the buckets.
+    prom_linked_list_node_t* current_node = hist_sample->l_value_list->head;
+    for (int i = 0; i < hist_sample->buckets->count; i++, current_node = current_node->next)
+    {
+        if (current_node == NULL)
+            return 1;
+        double upper_bound = hist_sample->buckets->upper_bounds[i];
+        prom_metric_sample_t* bucket =
+            (prom_metric_sample_t*)prom_map_get(hist_sample->samples, (const char*)current_node->item);
+        if (bucket == NULL)
+            return 1;
+
+        uint64_t cumulative_count = (uint64_t)bucket->r_value;
+        // One byte tags, the count as a varint and the bound as a fixed64
+        size_t len = 1 + prom_protobuf_varint_len(cumulative_count) + 1 + sizeof(double);
+
+        r = prom_protobuf_add_tag(sb, PROM_PROTOBUF_HISTOGRAM_BUCKET, PROM_PROTOBUF_WIRE_LENGTH_DELIMITED);
+        if (r)
+            return r;
+
+        r = prom_protobuf_add_varint(sb, len);
+        if (r)
+            return r;
+
+        r = prom_protobuf_add_uint64_field(sb, PROM_PROTOBUF_BUCKET_CUMULATIVE_COUNT, cumulative_count);
+        if (r)
+            return r;
+
+        r = prom_protobuf_add_double_field(sb, PROM_PROTOBUF_BUCKET_UPPER_BOUND, upper_bound);
+        if (r)
+            return r;
+    }
+
+    prom_linked_list_node_t* count_node = current_node != NULL ? current_node->next : NULL;
+    prom_linked_list_node_t* sum_node = count_node != NULL ? count_node->next : NULL;
+    if (sum_node == NULL)
+        return 1;
+    prom_metric_sample_t* count =
+        (prom_metric_sample_t*)prom_map_get(hist_sample->samples, (const char*)count_node->item);
+    prom_metric_sample_t* sum = (prom_metric_sample_t*)prom_map_get(hist_sample->samples, (const char*)sum_node->item);
+    if (count == NULL || sum == NULL)
+        return 1;
+
+    r = prom_protobuf_add_uint64_field(sb, PROM_PROTOBUF_HISTOGRAM_SAMPLE_COUNT, (uint64_t)count->r_value);
+    if (r)
+        return r;
+
+    return prom_protobuf_add_double_field(sb, PROM_PROTOBUF_HISTOGRAM_SAMPLE_SUM, sum->r_value);
+}
+
+/**
+ * @brief API PRIVATE Loads a Summary message for summary_sample into the value builder
+ */
+static int prom_metric_formatter_load_summary_protobuf(prom_metric_formatter_t* self,
+                                                       prom_metric_sample_summary_t* summary_sample)
+{
+    int r = 0;
+    prom_string_builder_t* sb = self->value_builder;
+
+    // l_value_list holds the quantile l_values in options order followed by count and sum
+    const prom_summary_options_t* options = summary_sample->options;
+    prom_linked_list_node_t* current_node = summary_sample->l_value_list->head;
+    for (size_t i = 0; i < options->quantile_count; i++, current_node = current_node->next)
+    {
+        if (current_node == NULL)
+            return 1;
+        prom_metric_sample_t* quantile =
+            (prom_metric_sample_t*)prom_map_get(summary_sample->samples, (const char*)current_node->item);
+        if (quantile == NULL)
+            return 1;
+
+        r = prom_protobuf_add_tag(sb, PROM_PROTOBUF_SUMMARY_QUANTILE, PROM_PROTOBUF_WIRE_LENGTH_DELIMITED);
+        if (r)
+            return r;
+
+        // One byte tags and two fixed64 payloads
+        r = prom_protobuf_add_varint(sb, 2 * (1 + sizeof(double)));
+        if (r)
+            return r;
+
+        r = prom_protobuf_add_double_field(sb, PROM_PROTOBUF_QUANTILE_QUANTILE, options->quantiles[i]);
+        if (r)
+            return r;
+
+        r = prom_protobuf_add_double_field(sb, PROM_PROTOBUF_QUANTILE_VALUE, quantile->r_value);
+        if (r)
+            return r;
+    }
+
+    prom_linked_list_node_t* count_node = current_node;
+    prom_linked_list_node_t* sum_node = count_node != NULL ? count_node->next : NULL;
+    if (sum_node == NULL)
+        return 1;
+    prom_metric_sample_t* count =
+        (prom_metric_sample_t*)prom_map_get(summary_sample->samples, (const char*)count_node->item);
+    prom_metric_sample_t* sum =
+        (prom_metric_sample_t*)prom_map_get(summary_sample->samples, (const char*)sum_node->item);
+    if (count == NULL || sum == NULL)
+        return 1;
+
+    r = prom_protobuf_add_uint64_field(sb, PROM_PROTOBUF_SUMMARY_SAMPLE_COUNT, (uint64_t)count->r_value);
+    if (r)
+        return r;
+
+    return prom_protobuf_add_double_field(sb, PROM_PROTOBUF_SUMMARY_SAMPLE_SUM, sum->r_value);
+}
+
+int prom_metric_formatter_load_metric_protobuf(prom_metric_formatter_t* self, prom_metric_t* metric)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+
+    int r = prom_metric_formatter_sync_metric(metric);
+    if (r)
+        return r;
+    uint64_t type = PROM_PROTOBUF_TYPE_UNTYPED;
+    uint32_t value_field = PROM_PROTOBUF_METRIC_UNTYPED;
+    switch (metric->type)
+    {
+    case PROM_COUNTER:
+        type = PROM_PROTOBUF_TYPE_COUNTER;
+        value_field = PROM_PROTOBUF_METRIC_COUNTER;
+        break;
+    case PROM_GAUGE:
+        type = PROM_PROTOBUF_TYPE_GAUGE;
+        value_field = PROM_PROTOBUF_METRIC_GAUGE;
+        break;
+    case PROM_HISTOGRAM:
+        type = PROM_PROTOBUF_TYPE_HISTOGRAM;
+        value_field = PROM_PROTOBUF_METRIC_HISTOGRAM;
+        break;
+    case PROM_SUMMARY:
+        type = PROM_PROTOBUF_TYPE_SUMMARY;
+        value_field = PROM_PROTOBUF_METRIC_SUMMARY;
+        break;
+    }
+
+    r = prom_metric_formatter_scratch(&self->family_builder);
+    if (r)
+        return r;
+
+    r = prom_protobuf_add_string_field(self->family_builder, PROM_PROTOBUF_FAMILY_NAME, metric->name);
+    if (r)
+        return r;
+
+    r = prom_protobuf_add_string_field(self->family_builder, PROM_PROTOBUF_FAMILY_HELP, metric->help);
+    if (r)
+        return r;
+
+    r = prom_protobuf_add_uint64_field(self->family_builder, PROM_PROTOBUF_FAMILY_TYPE, type);
+    if (r)
+        return r;
+
+    for (prom_linked_list_node_t* current_node = metric->samples->keys->head; current_node != NULL;
+         current_node = current_node->next)
+    {
+        const char* key = (const char*)current_node->item;
+
+        r = prom_metric_formatter_scratch(&self->metric_builder);
+        if (r)
+            return r;
+
+        r = prom_metric_formatter_add_label_pairs(self->metric_builder, metric, key);
+        if (r)
+            return r;
+
         if (metric->type == PROM_HISTOGRAM)
         {
             prom_metric_sample_histogram_t* hist_sample =
                 (prom_metric_sample_histogram_t*)prom_map_get(metric->samples, key);
+            if (hist_sample == NULL)
+                return 1;
+
+            r = prom_metric_formatter_scratch(&self->value_builder);
+            if (r)
+                return r;
+
+            r = prom_metric_formatter_load_histogram_protobuf(self, hist_sample);
+            if (r)
+                return r;
+
+            r = prom_metric_formatter_add_message_field(self->metric_builder, value_field, self->value_builder);
+            if (r)
+                return r;
+        }
+        else if (metric->type == PROM_SUMMARY)
+        {
+            prom_metric_sample_summary_t* summary_sample =
+                (prom_metric_sample_summary_t*)prom_map_get(metric->samples, key);
+            if (summary_sample == NULL)
+                return 1;
+
+            r = prom_metric_formatter_scratch(&self->value_builder);
+            if (r)
+                return r;
+
+            r = prom_metric_formatter_load_summary_protobuf(self, summary_sample);
+            if (r)
+                return r;
+
+            r = prom_metric_formatter_add_message_field(self->metric_builder, value_field, self->value_builder);
+            if (r)
+                return r;
+        }
+        else
+        {
+            prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(metric->samples, key);
+            if (sample == NULL)
+                return 1;
+
+            r = prom_metric_formatter_add_value_field(self->metric_builder, value_field, sample->r_value);
+            if (r)
+                return r;
+        }
+
+        r = prom_metric_formatter_add_message_field(self->family_builder, PROM_PROTOBUF_FAMILY_METRIC,
+                                                    self->metric_builder);
+        if (r)
+            return r;
+    }
+
+    // Delimited framing: every MetricFamily is prefixed by its length as a varint
+    r = prom_protobuf_add_varint(self->string_builder, prom_string_builder_len(self->family_builder));
+    if (r)
+        return r;
+
+    return prom_string_builder_add_bytes(self->string_builder, prom_string_builder_str(self->family_builder),
+                                         prom_string_builder_len(self->family_builder));
+}
+
+/**
+ * @brief API PRIVATE Returns the length of the OpenMetrics family name of metric; counters drop the _total suffix
+ */
+static size_t prom_metric_formatter_openmetrics_family_len(prom_metric_t* metric)
+{
+    size_t len = strlen(metric->name);
+    size_t suffix_len = strlen(PROM_OPENMETRICS_COUNTER_SUFFIX);
+    if (metric->type == PROM_COUNTER && len > suffix_len &&
+        strcmp(metric->name + len - suffix_len, PROM_OPENMETRICS_COUNTER_SUFFIX) == 0)
+        return len - suffix_len;
+    return len;
+}
+
+/**
+ * @brief API PRIVATE Loads an OpenMetrics sample line, inserting suffix between the metric name and the labels of the
+ * sample l_value, and the timestamp of the sample if it has one
+ */
+static int prom_metric_formatter_load_sample_openmetrics(prom_metric_formatter_t* self, prom_metric_t* metric,
+                                                         const char* suffix, prom_metric_sample_t* sample)
+{
+    int r = 0;
+
+    if (suffix != NULL)
+    {
+        size_t name_len = strlen(metric->name);
+        r = prom_string_builder_add_bytes(self->string_builder, sample->l_value, name_len);
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_str(self->string_builder, suffix);
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_str(self->string_builder, sample->l_value + name_len);
+        if (r)
+            return r;
+    }
+    else
+    {
+        r = prom_string_builder_add_str(self->string_builder, sample->l_value);
+        if (r)
+            return r;
+    }
 
+    r = prom_string_builder_add_char(self->string_builder, ' ');
+    if (r)
+        return r;
+
+    char buffer[PROM_DTOA_BUFFER_SIZE];
+    prom_dtoa(sample->r_value, buffer);
+    r = prom_string_builder_add_str(self->string_builder, buffer);
+    if (r)
+        return r;
+
+    // OpenMetrics timestamps are seconds since the epoch; millisecond precision is kept exactly
+    int64_t timestamp_ms = sample->timestamp_ms;
+    if (timestamp_ms > 0)
+    {
+        snprintf(buffer, sizeof(buffer), " %" PRId64 ".%03" PRId64, timestamp_ms / 1000, timestamp_ms % 1000);
+        r = prom_string_builder_add_str(self->string_builder, buffer);
+        if (r)
+            return r;
+    }
+
+    return prom_string_builder_add_char(self->string_builder, '\n');
+}
+
+int prom_metric_formatter_load_metric_openmetrics(prom_metric_formatter_t* self, prom_metric_t* metric)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+
+    int r = prom_metric_formatter_sync_metric(metric);
+    if (r)
+        return r;
+    size_t family_len = prom_metric_formatter_openmetrics_family_len(metric);
+    const char* lines[][2] = {{"# TYPE ", prom_metric_type_map[metric->type]}, {"# HELP ", metric->help}};
+
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        r = prom_string_builder_add_str(self->string_builder, lines[i][0]);
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_bytes(self->string_builder, metric->name, family_len);
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_char(self->string_builder, ' ');
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_str(self->string_builder, lines[i][1]);
+        if (r)
+            return r;
+
+        r = prom_string_builder_add_char(self->string_builder, '\n');
+        if (r)
+            return r;
+    }
+
+    const char* suffix = NULL;
+    if (metric->type == PROM_COUNTER && family_len == strlen(metric->name))
+        suffix = PROM_OPENMETRICS_COUNTER_SUFFIX;
+
+    for (prom_linked_list_node_t* current_node = metric->samples->keys->head; current_node != NULL;
+         current_node = current_node->next)
+    {
+        const char* key = (const char*)current_node->item;
+        if (metric->type == PROM_HISTOGRAM)
+        {
+            prom_metric_sample_histogram_t* hist_sample =
+                (prom_metric_sample_histogram_t*)prom_map_get(metric->samples, key);
             if (hist_sample == NULL)
                 return 1;
 
+            // l_value_list holds the bucket l_values, +Inf included, ahead of count and sum. Bucket l_values are
+            // stored without the _bucket suffix that OpenMetrics requires.
+            int bucket_count = hist_sample->buckets->count + 1;
+            int i = 0;
             for (prom_linked_list_node_t* current_hist_node = hist_sample->l_value_list->head;
-                 current_hist_node != NULL; current_hist_node = current_hist_node->next)
+                 current_hist_node != NULL; current_hist_node = current_hist_node->next, i++)
             {
                 const char* hist_key = (const char*)current_hist_node->item;
                 prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(hist_sample->samples, hist_key);
                 if (sample == NULL)
                     return 1;
-                r = prom_metric_formatter_load_sample(self, sample);
+                r = prom_metric_formatter_load_sample_openmetrics(
+                    self, metric, i < bucket_count ? PROM_OPENMETRICS_BUCKET_SUFFIX : NULL, sample);
+                if (r)
+                    return r;
+            }
+        }
+        else if (metric->type == PROM_SUMMARY)
+        {
+            // Quantile, count and sum l_values already carry the names OpenMetrics expects
+            prom_linked_list_t* l_value_list = NULL;
+            prom_map_t* samples = prom_metric_formatter_child_samples(metric, key, &l_value_list);
+            if (samples == NULL)
+                return 1;
+            for (prom_linked_list_node_t* current_summary_node = l_value_list->head; current_summary_node != NULL;
+                 current_summary_node = current_summary_node->next)
+            {
+                prom_metric_sample_t* sample =
+                    (prom_metric_sample_t*)prom_map_get(samples, (const char*)current_summary_node->item);
+                if (sample == NULL)
+                    return 1;
+                r = prom_metric_formatter_load_sample_openmetrics(self, metric, NULL, sample);
                 if (r)
                     return r;
             }
@@ -291,15 +1018,52 @@ int prom_metric_formatter_load_metric(prom_metric_formatter_t* self, prom_metric
             prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(metric->samples, key);
             if (sample == NULL)
                 return 1;
-            r = prom_metric_formatter_load_sample(self, sample);
+            r = prom_metric_formatter_load_sample_openmetrics(self, metric, suffix, sample);
             if (r)
                 return r;
         }
     }
-    return prom_string_builder_add_char(self->string_builder, '\n');
+    return 0;
 }
 
-int prom_metric_formatter_load_metrics(prom_metric_formatter_t* self, prom_map_t* collectors)
+size_t prom_metric_formatter_len(prom_metric_formatter_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    return prom_string_builder_len(self->string_builder);
+}
+
+void prom_metric_formatter_select(prom_metric_formatter_t* self, const prom_collector_selection_t* selection)
+{
+    PROM_ASSERT(self != NULL);
+    self->selection = selection;
+}
+
+/**
+ * @brief API PRIVATE Returns true if the collector named collector_name is in self->selection
+ */
+static bool prom_metric_formatter_collector_selected(prom_metric_formatter_t* self, const char* collector_name)
+{
+    const prom_collector_selection_t* selection = self->selection;
+    if (selection == NULL)
+        return true;
+    if (selection->prefix != NULL && strncmp(collector_name, selection->prefix, strlen(selection->prefix)) != 0)
+        return false;
+    if (selection->names_count == 0)
+        return true;
+    for (size_t i = 0; i < selection->names_count; i++)
+    {
+        if (strcmp(collector_name, selection->names[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief API PRIVATE Loads every metric of every selected collector with load_metric_fn. Collectors left out of the
+ * selection are not collected.
+ */
+static int prom_metric_formatter_load_collectors(prom_metric_formatter_t* self, prom_map_t* collectors,
+                                                 prom_metric_formatter_load_metric_fn load_metric_fn)
 {
     PROM_ASSERT(self != NULL);
     int r = 0;
@@ -307,6 +1071,8 @@ int prom_metric_formatter_load_metrics(prom_metric_formatter_t* self, prom_map_t
          current_node = current_node->next)
     {
         const char* collector_name = (const char*)current_node->item;
+        if (!prom_metric_formatter_collector_selected(self, collector_name))
+            continue;
         prom_collector_t* collector = (prom_collector_t*)prom_map_get(collectors, collector_name);
         if (collector == NULL)
             return 1;
@@ -322,10 +1088,62 @@ int prom_metric_formatter_load_metrics(prom_metric_formatter_t* self, prom_map_t
             prom_metric_t* metric = (prom_metric_t*)prom_map_get(metrics, metric_name);
             if (metric == NULL)
                 return 1;
-            r = prom_metric_formatter_load_metric(self, metric);
+            r = load_metric_fn(self, metric);
             if (r)
                 return r;
         }
     }
     return r;
 }
+
+int prom_metric_formatter_load_metrics(prom_metric_formatter_t* self, prom_map_t* collectors)
+{
+    return prom_metric_formatter_load_collectors(self, collectors, prom_metric_formatter_load_metric);
+}
+
+int prom_metric_formatter_load_metrics_protobuf(prom_metric_formatter_t* self, prom_map_t* collectors)
+{
+    return prom_metric_formatter_load_collectors(self, collectors, prom_metric_formatter_load_metric_protobuf);
+}
+
+int prom_metric_formatter_sync_histograms(prom_metric_formatter_t* self, prom_map_t* collectors)
+{
+    PROM_ASSERT(self != NULL);
+    for (prom_linked_list_node_t* current_node = collectors->keys->head; current_node != NULL;
+         current_node = current_node->next)
+    {
+        const char* collector_name = (const char*)current_node->item;
+        if (!prom_metric_formatter_collector_selected(self, collector_name))
+            continue;
+        prom_collector_t* collector = (prom_collector_t*)prom_map_get(collectors, collector_name);
+        if (collector == NULL)
+            return 1;
+
+        // The registered metrics are walked without calling collect_fn, which may do I/O
+        for (prom_linked_list_node_t* metric_node = collector->metrics->keys->head; metric_node != NULL;
+             metric_node = metric_node->next)
+        {
+            prom_metric_t* metric = (prom_metric_t*)prom_map_get(collector->metrics, (const char*)metric_node->item);
+            if (metric == NULL)
+                return 1;
+            int r = prom_metric_formatter_sync_metric(metric);
+            if (r)
+                return r;
+        }
+    }
+    return 0;
+}
+
+int prom_metric_formatter_load_metrics_since(prom_metric_formatter_t* self, prom_map_t* collectors, uint64_t since)
+{
+    self->since = since;
+    return prom_metric_formatter_load_collectors(self, collectors, prom_metric_formatter_load_metric_since);
+}
+
+int prom_metric_formatter_load_metrics_openmetrics(prom_metric_formatter_t* self, prom_map_t* collectors)
+{
+    int r = prom_metric_formatter_load_collectors(self, collectors, prom_metric_formatter_load_metric_openmetrics);
+    if (r)
+        return r;
+    return prom_string_builder_add_str(self->string_builder, "# EOF\n");
+}
@@ -66,11 +66,55 @@ int prom_metric_formatter_load_sample(prom_metric_formatter_t* metric_formatter,
  */
 int prom_metric_formatter_load_metric(prom_metric_formatter_t* self, prom_metric_t* metric);
 
+/**
+ * @brief API PRIVATE Restricts the loaders below to the collectors in selection until it is set back to NULL
+ */
+void prom_metric_formatter_select(prom_metric_formatter_t* self, const prom_collector_selection_t* selection);
+
 /**
  * @brief API PRIVATE Loads the given metrics
  */
 int prom_metric_formatter_load_metrics(prom_metric_formatter_t* self, prom_map_t* collectors);
 
+/**
+ * @brief API PRIVATE Loads a metric as a length-delimited io.prometheus.client.MetricFamily protobuf message
+ */
+int prom_metric_formatter_load_metric_protobuf(prom_metric_formatter_t* self, prom_metric_t* metric);
+
+/**
+ * @brief API PRIVATE Loads the given metrics in the delimited protobuf exposition format
+ */
+int prom_metric_formatter_load_metrics_protobuf(prom_metric_formatter_t* self, prom_map_t* collectors);
+
+/**
+ * @brief API PRIVATE Loads a metric in the OpenMetrics text format. Counter samples get the _total suffix, histogram
+ * buckets the _bucket suffix, and samples with a timestamp carry it.
+ */
+int prom_metric_formatter_load_metric_openmetrics(prom_metric_formatter_t* self, prom_metric_t* metric);
+
+/**
+ * @brief API PRIVATE Loads the given metrics in the OpenMetrics text format, terminated by # EOF
+ */
+int prom_metric_formatter_load_metrics_openmetrics(prom_metric_formatter_t* self, prom_map_t* collectors);
+
+/**
+ * @brief API PRIVATE Brings the rendered samples of the histograms registered in the selected collectors up to date.
+ * Every loader does this for the histograms it renders; a delta calls it before reading the version it reports, so
+ * observations made until then are reported under that version rather than the next one.
+ */
+int prom_metric_formatter_sync_histograms(prom_metric_formatter_t* self, prom_map_t* collectors);
+
+/**
+ * @brief API PRIVATE Loads, in the text exposition format, only the samples whose value changed after version since.
+ * HELP and TYPE lines are written only for metrics with at least one such sample.
+ */
+int prom_metric_formatter_load_metrics_since(prom_metric_formatter_t* self, prom_map_t* collectors, uint64_t since);
+
+/**
+ * @brief API PRIVATE Returns the number of bytes loaded so far; protobuf output may contain '\0'
+ */
+size_t prom_metric_formatter_len(prom_metric_formatter_t* self);
+
 /**
  * @brief API PRIVATE Clear the underlying string_builder
  */
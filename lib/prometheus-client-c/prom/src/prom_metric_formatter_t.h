@@ -17,12 +17,21 @@
 #ifndef PROM_METRIC_FORMATTER_T_H
 #define PROM_METRIC_FORMATTER_T_H
 
+#include <stdint.h>
+
+#include "prom_collector_registry.h"
 #include "prom_string_builder_t.h"
 
 typedef struct prom_metric_formatter
 {
     prom_string_builder_t* string_builder;
     prom_string_builder_t* err_builder;
+    prom_string_builder_t* family_builder; /**< Scratch space for protobuf MetricFamily messages, created on demand */
+    prom_string_builder_t* metric_builder; /**< Scratch space for protobuf Metric messages, created on demand */
+    prom_string_builder_t* value_builder;  /**< Scratch space for nested protobuf values, created on demand */
+    uint64_t since;                        /**< Version after which samples changed to be loaded by the delta loader */
+    /** Collectors the loaders walk, NULL for every collector */
+    const prom_collector_selection_t* selection;
 } prom_metric_formatter_t;
 
 #endif // PROM_METRIC_FORMATTER_T_H
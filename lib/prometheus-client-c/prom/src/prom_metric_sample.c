@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <math.h>
+#include <pthread.h>
 #include <stdatomic.h>
 
 // Public
@@ -26,12 +28,40 @@
 #include "prom_metric_sample_i.h"
 #include "prom_metric_sample_t.h"
 
+// Process wide change version; every creation or change of a sample value takes the next one
+static _Atomic uint64_t prom_metric_sample_version_counter = ATOMIC_VAR_INIT(0);
+
+// Writers hold this shared from taking a version until the sample stores it, and reading the current version holds it
+// exclusively, so every version up to the one returned is already visible in its sample
+static pthread_rwlock_t prom_metric_sample_version_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * @brief API PRIVATE Records that the value of the sample changed
+ */
+static void prom_metric_sample_touch(prom_metric_sample_t* self)
+{
+    pthread_rwlock_rdlock(&prom_metric_sample_version_lock);
+    atomic_store(&self->version, atomic_fetch_add(&prom_metric_sample_version_counter, 1) + 1);
+    pthread_rwlock_unlock(&prom_metric_sample_version_lock);
+}
+
+uint64_t prom_metric_sample_current_version(void)
+{
+    pthread_rwlock_wrlock(&prom_metric_sample_version_lock);
+    uint64_t version = atomic_load(&prom_metric_sample_version_counter);
+    pthread_rwlock_unlock(&prom_metric_sample_version_lock);
+    return version;
+}
+
 prom_metric_sample_t* prom_metric_sample_new(prom_metric_type_t type, const char* l_value, double r_value)
 {
     prom_metric_sample_t* self = (prom_metric_sample_t*)prom_malloc(sizeof(prom_metric_sample_t));
     self->type = type;
     self->l_value = prom_strdup(l_value);
     self->r_value = ATOMIC_VAR_INIT(r_value);
+    self->timestamp_ms = ATOMIC_VAR_INIT(0);
+    self->version = ATOMIC_VAR_INIT(0);
+    prom_metric_sample_touch(self);
     return self;
 }
 
@@ -76,6 +106,8 @@ int prom_metric_sample_add(prom_metric_sample_t* self, double r_value)
         _Atomic double new = ATOMIC_VAR_INIT(old + r_value);
         if (atomic_compare_exchange_weak(&self->r_value, &old, new))
         {
+            if (r_value != 0)
+                prom_metric_sample_touch(self);
             return 0;
         }
     }
@@ -95,11 +127,21 @@ int prom_metric_sample_sub(prom_metric_sample_t* self, double r_value)
         _Atomic double new = ATOMIC_VAR_INIT(old - r_value);
         if (atomic_compare_exchange_weak(&self->r_value, &old, new))
         {
+            if (r_value != 0)
+                prom_metric_sample_touch(self);
             return 0;
         }
     }
 }
 
+void prom_metric_sample_store(prom_metric_sample_t* self, double r_value)
+{
+    double old = atomic_exchange(&self->r_value, r_value);
+    // Setting the value it already had is not a change; NaN never compares equal, so it is compared by identity
+    if (old != r_value && !(isnan(old) && isnan(r_value)))
+        prom_metric_sample_touch(self);
+}
+
 int prom_metric_sample_set(prom_metric_sample_t* self, double r_value)
 {
     if (self->type != PROM_GAUGE)
@@ -107,6 +149,15 @@ int prom_metric_sample_set(prom_metric_sample_t* self, double r_value)
         PROM_LOG(PROM_METRIC_INCORRECT_TYPE);
         return 1;
     }
-    atomic_store(&self->r_value, r_value);
+    prom_metric_sample_store(self, r_value);
+    return 0;
+}
+
+int prom_metric_sample_set_timestamp(prom_metric_sample_t* self, int64_t timestamp_ms)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+    atomic_store(&self->timestamp_ms, timestamp_ms);
     return 0;
 }
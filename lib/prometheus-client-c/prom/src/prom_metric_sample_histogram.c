@@ -15,6 +15,7 @@
  */
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 
 // Public
@@ -62,6 +63,8 @@ static int prom_metric_sample_histogram_init_summary(prom_metric_sample_histogra
                                                      size_t label_count, const char** label_keys,
                                                      const char** label_values);
 
+static int prom_metric_sample_histogram_bucket_index(const prom_histogram_buckets_t* buckets, double value);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // End static declarations
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -127,6 +130,13 @@ prom_metric_sample_histogram_t* prom_metric_sample_histogram_new(const char* nam
 
     self->buckets = buckets;
 
+    // One counter per bucket plus one for the values above every upper bound
+    int bucket_count = prom_histogram_buckets_count(buckets);
+    self->bucket_counts = (_Atomic uint64_t*)prom_malloc((bucket_count + 1) * sizeof(_Atomic uint64_t));
+    for (int i = 0; i <= bucket_count; i++)
+        atomic_init(&self->bucket_counts[i], 0);
+    atomic_init(&self->sum, 0.0);
+
     // Allocate and initialize the lock
     self->rwlock = (pthread_rwlock_t*)prom_malloc(sizeof(pthread_rwlock_t));
     r = pthread_rwlock_init(self->rwlock, NULL);
@@ -342,6 +352,9 @@ int prom_metric_sample_histogram_destroy(prom_metric_sample_histogram_t* self)
     prom_free(self->rwlock);
     self->rwlock = NULL;
 
+    prom_free((void*)self->bucket_counts);
+    self->bucket_counts = NULL;
+
     prom_free(self);
     self = NULL;
     return ret;
@@ -363,120 +376,86 @@ void prom_metric_sample_histogram_free_generic(void* gen)
     prom_metric_sample_histogram_destroy(self);
 }
 
+/**
+ * @brief API PRIVATE Returns the index of the first bucket whose upper bound is at least value, or the number of
+ * buckets if there is none. NaN compares false against every bound and lands past the last bucket.
+ */
+static int prom_metric_sample_histogram_bucket_index(const prom_histogram_buckets_t* buckets, double value)
+{
+    int low = 0;
+    int high = buckets->count;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (value <= buckets->upper_bounds[middle])
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low;
+}
+
 int prom_metric_sample_histogram_observe(prom_metric_sample_histogram_t* self, double value)
 {
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+
+    // Lock free: only the counter of the bucket holding value is incremented. Cumulative counts are computed when the
+    // histogram is rendered, see prom_metric_sample_histogram_sync.
+    int index = prom_metric_sample_histogram_bucket_index(self->buckets, value);
+    atomic_fetch_add_explicit(&self->bucket_counts[index], 1, memory_order_relaxed);
+
+    double old = atomic_load_explicit(&self->sum, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&self->sum, &old, old + value, memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+    return 0;
+}
+
+int prom_metric_sample_histogram_sync(prom_metric_sample_histogram_t* self)
+{
+    PROM_ASSERT(self != NULL);
     int r = 0;
 
     r = pthread_rwlock_wrlock(self->rwlock);
     if (r)
     {
-        printf("RETURN CODE: %d\n", r);
         PROM_LOG(PROM_PTHREAD_RWLOCK_LOCK_ERROR);
         return r;
     }
 
-#define PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(r)                                                          \
-    int rr = 0;                                                                                                        \
-    rr = pthread_rwlock_unlock(self->rwlock);                                                                          \
-    if (rr)                                                                                                            \
-    {                                                                                                                  \
-        PROM_LOG(PROM_PTHREAD_RWLOCK_UNLOCK_ERROR);                                                                    \
-        return rr;                                                                                                     \
-    }                                                                                                                  \
-    else                                                                                                               \
-    {                                                                                                                  \
-        return r;                                                                                                      \
-    }
-
-    // Update the counter for the proper bucket if found
+    // l_value_list holds the bucket l_values in upper_bounds order followed by +Inf, count and sum. Counters read while
+    // observations go on may be a few observations apart from the sum, but the buckets are always cumulative.
     int bucket_count = prom_histogram_buckets_count(self->buckets);
-    for (int i = (bucket_count - 1); i >= 0; i--)
+    int inf_index = bucket_count;
+    int sum_index = bucket_count + 2;
+    uint64_t cumulative = 0;
+    prom_linked_list_node_t* current_node = self->l_value_list->head;
+    for (int i = 0; i <= sum_index; i++)
     {
-        if (value > self->buckets->upper_bounds[i])
-        {
-            break;
-        }
-
-        const char* bucket_key = prom_metric_sample_histogram_bucket_to_str(self->buckets->upper_bounds[i]);
-        if (bucket_key == NULL)
-        {
-            PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1)
-        }
-
-        const char* l_value = prom_map_get(self->l_values, bucket_key);
-        if (l_value == NULL)
-        {
-            prom_free((void*)bucket_key);
-            PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1)
-        }
-
-        prom_metric_sample_t* sample = prom_map_get(self->samples, l_value);
+        prom_metric_sample_t* sample =
+            current_node == NULL ? NULL : (prom_metric_sample_t*)prom_map_get(self->samples, current_node->item);
         if (sample == NULL)
         {
-            prom_free((void*)bucket_key);
-            PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1)
-        }
-
-        prom_free((void*)bucket_key);
-        r = prom_metric_sample_add(sample, 1.0);
-        if (r)
-        {
-            PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(r);
+            r = 1;
+            break;
         }
+        if (i <= inf_index)
+            cumulative += atomic_load_explicit(&self->bucket_counts[i], memory_order_relaxed);
+        if (i == sum_index)
+            prom_metric_sample_store(sample, atomic_load_explicit(&self->sum, memory_order_relaxed));
+        else
+            prom_metric_sample_store(sample, (double)cumulative);
+        current_node = current_node->next;
     }
 
-    // Update the +Inf and count samples
-    const char* inf_l_value = prom_map_get(self->l_values, "+Inf");
-    if (inf_l_value == NULL)
+    int rr = pthread_rwlock_unlock(self->rwlock);
+    if (rr)
     {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
+        PROM_LOG(PROM_PTHREAD_RWLOCK_UNLOCK_ERROR);
+        return rr;
     }
-
-    prom_metric_sample_t* inf_sample = prom_map_get(self->samples, inf_l_value);
-    if (inf_sample == NULL)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    r = prom_metric_sample_add(inf_sample, 1.0);
-    if (r)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    const char* count_l_value = prom_map_get(self->l_values, "count");
-    if (count_l_value == NULL)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    prom_metric_sample_t* count_sample = prom_map_get(self->samples, count_l_value);
-    if (count_sample == NULL)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    r = prom_metric_sample_add(count_sample, 1.0);
-    if (r)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    // Update the sum sample
-    const char* sum_l_value = prom_map_get(self->l_values, "sum");
-    if (sum_l_value == NULL)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    prom_metric_sample_t* sum_sample = prom_map_get(self->samples, sum_l_value);
-    if (sum_sample == NULL)
-    {
-        PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(1);
-    }
-
-    r = prom_metric_sample_add(sum_sample, value);
-    PROM_METRIC_SAMPLE_HISTOGRAM_OBSERVE_HANDLE_UNLOCK(r);
     return r;
 }
 
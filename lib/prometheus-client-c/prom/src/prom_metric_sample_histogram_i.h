@@ -40,6 +40,12 @@ int prom_metric_sample_histogram_destroy(prom_metric_sample_histogram_t* self);
  */
 int prom_metric_sample_histogram_destroy_generic(void* gen);
 
+/**
+ * @brief API PRIVATE Writes the cumulative bucket counts, the +Inf bucket, the count and the sum into the samples read
+ * by the formatters. Observations only update per-bucket counters, so this must run before the samples are rendered.
+ */
+int prom_metric_sample_histogram_sync(prom_metric_sample_histogram_t* self);
+
 char* prom_metric_sample_histogram_bucket_to_str(double bucket);
 
 void prom_metric_sample_histogram_free_generic(void* gen);
@@ -15,6 +15,8 @@
  */
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 // Public
 #include "prom_histogram_buckets.h"
@@ -34,7 +36,10 @@ struct prom_metric_sample_histogram
     prom_map_t* samples;
     prom_metric_formatter_t* metric_formatter;
     prom_histogram_buckets_t* buckets;
-    pthread_rwlock_t* rwlock;
+    pthread_rwlock_t* rwlock;         /**< Serializes prom_metric_sample_histogram_sync; observations do not take it */
+    _Atomic uint64_t* bucket_counts;  /**< Observations per bucket in upper_bounds order, not cumulative, followed by
+                                           the observations above every upper bound */
+    _Atomic double sum;               /**< Sum of the observed values */
 };
 
 #endif // PROM_METRIC_HISTOGRAM_SAMPLE_T_H
@@ -46,4 +46,14 @@ int prom_metric_sample_destroy_generic(void*);
  */
 void prom_metric_sample_free_generic(void* gen);
 
+/**
+ * @brief API PRIVATE Sets the value whatever the sample type, recording a change only if it differs from the current one
+ */
+void prom_metric_sample_store(prom_metric_sample_t* self, double r_value);
+
+/**
+ * @brief API PRIVATE Returns the latest change version handed out to a sample; 0 before any sample exists
+ */
+uint64_t prom_metric_sample_current_version(void);
+
 #endif // PROM_METRIC_SAMPLE_I_H
@@ -0,0 +1,422 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+// Public
+#include "prom_alloc.h"
+#include "prom_summary.h"
+
+// Private
+#include "prom_assert.h"
+#include "prom_errors.h"
+#include "prom_linked_list_i.h"
+#include "prom_log.h"
+#include "prom_map_i.h"
+#include "prom_metric_formatter_i.h"
+#include "prom_metric_sample_i.h"
+#include "prom_metric_sample_summary_i.h"
+#include "prom_sketch_i.h"
+
+// Bins per sign of each sketch. At the default 1% accuracy they cover values spanning 17 orders of magnitude.
+#define PROM_METRIC_SAMPLE_SUMMARY_MAX_BINS 2048
+
+#define PROM_METRIC_SAMPLE_SUMMARY_QUANTILE_SIZE 32
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static Declarations
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* prom_metric_sample_summary_l_value(prom_metric_sample_summary_t* self, const char* name,
+                                                      const char* suffix, size_t label_count, const char** label_keys,
+                                                      const char** label_values, const char* quantile);
+
+static int prom_metric_sample_summary_init_sample(prom_metric_sample_summary_t* self, const char* l_value,
+                                                  double r_value);
+
+static double prom_metric_sample_summary_now(void);
+
+static void prom_metric_sample_summary_rotate(prom_metric_sample_summary_t* self, double now);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// End static declarations
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+prom_metric_sample_summary_t* prom_metric_sample_summary_new(const char* name, const prom_summary_options_t* options,
+                                                             size_t label_count, const char** label_keys,
+                                                             const char** label_values)
+{
+    int r = 0;
+
+    prom_metric_sample_summary_t* self =
+        (prom_metric_sample_summary_t*)prom_malloc(sizeof(prom_metric_sample_summary_t));
+    self->l_value_list = NULL;
+    self->samples = NULL;
+    self->metric_formatter = NULL;
+    self->rwlock = NULL;
+    self->merged = NULL;
+    self->options = options;
+    self->current = 0;
+    self->rotated_at = prom_metric_sample_summary_now();
+    self->count = 0;
+    self->sum = 0.0;
+
+    // Allocate the sketches first so that destroy can walk them whatever fails later
+    self->windows = (prom_sketch_t**)prom_malloc(options->age_buckets * sizeof(prom_sketch_t*));
+    for (size_t i = 0; i < options->age_buckets; i++)
+        self->windows[i] = prom_sketch_new(options->relative_accuracy, PROM_METRIC_SAMPLE_SUMMARY_MAX_BINS);
+    for (size_t i = 0; i < options->age_buckets; i++)
+    {
+        if (self->windows[i] == NULL)
+        {
+            prom_metric_sample_summary_destroy(self);
+            return NULL;
+        }
+    }
+
+    self->merged = prom_sketch_new(options->relative_accuracy, PROM_METRIC_SAMPLE_SUMMARY_MAX_BINS);
+    if (self->merged == NULL)
+    {
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    self->l_value_list = prom_linked_list_new();
+    if (self->l_value_list == NULL)
+    {
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    self->metric_formatter = prom_metric_formatter_new();
+    if (self->metric_formatter == NULL)
+    {
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    self->samples = prom_map_new();
+    if (self->samples == NULL)
+    {
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    r = prom_map_set_free_value_fn(self->samples, &prom_metric_sample_free_generic);
+    if (r)
+    {
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    self->rwlock = (pthread_rwlock_t*)prom_malloc(sizeof(pthread_rwlock_t));
+    r = pthread_rwlock_init(self->rwlock, NULL);
+    if (r)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_INIT_ERROR);
+        prom_free(self->rwlock);
+        self->rwlock = NULL;
+        prom_metric_sample_summary_destroy(self);
+        return NULL;
+    }
+
+    // One sample per quantile, in options order, then count and sum; the quantiles stay NaN until observed
+    for (size_t i = 0; i < options->quantile_count; i++)
+    {
+        char quantile[PROM_METRIC_SAMPLE_SUMMARY_QUANTILE_SIZE];
+        snprintf(quantile, sizeof(quantile), "%g", options->quantiles[i]);
+        const char* l_value = prom_metric_sample_summary_l_value(self, name, NULL, label_count, label_keys,
+                                                                 label_values, quantile);
+        r = prom_metric_sample_summary_init_sample(self, l_value, NAN);
+        prom_free((void*)l_value);
+        if (r)
+        {
+            prom_metric_sample_summary_destroy(self);
+            return NULL;
+        }
+    }
+
+    const char* suffixes[] = {"count", "sum"};
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+    {
+        const char* l_value =
+            prom_metric_sample_summary_l_value(self, name, suffixes[i], label_count, label_keys, label_values, NULL);
+        r = prom_metric_sample_summary_init_sample(self, l_value, 0.0);
+        prom_free((void*)l_value);
+        if (r)
+        {
+            prom_metric_sample_summary_destroy(self);
+            return NULL;
+        }
+    }
+    return self;
+}
+
+/**
+ * @brief API PRIVATE Appends l_value to l_value_list and adds a sample for it holding r_value
+ */
+static int prom_metric_sample_summary_init_sample(prom_metric_sample_summary_t* self, const char* l_value,
+                                                  double r_value)
+{
+    PROM_ASSERT(self != NULL);
+    if (l_value == NULL)
+        return 1;
+
+    int r = prom_linked_list_append(self->l_value_list, prom_strdup(l_value));
+    if (r)
+        return r;
+
+    prom_metric_sample_t* sample = prom_metric_sample_new(PROM_SUMMARY, l_value, r_value);
+    if (sample == NULL)
+        return 1;
+
+    return prom_map_set(self->samples, l_value, sample);
+}
+
+/**
+ * @brief API PRIVATE Returns the l_value of a sample of the summary: the name with suffix, the labels and, if quantile
+ * is not NULL, the quantile label. The caller must free it.
+ */
+static const char* prom_metric_sample_summary_l_value(prom_metric_sample_summary_t* self, const char* name,
+                                                      const char* suffix, size_t label_count, const char** label_keys,
+                                                      const char** label_values, const char* quantile)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
+    if (quantile == NULL)
+    {
+        r = prom_metric_formatter_load_l_value(self->metric_formatter, name, suffix, label_count, label_keys,
+                                               label_values);
+        return r ? NULL : (const char*)prom_metric_formatter_dump(self->metric_formatter);
+    }
+
+    // The user labels followed by the quantile label; the strings are borrowed, only the arrays are allocated
+    const char** keys = (const char**)prom_malloc((label_count + 1) * sizeof(char*));
+    const char** values = (const char**)prom_malloc((label_count + 1) * sizeof(char*));
+    for (size_t i = 0; i < label_count; i++)
+    {
+        keys[i] = label_keys[i];
+        values[i] = label_values[i];
+    }
+    keys[label_count] = "quantile";
+    values[label_count] = quantile;
+
+    r = prom_metric_formatter_load_l_value(self->metric_formatter, name, suffix, label_count + 1, keys, values);
+    prom_free(keys);
+    prom_free(values);
+    return r ? NULL : (const char*)prom_metric_formatter_dump(self->metric_formatter);
+}
+
+int prom_metric_sample_summary_destroy(prom_metric_sample_summary_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
+    int ret = 0;
+
+    if (self == NULL)
+        return 0;
+
+    if (self->l_value_list != NULL)
+    {
+        r = prom_linked_list_destroy(self->l_value_list);
+        if (r)
+            ret = r;
+        self->l_value_list = NULL;
+    }
+
+    if (self->samples != NULL)
+    {
+        r = prom_map_destroy(self->samples);
+        if (r)
+            ret = r;
+        self->samples = NULL;
+    }
+
+    if (self->metric_formatter != NULL)
+    {
+        r = prom_metric_formatter_destroy(self->metric_formatter);
+        if (r)
+            ret = r;
+        self->metric_formatter = NULL;
+    }
+
+    if (self->rwlock != NULL)
+    {
+        r = pthread_rwlock_destroy(self->rwlock);
+        if (r)
+        {
+            PROM_LOG(PROM_PTHREAD_RWLOCK_DESTROY_ERROR);
+            ret = r;
+        }
+        prom_free(self->rwlock);
+        self->rwlock = NULL;
+    }
+
+    for (size_t i = 0; i < self->options->age_buckets; i++)
+    {
+        if (self->windows[i] != NULL)
+            prom_sketch_destroy(self->windows[i]);
+    }
+    prom_free(self->windows);
+    self->windows = NULL;
+
+    if (self->merged != NULL)
+        prom_sketch_destroy(self->merged);
+    self->merged = NULL;
+
+    prom_free(self);
+    self = NULL;
+    return ret;
+}
+
+int prom_metric_sample_summary_destroy_generic(void* gen)
+{
+    int r = 0;
+
+    prom_metric_sample_summary_t* self = (prom_metric_sample_summary_t*)gen;
+    r = prom_metric_sample_summary_destroy(self);
+    self = NULL;
+    return r;
+}
+
+void prom_metric_sample_summary_free_generic(void* gen)
+{
+    prom_metric_sample_summary_t* self = (prom_metric_sample_summary_t*)gen;
+    prom_metric_sample_summary_destroy(self);
+}
+
+/**
+ * @brief API PRIVATE Returns the monotonic clock in seconds
+ */
+static double prom_metric_sample_summary_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief API PRIVATE Moves on to the next window for every max_age / age_buckets elapsed since the current one
+ * started, clearing each window it moves on to. Must be called with the write lock held.
+ */
+static void prom_metric_sample_summary_rotate(prom_metric_sample_summary_t* self, double now)
+{
+    if (self->options->max_age <= 0)
+        return;
+
+    double window_length = self->options->max_age / (double)self->options->age_buckets;
+    for (size_t i = 0; i < self->options->age_buckets && now - self->rotated_at >= window_length; i++)
+    {
+        self->current = (self->current + 1) % self->options->age_buckets;
+        prom_sketch_clear(self->windows[self->current]);
+        self->rotated_at += window_length;
+    }
+    // Idle for longer than max_age: every window has been cleared, start afresh
+    if (now - self->rotated_at >= window_length)
+        self->rotated_at = now;
+}
+
+int prom_metric_sample_summary_observe_at(prom_metric_sample_summary_t* self, double value, double now)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+
+    int r = pthread_rwlock_wrlock(self->rwlock);
+    if (r)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_LOCK_ERROR);
+        return r;
+    }
+
+    prom_metric_sample_summary_rotate(self, now);
+    // NaN has no rank; like the +Inf bucket of a histogram it still shows up in the count and the sum
+    if (!isnan(value))
+        r = prom_sketch_insert(self->windows[self->current], value);
+    if (r == 0)
+    {
+        self->count++;
+        self->sum += value;
+    }
+
+    int rr = pthread_rwlock_unlock(self->rwlock);
+    if (rr)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_UNLOCK_ERROR);
+        return rr;
+    }
+    return r;
+}
+
+int prom_metric_sample_summary_observe(prom_metric_sample_summary_t* self, double value)
+{
+    return prom_metric_sample_summary_observe_at(self, value, prom_metric_sample_summary_now());
+}
+
+int prom_metric_sample_summary_sync_at(prom_metric_sample_summary_t* self, double now)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
+
+    r = pthread_rwlock_wrlock(self->rwlock);
+    if (r)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_LOCK_ERROR);
+        return r;
+    }
+
+    // The windows are merged into one sketch, so the quantiles are those of the whole sliding window
+    prom_metric_sample_summary_rotate(self, now);
+    prom_sketch_clear(self->merged);
+    for (size_t i = 0; i < self->options->age_buckets && r == 0; i++)
+        r = prom_sketch_merge(self->merged, self->windows[i]);
+
+    // l_value_list holds the quantile l_values in options order followed by count and sum
+    size_t quantile_count = self->options->quantile_count;
+    prom_linked_list_node_t* current_node = self->l_value_list->head;
+    for (size_t i = 0; i < quantile_count + 2 && r == 0; i++, current_node = current_node->next)
+    {
+        prom_metric_sample_t* sample =
+            current_node == NULL ? NULL : (prom_metric_sample_t*)prom_map_get(self->samples, current_node->item);
+        if (sample == NULL)
+        {
+            r = 1;
+            break;
+        }
+        if (i < quantile_count)
+            prom_metric_sample_store(sample, prom_sketch_quantile(self->merged, self->options->quantiles[i]));
+        else if (i == quantile_count)
+            prom_metric_sample_store(sample, (double)self->count);
+        else
+            prom_metric_sample_store(sample, self->sum);
+    }
+
+    int rr = pthread_rwlock_unlock(self->rwlock);
+    if (rr)
+    {
+        PROM_LOG(PROM_PTHREAD_RWLOCK_UNLOCK_ERROR);
+        return rr;
+    }
+    return r;
+}
+
+int prom_metric_sample_summary_sync(prom_metric_sample_summary_t* self)
+{
+    return prom_metric_sample_summary_sync_at(self, prom_metric_sample_summary_now());
+}
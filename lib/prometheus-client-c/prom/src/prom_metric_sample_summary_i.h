@@ -0,0 +1,65 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROM_METRIC_SAMPLE_SUMMARY_I_H
+#define PROM_METRIC_SAMPLE_SUMMARY_I_H
+
+// Public
+#include "prom_metric_sample_summary.h"
+#include "prom_summary.h"
+
+// Private
+#include "prom_metric_sample_summary_t.h"
+
+/**
+ * @brief API PRIVATE Create a pointer to a prom_metric_sample_summary_t
+ */
+prom_metric_sample_summary_t* prom_metric_sample_summary_new(const char* name, const prom_summary_options_t* options,
+                                                             size_t label_count, const char** label_keys,
+                                                             const char** label_values);
+
+/**
+ * @brief API PRIVATE Destroy a prom_metric_sample_summary_t
+ */
+int prom_metric_sample_summary_destroy(prom_metric_sample_summary_t* self);
+
+/**
+ * @brief API PRIVATE Destroy a void pointer that is cast to a prom_metric_sample_summary_t*
+ */
+int prom_metric_sample_summary_destroy_generic(void* gen);
+
+/**
+ * @brief API PRIVATE Destroy a void pointer that is cast to a prom_metric_sample_summary_t*. Discards any errors.
+ */
+void prom_metric_sample_summary_free_generic(void* gen);
+
+/**
+ * @brief API PRIVATE Observes value as if the monotonic clock read now seconds
+ */
+int prom_metric_sample_summary_observe_at(prom_metric_sample_summary_t* self, double value, double now);
+
+/**
+ * @brief API PRIVATE Writes the quantiles of the sliding window, the count and the sum into the samples read by the
+ * formatters. Observations only update the sketches, so this must run before the samples are rendered.
+ */
+int prom_metric_sample_summary_sync(prom_metric_sample_summary_t* self);
+
+/**
+ * @brief API PRIVATE prom_metric_sample_summary_sync as if the monotonic clock read now seconds
+ */
+int prom_metric_sample_summary_sync_at(prom_metric_sample_summary_t* self, double now);
+
+#endif // PROM_METRIC_SAMPLE_SUMMARY_I_H
@@ -0,0 +1,49 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+
+// Public
+#include "prom_metric_sample_summary.h"
+#include "prom_summary.h"
+
+// Private
+#include "prom_linked_list_t.h"
+#include "prom_map_t.h"
+#include "prom_metric_formatter_t.h"
+#include "prom_sketch_i.h"
+
+#ifndef PROM_METRIC_SAMPLE_SUMMARY_T_H
+#define PROM_METRIC_SAMPLE_SUMMARY_T_H
+
+struct prom_metric_sample_summary
+{
+    prom_linked_list_t* l_value_list; /**< The quantile l_values in options order, followed by count and sum */
+    prom_map_t* samples;              /**< The l_value/prom_metric_sample_t of the samples read by the formatters */
+    prom_metric_formatter_t* metric_formatter;
+    const prom_summary_options_t* options; /**< Owned by the metric */
+    pthread_rwlock_t* rwlock;              /**< Serializes observations, window rotations and syncs */
+    prom_sketch_t** windows;               /**< One sketch per age bucket, each holding the observations of its part of
+                                                the sliding window */
+    size_t current;                        /**< Index of the window receiving observations */
+    double rotated_at;                     /**< Monotonic time, in seconds, at which the current window started */
+    prom_sketch_t* merged;                 /**< Scratch sketch the windows are merged into to read the quantiles */
+    uint64_t count;                        /**< Observations since the sample was created */
+    double sum;                            /**< Sum of the observed values */
+};
+
+#endif // PROM_METRIC_SAMPLE_SUMMARY_T_H
@@ -22,9 +22,11 @@
 
 struct prom_metric_sample
 {
-    prom_metric_type_t type; /**< type is the metric type for the sample */
-    char* l_value;           /**< l_value is the full metric name and label set represeted as a string */
-    _Atomic double r_value;  /**< r_value is the value of the metric sample */
+    prom_metric_type_t type;      /**< type is the metric type for the sample */
+    char* l_value;                /**< l_value is the full metric name and label set represeted as a string */
+    _Atomic double r_value;       /**< r_value is the value of the metric sample */
+    _Atomic int64_t timestamp_ms; /**< timestamp_ms is when r_value was observed, in ms since the epoch, 0 if unset */
+    _Atomic uint64_t version;     /**< version is the change version at which r_value last changed */
 };
 
 #endif // PROM_METRIC_SAMPLE_T_H
@@ -22,6 +22,7 @@
 // Public
 #include "prom_histogram_buckets.h"
 #include "prom_metric.h"
+#include "prom_summary.h"
 
 // Private
 #include "prom_map_i.h"
@@ -55,6 +56,7 @@ struct prom_metric
     const char* help;                   /**< help             The help output for the metric */
     prom_map_t* samples;                /**< samples          Map comprised of samples for the given metric */
     prom_histogram_buckets_t* buckets;  /**< buckets          Array of histogram bucket upper bound values */
+    prom_summary_options_t* summary;    /**< summary          Quantiles and sliding window of a summary */
     size_t label_key_count;             /**< label_keys_count The count of labe_keys*/
     prom_metric_formatter_t* formatter; /**< formatter        The metric formatter  */
     pthread_rwlock_t* rwlock;           /**< rwlock           Required for locking on certain non-atomic operations */
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+// Private
+#include "prom_assert.h"
+#include "prom_protobuf_i.h"
+#include "prom_string_builder_i.h"
+
+// A varint carries 7 bits per byte, so a 64 bit value needs at most 10 bytes
+#define PROM_PROTOBUF_MAX_VARINT_LEN 10
+#define PROM_PROTOBUF_FIXED64_LEN 8
+
+int prom_protobuf_add_varint(prom_string_builder_t* sb, uint64_t value)
+{
+    PROM_ASSERT(sb != NULL);
+    char buffer[PROM_PROTOBUF_MAX_VARINT_LEN];
+    size_t len = 0;
+    while (value >= 0x80)
+    {
+        buffer[len++] = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[len++] = (char)value;
+    return prom_string_builder_add_bytes(sb, buffer, len);
+}
+
+size_t prom_protobuf_varint_len(uint64_t value)
+{
+    size_t len = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        len++;
+    }
+    return len;
+}
+
+int prom_protobuf_add_tag(prom_string_builder_t* sb, uint32_t field, prom_protobuf_wire_type_t wire_type)
+{
+    return prom_protobuf_add_varint(sb, ((uint64_t)field << 3) | (uint64_t)wire_type);
+}
+
+int prom_protobuf_add_uint64_field(prom_string_builder_t* sb, uint32_t field, uint64_t value)
+{
+    int r = prom_protobuf_add_tag(sb, field, PROM_PROTOBUF_WIRE_VARINT);
+    if (r)
+        return r;
+    return prom_protobuf_add_varint(sb, value);
+}
+
+int prom_protobuf_add_double_field(prom_string_builder_t* sb, uint32_t field, double value)
+{
+    int r = prom_protobuf_add_tag(sb, field, PROM_PROTOBUF_WIRE_FIXED64);
+    if (r)
+        return r;
+
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    char buffer[PROM_PROTOBUF_FIXED64_LEN];
+    for (int i = 0; i < PROM_PROTOBUF_FIXED64_LEN; i++)
+    {
+        buffer[i] = (char)(bits & 0xFF);
+        bits >>= 8;
+    }
+    return prom_string_builder_add_bytes(sb, buffer, sizeof(buffer));
+}
+
+int prom_protobuf_add_bytes_field(prom_string_builder_t* sb, uint32_t field, const char* data, size_t len)
+{
+    int r = prom_protobuf_add_tag(sb, field, PROM_PROTOBUF_WIRE_LENGTH_DELIMITED);
+    if (r)
+        return r;
+    r = prom_protobuf_add_varint(sb, len);
+    if (r)
+        return r;
+    return prom_string_builder_add_bytes(sb, data, len);
+}
+
+int prom_protobuf_add_string_field(prom_string_builder_t* sb, uint32_t field, const char* str)
+{
+    if (str == NULL)
+        str = "";
+    return prom_protobuf_add_bytes_field(sb, field, str, strlen(str));
+}
@@ -0,0 +1,74 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reference: https://protobuf.dev/programming-guides/encoding/
+
+#ifndef PROM_PROTOBUF_I_H
+#define PROM_PROTOBUF_I_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Private
+#include "prom_string_builder_t.h"
+
+/**
+ * @brief API PRIVATE Protocol buffer wire types
+ */
+typedef enum prom_protobuf_wire_type
+{
+    PROM_PROTOBUF_WIRE_VARINT = 0,
+    PROM_PROTOBUF_WIRE_FIXED64 = 1,
+    PROM_PROTOBUF_WIRE_LENGTH_DELIMITED = 2,
+    PROM_PROTOBUF_WIRE_FIXED32 = 5
+} prom_protobuf_wire_type_t;
+
+/**
+ * @brief API PRIVATE Appends value as a base 128 varint
+ */
+int prom_protobuf_add_varint(prom_string_builder_t* sb, uint64_t value);
+
+/**
+ * @brief API PRIVATE Returns the number of bytes value takes as a varint
+ */
+size_t prom_protobuf_varint_len(uint64_t value);
+
+/**
+ * @brief API PRIVATE Appends the key of field number field with the given wire type
+ */
+int prom_protobuf_add_tag(prom_string_builder_t* sb, uint32_t field, prom_protobuf_wire_type_t wire_type);
+
+/**
+ * @brief API PRIVATE Appends a varint field (uint64, int64, enum)
+ */
+int prom_protobuf_add_uint64_field(prom_string_builder_t* sb, uint32_t field, uint64_t value);
+
+/**
+ * @brief API PRIVATE Appends a double field, encoded as little endian fixed64
+ */
+int prom_protobuf_add_double_field(prom_string_builder_t* sb, uint32_t field, double value);
+
+/**
+ * @brief API PRIVATE Appends a length delimited field (string, bytes or an embedded message)
+ */
+int prom_protobuf_add_bytes_field(prom_string_builder_t* sb, uint32_t field, const char* data, size_t len);
+
+/**
+ * @brief API PRIVATE Appends a string field; NULL is treated as the empty string
+ */
+int prom_protobuf_add_string_field(prom_string_builder_t* sb, uint32_t field, const char* str);
+
+#endif // PROM_PROTOBUF_I_H
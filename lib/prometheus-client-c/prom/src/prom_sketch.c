@@ -0,0 +1,310 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+
+// Public
+#include "prom_alloc.h"
+
+// Private
+#include "prom_assert.h"
+#include "prom_sketch_i.h"
+#include "prom_sketch_t.h"
+
+// Bins allocated by a store the first time it is used; it doubles from there up to max_bins
+#define PROM_SKETCH_INITIAL_BINS 32
+
+// Bin indexes are clamped to +/- this bound so that the distance between any two of them fits an int
+#define PROM_SKETCH_MAX_INDEX (INT_MAX / 4)
+
+prom_sketch_t* prom_sketch_new(double relative_accuracy, size_t max_bins)
+{
+    if (!(relative_accuracy > 0.0 && relative_accuracy < 1.0) || max_bins == 0)
+        return NULL;
+
+    prom_sketch_t* self = (prom_sketch_t*)prom_malloc(sizeof(prom_sketch_t));
+    if (self == NULL)
+        return NULL;
+    memset(self, 0, sizeof(prom_sketch_t));
+    self->relative_accuracy = relative_accuracy;
+    self->gamma = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+    self->log_gamma = log(self->gamma);
+    self->max_bins = max_bins;
+    return self;
+}
+
+int prom_sketch_destroy(prom_sketch_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 0;
+    prom_free(self->positive.counts);
+    prom_free(self->negative.counts);
+    prom_free(self);
+    self = NULL;
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Returns the bin of a magnitude of at least DBL_MIN
+ */
+static int prom_sketch_index(const prom_sketch_t* self, double magnitude)
+{
+    double index = ceil(log(magnitude) / self->log_gamma);
+    if (index > PROM_SKETCH_MAX_INDEX)
+        return PROM_SKETCH_MAX_INDEX;
+    if (index < -PROM_SKETCH_MAX_INDEX)
+        return -PROM_SKETCH_MAX_INDEX;
+    return (int)index;
+}
+
+/**
+ * @brief API PRIVATE Returns the value reported for a bin, the one with the same relative error to both its bounds
+ */
+static double prom_sketch_value(const prom_sketch_t* self, int index)
+{
+    return exp(index * self->log_gamma) * (1.0 - self->relative_accuracy);
+}
+
+/**
+ * @brief API PRIVATE Makes room for length bins in the store, doubling its allocation up to max_bins
+ */
+static int prom_sketch_store_reserve(prom_sketch_store_t* self, size_t length, size_t max_bins)
+{
+    if (length <= self->capacity)
+        return 0;
+    size_t capacity = self->capacity == 0 ? PROM_SKETCH_INITIAL_BINS : self->capacity * 2;
+    if (capacity > max_bins)
+        capacity = max_bins;
+    if (capacity < length)
+        capacity = length;
+    uint64_t* counts = (uint64_t*)prom_realloc(self->counts, capacity * sizeof(uint64_t));
+    if (counts == NULL)
+        return 1;
+    self->counts = counts;
+    self->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Moves the counts of every bin below offset into the bin at offset, which becomes the first one
+ */
+static void prom_sketch_store_collapse(prom_sketch_store_t* self, int offset)
+{
+    size_t dropped = (size_t)(offset - self->offset);
+    if (dropped >= self->length)
+    {
+        uint64_t total = 0;
+        for (size_t i = 0; i < self->length; i++)
+            total += self->counts[i];
+        self->counts[0] = total;
+        self->length = 1;
+    }
+    else
+    {
+        uint64_t collapsed = 0;
+        for (size_t i = 0; i < dropped; i++)
+            collapsed += self->counts[i];
+        memmove(self->counts, self->counts + dropped, (self->length - dropped) * sizeof(uint64_t));
+        self->counts[0] += collapsed;
+        self->length -= dropped;
+    }
+    self->offset = offset;
+}
+
+/**
+ * @brief API PRIVATE Adds count to the bin index. Once the store spans max_bins bins, the lowest bins are collapsed
+ * so that the highest magnitudes, the ones summaries are usually watched for, keep their accuracy.
+ */
+static int prom_sketch_store_add(prom_sketch_store_t* self, size_t max_bins, int index, uint64_t count)
+{
+    int r = 0;
+    if (self->length == 0)
+    {
+        r = prom_sketch_store_reserve(self, 1, max_bins);
+        if (r)
+            return r;
+        self->offset = index;
+        self->counts[0] = 0;
+        self->length = 1;
+    }
+    else if (index < self->offset)
+    {
+        // Below a full store the value is counted in its lowest bin
+        int lowest = self->offset + (int)self->length - (int)max_bins;
+        if (index < lowest)
+            index = lowest;
+        size_t shift = (size_t)(self->offset - index);
+        if (shift > 0)
+        {
+            r = prom_sketch_store_reserve(self, self->length + shift, max_bins);
+            if (r)
+                return r;
+            memmove(self->counts + shift, self->counts, self->length * sizeof(uint64_t));
+            memset(self->counts, 0, shift * sizeof(uint64_t));
+            self->offset = index;
+            self->length += shift;
+        }
+    }
+    else if ((size_t)(index - self->offset) >= self->length)
+    {
+        if ((size_t)(index - self->offset) >= max_bins)
+            prom_sketch_store_collapse(self, index - (int)max_bins + 1);
+        size_t length = (size_t)(index - self->offset) + 1;
+        r = prom_sketch_store_reserve(self, length, max_bins);
+        if (r)
+            return r;
+        memset(self->counts + self->length, 0, (length - self->length) * sizeof(uint64_t));
+        self->length = length;
+    }
+    self->counts[index - self->offset] += count;
+    return 0;
+}
+
+int prom_sketch_insert(prom_sketch_t* self, double value)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL || isnan(value))
+        return 1;
+
+    int r = 0;
+    double magnitude = fabs(value);
+    if (magnitude < DBL_MIN)
+        self->zero_count++;
+    else
+    {
+        r = prom_sketch_store_add(value > 0 ? &self->positive : &self->negative, self->max_bins,
+                                  prom_sketch_index(self, magnitude), 1);
+        if (r)
+            return r;
+    }
+    if (self->count == 0 || value < self->min)
+        self->min = value;
+    if (self->count == 0 || value > self->max)
+        self->max = value;
+    self->count++;
+    return 0;
+}
+
+/**
+ * @brief API PRIVATE Adds every bin of other to self
+ */
+static int prom_sketch_store_merge(prom_sketch_store_t* self, size_t max_bins, const prom_sketch_store_t* other)
+{
+    if (other->length == 0)
+        return 0;
+
+    // Extending to the highest and then the lowest bin of other first resizes self at most twice
+    int r = prom_sketch_store_add(self, max_bins, other->offset + (int)other->length - 1, 0);
+    if (r)
+        return r;
+    r = prom_sketch_store_add(self, max_bins, other->offset, 0);
+    if (r)
+        return r;
+    for (size_t i = 0; i < other->length; i++)
+    {
+        if (other->counts[i] == 0)
+            continue;
+        r = prom_sketch_store_add(self, max_bins, other->offset + (int)i, other->counts[i]);
+        if (r)
+            return r;
+    }
+    return 0;
+}
+
+int prom_sketch_merge(prom_sketch_t* self, const prom_sketch_t* other)
+{
+    PROM_ASSERT(self != NULL);
+    PROM_ASSERT(other != NULL);
+    if (self == NULL || other == NULL || self->gamma != other->gamma)
+        return 1;
+
+    int r = prom_sketch_store_merge(&self->positive, self->max_bins, &other->positive);
+    if (r)
+        return r;
+    r = prom_sketch_store_merge(&self->negative, self->max_bins, &other->negative);
+    if (r)
+        return r;
+    if (other->count > 0 && (self->count == 0 || other->min < self->min))
+        self->min = other->min;
+    if (other->count > 0 && (self->count == 0 || other->max > self->max))
+        self->max = other->max;
+    self->zero_count += other->zero_count;
+    self->count += other->count;
+    return 0;
+}
+
+int prom_sketch_clear(prom_sketch_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+    self->positive.length = 0;
+    self->negative.length = 0;
+    self->zero_count = 0;
+    self->count = 0;
+    return 0;
+}
+
+uint64_t prom_sketch_count(const prom_sketch_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    return self->count;
+}
+
+/**
+ * @brief API PRIVATE Returns the value reported for the bin holding the q-quantile of a non empty sketch
+ */
+static double prom_sketch_bin_quantile(const prom_sketch_t* self, double q)
+{
+    // Values in ascending order: negative magnitudes from the highest bin down, zeros, then positive bins upwards
+    double rank = q * (double)(self->count - 1);
+    uint64_t seen = 0;
+    for (size_t i = self->negative.length; i > 0; i--)
+    {
+        seen += self->negative.counts[i - 1];
+        if (seen > rank)
+            return -prom_sketch_value(self, self->negative.offset + (int)(i - 1));
+    }
+    seen += self->zero_count;
+    if (seen > rank)
+        return 0.0;
+    for (size_t i = 0; i < self->positive.length; i++)
+    {
+        seen += self->positive.counts[i];
+        if (seen > rank)
+            return prom_sketch_value(self, self->positive.offset + (int)i);
+    }
+    // Not reached: every value has been seen by now, and rank is below the count
+    return NAN;
+}
+
+double prom_sketch_quantile(const prom_sketch_t* self, double q)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL || self->count == 0 || !(q >= 0.0 && q <= 1.0))
+        return NAN;
+    double value = prom_sketch_bin_quantile(self, q);
+
+    // The value of a bin may lie beyond the values it holds; the extremes are known exactly
+    if (q == 0.0 || value < self->min)
+        return self->min;
+    if (q == 1.0 || value > self->max)
+        return self->max;
+    return value;
+}
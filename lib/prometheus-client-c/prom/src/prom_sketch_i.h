@@ -0,0 +1,67 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROM_SKETCH_I_H
+#define PROM_SKETCH_I_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct prom_sketch;
+/**
+ * @brief API PRIVATE A relative error quantile sketch
+ */
+typedef struct prom_sketch prom_sketch_t;
+
+/**
+ * @brief API PRIVATE Returns an empty prom_sketch_t*, or NULL if relative_accuracy is not in (0, 1) or max_bins is 0
+ * @param relative_accuracy Bound of the relative error of the reported quantiles, e.g. 0.01 for 1%
+ * @param max_bins Bins kept per sign. Values spanning more bins lose accuracy for the magnitudes closest to zero.
+ */
+prom_sketch_t* prom_sketch_new(double relative_accuracy, size_t max_bins);
+
+/**
+ * @brief API PRIVATE Destroys a prom_sketch_t*
+ */
+int prom_sketch_destroy(prom_sketch_t* self);
+
+/**
+ * @brief API PRIVATE Adds value to the sketch. NaN is rejected with a non-zero return value.
+ */
+int prom_sketch_insert(prom_sketch_t* self, double value);
+
+/**
+ * @brief API PRIVATE Adds every value of other to self. Both sketches must have the same relative accuracy.
+ */
+int prom_sketch_merge(prom_sketch_t* self, const prom_sketch_t* other);
+
+/**
+ * @brief API PRIVATE Removes every value from the sketch, keeping its allocated bins
+ */
+int prom_sketch_clear(prom_sketch_t* self);
+
+/**
+ * @brief API PRIVATE Returns the number of values in the sketch
+ */
+uint64_t prom_sketch_count(const prom_sketch_t* self);
+
+/**
+ * @brief API PRIVATE Returns the q-quantile, 0 <= q <= 1, of the values in the sketch within its relative accuracy,
+ * or NaN if the sketch is empty. The 0 and 1 quantiles are the exact minimum and maximum.
+ */
+double prom_sketch_quantile(const prom_sketch_t* self, double q);
+
+#endif // PROM_SKETCH_I_H
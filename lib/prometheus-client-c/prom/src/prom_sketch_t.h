@@ -0,0 +1,56 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PROM_SKETCH_T_H
+#define PROM_SKETCH_T_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief API PRIVATE The bins of one sign of a prom_sketch_t. Only the span between the lowest and the highest bin
+ * observed is allocated, so memory follows the dynamic range of the values rather than their count.
+ */
+typedef struct prom_sketch_store
+{
+    uint64_t* counts; /**< counts   Observations per bin, for the bin indexes offset to offset + length - 1 */
+    int offset;       /**< offset   Index of the first bin */
+    size_t length;    /**< length   Bins in use */
+    size_t capacity;  /**< capacity Bins allocated; never more than the max_bins of the sketch */
+} prom_sketch_store_t;
+
+/**
+ * @brief API PRIVATE A DDSketch: a quantile sketch with a relative error guarantee.
+ *
+ * A value v > 0 is counted in bin ceil(log(v) / log(gamma)), with gamma = (1 + a) / (1 - a) for the relative accuracy
+ * a; every value of a bin is within a of the value reported for it. Inserting is O(1) and two sketches of the same
+ * accuracy merge by adding their bins.
+ */
+struct prom_sketch
+{
+    double relative_accuracy; /**< relative_accuracy Bound of the relative error of the reported quantiles */
+    double gamma;             /**< gamma             Ratio between the upper bounds of consecutive bins */
+    double log_gamma;         /**< log_gamma         Natural logarithm of gamma */
+    size_t max_bins;          /**< max_bins          Bins per sign; beyond it the lowest magnitudes are collapsed */
+    prom_sketch_store_t positive;
+    prom_sketch_store_t negative; /**< negative Bins of the magnitudes of the negative values */
+    uint64_t zero_count;          /**< zero_count        Values too close to zero to be given a bin */
+    uint64_t count;               /**< count             Values in the sketch */
+    double min;                   /**< min               Lowest value inserted, exact */
+    double max;                   /**< max               Highest value inserted, exact */
+};
+
+#endif // PROM_SKETCH_T_H
@@ -118,6 +118,26 @@ int prom_string_builder_add_str(prom_string_builder_t* self, const char* str)
     return 0;
 }
 
+int prom_string_builder_add_bytes(prom_string_builder_t* self, const char* data, size_t len)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
+
+    if (self == NULL)
+        return 1;
+    if (len == 0)
+        return 0;
+
+    r = prom_string_builder_ensure_space(self, len);
+    if (r)
+        return r;
+
+    memcpy(self->str + self->len, data, len);
+    self->len += len;
+    self->str[self->len] = '\0';
+    return 0;
+}
+
 int prom_string_builder_add_char(prom_string_builder_t* self, char c)
 {
     PROM_ASSERT(self != NULL);
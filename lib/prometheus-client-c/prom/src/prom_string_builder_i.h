@@ -39,6 +39,12 @@ int prom_string_builder_destroy(prom_string_builder_t* self);
  */
 int prom_string_builder_add_str(prom_string_builder_t* self, const char* str);
 
+/**
+ * API PRIVATE
+ * @brief Adds len bytes of data, which may contain '\0' (e.g. protobuf payloads)
+ */
+int prom_string_builder_add_bytes(prom_string_builder_t* self, const char* data, size_t len);
+
 /**
  * API PRIVATE
  * @brief Adds a char
@@ -55,7 +61,7 @@ int prom_string_builder_clear(prom_string_builder_t* self);
  * API PRIVATE
  * @brief Remove data from the end
  */
-int prom_string_buillder_truncate(prom_string_builder_t* self, size_t len);
+int prom_string_builder_truncate(prom_string_builder_t* self, size_t len);
 
 /**
  * API PRIVATE
@@ -0,0 +1,96 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Public
+#include "prom_summary.h"
+
+#include "prom_alloc.h"
+
+// Private
+#include "prom_assert.h"
+#include "prom_errors.h"
+#include "prom_log.h"
+#include "prom_metric_i.h"
+#include "prom_metric_sample_summary_i.h"
+#include "prom_metric_t.h"
+
+static const double prom_summary_default_quantiles[] = {0.5, 0.9, 0.99};
+
+const prom_summary_options_t prom_summary_default_options = {
+    prom_summary_default_quantiles, sizeof(prom_summary_default_quantiles) / sizeof(prom_summary_default_quantiles[0]),
+    0.01, 600.0, 5};
+
+prom_summary_t* prom_summary_new(const char* name, const char* help, const prom_summary_options_t* options,
+                                 size_t label_key_count, const char** label_keys)
+{
+    if (options == NULL)
+        options = &prom_summary_default_options;
+
+    // Ensure the options are usable before anything is allocated
+    if (!(options->relative_accuracy > 0.0 && options->relative_accuracy < 1.0) || !(options->max_age >= 0.0) ||
+        (options->max_age > 0.0 && options->age_buckets == 0) ||
+        (options->quantile_count > 0 && options->quantiles == NULL))
+        return NULL;
+    for (size_t i = 0; i < options->quantile_count; i++)
+    {
+        if (!(options->quantiles[i] >= 0.0 && options->quantiles[i] <= 1.0))
+            return NULL;
+    }
+
+    prom_summary_t* self = (prom_summary_t*)prom_metric_new(PROM_SUMMARY, name, help, label_key_count, label_keys);
+    if (self == NULL)
+        return NULL;
+
+    // The metric keeps its own copy; every sample points at it
+    prom_summary_options_t* copy = (prom_summary_options_t*)prom_malloc(sizeof(prom_summary_options_t));
+    double* quantiles = (double*)prom_malloc((options->quantile_count + 1) * sizeof(double));
+    for (size_t i = 0; i < options->quantile_count; i++)
+        quantiles[i] = options->quantiles[i];
+    *copy = *options;
+    copy->quantiles = quantiles;
+    // Without a sliding window a single sketch holds every observation
+    if (copy->max_age == 0.0)
+        copy->age_buckets = 1;
+    self->summary = copy;
+    return self;
+}
+
+int prom_summary_destroy(prom_summary_t* self)
+{
+    PROM_ASSERT(self != NULL);
+    int r = 0;
+    if (self == NULL)
+        return r;
+    r = prom_metric_destroy(self);
+    self = NULL;
+    return r;
+}
+
+int prom_summary_observe(prom_summary_t* self, double value, const char** label_values)
+{
+    PROM_ASSERT(self != NULL);
+    if (self == NULL)
+        return 1;
+    if (self->type != PROM_SUMMARY)
+    {
+        PROM_LOG(PROM_METRIC_INCORRECT_TYPE);
+        return 1;
+    }
+    prom_metric_sample_summary_t* s_sample = prom_metric_sample_summary_from_labels(self, label_values);
+    if (s_sample == NULL)
+        return 1;
+    return prom_metric_sample_summary_observe(s_sample, value);
+}
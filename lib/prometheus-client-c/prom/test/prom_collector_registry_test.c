@@ -14,6 +14,11 @@
  * limitations under the License.
  */
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
 #include "prom_test_helpers.h"
 
 static void prom_registry_test_init(void);
@@ -23,6 +28,9 @@ prom_counter_t* test_counter;
 prom_gauge_t* test_gauge;
 prom_histogram_t* test_histogram;
 
+#define PROM_REGISTRY_TEST_WRITERS 4
+#define PROM_REGISTRY_TEST_WRITES 2000
+
 void test_large_registry(void)
 {
     prom_collector_registry_default_init();
@@ -106,6 +114,204 @@ void test_prom_collector_registry_bridge(void)
     prom_registry_test_destroy();
 }
 
+void test_prom_collector_registry_bridge_since(void)
+{
+    prom_registry_test_init();
+
+    const char* labels[] = {"foo"};
+    prom_counter_inc(test_counter, labels);
+    prom_gauge_set(test_gauge, 2.0, labels);
+
+    uint64_t version = 0;
+    const char* result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, 0, NULL, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_counter{label=\"foo\"} 1"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_gauge{label=\"foo\"} 2"));
+    TEST_ASSERT_TRUE(version > 0);
+    free((char*)result);
+
+    // Setting the value the gauge already holds is not a change
+    uint64_t previous = version;
+    prom_gauge_set(test_gauge, 2.0, labels);
+    result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, previous, NULL, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NULL(strstr(result, "test_gauge"));
+    TEST_ASSERT_NULL(strstr(result, "test_counter"));
+    free((char*)result);
+
+    previous = version;
+    prom_gauge_set(test_gauge, 3.0, labels);
+    result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, previous, NULL, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NOT_NULL(strstr(result, "# TYPE test_gauge gauge\ntest_gauge{label=\"foo\"} 3"));
+    TEST_ASSERT_NULL(strstr(result, "test_counter"));
+    TEST_ASSERT_NULL(strstr(result, "test_histogram"));
+    TEST_ASSERT_TRUE(version > previous);
+    free((char*)result);
+
+    // A histogram observation is reported by the next delta only, although the buckets are only written when rendering
+    previous = version;
+    prom_histogram_observe(test_histogram, 7.0, NULL);
+    result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, previous, NULL, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram{le=\"10.0\"} 1"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram_count 1"));
+    free((char*)result);
+
+    previous = version;
+    result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, previous, NULL, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NULL(strstr(result, "test_histogram"));
+    free((char*)result);
+
+    prom_registry_test_destroy();
+}
+
+/** State shared by the writers and the renderer of the concurrent since test */
+static struct
+{
+    prom_metric_sample_t* samples[PROM_REGISTRY_TEST_WRITERS];
+    const char* labels[PROM_REGISTRY_TEST_WRITERS];
+    atomic_int seen[PROM_REGISTRY_TEST_WRITERS]; /**< Last value of each sample found in a delta */
+    atomic_int running;                          /**< Writers still running */
+    atomic_int lost;                             /**< Writes that no delta reported in time */
+} prom_registry_test_since;
+
+static double prom_registry_test_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Sets its sample to 1, 2, ... and waits for a delta to report each value before the next one, so every write
+ * is the last one of its sample for a while
+ */
+static void* prom_registry_test_writer(void* arg)
+{
+    int i = (int)(intptr_t)arg;
+    for (int value = 1; value <= PROM_REGISTRY_TEST_WRITES; value++)
+    {
+        prom_metric_sample_set(prom_registry_test_since.samples[i], (double)value);
+        double deadline = prom_registry_test_now() + 1.0;
+        while (atomic_load(&prom_registry_test_since.seen[i]) != value)
+        {
+            if (prom_registry_test_now() > deadline)
+            {
+                atomic_fetch_add(&prom_registry_test_since.lost, 1);
+                break;
+            }
+            sched_yield();
+        }
+    }
+    atomic_fetch_sub(&prom_registry_test_since.running, 1);
+    return NULL;
+}
+
+void test_prom_collector_registry_bridge_since_concurrent(void)
+{
+    prom_registry_test_init();
+
+    const char* labels[PROM_REGISTRY_TEST_WRITERS] = {"w0", "w1", "w2", "w3"};
+    atomic_store(&prom_registry_test_since.running, PROM_REGISTRY_TEST_WRITERS);
+    atomic_store(&prom_registry_test_since.lost, 0);
+    for (int i = 0; i < PROM_REGISTRY_TEST_WRITERS; i++)
+    {
+        const char* label[] = {labels[i]};
+        prom_registry_test_since.labels[i] = labels[i];
+        prom_registry_test_since.samples[i] = prom_metric_sample_from_labels(test_gauge, label);
+        atomic_store(&prom_registry_test_since.seen[i], 0);
+    }
+    pthread_t threads[PROM_REGISTRY_TEST_WRITERS];
+    for (int i = 0; i < PROM_REGISTRY_TEST_WRITERS; i++)
+        pthread_create(&threads[i], NULL, prom_registry_test_writer, (void*)(intptr_t)i);
+
+    // A delta taken while a write is in progress must not skip that write for good
+    uint64_t version = 0;
+    char line[64];
+    while (atomic_load(&prom_registry_test_since.running) > 0)
+    {
+        const char* result =
+            prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, version, NULL, &version, NULL);
+        TEST_ASSERT_NOT_NULL(result);
+        for (int i = 0; i < PROM_REGISTRY_TEST_WRITERS; i++)
+        {
+            snprintf(line, sizeof(line), "test_gauge{label=\"%s\"} ", labels[i]);
+            const char* found = strstr(result, line);
+            if (found != NULL)
+                atomic_store(&prom_registry_test_since.seen[i], (int)strtod(found + strlen(line), NULL));
+        }
+        free((char*)result);
+    }
+    for (int i = 0; i < PROM_REGISTRY_TEST_WRITERS; i++)
+        pthread_join(threads[i], NULL);
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&prom_registry_test_since.lost));
+
+    prom_registry_test_destroy();
+}
+
+void test_prom_collector_registry_bridge_select(void)
+{
+    prom_registry_test_init();
+
+    prom_collector_t* extra = prom_collector_new("extra");
+    prom_gauge_t* extra_gauge = prom_gauge_new("extra_gauge", "gauge in a named collector", 0, NULL);
+    TEST_ASSERT_EQUAL_INT(0, prom_collector_add_metric(extra, extra_gauge));
+    TEST_ASSERT_EQUAL_INT(0, prom_collector_registry_register_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, extra));
+    TEST_ASSERT_TRUE(prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, "extra") == extra);
+    TEST_ASSERT_NULL(prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, "missing"));
+
+    const char* labels[] = {"foo"};
+    prom_gauge_set(test_gauge, 2.0, labels);
+    prom_gauge_set(extra_gauge, 4.0, NULL);
+
+    const char* names[] = {"extra"};
+    prom_collector_selection_t by_name = {.names = names, .names_count = 1, .prefix = NULL};
+    size_t len = 0;
+    const char* result =
+        prom_collector_registry_bridge_select(PROM_COLLECTOR_REGISTRY_DEFAULT, PROM_EXPOSITION_TEXT, &by_name, &len);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_EQUAL_INT(strlen(result), len);
+    TEST_ASSERT_NOT_NULL(strstr(result, "extra_gauge 4"));
+    TEST_ASSERT_NULL(strstr(result, "test_gauge"));
+    TEST_ASSERT_NULL(strstr(result, "process_max_fds"));
+    free((char*)result);
+
+    // Both conditions must hold: the prefix matches "default" and "process", the name list only "default"
+    const char* default_name[] = {"default"};
+    prom_collector_selection_t by_both = {.names = default_name, .names_count = 1, .prefix = "proc"};
+    result = prom_collector_registry_bridge_select(PROM_COLLECTOR_REGISTRY_DEFAULT, PROM_EXPOSITION_TEXT, &by_both,
+                                                   NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_EQUAL_STRING("", result);
+    free((char*)result);
+
+    prom_collector_selection_t by_prefix = {.names = NULL, .names_count = 0, .prefix = "proc"};
+    result = prom_collector_registry_bridge_select(PROM_COLLECTOR_REGISTRY_DEFAULT, PROM_EXPOSITION_OPENMETRICS,
+                                                   &by_prefix, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NOT_NULL(strstr(result, "process_max_fds"));
+    TEST_ASSERT_NULL(strstr(result, "extra_gauge"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "# EOF\n"));
+    free((char*)result);
+
+    // The delta honours the selection, and the selection does not outlive the call
+    uint64_t version = 0;
+    result = prom_collector_registry_bridge_since(PROM_COLLECTOR_REGISTRY_DEFAULT, 0, &by_name, &version, NULL);
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_NOT_NULL(strstr(result, "extra_gauge 4"));
+    TEST_ASSERT_NULL(strstr(result, "test_gauge"));
+    free((char*)result);
+
+    result = prom_collector_registry_bridge(PROM_COLLECTOR_REGISTRY_DEFAULT);
+    TEST_ASSERT_NOT_NULL(strstr(result, "extra_gauge 4"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_gauge"));
+    free((char*)result);
+
+    prom_registry_test_destroy();
+}
+
 void test_prom_collector_registry_validate_metric_name(void)
 {
     prom_registry_test_init();
@@ -141,6 +347,9 @@ int main(int argc, const char** argv)
     UNITY_BEGIN();
     // RUN_TEST(test_prom_collector_registry_must_register);
     RUN_TEST(test_prom_collector_registry_bridge);
+    RUN_TEST(test_prom_collector_registry_bridge_since);
+    RUN_TEST(test_prom_collector_registry_bridge_since_concurrent);
+    RUN_TEST(test_prom_collector_registry_bridge_select);
     // RUN_TEST(test_prom_collector_registry_validate_metric_name);
     // RUN_TEST(test_large_registry);
     return UNITY_END();
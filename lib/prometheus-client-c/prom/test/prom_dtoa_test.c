@@ -0,0 +1,98 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <math.h>
+
+#include "prom_test_helpers.h"
+
+static void assert_dtoa(const char* expected, double value)
+{
+    char buffer[PROM_DTOA_BUFFER_SIZE];
+    size_t len = prom_dtoa(value, buffer);
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    TEST_ASSERT_EQUAL_INT(strlen(expected), len);
+}
+
+void test_prom_dtoa_integers(void)
+{
+    assert_dtoa("0", 0.0);
+    assert_dtoa("-0", -0.0);
+    assert_dtoa("1", 1.0);
+    assert_dtoa("-1", -1.0);
+    assert_dtoa("1024", 1024.0);
+    assert_dtoa("16777216000", 16777216000.0);
+    assert_dtoa("1048576", 1048576.0);
+    assert_dtoa("99999999999999984", 99999999999999984.0);
+}
+
+void test_prom_dtoa_fractions(void)
+{
+    assert_dtoa("0.1", 0.1);
+    assert_dtoa("0.3", 0.3);
+    assert_dtoa("22.2", 22.2);
+    assert_dtoa("-3.25", -3.25);
+    assert_dtoa("33.333333333333336", 100.0 / 3.0);
+    assert_dtoa("0.0001", 0.0001);
+}
+
+void test_prom_dtoa_exponents(void)
+{
+    assert_dtoa("1e+17", 1e17);
+    assert_dtoa("1e+21", 1e21);
+    assert_dtoa("1.2345678901234568e+17", 123456789012345678.0);
+    assert_dtoa("1e-05", 0.00001);
+    assert_dtoa("1.5e-07", 1.5e-7);
+    assert_dtoa("5e-324", 5e-324);
+    assert_dtoa("2.2250738585072014e-308", 2.2250738585072014e-308);
+    assert_dtoa("1.7976931348623157e+308", 1.7976931348623157e308);
+}
+
+void test_prom_dtoa_special_values(void)
+{
+    assert_dtoa("NaN", NAN);
+    assert_dtoa("+Inf", INFINITY);
+    assert_dtoa("-Inf", -INFINITY);
+}
+
+void test_prom_dtoa_round_trip(void)
+{
+    char buffer[PROM_DTOA_BUFFER_SIZE];
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < 100000; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value;
+        memcpy(&value, &state, sizeof(value));
+        if (isnan(value) || isinf(value))
+            continue;
+        prom_dtoa(value, buffer);
+        TEST_ASSERT(strtod(buffer, NULL) == value);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_prom_dtoa_integers);
+    RUN_TEST(test_prom_dtoa_fractions);
+    RUN_TEST(test_prom_dtoa_exponents);
+    RUN_TEST(test_prom_dtoa_special_values);
+    RUN_TEST(test_prom_dtoa_round_trip);
+    return UNITY_END();
+}
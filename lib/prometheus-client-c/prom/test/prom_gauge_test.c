@@ -105,6 +105,24 @@ void test_gauge_set(void)
     g = NULL;
 }
 
+void test_gauge_set_with_timestamp(void)
+{
+    prom_gauge_t* g = prom_gauge_new("test_gauge", "gauge under test", 2, (const char*[]){"foo", "bar"});
+    TEST_ASSERT(g);
+
+    prom_gauge_set_with_timestamp(g, 2.5, 1700000000123LL, sample_labels_a);
+
+    prom_metric_sample_t* sample = prom_metric_sample_from_labels(g, sample_labels_a);
+    TEST_ASSERT_EQUAL_DOUBLE(2.5, sample->r_value);
+    TEST_ASSERT(sample->timestamp_ms == 1700000000123LL);
+
+    sample = prom_metric_sample_from_labels(g, sample_labels_b);
+    TEST_ASSERT(sample->timestamp_ms == 0);
+
+    prom_gauge_destroy(g);
+    g = NULL;
+}
+
 int main(int argc, const char** argv)
 {
     UNITY_BEGIN();
@@ -113,5 +131,6 @@ int main(int argc, const char** argv)
     RUN_TEST(test_gauge_add);
     RUN_TEST(test_gauge_sub);
     RUN_TEST(test_gauge_set);
+    RUN_TEST(test_gauge_set_with_timestamp);
     return UNITY_END();
 }
@@ -14,8 +14,13 @@
  * limitations under the License.
  */
 
+#include <pthread.h>
+
 #include "prom_test_helpers.h"
 
+#define PROM_HISTOGRAM_TEST_THREADS 4
+#define PROM_HISTOGRAM_TEST_OBSERVATIONS 10000
+
 void test_prom_histogram(void)
 {
     prom_histogram_t* h = prom_histogram_new("test_histogram", "histogram under test",
@@ -28,6 +33,9 @@ void test_prom_histogram(void)
 
     prom_metric_sample_histogram_t* h_sample = prom_metric_sample_histogram_from_labels(h, NULL);
 
+    // Observations only touch per-bucket counters; the cumulative samples are written when rendering
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_histogram_sync(h_sample));
+
     // Test counter for each bucket
     char* bucket_key = prom_metric_sample_histogram_bucket_to_str(5.0);
     const char* l_value = prom_map_get(h_sample->l_values, bucket_key);
@@ -74,9 +82,77 @@ void test_prom_histogram(void)
     h = NULL;
 }
 
+void test_prom_histogram_bucket_bounds(void)
+{
+    prom_histogram_t* h = prom_histogram_new("test_histogram", "histogram under test",
+                                             prom_histogram_buckets_new(3, 1.0, 2.0, 4.0), 0, NULL);
+
+    // Upper bounds are inclusive, values above every bound and NaN only count in +Inf
+    prom_histogram_observe(h, 1.0, NULL);
+    prom_histogram_observe(h, 2.0, NULL);
+    prom_histogram_observe(h, 2.5, NULL);
+    prom_histogram_observe(h, 4.0, NULL);
+    prom_histogram_observe(h, 9.0, NULL);
+    prom_histogram_observe(h, 0.0 / 0.0, NULL);
+
+    prom_metric_formatter_t* formatter = prom_metric_formatter_new();
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_formatter_load_metric(formatter, h));
+    const char* result = prom_metric_formatter_dump(formatter);
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram{le=\"1.0\"} 1\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram{le=\"2.0\"} 2\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram{le=\"4.0\"} 4\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram{le=\"+Inf\"} 6\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_histogram_count 6\n"));
+    free((char*)result);
+
+    prom_metric_formatter_destroy(formatter);
+    prom_histogram_destroy(h);
+}
+
+static void* prom_histogram_test_observer(void* arg)
+{
+    prom_metric_sample_histogram_t* h_sample = (prom_metric_sample_histogram_t*)arg;
+    for (int i = 0; i < PROM_HISTOGRAM_TEST_OBSERVATIONS; i++)
+        prom_metric_sample_histogram_observe(h_sample, (double)(i % 3));
+    return NULL;
+}
+
+void test_prom_histogram_concurrent_observe(void)
+{
+    prom_histogram_t* h = prom_histogram_new("test_histogram", "histogram under test",
+                                             prom_histogram_buckets_linear(0.0, 1.0, 3), 0, NULL);
+    prom_metric_sample_histogram_t* h_sample = prom_metric_sample_histogram_from_labels(h, NULL);
+
+    pthread_t threads[PROM_HISTOGRAM_TEST_THREADS];
+    for (int i = 0; i < PROM_HISTOGRAM_TEST_THREADS; i++)
+        pthread_create(&threads[i], NULL, prom_histogram_test_observer, h_sample);
+    // Renders running alongside the observers must not lose observations
+    for (int i = 0; i < 100; i++)
+        prom_metric_sample_histogram_sync(h_sample);
+    for (int i = 0; i < PROM_HISTOGRAM_TEST_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_histogram_sync(h_sample));
+
+    double total = PROM_HISTOGRAM_TEST_THREADS * PROM_HISTOGRAM_TEST_OBSERVATIONS;
+    const char* count_l_value = prom_map_get(h_sample->l_values, "count");
+    prom_metric_sample_t* count = (prom_metric_sample_t*)prom_map_get(h_sample->samples, count_l_value);
+    TEST_ASSERT_EQUAL_DOUBLE(total, count->r_value);
+
+    const char* sum_l_value = prom_map_get(h_sample->l_values, "sum");
+    prom_metric_sample_t* sum = (prom_metric_sample_t*)prom_map_get(h_sample->samples, sum_l_value);
+    double per_thread = 0;
+    for (int i = 0; i < PROM_HISTOGRAM_TEST_OBSERVATIONS; i++)
+        per_thread += i % 3;
+    TEST_ASSERT_EQUAL_DOUBLE(per_thread * PROM_HISTOGRAM_TEST_THREADS, sum->r_value);
+
+    prom_histogram_destroy(h);
+}
+
 int main(int argc, const char** argv)
 {
     UNITY_BEGIN();
     RUN_TEST(test_prom_histogram);
+    RUN_TEST(test_prom_histogram_bucket_bounds);
+    RUN_TEST(test_prom_histogram_concurrent_observe);
     return UNITY_END();
 }
@@ -134,6 +134,150 @@ void test_prom_metric_formatter_load_metrics(void)
     PROM_COLLECTOR_REGISTRY_DEFAULT = NULL;
 }
 
+void test_prom_metric_formatter_load_metric_protobuf(void)
+{
+    prom_metric_formatter_t* mf = prom_metric_formatter_new();
+    const char* gauge_keys[] = {"foo"};
+    const char* sample_a[] = {"a\",b"};
+    prom_metric_t* m = prom_metric_new(PROM_GAUGE, "g", "h", 1, gauge_keys);
+    prom_metric_sample_t* s_a = prom_metric_sample_from_labels(m, sample_a);
+    prom_metric_sample_set(s_a, 1.0);
+    prom_metric_formatter_load_metric_protobuf(mf, m);
+
+    // MetricFamily{name: "g", help: "h", type: GAUGE, metric: [{label: [{foo, a",b}], gauge: {value: 1}}]}
+    const char expected[] = "\x22"
+                            "\x0a\x01g"
+                            "\x12\x01h"
+                            "\x18\x01"
+                            "\x22\x18"
+                            "\x0a\x0b\x0a\x03"
+                            "foo\x12\x04"
+                            "a\",b"
+                            "\x12\x09\x09\x00\x00\x00\x00\x00\x00\xf0\x3f";
+    TEST_ASSERT_EQUAL_INT(sizeof(expected) - 1, prom_metric_formatter_len(mf));
+    char* actual = prom_metric_formatter_dump(mf);
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected) - 1);
+
+    free(actual);
+    actual = NULL;
+    prom_metric_destroy(m);
+    m = NULL;
+    prom_metric_formatter_destroy(mf);
+    mf = NULL;
+}
+
+void test_prom_metric_formatter_load_histogram_protobuf(void)
+{
+    prom_metric_formatter_t* mf = prom_metric_formatter_new();
+    prom_histogram_buckets_t* buckets = prom_histogram_buckets_new(2, 1.0, 2.0);
+    prom_histogram_t* h = prom_histogram_new("h", "h", buckets, 0, NULL);
+    prom_histogram_observe(h, 0.5, NULL);
+    prom_histogram_observe(h, 1.5, NULL);
+    prom_histogram_observe(h, 3.0, NULL);
+    prom_metric_formatter_load_metric_protobuf(mf, h);
+
+    // MetricFamily{name: "h", help: "h", type: HISTOGRAM,
+    //              metric: [{histogram: {bucket: [{1, 1.0}, {2, 2.0}], sample_count: 3, sample_sum: 5.0}}]}
+    const char expected[] = "\x31"
+                            "\x0a\x01h"
+                            "\x12\x01h"
+                            "\x18\x04"
+                            "\x22\x27"
+                            "\x3a\x25"
+                            "\x1a\x0b\x08\x01\x11\x00\x00\x00\x00\x00\x00\xf0\x3f"
+                            "\x1a\x0b\x08\x02\x11\x00\x00\x00\x00\x00\x00\x00\x40"
+                            "\x08\x03"
+                            "\x11\x00\x00\x00\x00\x00\x00\x14\x40";
+    TEST_ASSERT_EQUAL_INT(sizeof(expected) - 1, prom_metric_formatter_len(mf));
+    char* actual = prom_metric_formatter_dump(mf);
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected) - 1);
+
+    free(actual);
+    actual = NULL;
+    prom_histogram_destroy(h);
+    h = NULL;
+    prom_metric_formatter_destroy(mf);
+    mf = NULL;
+}
+
+void test_prom_metric_formatter_load_summary_protobuf(void)
+{
+    prom_metric_formatter_t* mf = prom_metric_formatter_new();
+    static const double quantiles[] = {0.5};
+    prom_summary_options_t options = {quantiles, 1, 0.01, 0.0, 1};
+    prom_summary_t* s = prom_summary_new("s", "s", &options, 0, NULL);
+    prom_summary_observe(s, 1.0, NULL);
+    prom_metric_formatter_load_metric_protobuf(mf, s);
+
+    // MetricFamily{name: "s", help: "s", type: SUMMARY,
+    //              metric: [{summary: {quantile: [{0.5, 1.0}], sample_count: 1, sample_sum: 1.0}}]}
+    const char expected[] = "\x2b"
+                            "\x0a\x01s"
+                            "\x12\x01s"
+                            "\x18\x02"
+                            "\x22\x21"
+                            "\x22\x1f"
+                            "\x1a\x12\x09\x00\x00\x00\x00\x00\x00\xe0\x3f\x11\x00\x00\x00\x00\x00\x00\xf0\x3f"
+                            "\x08\x01"
+                            "\x11\x00\x00\x00\x00\x00\x00\xf0\x3f";
+    TEST_ASSERT_EQUAL_INT(sizeof(expected) - 1, prom_metric_formatter_len(mf));
+    char* actual = prom_metric_formatter_dump(mf);
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected) - 1);
+
+    free(actual);
+    actual = NULL;
+    prom_summary_destroy(s);
+    s = NULL;
+    prom_metric_formatter_destroy(mf);
+    mf = NULL;
+}
+
+void test_prom_metric_formatter_load_metrics_openmetrics(void)
+{
+    prom_collector_registry_t* registry = prom_collector_registry_new("openmetrics");
+    prom_collector_t* collector = prom_collector_new("test");
+    prom_counter_t* c = prom_counter_new("requests", "requests served", 1, (const char*[]){"code"});
+    prom_counter_t* c_total = prom_counter_new("bytes_total", "bytes served", 0, NULL);
+    prom_gauge_t* g = prom_gauge_new("temperature", "temperature read", 0, NULL);
+    prom_histogram_t* h = prom_histogram_new("latency", "request latency", prom_histogram_buckets_new(1, 1.0), 0, NULL);
+    prom_collector_add_metric(collector, c);
+    prom_collector_add_metric(collector, c_total);
+    prom_collector_add_metric(collector, g);
+    prom_collector_add_metric(collector, h);
+    prom_collector_registry_register_collector(registry, collector);
+
+    prom_counter_add_with_timestamp(c, 3, 1700000000005LL, (const char*[]){"200"});
+    prom_counter_inc(c_total, NULL);
+    prom_gauge_set_with_timestamp(g, 21.5, 1700000000123LL, NULL);
+    prom_histogram_observe(h, 0.5, NULL);
+
+    size_t len = 0;
+    const char* result = prom_collector_registry_bridge_format(registry, PROM_EXPOSITION_OPENMETRICS, &len);
+    const char* expected = "# TYPE requests counter\n"
+                           "# HELP requests requests served\n"
+                           "requests_total{code=\"200\"} 3 1700000000.005\n"
+                           "# TYPE bytes counter\n"
+                           "# HELP bytes bytes served\n"
+                           "bytes_total 1\n"
+                           "# TYPE temperature gauge\n"
+                           "# HELP temperature temperature read\n"
+                           "temperature 21.5 1700000000.123\n"
+                           "# TYPE latency histogram\n"
+                           "# HELP latency request latency\n"
+                           "latency_bucket{le=\"1.0\"} 1\n"
+                           "latency_bucket{le=\"+Inf\"} 1\n"
+                           "latency_count 1\n"
+                           "latency_sum 0.5\n"
+                           "# EOF\n";
+    TEST_ASSERT_EQUAL_STRING(expected, result);
+    TEST_ASSERT_EQUAL_INT(strlen(expected), len);
+
+    free((char*)result);
+    result = NULL;
+    prom_collector_registry_destroy(registry);
+    registry = NULL;
+}
+
 int main(int argc, const char** argv)
 {
     UNITY_BEGIN();
@@ -141,5 +285,9 @@ int main(int argc, const char** argv)
     RUN_TEST(test_prom_metric_formatter_load_sample);
     RUN_TEST(test_prom_metric_formatter_load_metric);
     RUN_TEST(test_prom_metric_formatter_load_metrics);
+    RUN_TEST(test_prom_metric_formatter_load_metric_protobuf);
+    RUN_TEST(test_prom_metric_formatter_load_histogram_protobuf);
+    RUN_TEST(test_prom_metric_formatter_load_summary_protobuf);
+    RUN_TEST(test_prom_metric_formatter_load_metrics_openmetrics);
     return UNITY_END();
 }
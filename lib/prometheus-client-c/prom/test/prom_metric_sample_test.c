@@ -66,11 +66,37 @@ void test_prom_metric_set(void)
     s = NULL;
 }
 
+void test_prom_metric_sample_version(void)
+{
+    prom_metric_sample_t* s = prom_metric_sample_new(PROM_GAUGE, l_value, 1.0);
+    TEST_ASSERT(s);
+    uint64_t created = s->version;
+    TEST_ASSERT_TRUE(created > 0);
+    TEST_ASSERT_TRUE(prom_metric_sample_current_version() >= created);
+
+    prom_metric_sample_set(s, 1.0);
+    TEST_ASSERT_TRUE(s->version == created);
+
+    prom_metric_sample_set(s, 2.0);
+    uint64_t changed = s->version;
+    TEST_ASSERT_TRUE(changed > created);
+
+    prom_metric_sample_add(s, 0.0);
+    TEST_ASSERT_TRUE(s->version == changed);
+
+    prom_metric_sample_sub(s, 1.0);
+    TEST_ASSERT_TRUE(s->version > changed);
+
+    prom_metric_sample_destroy(s);
+    s = NULL;
+}
+
 int main(int argc, const char** argv)
 {
     UNITY_BEGIN();
     RUN_TEST(test_prom_metric_sample_add);
     RUN_TEST(test_prom_metric_sample_sub);
     RUN_TEST(test_prom_metric_set);
+    RUN_TEST(test_prom_metric_sample_version);
     return UNITY_END();
 }
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prom_test_helpers.h"
+
+static void assert_bytes(const char* expected, size_t expected_len, prom_string_builder_t* sb)
+{
+    TEST_ASSERT_EQUAL_INT(expected_len, prom_string_builder_len(sb));
+    TEST_ASSERT_EQUAL_MEMORY(expected, prom_string_builder_str(sb), expected_len);
+    prom_string_builder_clear(sb);
+}
+
+void test_prom_protobuf_add_varint(void)
+{
+    prom_string_builder_t* sb = prom_string_builder_new();
+
+    prom_protobuf_add_varint(sb, 0);
+    assert_bytes("\x00", 1, sb);
+
+    prom_protobuf_add_varint(sb, 1);
+    assert_bytes("\x01", 1, sb);
+
+    prom_protobuf_add_varint(sb, 300);
+    assert_bytes("\xac\x02", 2, sb);
+
+    prom_protobuf_add_varint(sb, UINT64_MAX);
+    assert_bytes("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 10, sb);
+
+    TEST_ASSERT_EQUAL_INT(1, prom_protobuf_varint_len(0));
+    TEST_ASSERT_EQUAL_INT(1, prom_protobuf_varint_len(127));
+    TEST_ASSERT_EQUAL_INT(2, prom_protobuf_varint_len(128));
+    TEST_ASSERT_EQUAL_INT(10, prom_protobuf_varint_len(UINT64_MAX));
+
+    prom_string_builder_destroy(sb);
+}
+
+void test_prom_protobuf_add_fields(void)
+{
+    prom_string_builder_t* sb = prom_string_builder_new();
+
+    prom_protobuf_add_uint64_field(sb, 3, 150);
+    assert_bytes("\x18\x96\x01", 3, sb);
+
+    prom_protobuf_add_double_field(sb, 1, 1.0);
+    assert_bytes("\x09\x00\x00\x00\x00\x00\x00\xf0\x3f", 9, sb);
+
+    prom_protobuf_add_string_field(sb, 2, "testing");
+    assert_bytes("\x12\x07testing", 9, sb);
+
+    prom_protobuf_add_string_field(sb, 2, NULL);
+    assert_bytes("\x12\x00", 2, sb);
+
+    prom_string_builder_destroy(sb);
+}
+
+int main(int argc, const char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_prom_protobuf_add_varint);
+    RUN_TEST(test_prom_protobuf_add_fields);
+    return UNITY_END();
+}
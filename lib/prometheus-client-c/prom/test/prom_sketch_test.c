@@ -0,0 +1,178 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+
+#include "prom_test_helpers.h"
+
+#define PROM_SKETCH_TEST_ACCURACY 0.01
+#define PROM_SKETCH_TEST_MAX_BINS 2048
+#define PROM_SKETCH_TEST_VALUES 10000
+
+// The bound is reached at the edges of a bin, so rounding gets a little slack
+static void prom_sketch_test_assert_relative(double expected, double actual)
+{
+    TEST_ASSERT_TRUE(fabs(actual - expected) <= PROM_SKETCH_TEST_ACCURACY * fabs(expected) * (1 + 1e-9));
+}
+
+void test_prom_sketch_quantile(void)
+{
+    prom_sketch_t* sketch = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    TEST_ASSERT_NOT_NULL(sketch);
+    for (int i = PROM_SKETCH_TEST_VALUES; i > 0; i--)
+        TEST_ASSERT_EQUAL_INT(0, prom_sketch_insert(sketch, (double)i));
+    TEST_ASSERT_EQUAL_INT(PROM_SKETCH_TEST_VALUES, prom_sketch_count(sketch));
+
+    // The q-quantile of 1..n is the value of rank floor(q * (n - 1)), within the relative accuracy
+    double quantiles[] = {0.0, 0.25, 0.5, 0.9, 0.99, 0.999, 1.0};
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+    {
+        double exact = floor(quantiles[i] * (PROM_SKETCH_TEST_VALUES - 1)) + 1;
+        prom_sketch_test_assert_relative(exact, prom_sketch_quantile(sketch, quantiles[i]));
+    }
+    TEST_ASSERT_TRUE(isnan(prom_sketch_quantile(sketch, 1.5)));
+
+    prom_sketch_destroy(sketch);
+}
+
+void test_prom_sketch_signs(void)
+{
+    prom_sketch_t* sketch = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    TEST_ASSERT_TRUE(isnan(prom_sketch_quantile(sketch, 0.5)));
+    TEST_ASSERT_EQUAL_INT(1, prom_sketch_insert(sketch, NAN));
+
+    prom_sketch_insert(sketch, -250.0);
+    prom_sketch_insert(sketch, -0.5);
+    prom_sketch_insert(sketch, 0.0);
+    prom_sketch_insert(sketch, 0.001);
+    prom_sketch_insert(sketch, 1e12);
+    TEST_ASSERT_EQUAL_INT(5, prom_sketch_count(sketch));
+
+    prom_sketch_test_assert_relative(-250.0, prom_sketch_quantile(sketch, 0.0));
+    prom_sketch_test_assert_relative(-0.5, prom_sketch_quantile(sketch, 0.25));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, prom_sketch_quantile(sketch, 0.5));
+    prom_sketch_test_assert_relative(0.001, prom_sketch_quantile(sketch, 0.75));
+    prom_sketch_test_assert_relative(1e12, prom_sketch_quantile(sketch, 1.0));
+
+    TEST_ASSERT_EQUAL_INT(0, prom_sketch_clear(sketch));
+    TEST_ASSERT_EQUAL_INT(0, prom_sketch_count(sketch));
+    TEST_ASSERT_TRUE(isnan(prom_sketch_quantile(sketch, 0.5)));
+
+    prom_sketch_destroy(sketch);
+}
+
+void test_prom_sketch_merge(void)
+{
+    prom_sketch_t* whole = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    prom_sketch_t* odd = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    prom_sketch_t* even = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    // Odd values are positive and go to one sketch, even ones negative to the other, so both stores are merged
+    for (int i = 1; i <= PROM_SKETCH_TEST_VALUES; i++)
+    {
+        double value = i % 2 ? (double)i : -(double)i;
+        prom_sketch_insert(whole, value);
+        prom_sketch_insert(i % 2 ? odd : even, value);
+    }
+
+    prom_sketch_t* merged = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    TEST_ASSERT_EQUAL_INT(0, prom_sketch_merge(merged, even));
+    TEST_ASSERT_EQUAL_INT(0, prom_sketch_merge(merged, odd));
+    TEST_ASSERT_EQUAL_INT(PROM_SKETCH_TEST_VALUES, prom_sketch_count(merged));
+
+    // Merging adds bins, so the merged sketch answers exactly like the one that saw every value
+    double quantiles[] = {0.0, 0.1, 0.5, 0.9, 0.99, 1.0};
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+        TEST_ASSERT_EQUAL_DOUBLE(prom_sketch_quantile(whole, quantiles[i]), prom_sketch_quantile(merged, quantiles[i]));
+
+    // Sketches of different accuracies do not share bins
+    prom_sketch_t* coarse = prom_sketch_new(0.05, PROM_SKETCH_TEST_MAX_BINS);
+    TEST_ASSERT_EQUAL_INT(1, prom_sketch_merge(merged, coarse));
+
+    prom_sketch_destroy(coarse);
+    prom_sketch_destroy(merged);
+    prom_sketch_destroy(even);
+    prom_sketch_destroy(odd);
+    prom_sketch_destroy(whole);
+}
+
+void test_prom_sketch_collapse(void)
+{
+    size_t max_bins = 16;
+    prom_sketch_t* sketch = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, max_bins);
+
+    // Spanning far more than 16 bins, both upwards and downwards
+    for (int i = 0; i < 200; i++)
+        prom_sketch_insert(sketch, pow(1.1, i));
+    for (int i = 0; i < 200; i++)
+        prom_sketch_insert(sketch, pow(1.1, -i));
+
+    TEST_ASSERT_EQUAL_INT(400, prom_sketch_count(sketch));
+    TEST_ASSERT_TRUE(sketch->positive.length <= max_bins);
+    TEST_ASSERT_TRUE(sketch->positive.capacity <= max_bins);
+
+    // The highest magnitudes keep their accuracy, the collapsed low ones are reported high
+    prom_sketch_test_assert_relative(pow(1.1, 199), prom_sketch_quantile(sketch, 1.0));
+    TEST_ASSERT_TRUE(prom_sketch_quantile(sketch, 0.01) > pow(1.1, -195));
+
+    prom_sketch_destroy(sketch);
+}
+
+void test_prom_sketch_extremes(void)
+{
+    prom_sketch_t* sketch = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+    prom_sketch_t* other = prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, PROM_SKETCH_TEST_MAX_BINS);
+
+    // The minimum and the maximum are exact, and no quantile is reported beyond them
+    prom_sketch_insert(sketch, 100.0);
+    prom_sketch_insert(sketch, 100.0);
+    TEST_ASSERT_EQUAL_DOUBLE(100.0, prom_sketch_quantile(sketch, 0.0));
+    TEST_ASSERT_EQUAL_DOUBLE(100.0, prom_sketch_quantile(sketch, 0.5));
+    TEST_ASSERT_EQUAL_DOUBLE(100.0, prom_sketch_quantile(sketch, 1.0));
+
+    prom_sketch_insert(other, -3.0);
+    prom_sketch_insert(other, 250.0);
+    TEST_ASSERT_EQUAL_INT(0, prom_sketch_merge(sketch, other));
+    TEST_ASSERT_EQUAL_DOUBLE(-3.0, prom_sketch_quantile(sketch, 0.0));
+    TEST_ASSERT_EQUAL_DOUBLE(250.0, prom_sketch_quantile(sketch, 1.0));
+
+    prom_sketch_clear(sketch);
+    prom_sketch_insert(sketch, 7.0);
+    TEST_ASSERT_EQUAL_DOUBLE(7.0, prom_sketch_quantile(sketch, 0.0));
+    TEST_ASSERT_EQUAL_DOUBLE(7.0, prom_sketch_quantile(sketch, 1.0));
+
+    prom_sketch_destroy(other);
+    prom_sketch_destroy(sketch);
+}
+
+void test_prom_sketch_new_invalid(void)
+{
+    TEST_ASSERT_NULL(prom_sketch_new(0.0, PROM_SKETCH_TEST_MAX_BINS));
+    TEST_ASSERT_NULL(prom_sketch_new(1.0, PROM_SKETCH_TEST_MAX_BINS));
+    TEST_ASSERT_NULL(prom_sketch_new(NAN, PROM_SKETCH_TEST_MAX_BINS));
+    TEST_ASSERT_NULL(prom_sketch_new(PROM_SKETCH_TEST_ACCURACY, 0));
+}
+
+int main(int argc, const char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_prom_sketch_quantile);
+    RUN_TEST(test_prom_sketch_signs);
+    RUN_TEST(test_prom_sketch_merge);
+    RUN_TEST(test_prom_sketch_collapse);
+    RUN_TEST(test_prom_sketch_extremes);
+    RUN_TEST(test_prom_sketch_new_invalid);
+    return UNITY_END();
+}
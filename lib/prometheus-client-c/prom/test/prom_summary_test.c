@@ -0,0 +1,178 @@
+/**
+ * Copyright 2019-2020 DigitalOcean Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+
+#include "prom_test_helpers.h"
+
+/**
+ * @brief Returns the rendered value of the sample of s_sample with the given l_value
+ */
+static double prom_summary_test_value(prom_metric_sample_summary_t* s_sample, const char* l_value)
+{
+    prom_metric_sample_t* sample = (prom_metric_sample_t*)prom_map_get(s_sample->samples, l_value);
+    TEST_ASSERT_NOT_NULL(sample);
+    return sample->r_value;
+}
+
+void test_prom_summary(void)
+{
+    prom_summary_t* s = prom_summary_new("test_summary", "summary under test", NULL, 0, NULL);
+    TEST_ASSERT_NOT_NULL(s);
+
+    for (int i = 1; i <= 1000; i++)
+        TEST_ASSERT_EQUAL_INT(0, prom_summary_observe(s, (double)i, NULL));
+
+    prom_metric_formatter_t* formatter = prom_metric_formatter_new();
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_formatter_load_metric(formatter, s));
+    const char* result = prom_metric_formatter_dump(formatter);
+    TEST_ASSERT_NOT_NULL(strstr(result, "# TYPE test_summary summary\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_summary{quantile=\"0.5\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_summary{quantile=\"0.9\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_summary{quantile=\"0.99\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_summary_count 1000\n"));
+    TEST_ASSERT_NOT_NULL(strstr(result, "test_summary_sum 500500\n"));
+    free((char*)result);
+
+    // Quantiles are within the default 1% of the exact ones
+    prom_metric_sample_summary_t* s_sample = prom_metric_sample_summary_from_labels(s, NULL);
+    double median = prom_summary_test_value(s_sample, "test_summary{quantile=\"0.5\"}");
+    double p99 = prom_summary_test_value(s_sample, "test_summary{quantile=\"0.99\"}");
+    TEST_ASSERT_TRUE(fabs(median - 500.0) <= 5.0);
+    TEST_ASSERT_TRUE(fabs(p99 - 990.0) <= 9.9);
+
+    prom_metric_formatter_destroy(formatter);
+    prom_summary_destroy(s);
+}
+
+void test_prom_summary_labels(void)
+{
+    static const double quantiles[] = {0.25, 1.0};
+    prom_summary_options_t options = {quantiles, 2, 0.001, 0.0, 0};
+    prom_summary_t* s = prom_summary_new("wait", "disk wait", &options, 1, (const char*[]){"disk"});
+    TEST_ASSERT_NOT_NULL(s);
+
+    prom_summary_observe(s, 4.0, (const char*[]){"sda"});
+    prom_summary_observe(s, 8.0, (const char*[]){"sda"});
+    prom_summary_observe(s, 0.0 / 0.0, (const char*[]){"sda"});
+
+    prom_metric_formatter_t* formatter = prom_metric_formatter_new();
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_formatter_load_metric(formatter, s));
+    const char* result = prom_metric_formatter_dump(formatter);
+    TEST_ASSERT_NOT_NULL(strstr(result, "wait{disk=\"sda\",quantile=\"0.25\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(result, "wait{disk=\"sda\",quantile=\"1\"} "));
+    // NaN is counted but has no rank
+    TEST_ASSERT_NOT_NULL(strstr(result, "wait_count{disk=\"sda\"} 3\n"));
+    free((char*)result);
+
+    prom_metric_sample_summary_t* s_sample = prom_metric_sample_summary_from_labels(s, (const char*[]){"sda"});
+    TEST_ASSERT_TRUE(fabs(prom_summary_test_value(s_sample, "wait{disk=\"sda\",quantile=\"1\"}") - 8.0) <= 0.008);
+
+    // A label set never observed has no quantiles yet
+    prom_metric_sample_summary_t* idle = prom_metric_sample_summary_from_labels(s, (const char*[]){"sdb"});
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_summary_sync(idle));
+    TEST_ASSERT_TRUE(isnan(prom_summary_test_value(idle, "wait{disk=\"sdb\",quantile=\"0.25\"}")));
+
+    prom_metric_formatter_destroy(formatter);
+    prom_summary_destroy(s);
+}
+
+void test_prom_summary_sliding_window(void)
+{
+    static const double quantiles[] = {1.0};
+    // Three windows of 20 seconds
+    prom_summary_options_t options = {quantiles, 1, 0.01, 60.0, 3};
+    prom_summary_t* s = prom_summary_new("lag", "lag", &options, 0, NULL);
+    prom_metric_sample_summary_t* s_sample = prom_metric_sample_summary_from_labels(s, NULL);
+    double start = s_sample->rotated_at;
+
+    prom_metric_sample_summary_observe_at(s_sample, 100.0, start + 1);
+    prom_metric_sample_summary_observe_at(s_sample, 2.0, start + 30);
+
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_summary_sync_at(s_sample, start + 45));
+    TEST_ASSERT_TRUE(fabs(prom_summary_test_value(s_sample, "lag{quantile=\"1\"}") - 100.0) <= 1.0);
+
+    // The window holding 100 is dropped once 60 seconds have passed since it started
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_summary_sync_at(s_sample, start + 61));
+    TEST_ASSERT_TRUE(fabs(prom_summary_test_value(s_sample, "lag{quantile=\"1\"}") - 2.0) <= 0.02);
+
+    // Idle for longer than max_age, nothing is left in the window; count and sum are not windowed
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_summary_sync_at(s_sample, start + 500));
+    TEST_ASSERT_TRUE(isnan(prom_summary_test_value(s_sample, "lag{quantile=\"1\"}")));
+    TEST_ASSERT_EQUAL_DOUBLE(2.0, prom_summary_test_value(s_sample, "lag_count"));
+    TEST_ASSERT_EQUAL_DOUBLE(102.0, prom_summary_test_value(s_sample, "lag_sum"));
+
+    // Observations after the idle period land in a fresh window
+    prom_metric_sample_summary_observe_at(s_sample, 7.0, start + 501);
+    TEST_ASSERT_EQUAL_INT(0, prom_metric_sample_summary_sync_at(s_sample, start + 502));
+    TEST_ASSERT_TRUE(fabs(prom_summary_test_value(s_sample, "lag{quantile=\"1\"}") - 7.0) <= 0.07);
+
+    prom_summary_destroy(s);
+}
+
+void test_prom_summary_openmetrics(void)
+{
+    prom_collector_registry_t* registry = prom_collector_registry_new("summary");
+    prom_collector_t* collector = prom_collector_new("test");
+    static const double quantiles[] = {0.5};
+    prom_summary_options_t options = {quantiles, 1, 0.01, 0.0, 1};
+    prom_summary_t* s = prom_summary_new("cpu", "cpu percent", &options, 0, NULL);
+    prom_collector_add_metric(collector, s);
+    prom_collector_registry_register_collector(registry, collector);
+    prom_summary_observe(s, 0.5, NULL);
+    prom_summary_observe(s, 1.0, NULL);
+    prom_summary_observe(s, 2.0, NULL);
+
+    size_t len = 0;
+    const char* result = prom_collector_registry_bridge_format(registry, PROM_EXPOSITION_OPENMETRICS, &len);
+    // The median, 1.0, falls in the bin reported as 0.99
+    const char* expected = "# TYPE cpu summary\n"
+                           "# HELP cpu cpu percent\n"
+                           "cpu{quantile=\"0.5\"} 0.99\n"
+                           "cpu_count 3\n"
+                           "cpu_sum 3.5\n"
+                           "# EOF\n";
+    TEST_ASSERT_EQUAL_STRING(expected, result);
+
+    free((char*)result);
+    prom_collector_registry_destroy(registry);
+}
+
+void test_prom_summary_new_invalid(void)
+{
+    static const double quantiles[] = {0.5, 1.5};
+    prom_summary_options_t options = {quantiles, 2, 0.01, 60.0, 3};
+    TEST_ASSERT_NULL(prom_summary_new("s", "s", &options, 0, NULL));
+
+    options.quantile_count = 1;
+    options.relative_accuracy = 0.0;
+    TEST_ASSERT_NULL(prom_summary_new("s", "s", &options, 0, NULL));
+
+    options.relative_accuracy = 0.01;
+    options.age_buckets = 0;
+    TEST_ASSERT_NULL(prom_summary_new("s", "s", &options, 0, NULL));
+}
+
+int main(int argc, const char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_prom_summary);
+    RUN_TEST(test_prom_summary_labels);
+    RUN_TEST(test_prom_summary_sliding_window);
+    RUN_TEST(test_prom_summary_openmetrics);
+    RUN_TEST(test_prom_summary_new_invalid);
+    return UNITY_END();
+}
@@ -6,6 +6,7 @@
 #include "prom.h"
 #include "prom_collector_registry_t.h"
 #include "prom_collector_t.h"
+#include "prom_dtoa_i.h"
 #include "prom_linked_list_i.h"
 #include "prom_linked_list_t.h"
 #include "prom_map_i.h"
@@ -16,6 +17,8 @@
 #include "prom_metric_sample_histogram_i.h"
 #include "prom_metric_sample_histogram_t.h"
 #include "prom_metric_sample_i.h"
+#include "prom_metric_sample_summary_i.h"
+#include "prom_metric_sample_summary_t.h"
 #include "prom_metric_sample_t.h"
 #include "prom_metric_t.h"
 #include "prom_process_fds_i.h"
@@ -26,6 +29,9 @@
 #include "prom_process_stat_t.h"
 #include "prom_procfs_i.h"
 #include "prom_procfs_t.h"
+#include "prom_protobuf_i.h"
+#include "prom_sketch_i.h"
+#include "prom_sketch_t.h"
 #include "prom_string_builder_i.h"
 #include "prom_string_builder_t.h"
 #include "unity.h"
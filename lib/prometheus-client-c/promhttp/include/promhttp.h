@@ -28,6 +28,33 @@
 #include "microhttpd.h"
 #include "prom_collector_registry.h"
 
+/**
+ * @brief Response header carrying the change version of a /metrics?since=<version> response.
+ *
+ * GET /metrics?since=<version> answers, in the text format, only the samples whose value changed after that version
+ * (see prom_collector_registry_bridge_since). The body starts with a "# VERSION <version>" comment and the same version
+ * is sent in this header; passing it as since on the next request returns the following changes. since=0 returns every
+ * sample. Delta responses are rendered for each request rather than taken from the snapshot.
+ */
+#define PROMHTTP_VERSION_HEADER "X-Metrics-Version"
+
+/**
+ * @brief Query parameters of /metrics restricting the response to some of the registered collectors.
+ *
+ * GET /metrics?collect[]=<name>&collect[]=<name> renders only the named collectors and collect_prefix=<prefix> only
+ * those whose name starts with prefix; when both are given a collector must satisfy both (see
+ * prom_collector_registry_bridge_select). Collectors left out are not even collected. An unknown name, an empty
+ * collect[] or more than 16 of them are answered with 400. Selected responses combine with since and with format and
+ * encoding negotiation, and are rendered for each request rather than taken from the snapshot.
+ */
+#define PROMHTTP_COLLECT_ARGUMENT "collect[]"
+
+/**
+ * @brief Query parameter of /metrics selecting the collectors whose name starts with its value (see
+ * PROMHTTP_COLLECT_ARGUMENT).
+ */
+#define PROMHTTP_COLLECT_PREFIX_ARGUMENT "collect_prefix"
+
 /**
  * @brief Sets the active registry for metric scraping.
  *
@@ -46,3 +73,96 @@ void promhttp_set_active_collector_registry(prom_collector_registry_t* active_re
  */
 struct MHD_Daemon* promhttp_start_daemon(unsigned int flags, unsigned short port, MHD_AcceptPolicyCallback apc,
                                          void* apc_cls);
+
+/**
+ * @brief Handles a GET request for a URL registered with promhttp_register_route.
+ *
+ * The handler queues its own response, e.g. with MHD_queue_response, and returns its result.
+ *
+ * @param connection The connection the request arrived on
+ * @param cls The closure passed to promhttp_register_route
+ * @return MHD_YES on success, MHD_NO to close the connection
+ */
+typedef enum MHD_Result (*promhttp_route_handler_t)(struct MHD_Connection* connection, void* cls);
+
+/**
+ * @brief Serves GET requests for url with handler, next to / and /metrics.
+ *
+ * Routes must be registered before a daemon is started. Overloaded daemons answer 503 before routes are consulted.
+ *
+ * @param url The exact request path, e.g. "/api/v1/range". It must outlive every daemon.
+ * @param handler The handler
+ * @param cls Passed to handler on every request
+ * @return Non-zero if the route table is full or url is already registered
+ */
+int promhttp_register_route(const char* url, promhttp_route_handler_t handler, void* cls);
+
+/**
+ * @brief Connection handling of a daemon started with promhttp_start_daemon_with_limits.
+ */
+typedef struct promhttp_limits
+{
+    unsigned int thread_pool_size;        /**< thread_pool_size        Polling threads; 0 or 1 for a single thread */
+    unsigned int connection_limit;        /**< connection_limit        Connections served normally; 0 for no limit */
+    unsigned int overload_headroom;       /**< overload_headroom       Connections accepted above connection_limit
+                                           *                           only to be answered 503 */
+    unsigned int per_ip_connection_limit; /**< per_ip_connection_limit Connections per client address; 0 for no
+                                           *                           limit */
+    unsigned int connection_timeout;      /**< connection_timeout      Seconds an idle keep-alive connection is kept
+                                           *                           open; 0 for no timeout */
+} promhttp_limits_t;
+
+/**
+ * @brief Starts a daemon in the background like promhttp_start_daemon, applying limits.
+ *
+ * While more than limits->connection_limit connections are open, requests are answered right away with 503 Service
+ * Unavailable, Retry-After and Connection: close instead of rendering the registry. microhttpd itself refuses
+ * connections beyond connection_limit + overload_headroom, and beyond per_ip_connection_limit from a single address.
+ *
+ * @param limits The limits to apply. If null is passed, this is the same as promhttp_start_daemon.
+ * @return struct MHD_Daemon*
+ */
+struct MHD_Daemon* promhttp_start_daemon_with_limits(unsigned int flags, unsigned short port,
+                                                     MHD_AcceptPolicyCallback apc, void* apc_cls,
+                                                     const promhttp_limits_t* limits);
+
+/**
+ * @brief Starts a daemon in the background that serves on a socket the caller already bound and put in the listening
+ * state, such as a Unix domain socket. It serves the same registry and snapshot as every other promhttp daemon.
+ *
+ * The open connection count behind the 503 response of promhttp_start_daemon_with_limits is shared by all promhttp
+ * daemons, and the most recently started daemon with limits sets its threshold.
+ *
+ * @param listen_fd The listening socket. microhttpd closes it when the daemon is stopped.
+ * @param limits The limits to apply. May be null.
+ * @return struct MHD_Daemon*, or null if listen_fd is negative or the daemon could not be started
+ */
+struct MHD_Daemon* promhttp_start_daemon_on_socket(unsigned int flags, int listen_fd, MHD_AcceptPolicyCallback apc,
+                                                   void* apc_cls, const promhttp_limits_t* limits);
+
+/**
+ * @brief Called after every render of the registry, on the thread that rendered it.
+ *
+ * @param seconds Time spent walking the registry, measured on CLOCK_MONOTONIC, without waiting for other renders
+ * @param bytes Size of the rendered body before compression
+ */
+typedef void (*promhttp_render_observer_t)(double seconds, size_t bytes);
+
+/**
+ * @brief Sets the function told about every render of the registry, e.g. to record render time histograms.
+ *
+ * Scrapes served from the snapshot render nothing and are not reported. The observer runs outside the render lock, so
+ * it may update metrics of the registry being rendered.
+ *
+ * @param observer The observer, or NULL to stop reporting
+ */
+void promhttp_set_render_observer(promhttp_render_observer_t observer);
+
+/**
+ * @brief Marks the end of a collection tick.
+ *
+ * Until this is called for the first time every scrape renders the registry. Afterwards, the first scrape following a
+ * tick renders the registry once and every scrape until the next tick is served from that snapshot, including its
+ * gzip/deflate compressed forms, so neither rendering nor compression cost grows with the number of scrapers.
+ */
+void promhttp_snapshot_tick(void);
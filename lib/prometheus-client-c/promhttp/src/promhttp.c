@@ -14,13 +14,477 @@
  * limitations under the License.
  */
 
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <zlib.h>
 
 #include "microhttpd.h"
 #include "prom.h"
+#include "promhttp.h"
+
+#define PROMHTTP_TEXT_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+#define PROMHTTP_PROTOBUF_MEDIA_TYPE "application/vnd.google.protobuf"
+#define PROMHTTP_PROTOBUF_CONTENT_TYPE                                                                                 \
+    PROMHTTP_PROTOBUF_MEDIA_TYPE "; proto=io.prometheus.client.MetricFamily; encoding=delimited"
+#define PROMHTTP_OPENMETRICS_MEDIA_TYPE "application/openmetrics-text"
+#define PROMHTTP_OPENMETRICS_CONTENT_TYPE PROMHTTP_OPENMETRICS_MEDIA_TYPE "; version=1.0.0; charset=utf-8"
+
+// Number of prom_exposition_format_t values
+#define PROMHTTP_FORMAT_COUNT 3
+
+// Room for the "# VERSION <version>" line of a delta response and for the version header value
+#define PROMHTTP_VERSION_PREFIX_SIZE 32
+
+#define PROMHTTP_NANOSECONDS_PER_SECOND 1e9
+
+// Maximum number of collect[] parameters in a /metrics request
+#define PROMHTTP_MAX_COLLECT 16
+
+// Maximum number of routes registered with promhttp_register_route
+#define PROMHTTP_MAX_ROUTES 16
+
+// zlib window bits; adding 16 makes deflate() emit a gzip wrapper instead of a zlib one
+#define PROMHTTP_ZLIB_WINDOW_BITS 15
+#define PROMHTTP_GZIP_WINDOW_BITS (PROMHTTP_ZLIB_WINDOW_BITS + 16)
+#define PROMHTTP_ZLIB_MEM_LEVEL 8
+
+typedef enum promhttp_encoding
+{
+    PROMHTTP_ENCODING_IDENTITY,
+    PROMHTTP_ENCODING_GZIP,
+    PROMHTTP_ENCODING_DEFLATE,
+    PROMHTTP_ENCODING_COUNT
+} promhttp_encoding_t;
+
+static const char* promhttp_encoding_names[PROMHTTP_ENCODING_COUNT] = {"identity", "gzip", "deflate"};
+
+static const char* promhttp_content_types[PROMHTTP_FORMAT_COUNT] = {
+    PROMHTTP_TEXT_CONTENT_TYPE, PROMHTTP_PROTOBUF_CONTENT_TYPE, PROMHTTP_OPENMETRICS_CONTENT_TYPE};
+
+// Media type parameters a scraper must send for the delimited protobuf format to be selected
+static const char* promhttp_protobuf_params[] = {"proto=io.prometheus.client.MetricFamily", "encoding=delimited", NULL};
+static const char* promhttp_no_params[] = {NULL};
+
+/**
+ * @brief A reference counted response body. Every response queued with it holds a reference, and so does the
+ * snapshot while the body is the latest one of its format.
+ */
+typedef struct promhttp_body
+{
+    atomic_int refs; /**< refs Number of holders of this body */
+    size_t len;      /**< len  Length of data in bytes */
+    char data[];     /**< data The body */
+} promhttp_body_t;
+
+/**
+ * @brief The latest bodies of one exposition format, one slot per content encoding. Compressed bodies are produced
+ * lazily from the identity body the first time a scraper asks for them.
+ */
+typedef struct promhttp_snapshot_slot
+{
+    unsigned long tick;       /**< tick       The tick the render started in */
+    unsigned long generation; /**< generation Incremented every time a render completes */
+    bool rendering;           /**< rendering  Set while a scrape renders this format for everyone waiting on it */
+    promhttp_body_t* bodies[PROMHTTP_ENCODING_COUNT]; /**< bodies Latest bodies, NULL until produced */
+} promhttp_snapshot_slot_t;
+
+/**
+ * @brief Coalesces renders across concurrent scrapes.
+ *
+ * At most one scrape per format renders at a time; scrapes that arrive while it runs wait for it and share its body.
+ * Once promhttp_snapshot_tick has been called, a body is also reused by every later scrape of the same tick.
+ */
+typedef struct promhttp_snapshot
+{
+    pthread_mutex_t lock; /**< lock    Guards every field below */
+    pthread_cond_t cond;  /**< cond    Signalled when a render completes */
+    bool enabled;         /**< enabled Set by the first promhttp_snapshot_tick */
+    unsigned long tick;   /**< tick    Incremented by promhttp_snapshot_tick */
+    promhttp_snapshot_slot_t slots[PROMHTTP_FORMAT_COUNT]; /**< slots Indexed by prom_exposition_format_t */
+} promhttp_snapshot_t;
 
 prom_collector_registry_t* PROM_ACTIVE_REGISTRY;
 
+static promhttp_snapshot_t promhttp_snapshot = {.lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER};
+
+// The registry renders through a single formatter, so renders of different formats must not overlap either
+static pthread_mutex_t promhttp_render_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct promhttp_route
+{
+    const char* url;
+    promhttp_route_handler_t handler;
+    void* cls;
+} promhttp_route_t;
+
+// Routes registered with promhttp_register_route; only written before any daemon is started
+static promhttp_route_t promhttp_routes[PROMHTTP_MAX_ROUTES];
+static size_t promhttp_route_count;
+
+// Connections currently open on the daemon, maintained by promhttp_notify_connection
+static atomic_uint promhttp_open_connections;
+
+// Open connections above which requests are answered 503; 0 disables the check
+static atomic_uint promhttp_overload_threshold;
+
+// Told about every render, set with promhttp_set_render_observer
+static _Atomic(promhttp_render_observer_t) promhttp_render_observer;
+
+static promhttp_body_t* promhttp_body_new(size_t capacity)
+{
+    promhttp_body_t* self = (promhttp_body_t*)malloc(sizeof(promhttp_body_t) + capacity);
+    if (self == NULL)
+        return NULL;
+    atomic_init(&self->refs, 1);
+    self->len = capacity;
+    return self;
+}
+
+static void promhttp_body_acquire(promhttp_body_t* self)
+{
+    atomic_fetch_add(&self->refs, 1);
+}
+
+static void promhttp_body_release(promhttp_body_t* self)
+{
+    if (self != NULL && atomic_fetch_sub(&self->refs, 1) == 1)
+        free(self);
+}
+
+/**
+ * @brief MHD free callback; receives the data pointer handed to MHD and releases the body that owns it
+ */
+static void promhttp_body_release_data(void* data)
+{
+    promhttp_body_release((promhttp_body_t*)((char*)data - offsetof(promhttp_body_t, data)));
+}
+
+/**
+ * @brief The collectors requested with collect[] and collect_prefix; selection.names points into names.
+ */
+typedef struct promhttp_collect
+{
+    const char* names[PROMHTTP_MAX_COLLECT];
+    prom_collector_selection_t selection;
+    bool invalid; /**< invalid Set for an unknown collector, an empty name or too many names */
+} promhttp_collect_t;
+
+static double promhttp_monotonic_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / PROMHTTP_NANOSECONDS_PER_SECOND;
+}
+
+/**
+ * @brief Reports a render that started at start, as returned by promhttp_monotonic_seconds, to the observer if any.
+ */
+static void promhttp_observe_render(double start, size_t bytes)
+{
+    promhttp_render_observer_t observer = atomic_load_explicit(&promhttp_render_observer, memory_order_acquire);
+    if (observer != NULL)
+        observer(promhttp_monotonic_seconds() - start, bytes);
+}
+
+void promhttp_set_render_observer(promhttp_render_observer_t observer)
+{
+    atomic_store_explicit(&promhttp_render_observer, observer, memory_order_release);
+}
+
+static promhttp_body_t* promhttp_body_render(prom_exposition_format_t format,
+                                             const prom_collector_selection_t* selection)
+{
+    size_t len = 0;
+    pthread_mutex_lock(&promhttp_render_lock);
+    double start = promhttp_monotonic_seconds();
+    const char* buf = prom_collector_registry_bridge_select(PROM_ACTIVE_REGISTRY, format, selection, &len);
+    pthread_mutex_unlock(&promhttp_render_lock);
+    if (buf == NULL)
+        return NULL;
+    promhttp_observe_render(start, len);
+    promhttp_body_t* self = promhttp_body_new(len);
+    if (self != NULL)
+        memcpy(self->data, buf, len);
+    free((void*)buf);
+    return self;
+}
+
+/**
+ * @brief Renders the samples of the selected collectors changed after since, prefixed with the version comment, and
+ * sets *version.
+ */
+static promhttp_body_t* promhttp_body_render_since(uint64_t since, const prom_collector_selection_t* selection,
+                                                   uint64_t* version)
+{
+    size_t len = 0;
+    pthread_mutex_lock(&promhttp_render_lock);
+    double start = promhttp_monotonic_seconds();
+    const char* buf = prom_collector_registry_bridge_since(PROM_ACTIVE_REGISTRY, since, selection, version, &len);
+    pthread_mutex_unlock(&promhttp_render_lock);
+    if (buf == NULL)
+        return NULL;
+    promhttp_observe_render(start, len);
+    char prefix[PROMHTTP_VERSION_PREFIX_SIZE];
+    int prefix_len = snprintf(prefix, sizeof(prefix), "# VERSION %" PRIu64 "\n", *version);
+    promhttp_body_t* self = promhttp_body_new((size_t)prefix_len + len);
+    if (self != NULL)
+    {
+        memcpy(self->data, prefix, (size_t)prefix_len);
+        memcpy(self->data + prefix_len, buf, len);
+    }
+    free((void*)buf);
+    return self;
+}
+
+static promhttp_body_t* promhttp_body_compress(const promhttp_body_t* src, promhttp_encoding_t encoding)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int window_bits = encoding == PROMHTTP_ENCODING_GZIP ? PROMHTTP_GZIP_WINDOW_BITS : PROMHTTP_ZLIB_WINDOW_BITS;
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, PROMHTTP_ZLIB_MEM_LEVEL,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        return NULL;
+
+    uLong bound = deflateBound(&stream, (uLong)src->len);
+    promhttp_body_t* self = promhttp_body_new(bound);
+    if (self == NULL)
+    {
+        deflateEnd(&stream);
+        return NULL;
+    }
+    stream.next_in = (Bytef*)src->data;
+    stream.avail_in = (uInt)src->len;
+    stream.next_out = (Bytef*)self->data;
+    stream.avail_out = (uInt)bound;
+    int r = deflate(&stream, Z_FINISH);
+    self->len = stream.total_out;
+    deflateEnd(&stream);
+    if (r != Z_STREAM_END)
+    {
+        promhttp_body_release(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * @brief Returns the body for the requested format and encoding with a reference held for the caller.
+ *
+ * The first scrape that finds no usable body renders one outside the lock; scrapes of the same format arriving in the
+ * meantime wait and share the result instead of walking the registry again. Without ticks a body is only usable by the
+ * scrapes that waited for it. Once promhttp_snapshot_tick has been called, it is reused until the next tick. Each
+ * encoding is compressed at most once per body. If compression fails the identity body is returned and *encoding is
+ * updated accordingly.
+ */
+static promhttp_body_t* promhttp_snapshot_get(prom_exposition_format_t format, promhttp_encoding_t* encoding)
+{
+    promhttp_snapshot_slot_t* slot = &promhttp_snapshot.slots[format];
+    pthread_mutex_lock(&promhttp_snapshot.lock);
+    bool cached = promhttp_snapshot.enabled && slot->tick == promhttp_snapshot.tick &&
+                  slot->bodies[PROMHTTP_ENCODING_IDENTITY] != NULL;
+    if (!cached && slot->rendering)
+    {
+        unsigned long generation = slot->generation;
+        while (slot->generation == generation)
+            pthread_cond_wait(&promhttp_snapshot.cond, &promhttp_snapshot.lock);
+    }
+    else if (!cached)
+    {
+        slot->rendering = true;
+        unsigned long tick = promhttp_snapshot.tick;
+        pthread_mutex_unlock(&promhttp_snapshot.lock);
+        promhttp_body_t* identity = promhttp_body_render(format, NULL);
+        pthread_mutex_lock(&promhttp_snapshot.lock);
+
+        for (int i = 0; i < PROMHTTP_ENCODING_COUNT; i++)
+        {
+            promhttp_body_release(slot->bodies[i]);
+            slot->bodies[i] = NULL;
+        }
+        slot->bodies[PROMHTTP_ENCODING_IDENTITY] = identity;
+        slot->tick = tick;
+        slot->generation++;
+        slot->rendering = false;
+        pthread_cond_broadcast(&promhttp_snapshot.cond);
+    }
+
+    promhttp_body_t* identity = slot->bodies[PROMHTTP_ENCODING_IDENTITY];
+    if (identity != NULL && slot->bodies[*encoding] == NULL)
+        slot->bodies[*encoding] = promhttp_body_compress(identity, *encoding);
+    if (slot->bodies[*encoding] == NULL)
+        *encoding = PROMHTTP_ENCODING_IDENTITY;
+
+    promhttp_body_t* body = slot->bodies[*encoding];
+    if (body != NULL)
+        promhttp_body_acquire(body);
+    pthread_mutex_unlock(&promhttp_snapshot.lock);
+    return body;
+}
+
+/**
+ * @brief Renders the selected collectors for a single request, bypassing the snapshot. If compression fails the
+ * identity body is returned and *encoding is updated accordingly.
+ */
+static promhttp_body_t* promhttp_body_render_selected(prom_exposition_format_t format,
+                                                      const prom_collector_selection_t* selection,
+                                                      promhttp_encoding_t* encoding)
+{
+    promhttp_body_t* identity = promhttp_body_render(format, selection);
+    if (identity == NULL || *encoding == PROMHTTP_ENCODING_IDENTITY)
+        return identity;
+    promhttp_body_t* compressed = promhttp_body_compress(identity, *encoding);
+    if (compressed == NULL)
+    {
+        *encoding = PROMHTTP_ENCODING_IDENTITY;
+        return identity;
+    }
+    promhttp_body_release(identity);
+    return compressed;
+}
+
+void promhttp_snapshot_tick(void)
+{
+    pthread_mutex_lock(&promhttp_snapshot.lock);
+    promhttp_snapshot.enabled = true;
+    promhttp_snapshot.tick++;
+    pthread_mutex_unlock(&promhttp_snapshot.lock);
+}
+
+/**
+ * @brief Returns true if the Accept-Encoding header lists coding without q=0. "*" only stands for the codings the
+ * header does not name.
+ */
+static bool promhttp_accepts_coding(const char* header, const char* coding)
+{
+    size_t coding_len = strlen(coding);
+    bool named = false;
+    bool named_accepted = false;
+    bool wildcard_accepted = false;
+    const char* p = header;
+    while (*p != '\0')
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+            p++;
+        const char* token = p;
+        while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+            p++;
+        size_t token_len = (size_t)(p - token);
+        bool rejected = false;
+        while (*p != '\0' && *p != ',')
+        {
+            if (*p == 'q' && p[1] == '=')
+            {
+                rejected = strtod(p + 2, NULL) <= 0.0;
+                break;
+            }
+            p++;
+        }
+        while (*p != '\0' && *p != ',')
+            p++;
+        if (token_len == coding_len && strncasecmp(token, coding, coding_len) == 0)
+        {
+            named = true;
+            named_accepted = named_accepted || !rejected;
+        }
+        else if (token_len == 1 && *token == '*')
+        {
+            wildcard_accepted = wildcard_accepted || !rejected;
+        }
+    }
+    return named ? named_accepted : wildcard_accepted;
+}
+
+static promhttp_encoding_t promhttp_negotiate_encoding(struct MHD_Connection* connection)
+{
+    const char* accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+    if (accept == NULL)
+        return PROMHTTP_ENCODING_IDENTITY;
+    if (promhttp_accepts_coding(accept, promhttp_encoding_names[PROMHTTP_ENCODING_GZIP]))
+        return PROMHTTP_ENCODING_GZIP;
+    if (promhttp_accepts_coding(accept, promhttp_encoding_names[PROMHTTP_ENCODING_DEFLATE]))
+        return PROMHTTP_ENCODING_DEFLATE;
+    return PROMHTTP_ENCODING_IDENTITY;
+}
+
+/**
+ * @brief Returns the highest q value among the Accept entries matching media_type with all of params, or -1 if none
+ * matches. Wildcard ranges only count when wildcards is set.
+ */
+static double promhttp_accept_quality(const char* header, const char* media_type, const char** params, bool wildcards)
+{
+    double best = -1.0;
+    const char* slash = strchr(media_type, '/');
+    size_t major_len = slash != NULL ? (size_t)(slash - media_type) : strlen(media_type);
+    const char* p = header;
+    while (*p != '\0')
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+            p++;
+        const char* range = p;
+        while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+            p++;
+        size_t range_len = (size_t)(p - range);
+        bool matches = range_len == strlen(media_type) && strncasecmp(range, media_type, range_len) == 0;
+        if (wildcards)
+            matches = matches || (range_len == 3 && strncmp(range, "*/*", 3) == 0) ||
+                      (range_len == major_len + 2 && strncasecmp(range, media_type, major_len) == 0 &&
+                       strncmp(range + major_len, "/*", 2) == 0);
+
+        double q = 1.0;
+        size_t found = 0;
+        while (*p != '\0' && *p != ',')
+        {
+            while (*p == ';' || *p == ' ' || *p == '\t')
+                p++;
+            const char* param = p;
+            while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+                p++;
+            size_t param_len = (size_t)(p - param);
+            if (param_len > 2 && param[0] == 'q' && param[1] == '=')
+                q = strtod(param + 2, NULL);
+            for (size_t i = 0; params[i] != NULL; i++)
+            {
+                if (param_len == strlen(params[i]) && strncmp(param, params[i], param_len) == 0)
+                    found++;
+            }
+        }
+        size_t required = 0;
+        while (params[required] != NULL)
+            required++;
+        if (matches && found >= required && q > best)
+            best = q;
+    }
+    return best;
+}
+
+/**
+ * @brief Picks the format the scraper rates highest. Protobuf and OpenMetrics must be named explicitly; on equal q
+ * values protobuf wins over OpenMetrics, which wins over text.
+ */
+static prom_exposition_format_t promhttp_negotiate_format(struct MHD_Connection* connection)
+{
+    const char* accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT);
+    if (accept == NULL)
+        return PROM_EXPOSITION_TEXT;
+    double protobuf_q = promhttp_accept_quality(accept, PROMHTTP_PROTOBUF_MEDIA_TYPE, promhttp_protobuf_params, false);
+    double openmetrics_q = promhttp_accept_quality(accept, PROMHTTP_OPENMETRICS_MEDIA_TYPE, promhttp_no_params, false);
+    double text_q = promhttp_accept_quality(accept, "text/plain", promhttp_no_params, true);
+    if (protobuf_q > 0.0 && protobuf_q >= openmetrics_q && protobuf_q >= text_q)
+        return PROM_EXPOSITION_PROTOBUF;
+    if (openmetrics_q > 0.0 && openmetrics_q >= text_q)
+        return PROM_EXPOSITION_OPENMETRICS;
+    return PROM_EXPOSITION_TEXT;
+}
+
 void promhttp_set_active_collector_registry(prom_collector_registry_t* active_registry)
 {
     if (!active_registry)
@@ -33,9 +497,131 @@ void promhttp_set_active_collector_registry(prom_collector_registry_t* active_re
     }
 }
 
+int promhttp_register_route(const char* url, promhttp_route_handler_t handler, void* cls)
+{
+    if (url == NULL || handler == NULL || promhttp_route_count == PROMHTTP_MAX_ROUTES)
+        return 1;
+    for (size_t i = 0; i < promhttp_route_count; i++)
+    {
+        if (strcmp(promhttp_routes[i].url, url) == 0)
+            return 1;
+    }
+    promhttp_routes[promhttp_route_count++] = (promhttp_route_t){url, handler, cls};
+    return 0;
+}
+
+static void promhttp_notify_connection(void* cls, struct MHD_Connection* connection, void** socket_context,
+                                       enum MHD_ConnectionNotificationCode toe)
+{
+    if (toe == MHD_CONNECTION_NOTIFY_STARTED)
+        atomic_fetch_add(&promhttp_open_connections, 1);
+    else if (toe == MHD_CONNECTION_NOTIFY_CLOSED)
+        atomic_fetch_sub(&promhttp_open_connections, 1);
+}
+
+static bool promhttp_overloaded(void)
+{
+    unsigned int threshold = atomic_load_explicit(&promhttp_overload_threshold, memory_order_relaxed);
+    return threshold != 0 && atomic_load_explicit(&promhttp_open_connections, memory_order_relaxed) > threshold;
+}
+
+/**
+ * @brief MHD_KeyValueIterator adding every collect[] argument to the promhttp_collect_t in cls
+ */
+static enum MHD_Result promhttp_collect_argument(void* cls, enum MHD_ValueKind kind, const char* key,
+                                                 const char* value)
+{
+    promhttp_collect_t* collect = (promhttp_collect_t*)cls;
+    (void)kind;
+    if (strcmp(key, PROMHTTP_COLLECT_ARGUMENT) != 0)
+        return MHD_YES;
+    if (value == NULL || collect->selection.names_count == PROMHTTP_MAX_COLLECT ||
+        prom_collector_registry_get_collector(PROM_ACTIVE_REGISTRY, value) == NULL)
+    {
+        collect->invalid = true;
+        return MHD_NO;
+    }
+    collect->names[collect->selection.names_count++] = value;
+    return MHD_YES;
+}
+
+/**
+ * @brief Reads the collector selection of a /metrics request and returns it, or NULL when every collector is wanted.
+ * collect->invalid is set if the selection cannot be served.
+ */
+static const prom_collector_selection_t* promhttp_parse_collect(struct MHD_Connection* connection,
+                                                                promhttp_collect_t* collect)
+{
+    memset(collect, 0, sizeof(*collect));
+    collect->selection.names = collect->names;
+    collect->selection.prefix =
+        MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, PROMHTTP_COLLECT_PREFIX_ARGUMENT);
+    MHD_get_connection_values(connection, MHD_GET_ARGUMENT_KIND, &promhttp_collect_argument, collect);
+    if (collect->selection.names_count == 0 && collect->selection.prefix == NULL)
+        return NULL;
+    return &collect->selection;
+}
+
+/**
+ * @brief Answers /metrics?since=<version> with the samples of the selected collectors changed after that version.
+ */
+static enum MHD_Result promhttp_queue_delta(struct MHD_Connection* connection, const char* since_text,
+                                            const prom_collector_selection_t* selection)
+{
+    char* end = NULL;
+    errno = 0;
+    unsigned long long since = strtoull(since_text, &end, 10);
+    if (errno != 0 || end == since_text || *end != '\0' || since_text[0] == '-')
+    {
+        char* buf = "Invalid since version\n";
+        struct MHD_Response* response =
+            MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
+        int ret = MHD_queue_response(connection, MHD_HTTP_BAD_REQUEST, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+
+    uint64_t version = 0;
+    promhttp_body_t* body = promhttp_body_render_since((uint64_t)since, selection, &version);
+    if (body == NULL)
+    {
+        char* buf = "Internal Server Error\n";
+        struct MHD_Response* response =
+            MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
+        int ret = MHD_queue_response(connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+    struct MHD_Response* response =
+        MHD_create_response_from_buffer_with_free_callback(body->len, body->data, &promhttp_body_release_data);
+    if (response == NULL)
+    {
+        promhttp_body_release(body);
+        return MHD_NO;
+    }
+    char version_text[PROMHTTP_VERSION_PREFIX_SIZE];
+    snprintf(version_text, sizeof(version_text), "%" PRIu64, version);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, PROMHTTP_TEXT_CONTENT_TYPE);
+    MHD_add_response_header(response, PROMHTTP_VERSION_HEADER, version_text);
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
 enum MHD_Result promhttp_handler(void* cls, struct MHD_Connection* connection, const char* url, const char* method,
                                  const char* version, const char* upload_data, size_t* upload_data_size, void** con_cls)
 {
+    if (promhttp_overloaded())
+    {
+        char* buf = "Service Unavailable\n";
+        struct MHD_Response* response =
+            MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
+        MHD_add_response_header(response, MHD_HTTP_HEADER_RETRY_AFTER, "1");
+        MHD_add_response_header(response, MHD_HTTP_HEADER_CONNECTION, "close");
+        int ret = MHD_queue_response(connection, MHD_HTTP_SERVICE_UNAVAILABLE, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
     if (strcmp(method, "GET") != 0)
     {
         char* buf = "Invalid HTTP Method\n";
@@ -56,12 +642,56 @@ enum MHD_Result promhttp_handler(void* cls, struct MHD_Connection* connection, c
     }
     if (strcmp(url, "/metrics") == 0)
     {
-        const char* buf = prom_collector_registry_bridge(PROM_ACTIVE_REGISTRY);
-        struct MHD_Response* response = MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_MUST_FREE);
+        // The selection is resolved against the collector names before anything is collected or formatted
+        promhttp_collect_t collect;
+        const prom_collector_selection_t* selection = promhttp_parse_collect(connection, &collect);
+        if (collect.invalid)
+        {
+            char* buf = "Invalid collector selection\n";
+            struct MHD_Response* response =
+                MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
+            int ret = MHD_queue_response(connection, MHD_HTTP_BAD_REQUEST, response);
+            MHD_destroy_response(response);
+            return ret;
+        }
+        const char* since = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "since");
+        if (since != NULL)
+            return promhttp_queue_delta(connection, since, selection);
+
+        prom_exposition_format_t format = promhttp_negotiate_format(connection);
+        promhttp_encoding_t encoding = promhttp_negotiate_encoding(connection);
+        promhttp_body_t* body = selection != NULL ? promhttp_body_render_selected(format, selection, &encoding)
+                                                  : promhttp_snapshot_get(format, &encoding);
+        if (body == NULL)
+        {
+            char* buf = "Internal Server Error\n";
+            struct MHD_Response* response =
+                MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
+            int ret = MHD_queue_response(connection, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+            MHD_destroy_response(response);
+            return ret;
+        }
+        struct MHD_Response* response =
+            MHD_create_response_from_buffer_with_free_callback(body->len, body->data, &promhttp_body_release_data);
+        if (response == NULL)
+        {
+            promhttp_body_release(body);
+            return MHD_NO;
+        }
+        MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, promhttp_content_types[format]);
+        MHD_add_response_header(response, MHD_HTTP_HEADER_VARY,
+                                MHD_HTTP_HEADER_ACCEPT ", " MHD_HTTP_HEADER_ACCEPT_ENCODING);
+        if (encoding != PROMHTTP_ENCODING_IDENTITY)
+            MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_ENCODING, promhttp_encoding_names[encoding]);
         int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
         MHD_destroy_response(response);
         return ret;
     }
+    for (size_t i = 0; i < promhttp_route_count; i++)
+    {
+        if (strcmp(url, promhttp_routes[i].url) == 0)
+            return promhttp_routes[i].handler(connection, promhttp_routes[i].cls);
+    }
     char* buf = "Bad Request\n";
     struct MHD_Response* response = MHD_create_response_from_buffer(strlen(buf), (void*)buf, MHD_RESPMEM_PERSISTENT);
     int ret = MHD_queue_response(connection, MHD_HTTP_BAD_REQUEST, response);
@@ -74,3 +704,47 @@ struct MHD_Daemon* promhttp_start_daemon(unsigned int flags, unsigned short port
 {
     return MHD_start_daemon(flags, port, apc, apc_cls, &promhttp_handler, NULL, MHD_OPTION_END);
 }
+
+// Starts a daemon listening on port, or on listen_fd when it is not negative; limits may be NULL
+static struct MHD_Daemon* promhttp_start(unsigned int flags, unsigned short port, int listen_fd,
+                                         MHD_AcceptPolicyCallback apc, void* apc_cls, const promhttp_limits_t* limits)
+{
+    struct MHD_OptionItem options[6];
+    size_t count = 0;
+    if (listen_fd >= 0)
+        options[count++] = (struct MHD_OptionItem){MHD_OPTION_LISTEN_SOCKET, listen_fd, NULL};
+    if (limits != NULL)
+    {
+        if (limits->thread_pool_size > 1)
+            options[count++] = (struct MHD_OptionItem){MHD_OPTION_THREAD_POOL_SIZE, limits->thread_pool_size, NULL};
+        if (limits->connection_limit > 0)
+            options[count++] = (struct MHD_OptionItem){
+                MHD_OPTION_CONNECTION_LIMIT, limits->connection_limit + limits->overload_headroom, NULL};
+        if (limits->per_ip_connection_limit > 0)
+            options[count++] =
+                (struct MHD_OptionItem){MHD_OPTION_PER_IP_CONNECTION_LIMIT, limits->per_ip_connection_limit, NULL};
+        options[count++] = (struct MHD_OptionItem){MHD_OPTION_CONNECTION_TIMEOUT, limits->connection_timeout, NULL};
+        atomic_store(&promhttp_overload_threshold, limits->connection_limit);
+    }
+    options[count] = (struct MHD_OptionItem){MHD_OPTION_END, 0, NULL};
+
+    return MHD_start_daemon(flags, port, apc, apc_cls, &promhttp_handler, NULL, MHD_OPTION_NOTIFY_CONNECTION,
+                            &promhttp_notify_connection, NULL, MHD_OPTION_ARRAY, options, MHD_OPTION_END);
+}
+
+struct MHD_Daemon* promhttp_start_daemon_with_limits(unsigned int flags, unsigned short port,
+                                                     MHD_AcceptPolicyCallback apc, void* apc_cls,
+                                                     const promhttp_limits_t* limits)
+{
+    if (limits == NULL)
+        return promhttp_start_daemon(flags, port, apc, apc_cls);
+    return promhttp_start(flags, port, -1, apc, apc_cls, limits);
+}
+
+struct MHD_Daemon* promhttp_start_daemon_on_socket(unsigned int flags, int listen_fd, MHD_AcceptPolicyCallback apc,
+                                                   void* apc_cls, const promhttp_limits_t* limits)
+{
+    if (listen_fd < 0)
+        return NULL;
+    return promhttp_start(flags, 0, listen_fd, apc, apc_cls, limits);
+}
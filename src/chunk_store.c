@@ -0,0 +1,326 @@
+#include "chunk_store.h"
+#include "gorilla.h"
+#include "history_file.h"
+#include "series.h"
+#include "timing.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define SECONDS_PER_HOUR 3600
+#define MILLISECONDS_PER_SECOND 1000LL
+#define NO_TIMESTAMP 0
+#define BITS_PER_BYTE 8
+
+/**
+ * @brief Chunks de una serie.
+ */
+typedef struct
+{
+    gorilla_chunk_t head;     /**< Chunk abierto. */
+    gorilla_chunk_t* sealed;  /**< Anillo de chunks cerrados, del más antiguo al más reciente desde first. */
+    uint64_t* sequences;      /**< Secuencia en el archivo de cada chunk cerrado (o HISTORY_FILE_NOT_PERSISTED). */
+    size_t first;             /**< Posición del chunk cerrado más antiguo. */
+    size_t count;             /**< Chunks cerrados en el anillo. */
+    uint64_t name_hash;       /**< Identificador de la serie en el archivo de historial. */
+} store_series_t;
+
+/** Chunks de cada serie, en el orden de la tabla de series */
+static store_series_t store_series[MAX_SERIES];
+
+/** Series con almacén, 0 si está desactivado */
+static size_t store_series_total = 0;
+
+/** Capacidad del anillo de chunks cerrados de cada serie */
+static size_t store_max_sealed = 0;
+
+/** Retención en milisegundos */
+static long long store_retention_ms = 0;
+
+/** Protege los chunks: el colector escribe mientras los hilos HTTP consultan */
+static pthread_mutex_t store_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int chunk_store_init(unsigned int retention_hours)
+{
+    if (retention_hours == 0)
+    {
+        return SUCCESS;
+    }
+
+    // A una muestra por segundo la retención ocupa esta cantidad de chunks; con intervalos mayores sobran lugares
+    store_max_sealed = ((size_t)retention_hours * SECONDS_PER_HOUR + GORILLA_CHUNK_SAMPLES - 1) / GORILLA_CHUNK_SAMPLES;
+    store_retention_ms = (long long)retention_hours * SECONDS_PER_HOUR * MILLISECONDS_PER_SECOND;
+
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        gorilla_chunk_init(&store_series[i].head);
+        store_series[i].sealed = calloc(store_max_sealed, sizeof(gorilla_chunk_t));
+        store_series[i].sequences = calloc(store_max_sealed, sizeof(uint64_t));
+        store_series[i].name_hash = history_file_hash(series_get(i)->name);
+        if (store_series[i].sealed == NULL || store_series[i].sequences == NULL)
+        {
+            fprintf(stderr, "Error allocating history store\n");
+            return ERROR;
+        }
+    }
+    store_series_total = count;
+    return SUCCESS;
+}
+
+int chunk_store_enabled(void)
+{
+    return store_series_total > 0;
+}
+
+/**
+ * @brief Quita del anillo el chunk cerrado más antiguo; la memoria solo se libera si no está en el mapeo del archivo.
+ */
+static void drop_oldest(store_series_t* series)
+{
+    gorilla_chunk_t* chunk = &series->sealed[series->first];
+    if (series->sequences[series->first] == HISTORY_FILE_NOT_PERSISTED)
+    {
+        gorilla_chunk_free(chunk);
+    }
+    else
+    {
+        gorilla_chunk_init(chunk);
+    }
+    series->first = (series->first + 1) % store_max_sealed;
+    series->count--;
+}
+
+/**
+ * @brief Pasa un chunk cerrado al final del anillo, desplazando el más antiguo si está lleno.
+ */
+static void push_sealed(store_series_t* series, const gorilla_chunk_t* chunk, uint64_t sequence)
+{
+    if (series->count == store_max_sealed)
+    {
+        drop_oldest(series);
+    }
+    size_t position = (series->first + series->count) % store_max_sealed;
+    series->sealed[position] = *chunk;
+    series->sequences[position] = sequence;
+    series->count++;
+}
+
+/**
+ * @brief Quita los chunks más antiguos que la retención.
+ */
+static void drop_expired(store_series_t* series, long long now_ms)
+{
+    while (series->count > 0 && series->sealed[series->first].last_timestamp < now_ms - store_retention_ms)
+    {
+        drop_oldest(series);
+    }
+}
+
+/**
+ * @brief Quita de todas las series los chunks cuyo bloque del archivo fue pisado por una escritura.
+ *
+ * El archivo pisa los bloques en el orden en que se escribieron, así que los afectados son siempre los más antiguos
+ * de cada anillo.
+ */
+static void drop_overwritten(void)
+{
+    for (size_t i = 0; i < store_series_total; i++)
+    {
+        store_series_t* series = &store_series[i];
+        while (series->count > 0 && series->sequences[series->first] != HISTORY_FILE_NOT_PERSISTED &&
+               !history_file_block_intact(series->sealed[series->first].data, series->sequences[series->first]))
+        {
+            drop_oldest(series);
+        }
+    }
+}
+
+/**
+ * @brief Cierra el chunk abierto, lo pasa al anillo (y al archivo, si hay uno) y quita los chunks vencidos o
+ * desplazados.
+ */
+static void seal_head(store_series_t* series, long long now_ms)
+{
+    gorilla_chunk_seal(&series->head);
+    uint64_t sequence = HISTORY_FILE_NOT_PERSISTED;
+    uint8_t* mapped = history_file_append(series->name_hash, &series->head, &sequence);
+    if (mapped != NULL)
+    {
+        // Desde ahora las consultas leen la copia del archivo
+        free(series->head.data);
+        series->head.data = mapped;
+        series->head.capacity = 0;
+    }
+    push_sealed(series, &series->head, sequence);
+    gorilla_chunk_init(&series->head);
+
+    drop_expired(series, now_ms);
+    if (mapped != NULL)
+    {
+        drop_overwritten();
+    }
+}
+
+/**
+ * @brief Agrega al anillo de su serie un chunk recuperado del archivo.
+ */
+static void load_block(const history_file_block_t* block, uint8_t* data, void* ctx)
+{
+    (void)ctx;
+    for (size_t i = 0; i < store_series_total; i++)
+    {
+        store_series_t* series = &store_series[i];
+        if (series->name_hash != block->series_hash)
+        {
+            continue;
+        }
+        // Un bloque que no es posterior al último cargado corresponde a un reloj que retrocedió; se ignora
+        size_t newest = (series->first + series->count - 1) % store_max_sealed;
+        if (series->count > 0 && block->first_timestamp <= series->sealed[newest].last_timestamp)
+        {
+            return;
+        }
+        gorilla_chunk_t chunk;
+        gorilla_chunk_init(&chunk);
+        chunk.data = data;
+        chunk.bit_len = (size_t)block->data_size * BITS_PER_BYTE;
+        chunk.count = block->sample_count;
+        chunk.first_timestamp = block->first_timestamp;
+        chunk.last_timestamp = block->last_timestamp;
+        push_sealed(series, &chunk, block->sequence);
+        return;
+    }
+}
+
+int chunk_store_open_file(const char* path, size_t size)
+{
+    if (store_series_total == 0)
+    {
+        fprintf(stderr, "Error: the history file requires the history store (--history-hours > 0)\n");
+        return ERROR;
+    }
+
+    pthread_mutex_lock(&store_lock);
+    int result = history_file_open(path, size, load_block, NULL);
+    if (result == SUCCESS)
+    {
+        long long now_ms = timing_wall_ms();
+        for (size_t i = 0; i < store_series_total; i++)
+        {
+            drop_expired(&store_series[i], now_ms);
+        }
+    }
+    pthread_mutex_unlock(&store_lock);
+    return result;
+}
+
+/**
+ * @brief Marca de tiempo de la última muestra almacenada de una serie.
+ */
+static long long last_timestamp(const store_series_t* series)
+{
+    if (series->head.count > 0)
+    {
+        return series->head.last_timestamp;
+    }
+    if (series->count > 0)
+    {
+        return series->sealed[(series->first + series->count - 1) % store_max_sealed].last_timestamp;
+    }
+    return NO_TIMESTAMP;
+}
+
+void chunk_store_record(void)
+{
+    pthread_mutex_lock(&store_lock);
+    for (size_t i = 0; i < store_series_total; i++)
+    {
+        const series_t* source = series_get(i);
+        store_series_t* series = &store_series[i];
+        if (source->timestamp_ms == NO_TIMESTAMP || source->timestamp_ms <= last_timestamp(series))
+        {
+            continue;
+        }
+
+        int result = gorilla_chunk_append(&series->head, source->timestamp_ms, source->value);
+        if (result == GORILLA_FULL)
+        {
+            seal_head(series, source->timestamp_ms);
+            result = gorilla_chunk_append(&series->head, source->timestamp_ms, source->value);
+        }
+        if (result == GORILLA_ERROR)
+        {
+            fprintf(stderr, "Error storing sample of %s\n", source->name);
+        }
+    }
+    pthread_mutex_unlock(&store_lock);
+
+    // Las consultas solo leen el mapeo, así que la sincronización no necesita el bloqueo
+    history_file_sync();
+}
+
+/**
+ * @brief Recorre las muestras de un chunk dentro del intervalo.
+ */
+static size_t scan_chunk(const gorilla_chunk_t* chunk, long long since_ms, long long until_ms,
+                         chunk_store_visitor_t visitor, void* ctx)
+{
+    if (chunk->count == 0 || chunk->last_timestamp <= since_ms || chunk->first_timestamp > until_ms)
+    {
+        return 0;
+    }
+
+    size_t visited = 0;
+    gorilla_iter_t iter;
+    gorilla_iter_init(&iter, chunk->data, chunk->count);
+    int64_t timestamp;
+    double value;
+    while (gorilla_iter_next(&iter, &timestamp, &value) && timestamp <= until_ms)
+    {
+        if (timestamp > since_ms)
+        {
+            visitor(timestamp, value, ctx);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+size_t chunk_store_scan(size_t series_index, long long since_ms, long long until_ms, chunk_store_visitor_t visitor,
+                        void* ctx)
+{
+    size_t visited = 0;
+    pthread_mutex_lock(&store_lock);
+    if (series_index < store_series_total)
+    {
+        const store_series_t* series = &store_series[series_index];
+        for (size_t i = 0; i < series->count; i++)
+        {
+            visited += scan_chunk(&series->sealed[(series->first + i) % store_max_sealed], since_ms, until_ms,
+                                  visitor, ctx);
+        }
+        visited += scan_chunk(&series->head, since_ms, until_ms, visitor, ctx);
+    }
+    pthread_mutex_unlock(&store_lock);
+    return visited;
+}
+
+size_t chunk_store_bytes(void)
+{
+    size_t bytes = 0;
+    pthread_mutex_lock(&store_lock);
+    for (size_t i = 0; i < store_series_total; i++)
+    {
+        const store_series_t* series = &store_series[i];
+        for (size_t j = 0; j < series->count; j++)
+        {
+            bytes += gorilla_chunk_size(&series->sealed[(series->first + j) % store_max_sealed]);
+        }
+        bytes += gorilla_chunk_size(&series->head);
+    }
+    pthread_mutex_unlock(&store_lock);
+    return bytes;
+}
@@ -0,0 +1,383 @@
+#include "collector_runner.h"
+#include "governor.h"
+#include "rate_state.h"
+#include "self_metrics.h"
+#include "series.h"
+#include "timing.h"
+#include <errno.h>
+#include <prom.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define COLLECTOR_LABELS 1
+#define NANOSECONDS_PER_MILLISECOND 1000000LL
+
+// Grupos distintos que pueden tener un hilo propio
+#define MAX_WORKERS 16
+
+// Nombre del collector vacío que reemplaza a un grupo vencido sin métricas de muestreo en el render
+#define STALE_COLLECTOR "stale"
+
+/** Hilo de un grupo y el estado de su última actualización */
+typedef struct
+{
+    const char* collector;
+    void (*update)(void);
+    prom_collector_t* group; /**< Collector del grupo, o NULL si sus métricas están en el collector por defecto */
+    prom_collector_t* stale_view; /**< Lo que se muestra del grupo mientras está vencido */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t start;    /**< Avisa al hilo que hay una actualización pendiente */
+    pthread_cond_t finished; /**< Avisa al ciclo que la actualización terminó; usa CLOCK_MONOTONIC */
+    int pending;             /**< Actualización pedida y todavía no tomada por el hilo */
+    int busy;                /**< Actualización pedida y todavía no terminada */
+    int late;                /**< Actualización que venció el plazo y cuya CPU no se cargó al gobernador */
+    double cpu_seconds;      /**< CPU del hilo en la última actualización */
+    rate_state_t state;      /**< Copia del estado de tasas sobre la que trabaja el hilo */
+    series_batch_t batch;    /**< Escrituras de series de la última actualización */
+    int stale;               /**< Venció el plazo; atómico, lo leen los hilos HTTP en cada render */
+    prom_metric_sample_t* timeouts_sample;
+    prom_metric_sample_t* stale_sample;
+} worker_t;
+
+/**
+ * Las entradas se completan antes de publicar la cantidad y nunca se mueven, así que los hilos HTTP pueden
+ * recorrerlas sin lock hasta la cantidad publicada.
+ */
+static worker_t workers[MAX_WORKERS];
+static size_t worker_count = 0;
+
+static unsigned int deadline;
+static prom_collector_t* empty_collector;
+
+/**
+ * Métricas de cada grupo que mantienen al día otros hilos. Cada collector de esta tabla no se registra y nunca se
+ * destruye: sus métricas también están en el collector del grupo, que es el dueño.
+ */
+static struct
+{
+    const char* collector;
+    prom_collector_t* metrics;
+} sampled_groups[MAX_WORKERS];
+static size_t sampled_group_count = 0;
+
+/** Etiqueta de las métricas de vencimientos */
+static const char* collector_label[] = {"collector"};
+
+/** Métricas de vencimientos; NULL hasta collector_runner_init */
+static prom_counter_t* timeouts_metric;
+static prom_gauge_t* stale_metric;
+
+/**
+ * @brief Collect de un grupo con hilo propio: sin métricas mientras el grupo está vencido.
+ */
+static prom_map_t* collect_unless_stale(prom_collector_t* self)
+{
+    size_t count = __atomic_load_n(&worker_count, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (workers[i].group == self && __atomic_load_n(&workers[i].stale, __ATOMIC_RELAXED))
+        {
+            return prom_collector_default_collect(workers[i].stale_view);
+        }
+    }
+    return prom_collector_default_collect(self);
+}
+
+/**
+ * @brief Agrega una métrica al collector de la autoinstrumentación, o al registro si no existe.
+ */
+static int add_self_metric(prom_metric_t* metric)
+{
+    prom_collector_t* collector =
+        prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, SELF_COLLECTOR);
+    return collector != NULL ? prom_collector_add_metric(collector, metric)
+                             : prom_collector_registry_register_metric(metric);
+}
+
+int collector_runner_init(unsigned int deadline_ms)
+{
+    deadline = deadline_ms;
+    if (deadline == 0)
+    {
+        return SUCCESS;
+    }
+
+    timeouts_metric = prom_counter_new("collector_timeouts_total",
+                                       "Ticks in which a group of metrics missed its deadline", COLLECTOR_LABELS,
+                                       collector_label);
+    if (timeouts_metric != NULL && add_self_metric(timeouts_metric) != SUCCESS)
+    {
+        prom_counter_destroy(timeouts_metric);
+        timeouts_metric = NULL;
+    }
+    stale_metric = prom_gauge_new("collector_stale",
+                                  "Whether the metrics of a group are hidden after a missed deadline",
+                                  COLLECTOR_LABELS, collector_label);
+    if (stale_metric != NULL && add_self_metric(stale_metric) != SUCCESS)
+    {
+        prom_gauge_destroy(stale_metric);
+        stale_metric = NULL;
+    }
+    empty_collector = prom_collector_new(STALE_COLLECTOR);
+    if (timeouts_metric == NULL || stale_metric == NULL || empty_collector == NULL)
+    {
+        fprintf(stderr, "Error creating collector deadline metrics\n");
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Devuelve el collector de las métricas de muestreo de un grupo, creándolo si create; NULL si no hay.
+ */
+static prom_collector_t* sampled_metrics(const char* collector, int create)
+{
+    for (size_t i = 0; i < sampled_group_count; i++)
+    {
+        if (strcmp(sampled_groups[i].collector, collector) == 0)
+        {
+            return sampled_groups[i].metrics;
+        }
+    }
+    if (!create || sampled_group_count == MAX_WORKERS)
+    {
+        return NULL;
+    }
+    prom_collector_t* metrics = prom_collector_new(collector);
+    if (metrics != NULL)
+    {
+        sampled_groups[sampled_group_count].collector = collector;
+        sampled_groups[sampled_group_count].metrics = metrics;
+        sampled_group_count++;
+    }
+    return metrics;
+}
+
+int collector_runner_add_sampled_metric(const char* collector, prom_metric_t* metric)
+{
+    prom_collector_t* group = prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, collector);
+    if (group == NULL)
+    {
+        return prom_collector_registry_register_metric(metric);
+    }
+
+    // Sin plazo los grupos nunca se ocultan y no hace falta separar estas métricas
+    prom_collector_t* metrics = deadline > 0 ? sampled_metrics(collector, 1) : NULL;
+    if (deadline > 0 && metrics == NULL)
+    {
+        fprintf(stderr, "Error creating the sampled metrics of the %s collector\n", collector);
+        return ERROR;
+    }
+    if (prom_collector_add_metric(group, metric) != SUCCESS)
+    {
+        return ERROR;
+    }
+    if (metrics != NULL && prom_collector_add_metric(metrics, metric) != SUCCESS)
+    {
+        fprintf(stderr, "Warning: A sampled metric of the %s collector will be hidden with the group\n", collector);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Hilo de un grupo: espera pedidos y actualiza las métricas, midiendo su propio tiempo de CPU.
+ *
+ * Las series y el estado de tasas no se tocan desde este hilo: la actualización escribe en la copia y el lote del
+ * grupo, que el hilo de recolección aplica solo si terminó a tiempo.
+ */
+static void* worker_thread(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    rate_state_bind(&worker->state);
+    series_defer(&worker->batch);
+    pthread_mutex_lock(&worker->lock);
+    while (1)
+    {
+        while (!worker->pending)
+        {
+            pthread_cond_wait(&worker->start, &worker->lock);
+        }
+        worker->pending = 0;
+        pthread_mutex_unlock(&worker->lock);
+
+        double cpu_start = timing_clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+        worker->update();
+        double cpu_seconds = timing_clock_seconds(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+
+        pthread_mutex_lock(&worker->lock);
+        worker->cpu_seconds = cpu_seconds;
+        worker->busy = 0;
+        pthread_cond_signal(&worker->finished);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Devuelve el hilo del grupo, creándolo la primera vez; NULL si no puede crearse.
+ *
+ * Solo el hilo de recolección agrega entradas.
+ */
+static worker_t* worker_for(const char* collector, void (*update)(void))
+{
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        if (workers[i].collector == collector || strcmp(workers[i].collector, collector) == 0)
+        {
+            return &workers[i];
+        }
+    }
+    if (worker_count == MAX_WORKERS)
+    {
+        return NULL;
+    }
+
+    worker_t* worker = &workers[worker_count];
+    memset(worker, 0, sizeof(*worker));
+    worker->collector = collector;
+    worker->update = update;
+    worker->group = prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, collector);
+    worker->stale_view = sampled_metrics(collector, 0);
+    if (worker->stale_view == NULL)
+    {
+        worker->stale_view = empty_collector;
+    }
+    const char* labels[] = {collector};
+    worker->timeouts_sample = prom_metric_sample_from_labels(timeouts_metric, labels);
+    worker->stale_sample = prom_metric_sample_from_labels(stale_metric, labels);
+    if (worker->timeouts_sample == NULL || worker->stale_sample == NULL)
+    {
+        return NULL;
+    }
+    prom_metric_sample_set(worker->stale_sample, 0);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->start, NULL);
+    pthread_cond_init(&worker->finished, &attr);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(&worker->thread, NULL, worker_thread, worker) != SUCCESS)
+    {
+        fprintf(stderr, "Warning: Could not start a thread for the %s collector, updating it inline\n", collector);
+        pthread_cond_destroy(&worker->finished);
+        pthread_cond_destroy(&worker->start);
+        pthread_mutex_destroy(&worker->lock);
+        return NULL;
+    }
+    pthread_detach(worker->thread);
+
+    // Un grupo sin collector propio comparte el por defecto con otras métricas y no se oculta
+    if (worker->group != NULL)
+    {
+        prom_collector_set_collect_fn(worker->group, collect_unless_stale);
+    }
+    __atomic_store_n(&worker_count, worker_count + 1, __ATOMIC_RELEASE);
+    return worker;
+}
+
+/**
+ * @brief Actualiza el grupo en el hilo que llama.
+ */
+static void run_inline(const char* collector, void (*update)(void))
+{
+    double start = timing_now();
+    double cpu_start = timing_clock_seconds(CLOCK_THREAD_CPUTIME_ID);
+    update();
+    governor_collector_done(collector, timing_clock_seconds(CLOCK_THREAD_CPUTIME_ID) - cpu_start);
+    self_metrics_collector_done(collector, start);
+}
+
+/**
+ * @brief Marca el grupo como vencido u oculto, o lo vuelve a mostrar.
+ */
+static void set_stale(worker_t* worker, int stale)
+{
+    if (stale)
+    {
+        prom_metric_sample_add(worker->timeouts_sample, 1);
+    }
+    if (__atomic_load_n(&worker->stale, __ATOMIC_RELAXED) != stale)
+    {
+        __atomic_store_n(&worker->stale, stale, __ATOMIC_RELAXED);
+        prom_metric_sample_set(worker->stale_sample, stale);
+    }
+}
+
+void collector_run(const char* collector, void (*update)(void))
+{
+    if (!governor_collector_due(collector))
+    {
+        return;
+    }
+    worker_t* worker = deadline > 0 ? worker_for(collector, update) : NULL;
+    if (worker == NULL)
+    {
+        run_inline(collector, update);
+        return;
+    }
+
+    pthread_mutex_lock(&worker->lock);
+
+    // Una actualización que venció el plazo ya terminó: su CPU se carga antes de que la próxima la reemplace
+    int charge_late = worker->late && !worker->busy;
+    double late_cpu_seconds = worker->cpu_seconds;
+    if (charge_late)
+    {
+        worker->late = 0;
+    }
+
+    // Sigue bloqueado desde un ciclo anterior: no se lanza otra actualización
+    if (worker->busy)
+    {
+        pthread_mutex_unlock(&worker->lock);
+        set_stale(worker, 1);
+        return;
+    }
+
+    double start = timing_now();
+    struct timespec limit;
+    timing_monotonic(&limit);
+    timing_add_ns(&limit, (long long)deadline * NANOSECONDS_PER_MILLISECOND);
+
+    // El hilo está libre: la copia y el lote pueden prepararse sin que los toque
+    worker->state = *rate_state_get();
+    worker->batch.count = 0;
+    worker->pending = 1;
+    worker->busy = 1;
+    pthread_cond_signal(&worker->start);
+    int result = SUCCESS;
+    while (worker->busy && result != ETIMEDOUT)
+    {
+        result = pthread_cond_timedwait(&worker->finished, &worker->lock, &limit);
+    }
+    int finished = !worker->busy;
+    double cpu_seconds = worker->cpu_seconds;
+    worker->late = !finished;
+    pthread_mutex_unlock(&worker->lock);
+
+    if (charge_late)
+    {
+        governor_collector_done(collector, late_cpu_seconds);
+    }
+
+    // Terminado, el hilo no vuelve a tocar la copia ni el lote hasta el próximo pedido
+    if (finished)
+    {
+        series_apply(&worker->batch);
+        *rate_state_get() = worker->state;
+        governor_collector_done(collector, cpu_seconds);
+        set_stale(worker, 0);
+    }
+    else
+    {
+        fprintf(stderr, "Collector %s missed its %u ms deadline\n", collector, deadline);
+        set_stale(worker, 1);
+    }
+    self_metrics_collector_done(collector, start);
+}
@@ -0,0 +1,412 @@
+#include "config.h"
+#include "metrics_shm.h"
+#include "microburst.h"
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/un.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define HELP_REQUESTED 1
+#define BASE_10 10
+#define BASE_8 8
+#define MAX_FILE_MODE 0777
+#define MAX_PORT 65535
+#define MAX_HTTP_THREADS 256
+#define MAX_TIMEOUT_SECONDS 3600
+#define MAX_HISTORY_HOURS 168
+#define MIN_HISTORY_FILE_MB 1
+#define MAX_HISTORY_FILE_MB 65536
+#define MAX_REMOTE_WRITE_QUEUE 100000
+// Mínimo que IPv4 garantiza sin fragmentar y máximo de un datagrama UDP
+#define MIN_UDP_MTU 576
+#define MAX_UDP_MTU 65535
+#define MAX_STREAM_QUEUE 3600
+#define MAX_SUBSAMPLE_HZ 100
+#define MAX_SUBSAMPLE_WINDOW 3600
+#define MIN_MICROBURST_INTERVAL_MS 1
+#define MAX_MICROBURST_INTERVAL_MS 10
+#define MAX_MICROBURST_THRESHOLD_MBPS 1000000
+// Última CPU que cabe en un cpu_set_t
+#define MAX_MICROBURST_CPU 1023
+#define MAX_CPU_BUDGET_MILLICORES 1000
+#define MAX_COLLECTOR_DEADLINE_MS 60000
+// Descriptores que microhttpd reserva para uso interno en modo select
+#define SELECT_RESERVED_FDS 4
+
+// Identificadores de las opciones largas, fuera del rango de los caracteres imprimibles
+enum
+{
+    OPT_PORT = 256,
+    OPT_HTTP_MODE,
+    OPT_HTTP_THREADS,
+    OPT_MAX_CONNECTIONS,
+    OPT_OVERLOAD_HEADROOM,
+    OPT_MAX_CONNECTIONS_PER_IP,
+    OPT_KEEPALIVE_TIMEOUT,
+    OPT_UNIX_SOCKET,
+    OPT_UNIX_SOCKET_MODE,
+    OPT_UNIX_SOCKET_GROUP,
+    OPT_SHM_EXPORT,
+    OPT_HISTORY_HOURS,
+    OPT_HISTORY_FILE,
+    OPT_HISTORY_FILE_SIZE,
+    OPT_STATE_FILE,
+    OPT_REMOTE_WRITE_URL,
+    OPT_REMOTE_WRITE_INTERVAL,
+    OPT_REMOTE_WRITE_QUEUE,
+    OPT_UDP_TARGET,
+    OPT_UDP_FORMAT,
+    OPT_UDP_MTU,
+    OPT_STREAM_QUEUE,
+    OPT_SUBSAMPLE_HZ,
+    OPT_SUBSAMPLE_WINDOW,
+    OPT_MICROBURST,
+    OPT_MICROBURST_INTERVAL_MS,
+    OPT_MICROBURST_THRESHOLD_MBPS,
+    OPT_MICROBURST_CPU,
+    OPT_CPU_BUDGET_MILLICORES,
+    OPT_COLLECTOR_DEADLINE_MS,
+    OPT_HELP
+};
+
+static const struct option long_options[] = {{"port", required_argument, NULL, OPT_PORT},
+                                             {"http-mode", required_argument, NULL, OPT_HTTP_MODE},
+                                             {"http-threads", required_argument, NULL, OPT_HTTP_THREADS},
+                                             {"max-connections", required_argument, NULL, OPT_MAX_CONNECTIONS},
+                                             {"overload-headroom", required_argument, NULL, OPT_OVERLOAD_HEADROOM},
+                                             {"max-connections-per-ip", required_argument, NULL,
+                                              OPT_MAX_CONNECTIONS_PER_IP},
+                                             {"keepalive-timeout", required_argument, NULL, OPT_KEEPALIVE_TIMEOUT},
+                                             {"unix-socket", required_argument, NULL, OPT_UNIX_SOCKET},
+                                             {"unix-socket-mode", required_argument, NULL, OPT_UNIX_SOCKET_MODE},
+                                             {"unix-socket-group", required_argument, NULL, OPT_UNIX_SOCKET_GROUP},
+                                             {"shm-export", required_argument, NULL, OPT_SHM_EXPORT},
+                                             {"history-hours", required_argument, NULL, OPT_HISTORY_HOURS},
+                                             {"history-file", required_argument, NULL, OPT_HISTORY_FILE},
+                                             {"history-file-size", required_argument, NULL, OPT_HISTORY_FILE_SIZE},
+                                             {"state-file", required_argument, NULL, OPT_STATE_FILE},
+                                             {"remote-write-url", required_argument, NULL, OPT_REMOTE_WRITE_URL},
+                                             {"remote-write-interval", required_argument, NULL,
+                                              OPT_REMOTE_WRITE_INTERVAL},
+                                             {"remote-write-queue", required_argument, NULL, OPT_REMOTE_WRITE_QUEUE},
+                                             {"udp-target", required_argument, NULL, OPT_UDP_TARGET},
+                                             {"udp-format", required_argument, NULL, OPT_UDP_FORMAT},
+                                             {"udp-mtu", required_argument, NULL, OPT_UDP_MTU},
+                                             {"stream-queue", required_argument, NULL, OPT_STREAM_QUEUE},
+                                             {"subsample-hz", required_argument, NULL, OPT_SUBSAMPLE_HZ},
+                                             {"subsample-window", required_argument, NULL, OPT_SUBSAMPLE_WINDOW},
+                                             {"microburst", required_argument, NULL, OPT_MICROBURST},
+                                             {"microburst-interval-ms", required_argument, NULL,
+                                              OPT_MICROBURST_INTERVAL_MS},
+                                             {"microburst-threshold-mbps", required_argument, NULL,
+                                              OPT_MICROBURST_THRESHOLD_MBPS},
+                                             {"microburst-cpu", required_argument, NULL, OPT_MICROBURST_CPU},
+                                             {"cpu-budget-millicores", required_argument, NULL,
+                                              OPT_CPU_BUDGET_MILLICORES},
+                                             {"collector-deadline-ms", required_argument, NULL,
+                                              OPT_COLLECTOR_DEADLINE_MS},
+                                             {"help", no_argument, NULL, OPT_HELP},
+                                             {NULL, 0, NULL, 0}};
+
+/**
+ * @brief Convierte un argumento en la base indicada a entero sin signo dentro de [min, max].
+ */
+static int parse_unsigned_base(const char* name, const char* text, int base, unsigned long min, unsigned long max,
+                               unsigned int* value)
+{
+    char* end = NULL;
+    errno = 0;
+    unsigned long parsed = strtoul(text, &end, base);
+    if (errno != 0 || end == text || *end != '\0' || text[0] == '-' || parsed < min || parsed > max)
+    {
+        fprintf(stderr, "Invalid value for --%s: '%s' (expected %lu-%lu)\n", name, text, min, max);
+        return ERROR;
+    }
+    *value = (unsigned int)parsed;
+    return SUCCESS;
+}
+
+/**
+ * @brief Convierte un argumento decimal a entero sin signo dentro de [min, max].
+ */
+static int parse_unsigned(const char* name, const char* text, unsigned long min, unsigned long max,
+                          unsigned int* value)
+{
+    return parse_unsigned_base(name, text, BASE_10, min, max, value);
+}
+
+void config_set_defaults(monitor_config_t* config)
+{
+    config->http_port = DEFAULT_HTTP_PORT;
+    config->http_mode = HTTP_MODE_EPOLL;
+    config->http_threads = DEFAULT_HTTP_THREADS;
+    config->max_connections = DEFAULT_MAX_CONNECTIONS;
+    config->overload_headroom = DEFAULT_OVERLOAD_HEADROOM;
+    config->max_connections_per_ip = DEFAULT_MAX_CONNECTIONS_PER_IP;
+    config->keepalive_timeout = DEFAULT_KEEPALIVE_TIMEOUT;
+    config->unix_socket_path = NULL;
+    config->unix_socket_mode = DEFAULT_UNIX_SOCKET_MODE;
+    config->unix_socket_group = NULL;
+    config->shm_export_path = NULL;
+    config->history_hours = DEFAULT_HISTORY_HOURS;
+    config->history_file_path = NULL;
+    config->history_file_mb = DEFAULT_HISTORY_FILE_MB;
+    config->state_file_path = NULL;
+    config->remote_write_url = NULL;
+    config->remote_write_interval = DEFAULT_REMOTE_WRITE_INTERVAL;
+    config->remote_write_queue = DEFAULT_REMOTE_WRITE_QUEUE;
+    config->udp_target = NULL;
+    config->udp_format = UDP_FORMAT_STATSD;
+    config->udp_mtu = DEFAULT_UDP_MTU;
+    config->stream_queue = DEFAULT_STREAM_QUEUE;
+    config->subsample_hz = DEFAULT_SUBSAMPLE_HZ;
+    config->subsample_window = DEFAULT_SUBSAMPLE_WINDOW;
+    config->microburst_interfaces = NULL;
+    config->microburst_interval_ms = DEFAULT_MICROBURST_INTERVAL_MS;
+    config->microburst_threshold = 0;
+    config->microburst_cpu = MICROBURST_NO_CPU;
+    config->cpu_budget_millicores = 0;
+    config->collector_deadline_ms = DEFAULT_COLLECTOR_DEADLINE_MS;
+}
+
+int config_parse_args(monitor_config_t* config, int argc, char* argv[])
+{
+    int result = SUCCESS;
+    int option;
+    unsigned int cpu;
+
+    optind = 1;
+    while (result == SUCCESS && (option = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        switch (option)
+        {
+        case OPT_PORT:
+            result = parse_unsigned("port", optarg, 1, MAX_PORT, &config->http_port);
+            break;
+        case OPT_HTTP_MODE:
+            if (strcmp(optarg, "select") == 0)
+            {
+                config->http_mode = HTTP_MODE_SELECT;
+            }
+            else if (strcmp(optarg, "epoll") == 0)
+            {
+                config->http_mode = HTTP_MODE_EPOLL;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid value for --http-mode: '%s' (expected select or epoll)\n", optarg);
+                result = ERROR;
+            }
+            break;
+        case OPT_HTTP_THREADS:
+            result = parse_unsigned("http-threads", optarg, 1, MAX_HTTP_THREADS, &config->http_threads);
+            break;
+        case OPT_MAX_CONNECTIONS:
+            result = parse_unsigned("max-connections", optarg, 1, FD_SETSIZE * FD_SETSIZE, &config->max_connections);
+            break;
+        case OPT_OVERLOAD_HEADROOM:
+            result = parse_unsigned("overload-headroom", optarg, 0, FD_SETSIZE * FD_SETSIZE,
+                                    &config->overload_headroom);
+            break;
+        case OPT_MAX_CONNECTIONS_PER_IP:
+            result = parse_unsigned("max-connections-per-ip", optarg, 0, FD_SETSIZE * FD_SETSIZE,
+                                    &config->max_connections_per_ip);
+            break;
+        case OPT_KEEPALIVE_TIMEOUT:
+            result = parse_unsigned("keepalive-timeout", optarg, 0, MAX_TIMEOUT_SECONDS, &config->keepalive_timeout);
+            break;
+        case OPT_UNIX_SOCKET:
+            // sun_path debe alojar la ruta y su terminador; en el espacio abstracto el '@' ocupa el byte nulo inicial
+            if (optarg[0] == '\0' || strlen(optarg) >= sizeof(((struct sockaddr_un*)NULL)->sun_path))
+            {
+                fprintf(stderr, "Invalid value for --unix-socket: '%s' (empty or too long)\n", optarg);
+                result = ERROR;
+            }
+            else
+            {
+                config->unix_socket_path = optarg;
+            }
+            break;
+        case OPT_UNIX_SOCKET_MODE:
+            result =
+                parse_unsigned_base("unix-socket-mode", optarg, BASE_8, 0, MAX_FILE_MODE, &config->unix_socket_mode);
+            break;
+        case OPT_UNIX_SOCKET_GROUP:
+            config->unix_socket_group = optarg;
+            break;
+        case OPT_SHM_EXPORT:
+            config->shm_export_path = optarg;
+            break;
+        case OPT_HISTORY_HOURS:
+            result = parse_unsigned("history-hours", optarg, 0, MAX_HISTORY_HOURS, &config->history_hours);
+            break;
+        case OPT_HISTORY_FILE:
+            config->history_file_path = optarg;
+            break;
+        case OPT_HISTORY_FILE_SIZE:
+            result = parse_unsigned("history-file-size", optarg, MIN_HISTORY_FILE_MB, MAX_HISTORY_FILE_MB,
+                                    &config->history_file_mb);
+            break;
+        case OPT_STATE_FILE:
+            config->state_file_path = optarg;
+            break;
+        case OPT_REMOTE_WRITE_URL:
+            config->remote_write_url = optarg;
+            break;
+        case OPT_REMOTE_WRITE_INTERVAL:
+            result = parse_unsigned("remote-write-interval", optarg, 1, MAX_TIMEOUT_SECONDS,
+                                    &config->remote_write_interval);
+            break;
+        case OPT_REMOTE_WRITE_QUEUE:
+            result = parse_unsigned("remote-write-queue", optarg, 1, MAX_REMOTE_WRITE_QUEUE,
+                                    &config->remote_write_queue);
+            break;
+        case OPT_UDP_TARGET:
+            config->udp_target = optarg;
+            break;
+        case OPT_UDP_FORMAT:
+            if (strcmp(optarg, "statsd") == 0)
+            {
+                config->udp_format = UDP_FORMAT_STATSD;
+            }
+            else if (strcmp(optarg, "influx") == 0)
+            {
+                config->udp_format = UDP_FORMAT_INFLUX;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid value for --udp-format: '%s' (expected statsd or influx)\n", optarg);
+                result = ERROR;
+            }
+            break;
+        case OPT_UDP_MTU:
+            result = parse_unsigned("udp-mtu", optarg, MIN_UDP_MTU, MAX_UDP_MTU, &config->udp_mtu);
+            break;
+        case OPT_STREAM_QUEUE:
+            result = parse_unsigned("stream-queue", optarg, 1, MAX_STREAM_QUEUE, &config->stream_queue);
+            break;
+        case OPT_SUBSAMPLE_HZ:
+            result = parse_unsigned("subsample-hz", optarg, 0, MAX_SUBSAMPLE_HZ, &config->subsample_hz);
+            break;
+        case OPT_SUBSAMPLE_WINDOW:
+            result = parse_unsigned("subsample-window", optarg, 1, MAX_SUBSAMPLE_WINDOW, &config->subsample_window);
+            break;
+        case OPT_MICROBURST:
+            config->microburst_interfaces = optarg;
+            break;
+        case OPT_MICROBURST_INTERVAL_MS:
+            result = parse_unsigned("microburst-interval-ms", optarg, MIN_MICROBURST_INTERVAL_MS,
+                                    MAX_MICROBURST_INTERVAL_MS, &config->microburst_interval_ms);
+            break;
+        case OPT_MICROBURST_THRESHOLD_MBPS:
+            result = parse_unsigned("microburst-threshold-mbps", optarg, 0, MAX_MICROBURST_THRESHOLD_MBPS,
+                                    &config->microburst_threshold);
+            break;
+        case OPT_MICROBURST_CPU:
+            result = parse_unsigned("microburst-cpu", optarg, 0, MAX_MICROBURST_CPU, &cpu);
+            config->microburst_cpu = (int)cpu;
+            break;
+        case OPT_CPU_BUDGET_MILLICORES:
+            result = parse_unsigned("cpu-budget-millicores", optarg, 0, MAX_CPU_BUDGET_MILLICORES,
+                                    &config->cpu_budget_millicores);
+            break;
+        case OPT_COLLECTOR_DEADLINE_MS:
+            result = parse_unsigned("collector-deadline-ms", optarg, 0, MAX_COLLECTOR_DEADLINE_MS,
+                                    &config->collector_deadline_ms);
+            break;
+        case OPT_HELP:
+            return HELP_REQUESTED;
+        default:
+            result = ERROR;
+            break;
+        }
+    }
+
+    if (result == SUCCESS && optind < argc)
+    {
+        fprintf(stderr, "Unexpected argument: '%s'\n", argv[optind]);
+        result = ERROR;
+    }
+
+    // select() no puede vigilar descriptores por encima de FD_SETSIZE
+    if (result == SUCCESS && config->http_mode == HTTP_MODE_SELECT &&
+        config->max_connections + config->overload_headroom > FD_SETSIZE - SELECT_RESERVED_FDS)
+    {
+        fprintf(stderr, "--max-connections plus --overload-headroom must not exceed %d in select mode\n",
+                FD_SETSIZE - SELECT_RESERVED_FDS);
+        result = ERROR;
+    }
+
+    // El archivo guarda los chunks del almacén comprimido
+    if (result == SUCCESS && config->history_file_path != NULL && config->history_hours == 0)
+    {
+        fprintf(stderr, "--history-file requires --history-hours greater than 0\n");
+        result = ERROR;
+    }
+
+    return result;
+}
+
+void config_print_usage(const char* program)
+{
+    printf("Uso: %s [opciones]\n", program);
+    printf("  --port N                    Puerto HTTP (por defecto %d)\n", DEFAULT_HTTP_PORT);
+    printf("  --http-mode select|epoll    Modo de atención de conexiones (por defecto epoll)\n");
+    printf("  --http-threads N            Hilos del pool HTTP (por defecto %d)\n", DEFAULT_HTTP_THREADS);
+    printf("  --max-connections N         Conexiones atendidas antes de responder 503 (por defecto %d)\n",
+           DEFAULT_MAX_CONNECTIONS);
+    printf("  --overload-headroom N       Conexiones extra aceptadas para responder 503 (por defecto %d)\n",
+           DEFAULT_OVERLOAD_HEADROOM);
+    printf("  --max-connections-per-ip N  Conexiones por dirección IP, 0 sin límite (por defecto %d)\n",
+           DEFAULT_MAX_CONNECTIONS_PER_IP);
+    printf("  --keepalive-timeout S       Segundos antes de cerrar una conexión inactiva (por defecto %d)\n",
+           DEFAULT_KEEPALIVE_TIMEOUT);
+    printf("  --unix-socket PATH          Expone también las métricas en un socket Unix; '@nombre' usa el espacio\n");
+    printf("                              abstracto, sin permisos de sistema de archivos\n");
+    printf("  --unix-socket-mode MODE     Permisos octales del socket Unix (por defecto %04o)\n",
+           DEFAULT_UNIX_SOCKET_MODE);
+    printf("  --unix-socket-group GROUP   Grupo dueño del socket Unix\n");
+    printf("  --shm-export PATH           Publica los valores en memoria compartida (p. ej. %s)\n",
+           METRICS_SHM_DEFAULT_PATH);
+    printf("  --history-hours N           Horas de historial comprimido por serie, 0 lo desactiva (por defecto %d)\n",
+           DEFAULT_HISTORY_HOURS);
+    printf("  --history-file PATH         Persiste el historial comprimido en un archivo mapeado en memoria\n");
+    printf("  --history-file-size MB      Tamaño del archivo de historial (por defecto %d)\n", DEFAULT_HISTORY_FILE_MB);
+    printf("  --state-file PATH           Guarda las lecturas anteriores para calcular tasas desde el primer ciclo\n");
+    printf("                              tras un reinicio del proceso\n");
+    printf("  --remote-write-url URL      Envía las series a un receptor remote_write (http://host:puerto/ruta)\n");
+    printf("  --remote-write-interval S   Segundos de lecturas por lote enviado (por defecto %d)\n",
+           DEFAULT_REMOTE_WRITE_INTERVAL);
+    printf("  --remote-write-queue N      Lotes en espera antes de descartar el más antiguo (por defecto %d)\n",
+           DEFAULT_REMOTE_WRITE_QUEUE);
+    printf("  --udp-target HOST:PUERTO    Envía cada ciclo por UDP como registros de texto ([v6]:puerto para IPv6)\n");
+    printf("  --udp-format statsd|influx  Formato de los registros UDP (por defecto statsd)\n");
+    printf("  --udp-mtu N                 MTU hacia el destino UDP, para no fragmentar (por defecto %d)\n",
+           DEFAULT_UDP_MTU);
+    printf("  --stream-queue N            Ciclos pendientes por cliente de /stream antes de desconectarlo\n");
+    printf("                              (por defecto %d)\n", DEFAULT_STREAM_QUEUE);
+    printf("  --subsample-hz N            Lecturas por segundo de CPU, cola de ejecución y red para publicar su\n");
+    printf("                              distribución en cada ciclo, 0 lo desactiva (por defecto %d)\n",
+           DEFAULT_SUBSAMPLE_HZ);
+    printf("  --subsample-window N        Segundos de lecturas que cubren los cuantiles; conviene que supere en un\n");
+    printf("                              tercio al intervalo de scrape (por defecto %d)\n", DEFAULT_SUBSAMPLE_WINDOW);
+    printf("  --microburst IF[,IF...]     Lee los contadores de bytes de sysfs de las interfaces cada pocos\n");
+    printf("                              milisegundos y publica picos de tasa y ráfagas por ciclo\n");
+    printf("  --microburst-interval-ms N  Milisegundos entre lecturas, de %d a %d (por defecto %d)\n",
+           MIN_MICROBURST_INTERVAL_MS, MAX_MICROBURST_INTERVAL_MS, DEFAULT_MICROBURST_INTERVAL_MS);
+    printf("  --microburst-threshold-mbps N\n");
+    printf("                              Tasa en Mbit/s que define una ráfaga (por defecto el 80%% de la\n");
+    printf("                              velocidad del enlace)\n");
+    printf("  --microburst-cpu N          Fija el hilo de lectura a la CPU N\n");
+    printf("  --cpu-budget-millicores N   CPU de los grupos en milésimas de núcleo; por encima se estiran los\n");
+    printf("                              intervalos de los grupos más caros (por defecto sin límite)\n");
+    printf("  --collector-deadline-ms N   Plazo de cada grupo en su propio hilo; al vencer se ocultan sus\n");
+    printf("                              métricas, 0 los actualiza en el ciclo (por defecto %d)\n",
+           DEFAULT_COLLECTOR_DEADLINE_MS);
+    printf("  --help                      Muestra esta ayuda\n");
+}
@@ -11,8 +11,11 @@
 #define NO_LABELS 0
 #define ERROR_VALUE_DOUBLE -1.0
 #define ZERO_VALUE_DOUBLE 0.0
-#define HTTP_SERVER_PORT 8000
-#define SLEEP_INTERVAL_SECONDS 1
+#define SINGLE_THREAD 1
+#define NO_SOCKET -1
+#define UNIX_LISTEN_BACKLOG 64
+#define ALL_PERMISSIONS 0777
+#define NO_GROUP_CHANGE ((gid_t)-1)
 #define SINGLE_MATCH 1
 #define PRINTF_DECIMAL_PRECISION 1
 #define PRINTF_RATIO_PRECISION 3
@@ -28,6 +31,14 @@ static prom_gauge_t* cpu_usage_metric;
 /** Prometheus metric for memory usage */
 static prom_gauge_t* memory_usage_metric;
 
+/** Collectors por grupo de métricas; NULL si no pudo registrarse y sus métricas van al collector por defecto */
+static prom_collector_t* cpu_collector;
+static prom_collector_t* memory_collector;
+static prom_collector_t* disk_collector;
+static prom_collector_t* network_collector;
+static prom_collector_t* processes_collector;
+static prom_collector_t* context_collector;
+
 // Global variables
 
 // Memoria
@@ -67,10 +78,11 @@ prom_gauge_t* process_load_ratio_metric;
 void update_cpu_gauge()
 {
     double usage = get_cpu_usage();
+    long long read_ms = get_read_timestamp_ms();
     if (usage >= ZERO_VALUE_DOUBLE)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(cpu_usage_metric, usage, NULL);
+        series_set(cpu_usage_metric, usage, read_ms);
         pthread_mutex_unlock(&lock);
     }
     else
@@ -85,17 +97,18 @@ void update_memory_gauges()
 
     if (get_memory_info(&mem_info) == SUCCESS)
     {
+        long long read_ms = get_read_timestamp_ms();
         pthread_mutex_lock(&lock);
 
         // Actualizar las tres métricas
-        prom_gauge_set(memory_total_metric, (double)mem_info.total_mem, NULL);
-        prom_gauge_set(memory_used_metric, (double)mem_info.used_mem, NULL);
-        prom_gauge_set(memory_available_metric, (double)mem_info.available_mem, NULL);
+        series_set(memory_total_metric, (double)mem_info.total_mem, read_ms);
+        series_set(memory_used_metric, (double)mem_info.used_mem, read_ms);
+        series_set(memory_available_metric, (double)mem_info.available_mem, read_ms);
 
         if (mem_info.total_mem > ZERO)
         {
             double usage_percentage = ((double)mem_info.used_mem / (double)mem_info.total_mem) * PERCENTAGE;
-            prom_gauge_set(memory_usage_metric, usage_percentage, NULL);
+            series_set(memory_usage_metric, usage_percentage, read_ms);
         }
 
         pthread_mutex_unlock(&lock);
@@ -111,8 +124,7 @@ void update_memory_gauges()
 
 void update_disk_metrics()
 {
-    static disk_stats_t prev_stats = {SUCCESS};
-    static time_t prev_time = SUCCESS;
+    disk_rate_state_t* prev = &rate_state_get()->disk;
     static char* primary_disk = NULL;
     static int first_run = FIRST_RUN_FLAG;
 
@@ -128,27 +140,29 @@ void update_disk_metrics()
         }
     }
 
-    disk_stats_t current_stats;
-    time_t current_time = time(NULL);
+    disk_stats_t current_stats = {SUCCESS};
+    double current_time = timing_now();
 
     if (get_disk_stats(primary_disk, &current_stats) == SUCCESS)
     {
-        // Solo calcular métricas después de la primera lectura
-        if (prev_time > SUCCESS)
+        long long read_ms = get_read_timestamp_ms();
+
+        // Solo calcular métricas con una lectura anterior del mismo disco (puede venir de la ejecución anterior)
+        if (prev->valid && strcmp(prev->stats.device_name, current_stats.device_name) == SUCCESS)
         {
-            double time_delta = current_time - prev_time;
+            double time_delta = current_time - prev->monotonic_seconds;
             if (time_delta > ZERO_VALUE_DOUBLE)
             {
                 disk_health_metrics_t health;
-                calculate_disk_health(&current_stats, &prev_stats, time_delta, &health);
+                calculate_disk_health(&current_stats, &prev->stats, time_delta, &health);
 
                 pthread_mutex_lock(&lock);
 
                 // Exponer solo las métricas esenciales
-                prom_gauge_set(disk_read_rate_metric, health.read_rate, NULL);
-                prom_gauge_set(disk_write_rate_metric, health.write_rate, NULL);
-                prom_gauge_set(disk_utilization_metric, health.io_utilization, NULL);
-                prom_gauge_set(disk_queue_depth_metric, health.queue_depth, NULL);
+                series_set(disk_read_rate_metric, health.read_rate, read_ms);
+                series_set(disk_write_rate_metric, health.write_rate, read_ms);
+                series_set(disk_utilization_metric, health.io_utilization, read_ms);
+                series_set(disk_queue_depth_metric, health.queue_depth, read_ms);
 
                 pthread_mutex_unlock(&lock);
 
@@ -158,15 +172,15 @@ void update_disk_metrics()
             }
         }
 
-        prev_stats = current_stats;
-        prev_time = current_time;
+        prev->stats = current_stats;
+        prev->monotonic_seconds = current_time;
+        prev->valid = BOOL_TRUE;
     }
 }
 
 void update_network_metrics()
 {
-    static network_interface_stats_t prev_stats = {SUCCESS};
-    static time_t prev_time = SUCCESS;
+    network_rate_state_t* prev = &rate_state_get()->network;
     static char* primary_interface = NULL;
     static int first_run = FIRST_RUN_FLAG;
 
@@ -182,30 +196,32 @@ void update_network_metrics()
         }
     }
 
-    network_interface_stats_t current_stats;
-    time_t current_time = time(NULL);
+    network_interface_stats_t current_stats = {SUCCESS};
+    double current_time = timing_now();
 
     if (get_network_stats(primary_interface, &current_stats) == SUCCESS)
     {
-        // Solo calcular métricas después de la primera lectura
-        if (prev_time > SUCCESS)
+        long long read_ms = get_read_timestamp_ms();
+
+        // Solo calcular métricas con una lectura anterior de la misma interfaz (puede venir de la ejecución anterior)
+        if (prev->valid && strcmp(prev->stats.interface_name, current_stats.interface_name) == SUCCESS)
         {
-            double time_delta = current_time - prev_time;
+            double time_delta = current_time - prev->monotonic_seconds;
             if (time_delta > ZERO_VALUE_DOUBLE)
             {
                 network_metrics_t metrics;
-                calculate_network_metrics(&current_stats, &prev_stats, time_delta, &metrics);
+                calculate_network_metrics(&current_stats, &prev->stats, time_delta, &metrics);
 
                 pthread_mutex_lock(&lock);
 
                 // Exponer métricas de red
-                prom_gauge_set(network_rx_rate_metric, metrics.rx_rate_bps, NULL);
-                prom_gauge_set(network_tx_rate_metric, metrics.tx_rate_bps, NULL);
-                prom_gauge_set(network_rx_packet_rate_metric, metrics.rx_packet_rate, NULL);
-                prom_gauge_set(network_tx_packet_rate_metric, metrics.tx_packet_rate, NULL);
-                prom_gauge_set(network_rx_error_rate_metric, metrics.rx_error_rate, NULL);
-                prom_gauge_set(network_tx_error_rate_metric, metrics.tx_error_rate, NULL);
-                prom_gauge_set(network_bandwidth_usage_metric, metrics.total_bandwidth_usage, NULL);
+                series_set(network_rx_rate_metric, metrics.rx_rate_bps, read_ms);
+                series_set(network_tx_rate_metric, metrics.tx_rate_bps, read_ms);
+                series_set(network_rx_packet_rate_metric, metrics.rx_packet_rate, read_ms);
+                series_set(network_tx_packet_rate_metric, metrics.tx_packet_rate, read_ms);
+                series_set(network_rx_error_rate_metric, metrics.rx_error_rate, read_ms);
+                series_set(network_tx_error_rate_metric, metrics.tx_error_rate, read_ms);
+                series_set(network_bandwidth_usage_metric, metrics.total_bandwidth_usage, read_ms);
 
                 pthread_mutex_unlock(&lock);
 
@@ -216,8 +232,9 @@ void update_network_metrics()
             }
         }
 
-        prev_stats = current_stats;
-        prev_time = current_time;
+        prev->stats = current_stats;
+        prev->monotonic_seconds = current_time;
+        prev->valid = BOOL_TRUE;
     }
 }
 
@@ -227,14 +244,15 @@ void update_process_metrics()
 
     if (get_process_stats(&process_stats) == SUCCESS)
     {
+        long long read_ms = get_read_timestamp_ms();
         pthread_mutex_lock(&lock);
 
         // Actualizar métricas de procesos
-        prom_gauge_set(processes_total_metric, (double)process_stats.total_processes, NULL);
-        prom_gauge_set(processes_running_metric, (double)process_stats.running_processes, NULL);
-        prom_gauge_set(processes_sleeping_metric, (double)process_stats.sleeping_processes, NULL);
-        prom_gauge_set(processes_stopped_metric, (double)process_stats.stopped_processes, NULL);
-        prom_gauge_set(processes_zombie_metric, (double)process_stats.zombie_processes, NULL);
+        series_set(processes_total_metric, (double)process_stats.total_processes, read_ms);
+        series_set(processes_running_metric, (double)process_stats.running_processes, read_ms);
+        series_set(processes_sleeping_metric, (double)process_stats.sleeping_processes, read_ms);
+        series_set(processes_stopped_metric, (double)process_stats.stopped_processes, read_ms);
+        series_set(processes_zombie_metric, (double)process_stats.zombie_processes, read_ms);
 
         pthread_mutex_unlock(&lock);
 
@@ -250,17 +268,17 @@ void update_process_metrics()
 
 void update_context_metrics()
 {
-    static context_stats_t prev_context_stats = {SUCCESS};
+    context_rate_state_t* prev = &rate_state_get()->context;
     static process_stats_t current_process_stats = {SUCCESS};
-    static time_t prev_time = SUCCESS;
-    static int first_run = FIRST_RUN_FLAG;
 
     context_stats_t current_context_stats;
-    time_t current_time = time(NULL);
+    double current_time = timing_now();
 
     // Obtener estadísticas actuales de contexto
     if (get_context_stats(&current_context_stats) == SUCCESS)
     {
+        long long read_ms = get_read_timestamp_ms();
+
         // Obtener estadísticas actuales de procesos para el ratio de carga
         if (get_process_stats(&current_process_stats) != SUCCESS)
         {
@@ -268,23 +286,23 @@ void update_context_metrics()
             return;
         }
 
-        // Solo calcular métricas después de la primera lectura
-        if (!first_run && prev_time > SUCCESS)
+        // Solo calcular métricas con una lectura anterior (puede venir de la ejecución anterior)
+        if (prev->valid)
         {
-            double time_delta = current_time - prev_time;
+            double time_delta = current_time - prev->monotonic_seconds;
             if (time_delta > ZERO_VALUE_DOUBLE)
             {
                 system_performance_metrics_t perf_metrics;
-                calculate_system_performance_metrics(&current_context_stats, &prev_context_stats,
+                calculate_system_performance_metrics(&current_context_stats, &prev->stats,
                                                      &current_process_stats, time_delta, &perf_metrics);
 
                 pthread_mutex_lock(&lock);
 
                 // Exponer métricas de rendimiento del sistema
-                prom_gauge_set(context_switches_rate_metric, perf_metrics.context_switch_rate, NULL);
-                prom_gauge_set(process_creation_rate_metric, perf_metrics.process_creation_rate, NULL);
-                prom_gauge_set(interrupt_rate_metric, perf_metrics.interrupt_rate, NULL);
-                prom_gauge_set(process_load_ratio_metric, perf_metrics.process_load_ratio, NULL);
+                series_set(context_switches_rate_metric, perf_metrics.context_switch_rate, read_ms);
+                series_set(process_creation_rate_metric, perf_metrics.process_creation_rate, read_ms);
+                series_set(interrupt_rate_metric, perf_metrics.interrupt_rate, read_ms);
+                series_set(process_load_ratio_metric, perf_metrics.process_load_ratio, read_ms);
 
                 pthread_mutex_unlock(&lock);
 
@@ -296,9 +314,9 @@ void update_context_metrics()
             }
         }
 
-        prev_context_stats = current_context_stats;
-        prev_time = current_time;
-        first_run = NOT_FIRST_RUN;
+        prev->stats = current_context_stats;
+        prev->monotonic_seconds = current_time;
+        prev->valid = BOOL_TRUE;
     }
     else
     {
@@ -306,67 +324,210 @@ void update_context_metrics()
     }
 }
 
+int open_unix_listen_socket(const monitor_config_t* config)
+{
+    struct sockaddr_un addr;
+    memset(&addr, ZERO, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    const char* path = config->unix_socket_path;
+    size_t path_len = strlen(path);
+    bool abstract = path[ZERO] == ABSTRACT_SOCKET_PREFIX;
+    socklen_t addr_len;
+    if (abstract)
+    {
+        // El nombre abstracto empieza con un byte nulo y no lleva terminador: su largo lo fija addr_len
+        memcpy(addr.sun_path + 1, path + 1, path_len - 1);
+        addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len);
+    }
+    else
+    {
+        memcpy(addr.sun_path, path, path_len);
+        addr_len = (socklen_t)sizeof(addr);
+
+        // Reemplazar solo un socket que haya quedado de una ejecución anterior, nunca otro tipo de archivo
+        struct stat st;
+        if (lstat(path, &st) == SUCCESS && S_ISSOCK(st.st_mode) && unlink(path) != SUCCESS)
+        {
+            fprintf(stderr, "Error removing stale socket %s: %s\n", path, strerror(errno));
+            return NO_SOCKET;
+        }
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, ZERO);
+    if (fd == NO_SOCKET)
+    {
+        fprintf(stderr, "Error creating Unix socket: %s\n", strerror(errno));
+        return NO_SOCKET;
+    }
+
+    // La umask restringe el socket desde su creación, sin una ventana con permisos más amplios antes del chmod
+    mode_t mode = (mode_t)config->unix_socket_mode;
+    mode_t old_umask = umask((mode_t)(~mode & ALL_PERMISSIONS));
+    int bound = bind(fd, (struct sockaddr*)&addr, addr_len);
+    umask(old_umask);
+    if (bound != SUCCESS)
+    {
+        fprintf(stderr, "Error binding Unix socket %s: %s\n", path, strerror(errno));
+        close(fd);
+        return NO_SOCKET;
+    }
+
+    if (!abstract)
+    {
+        gid_t group = NO_GROUP_CHANGE;
+        if (config->unix_socket_group != NULL)
+        {
+            struct group* entry = getgrnam(config->unix_socket_group);
+            if (entry == NULL)
+            {
+                fprintf(stderr, "Unknown group for Unix socket: %s\n", config->unix_socket_group);
+                close(fd);
+                unlink(path);
+                return NO_SOCKET;
+            }
+            group = entry->gr_gid;
+        }
+        if (chmod(path, mode) != SUCCESS || (group != NO_GROUP_CHANGE && chown(path, (uid_t)-1, group) != SUCCESS))
+        {
+            fprintf(stderr, "Error setting permissions on %s: %s\n", path, strerror(errno));
+            close(fd);
+            unlink(path);
+            return NO_SOCKET;
+        }
+    }
+
+    if (listen(fd, UNIX_LISTEN_BACKLOG) != SUCCESS)
+    {
+        fprintf(stderr, "Error listening on Unix socket %s: %s\n", path, strerror(errno));
+        close(fd);
+        if (!abstract)
+        {
+            unlink(path);
+        }
+        return NO_SOCKET;
+    }
+    return fd;
+}
+
 void* expose_metrics(void* arg)
 {
-    (void)arg; // Unused argument
+    const monitor_config_t* config = (const monitor_config_t*)arg;
 
     // Ensure HTTP handler is attached to the default registry
     promhttp_set_active_collector_registry(NULL);
 
-    // Start HTTP server on port 8000
-    struct MHD_Daemon* daemon = promhttp_start_daemon(MHD_USE_SELECT_INTERNALLY, HTTP_SERVER_PORT, NULL, NULL);
+    promhttp_limits_t limits = {
+        .thread_pool_size = config->http_mode == HTTP_MODE_EPOLL ? config->http_threads : SINGLE_THREAD,
+        .connection_limit = config->max_connections,
+        .overload_headroom = config->overload_headroom,
+        .per_ip_connection_limit = config->max_connections_per_ip,
+        .connection_timeout = config->keepalive_timeout,
+    };
+    unsigned int flags = config->http_mode == HTTP_MODE_EPOLL ? MHD_USE_EPOLL_INTERNALLY : MHD_USE_SELECT_INTERNALLY;
+    // /stream suspende las conexiones de sus clientes mientras no hay eventos que enviar
+    flags |= MHD_ALLOW_SUSPEND_RESUME;
+
+    // microhttpd atiende las conexiones en sus propios hilos; no hace falta mantener vivo un hilo propio
+    struct MHD_Daemon* daemon =
+        promhttp_start_daemon_with_limits(flags, (unsigned short)config->http_port, NULL, NULL, &limits);
     if (daemon == NULL)
     {
         fprintf(stderr, "Error starting HTTP server\n");
         return NULL;
     }
 
-    // Keep server running
-    while (BOOL_TRUE)
+    // Los lectores locales pueden usar además un socket Unix, que sirve el mismo snapshot sin pasar por TCP
+    if (config->unix_socket_path != NULL)
+    {
+        int fd = open_unix_listen_socket(config);
+        limits.per_ip_connection_limit = ZERO;
+        if (fd == NO_SOCKET || promhttp_start_daemon_on_socket(flags, fd, NULL, NULL, &limits) == NULL)
+        {
+            fprintf(stderr, "Error starting HTTP server on Unix socket %s\n", config->unix_socket_path);
+            if (fd != NO_SOCKET)
+            {
+                close(fd);
+            }
+            MHD_stop_daemon(daemon);
+            return NULL;
+        }
+    }
+    return daemon;
+}
+
+/**
+ * @brief Crea y registra el collector de un grupo de métricas, para que un scraper pueda pedir solo ese grupo.
+ * @return El collector, o NULL si no pudo registrarse.
+ */
+static prom_collector_t* new_group_collector(const char* name)
+{
+    prom_collector_t* collector = prom_collector_new(name);
+    if (collector == NULL)
+    {
+        fprintf(stderr, "Warning: Could not create %s collector\n", name);
+        return NULL;
+    }
+    if (prom_collector_registry_register_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, collector) != SUCCESS)
     {
-        sleep(SLEEP_INTERVAL_SECONDS);
+        fprintf(stderr, "Warning: Could not register %s collector\n", name);
+        prom_collector_destroy(collector);
+        return NULL;
     }
+    return collector;
+}
 
-    // Should never reach here
-    MHD_stop_daemon(daemon);
-    return NULL;
+/**
+ * @brief Registra una métrica en el collector de su grupo, o en el collector por defecto si el grupo no tiene uno.
+ */
+static int register_group_metric(prom_collector_t* collector, prom_gauge_t* metric)
+{
+    if (collector == NULL)
+    {
+        return prom_collector_registry_register_metric(metric);
+    }
+    return prom_collector_add_metric(collector, metric);
 }
 
 void init_memory_metrics()
 {
+    if (!memory_collector)
+    {
+        memory_collector = new_group_collector(MEMORY_COLLECTOR);
+    }
+
     // Crear las tres métricas
     if (!memory_total_metric)
     {
-        memory_total_metric = prom_gauge_new("memory_total_bytes", "Total system memory in bytes", NO_LABELS, NULL);
+        memory_total_metric = series_gauge_new("memory_total_bytes", "Total system memory in bytes");
     }
     if (!memory_used_metric)
     {
-        memory_used_metric = prom_gauge_new("memory_used_bytes", "Used system memory in bytes", NO_LABELS, NULL);
+        memory_used_metric = series_gauge_new("memory_used_bytes", "Used system memory in bytes");
     }
     if (!memory_available_metric)
     {
-        memory_available_metric =
-            prom_gauge_new("memory_available_bytes", "Available system memory in bytes", NO_LABELS, NULL);
+        memory_available_metric = series_gauge_new("memory_available_bytes", "Available system memory in bytes");
     }
 
     // Registrar las métricas solo si se crearon correctamente
     if (memory_total_metric)
     {
-        if (prom_collector_registry_must_register_metric(memory_total_metric) != SUCCESS)
+        if (register_group_metric(memory_collector, memory_total_metric) != SUCCESS)
         {
             fprintf(stderr, "Warning: Could not register memory_total_metric\n");
         }
     }
     if (memory_used_metric)
     {
-        if (prom_collector_registry_must_register_metric(memory_used_metric) != SUCCESS)
+        if (register_group_metric(memory_collector, memory_used_metric) != SUCCESS)
         {
             fprintf(stderr, "Warning: Could not register memory_used_metric\n");
         }
     }
     if (memory_available_metric)
     {
-        if (prom_collector_registry_must_register_metric(memory_available_metric) != SUCCESS)
+        if (register_group_metric(memory_collector, memory_available_metric) != SUCCESS)
         {
             fprintf(stderr, "Warning: Could not register memory_available_metric\n");
         }
@@ -375,136 +536,133 @@ void init_memory_metrics()
 
 void init_disk_metrics(void)
 {
+    disk_collector = new_group_collector(DISK_COLLECTOR);
+
     // Crear las métricas de disco
-    disk_read_rate_metric = prom_gauge_new("disk_read_rate", "Disk read operations per second", NO_LABELS, NULL);
+    disk_read_rate_metric = series_gauge_new("disk_read_rate", "Disk read operations per second");
 
-    disk_write_rate_metric = prom_gauge_new("disk_write_rate", "Disk write operations per second", NO_LABELS, NULL);
+    disk_write_rate_metric = series_gauge_new("disk_write_rate", "Disk write operations per second");
 
-    disk_utilization_metric =
-        prom_gauge_new("disk_utilization_percent", "Disk utilization percentage", NO_LABELS, NULL);
+    disk_utilization_metric = series_gauge_new("disk_utilization_percent", "Disk utilization percentage");
 
-    disk_avg_wait_time_metric =
-        prom_gauge_new("disk_avg_wait_time_ms", "Average disk I/O wait time in milliseconds", NO_LABELS, NULL);
+    disk_avg_wait_time_metric = series_gauge_new("disk_avg_wait_time_ms", "Average disk I/O wait time in milliseconds");
 
-    disk_queue_depth_metric = prom_gauge_new("disk_queue_depth", "Current disk I/O queue depth", NO_LABELS, NULL);
+    disk_queue_depth_metric = series_gauge_new("disk_queue_depth", "Current disk I/O queue depth");
 
     // Registrar las métricas
     if (disk_read_rate_metric)
     {
-        prom_collector_registry_must_register_metric(disk_read_rate_metric);
+        register_group_metric(disk_collector, disk_read_rate_metric);
     }
     if (disk_write_rate_metric)
     {
-        prom_collector_registry_must_register_metric(disk_write_rate_metric);
+        register_group_metric(disk_collector, disk_write_rate_metric);
     }
     if (disk_utilization_metric)
     {
-        prom_collector_registry_must_register_metric(disk_utilization_metric);
+        register_group_metric(disk_collector, disk_utilization_metric);
     }
     if (disk_avg_wait_time_metric)
     {
-        prom_collector_registry_must_register_metric(disk_avg_wait_time_metric);
+        register_group_metric(disk_collector, disk_avg_wait_time_metric);
     }
     if (disk_queue_depth_metric)
     {
-        prom_collector_registry_must_register_metric(disk_queue_depth_metric);
+        register_group_metric(disk_collector, disk_queue_depth_metric);
     }
 }
 
 void init_network_metrics(void)
 {
+    network_collector = new_group_collector(NETWORK_COLLECTOR);
+
     // Crear las métricas de red
-    network_rx_rate_metric =
-        prom_gauge_new("network_rx_rate_bps", "Network receive rate in bytes per second", NO_LABELS, NULL);
+    network_rx_rate_metric = series_gauge_new("network_rx_rate_bps", "Network receive rate in bytes per second");
 
-    network_tx_rate_metric =
-        prom_gauge_new("network_tx_rate_bps", "Network transmit rate in bytes per second", NO_LABELS, NULL);
+    network_tx_rate_metric = series_gauge_new("network_tx_rate_bps", "Network transmit rate in bytes per second");
 
     network_rx_packet_rate_metric =
-        prom_gauge_new("network_rx_packet_rate", "Network receive packet rate per second", NO_LABELS, NULL);
+        series_gauge_new("network_rx_packet_rate", "Network receive packet rate per second");
 
     network_tx_packet_rate_metric =
-        prom_gauge_new("network_tx_packet_rate", "Network transmit packet rate per second", NO_LABELS, NULL);
+        series_gauge_new("network_tx_packet_rate", "Network transmit packet rate per second");
 
     network_rx_error_rate_metric =
-        prom_gauge_new("network_rx_error_rate_percent", "Network receive error rate percentage", NO_LABELS, NULL);
+        series_gauge_new("network_rx_error_rate_percent", "Network receive error rate percentage");
 
     network_tx_error_rate_metric =
-        prom_gauge_new("network_tx_error_rate_percent", "Network transmit error rate percentage", NO_LABELS, NULL);
+        series_gauge_new("network_tx_error_rate_percent", "Network transmit error rate percentage");
 
-    network_bandwidth_usage_metric = prom_gauge_new(
-        "network_bandwidth_usage_bps", "Total network bandwidth usage in bytes per second", NO_LABELS, NULL);
+    network_bandwidth_usage_metric =
+        series_gauge_new("network_bandwidth_usage_bps", "Total network bandwidth usage in bytes per second");
 
     // Registrar las métricas
     if (network_rx_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_rx_rate_metric);
+        register_group_metric(network_collector, network_rx_rate_metric);
     }
     if (network_tx_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_tx_rate_metric);
+        register_group_metric(network_collector, network_tx_rate_metric);
     }
     if (network_rx_packet_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_rx_packet_rate_metric);
+        register_group_metric(network_collector, network_rx_packet_rate_metric);
     }
     if (network_tx_packet_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_tx_packet_rate_metric);
+        register_group_metric(network_collector, network_tx_packet_rate_metric);
     }
     if (network_rx_error_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_rx_error_rate_metric);
+        register_group_metric(network_collector, network_rx_error_rate_metric);
     }
     if (network_tx_error_rate_metric)
     {
-        prom_collector_registry_must_register_metric(network_tx_error_rate_metric);
+        register_group_metric(network_collector, network_tx_error_rate_metric);
     }
     if (network_bandwidth_usage_metric)
     {
-        prom_collector_registry_must_register_metric(network_bandwidth_usage_metric);
+        register_group_metric(network_collector, network_bandwidth_usage_metric);
     }
 }
 
 void init_process_metrics(void)
 {
     printf("DEBUG: Inicializando métricas de procesos...\n");
+    processes_collector = new_group_collector(PROCESSES_COLLECTOR);
 
     // Crear las métricas de procesos
-    processes_total_metric =
-        prom_gauge_new("processes_total", "Total number of processes in the system", NO_LABELS, NULL);
+    processes_total_metric = series_gauge_new("processes_total", "Total number of processes in the system");
 
-    processes_running_metric =
-        prom_gauge_new("processes_running", "Number of processes in running state", NO_LABELS, NULL);
+    processes_running_metric = series_gauge_new("processes_running", "Number of processes in running state");
 
-    processes_sleeping_metric =
-        prom_gauge_new("processes_sleeping", "Number of processes in sleeping state", NO_LABELS, NULL);
+    processes_sleeping_metric = series_gauge_new("processes_sleeping", "Number of processes in sleeping state");
 
-    processes_stopped_metric =
-        prom_gauge_new("processes_stopped", "Number of processes in stopped state", NO_LABELS, NULL);
+    processes_stopped_metric = series_gauge_new("processes_stopped", "Number of processes in stopped state");
 
-    processes_zombie_metric = prom_gauge_new("processes_zombie", "Number of zombie processes", NO_LABELS, NULL);
+    processes_zombie_metric = series_gauge_new("processes_zombie", "Number of zombie processes");
 
     // Registrar las métricas
     if (processes_total_metric)
     {
-        prom_collector_registry_must_register_metric(processes_total_metric);
+        register_group_metric(processes_collector, processes_total_metric);
     }
     if (processes_running_metric)
     {
-        prom_collector_registry_must_register_metric(processes_running_metric);
+        register_group_metric(processes_collector, processes_running_metric);
     }
     if (processes_sleeping_metric)
     {
-        prom_collector_registry_must_register_metric(processes_sleeping_metric);
+        register_group_metric(processes_collector, processes_sleeping_metric);
     }
     if (processes_stopped_metric)
     {
-        prom_collector_registry_must_register_metric(processes_stopped_metric);
+        register_group_metric(processes_collector, processes_stopped_metric);
     }
     if (processes_zombie_metric)
     {
-        prom_collector_registry_must_register_metric(processes_zombie_metric);
+        register_group_metric(processes_collector, processes_zombie_metric);
     }
 
     printf("DEBUG: Métricas de procesos inicializadas\n");
@@ -512,34 +670,34 @@ void init_process_metrics(void)
 
 void init_context_metrics(void)
 {
+    context_collector = new_group_collector(CONTEXT_COLLECTOR);
+
     // Crear las métricas de cambios de contexto y rendimiento del sistema
-    context_switches_rate_metric =
-        prom_gauge_new("context_switches_rate", "Context switches per second", NO_LABELS, NULL);
+    context_switches_rate_metric = series_gauge_new("context_switches_rate", "Context switches per second");
 
-    process_creation_rate_metric =
-        prom_gauge_new("process_creation_rate", "Processes created per second", NO_LABELS, NULL);
+    process_creation_rate_metric = series_gauge_new("process_creation_rate", "Processes created per second");
 
-    interrupt_rate_metric = prom_gauge_new("interrupt_rate", "Interrupts per second", NO_LABELS, NULL);
+    interrupt_rate_metric = series_gauge_new("interrupt_rate", "Interrupts per second");
 
-    process_load_ratio_metric = prom_gauge_new(
-        "process_load_ratio", "Ratio of running processes to total processes (0.0-1.0)", NO_LABELS, NULL);
+    process_load_ratio_metric =
+        series_gauge_new("process_load_ratio", "Ratio of running processes to total processes (0.0-1.0)");
 
     // Registrar las métricas
     if (context_switches_rate_metric)
     {
-        prom_collector_registry_must_register_metric(context_switches_rate_metric);
+        register_group_metric(context_collector, context_switches_rate_metric);
     }
     if (process_creation_rate_metric)
     {
-        prom_collector_registry_must_register_metric(process_creation_rate_metric);
+        register_group_metric(context_collector, process_creation_rate_metric);
     }
     if (interrupt_rate_metric)
     {
-        prom_collector_registry_must_register_metric(interrupt_rate_metric);
+        register_group_metric(context_collector, interrupt_rate_metric);
     }
     if (process_load_ratio_metric)
     {
-        prom_collector_registry_must_register_metric(process_load_ratio_metric);
+        register_group_metric(context_collector, process_load_ratio_metric);
     }
 }
 
@@ -558,14 +716,15 @@ void init_metrics()
     }
 
     // Create CPU usage metric
-    cpu_usage_metric = prom_gauge_new("cpu_usage_percentage", "CPU usage percentage", NO_LABELS, NULL);
+    cpu_collector = new_group_collector(CPU_COLLECTOR);
+    cpu_usage_metric = series_gauge_new("cpu_usage_percentage", "CPU usage percentage");
     if (cpu_usage_metric == NULL)
     {
         fprintf(stderr, "Error creating CPU usage metric\n");
     }
 
     // Create memory usage metric
-    memory_usage_metric = prom_gauge_new("memory_usage_percentage", "Memory usage percentage", NO_LABELS, NULL);
+    memory_usage_metric = series_gauge_new("memory_usage_percentage", "Memory usage percentage");
     if (memory_usage_metric == NULL)
     {
         fprintf(stderr, "Error creating memory usage metric\n");
@@ -578,10 +737,10 @@ void init_metrics()
     init_process_metrics();
     init_context_metrics();
 
-    // Register basic metrics in the default registry
+    // Register basic metrics in their group collectors
     if (cpu_usage_metric != NULL)
     {
-        if (prom_collector_registry_must_register_metric(cpu_usage_metric) != SUCCESS)
+        if (register_group_metric(cpu_collector, cpu_usage_metric) != SUCCESS)
         {
             fprintf(stderr, "Warning: Could not register CPU metric\n");
         }
@@ -589,7 +748,7 @@ void init_metrics()
 
     if (memory_usage_metric != NULL)
     {
-        if (prom_collector_registry_must_register_metric(memory_usage_metric) != SUCCESS)
+        if (register_group_metric(memory_collector, memory_usage_metric) != SUCCESS)
         {
             fprintf(stderr, "Warning: Could not register memory percentage metric\n");
         }
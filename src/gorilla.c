@@ -0,0 +1,326 @@
+#include "gorilla.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS_PER_BYTE 8
+#define TIMESTAMP_BITS 64
+#define VALUE_BITS 64
+#define INITIAL_CAPACITY 64
+#define GROWTH_FACTOR 2
+// Bits de cada rango de delta de deltas y sus prefijos: '10', '110', '1110' y '1111'
+#define DOD_SMALL_BITS 7
+#define DOD_MEDIUM_BITS 9
+#define DOD_LARGE_BITS 12
+#define DOD_HUGE_BITS 32
+#define DOD_SMALL_PREFIX 0x2
+#define DOD_MEDIUM_PREFIX 0x6
+#define DOD_LARGE_PREFIX 0xE
+#define DOD_HUGE_PREFIX 0xF
+#define DOD_SMALL_PREFIX_BITS 2
+#define DOD_MEDIUM_PREFIX_BITS 3
+#define DOD_LARGE_PREFIX_BITS 4
+#define DOD_HUGE_PREFIX_BITS 4
+// Campos de una ventana XOR nueva
+#define LEADING_BITS 5
+#define LENGTH_BITS 6
+#define MAX_LEADING 31
+// Ventana inválida: fuerza a la primera XOR no nula a declarar la suya
+#define NO_WINDOW 0xFF
+
+/**
+ * @brief Verifica que v quepa en n bits en complemento a dos.
+ */
+static int fits_signed(int64_t v, int n)
+{
+    int64_t limit = (int64_t)1 << (n - 1);
+    return v >= -limit && v < limit;
+}
+
+/**
+ * @brief Asegura lugar para nbits más en el flujo, con los bytes nuevos en cero.
+ */
+static int reserve_bits(gorilla_chunk_t* chunk, int nbits)
+{
+    size_t needed = (chunk->bit_len + (size_t)nbits + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+    if (needed <= chunk->capacity)
+    {
+        return GORILLA_OK;
+    }
+    size_t capacity = chunk->capacity > 0 ? chunk->capacity : INITIAL_CAPACITY;
+    while (capacity < needed)
+    {
+        capacity *= GROWTH_FACTOR;
+    }
+    uint8_t* data = realloc(chunk->data, capacity);
+    if (data == NULL)
+    {
+        return GORILLA_ERROR;
+    }
+    memset(data + chunk->capacity, 0, capacity - chunk->capacity);
+    chunk->data = data;
+    chunk->capacity = capacity;
+    return GORILLA_OK;
+}
+
+/**
+ * @brief Escribe los nbits menos significativos de value, del más significativo al menos; el lugar ya está reservado.
+ */
+static void write_bits(gorilla_chunk_t* chunk, uint64_t value, int nbits)
+{
+    while (nbits > 0)
+    {
+        int free_bits = BITS_PER_BYTE - (int)(chunk->bit_len % BITS_PER_BYTE);
+        int take = nbits < free_bits ? nbits : free_bits;
+        uint8_t bits = (uint8_t)((value >> (nbits - take)) & ((1u << take) - 1));
+        chunk->data[chunk->bit_len / BITS_PER_BYTE] |= (uint8_t)(bits << (free_bits - take));
+        chunk->bit_len += (size_t)take;
+        nbits -= take;
+    }
+}
+
+/**
+ * @brief Lee nbits como entero sin signo.
+ */
+static uint64_t read_bits(gorilla_iter_t* iter, int nbits)
+{
+    uint64_t value = 0;
+    while (nbits > 0)
+    {
+        int available = BITS_PER_BYTE - (int)(iter->bit_pos % BITS_PER_BYTE);
+        int take = nbits < available ? nbits : available;
+        uint8_t byte = iter->data[iter->bit_pos / BITS_PER_BYTE];
+        uint64_t bits = (uint64_t)(byte >> (available - take)) & ((1u << take) - 1);
+        value = (value << take) | bits;
+        iter->bit_pos += (size_t)take;
+        nbits -= take;
+    }
+    return value;
+}
+
+/**
+ * @brief Lee nbits en complemento a dos.
+ */
+static int64_t read_signed(gorilla_iter_t* iter, int nbits)
+{
+    uint64_t raw = read_bits(iter, nbits);
+    uint64_t sign = (uint64_t)1 << (nbits - 1);
+    return (int64_t)((raw ^ sign) - sign);
+}
+
+static uint64_t double_bits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bits_double(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void gorilla_chunk_init(gorilla_chunk_t* chunk)
+{
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->leading = NO_WINDOW;
+}
+
+int gorilla_chunk_append(gorilla_chunk_t* chunk, int64_t timestamp_ms, double value)
+{
+    uint64_t value_bits = double_bits(value);
+
+    if (chunk->count == 0)
+    {
+        if (reserve_bits(chunk, TIMESTAMP_BITS + VALUE_BITS) != GORILLA_OK)
+        {
+            return GORILLA_ERROR;
+        }
+        write_bits(chunk, (uint64_t)timestamp_ms, TIMESTAMP_BITS);
+        write_bits(chunk, value_bits, VALUE_BITS);
+        chunk->first_timestamp = timestamp_ms;
+        chunk->last_timestamp = timestamp_ms;
+        chunk->last_value_bits = value_bits;
+        chunk->count = 1;
+        return GORILLA_OK;
+    }
+
+    if (timestamp_ms <= chunk->last_timestamp)
+    {
+        return GORILLA_ERROR;
+    }
+    int64_t delta = timestamp_ms - chunk->last_timestamp;
+    int64_t dod = delta - chunk->last_delta;
+    if (chunk->count >= GORILLA_CHUNK_SAMPLES || !fits_signed(dod, DOD_HUGE_BITS))
+    {
+        return GORILLA_FULL;
+    }
+
+    // Peor caso: prefijo y delta de deltas de 32 bits, más '11', ventana nueva y 64 bits significativos
+    if (reserve_bits(chunk, DOD_HUGE_PREFIX_BITS + DOD_HUGE_BITS + 2 + LEADING_BITS + LENGTH_BITS + VALUE_BITS) !=
+        GORILLA_OK)
+    {
+        return GORILLA_ERROR;
+    }
+
+    if (dod == 0)
+    {
+        write_bits(chunk, 0, 1);
+    }
+    else if (fits_signed(dod, DOD_SMALL_BITS))
+    {
+        write_bits(chunk, DOD_SMALL_PREFIX, DOD_SMALL_PREFIX_BITS);
+        write_bits(chunk, (uint64_t)dod, DOD_SMALL_BITS);
+    }
+    else if (fits_signed(dod, DOD_MEDIUM_BITS))
+    {
+        write_bits(chunk, DOD_MEDIUM_PREFIX, DOD_MEDIUM_PREFIX_BITS);
+        write_bits(chunk, (uint64_t)dod, DOD_MEDIUM_BITS);
+    }
+    else if (fits_signed(dod, DOD_LARGE_BITS))
+    {
+        write_bits(chunk, DOD_LARGE_PREFIX, DOD_LARGE_PREFIX_BITS);
+        write_bits(chunk, (uint64_t)dod, DOD_LARGE_BITS);
+    }
+    else
+    {
+        write_bits(chunk, DOD_HUGE_PREFIX, DOD_HUGE_PREFIX_BITS);
+        write_bits(chunk, (uint64_t)dod, DOD_HUGE_BITS);
+    }
+
+    uint64_t xor = value_bits ^ chunk->last_value_bits;
+    if (xor == 0)
+    {
+        write_bits(chunk, 0, 1);
+    }
+    else
+    {
+        int leading = __builtin_clzll(xor);
+        int trailing = __builtin_ctzll(xor);
+        if (leading > MAX_LEADING)
+        {
+            leading = MAX_LEADING;
+        }
+
+        if (chunk->leading != NO_WINDOW && leading >= chunk->leading && trailing >= chunk->trailing)
+        {
+            // Los bits significativos caben en la ventana anterior
+            write_bits(chunk, 0x2, 2);
+            write_bits(chunk, xor >> chunk->trailing, VALUE_BITS - chunk->leading - chunk->trailing);
+        }
+        else
+        {
+            // 64 bits significativos no caben en 6 bits y se escriben como 0
+            int significant = VALUE_BITS - leading - trailing;
+            write_bits(chunk, 0x3, 2);
+            write_bits(chunk, (uint64_t)leading, LEADING_BITS);
+            write_bits(chunk, (uint64_t)(significant % VALUE_BITS), LENGTH_BITS);
+            write_bits(chunk, xor >> trailing, significant);
+            chunk->leading = (uint8_t)leading;
+            chunk->trailing = (uint8_t)trailing;
+        }
+    }
+
+    chunk->last_delta = delta;
+    chunk->last_timestamp = timestamp_ms;
+    chunk->last_value_bits = value_bits;
+    chunk->count++;
+    return GORILLA_OK;
+}
+
+void gorilla_chunk_seal(gorilla_chunk_t* chunk)
+{
+    size_t used = gorilla_chunk_size(chunk);
+    if (used == 0 || used == chunk->capacity)
+    {
+        return;
+    }
+    uint8_t* data = realloc(chunk->data, used);
+    if (data != NULL)
+    {
+        chunk->data = data;
+        chunk->capacity = used;
+    }
+}
+
+size_t gorilla_chunk_size(const gorilla_chunk_t* chunk)
+{
+    return (chunk->bit_len + BITS_PER_BYTE - 1) / BITS_PER_BYTE;
+}
+
+void gorilla_chunk_free(gorilla_chunk_t* chunk)
+{
+    free(chunk->data);
+    gorilla_chunk_init(chunk);
+}
+
+void gorilla_iter_init(gorilla_iter_t* iter, const uint8_t* data, uint32_t count)
+{
+    memset(iter, 0, sizeof(*iter));
+    iter->data = data;
+    iter->remaining = count;
+    iter->leading = NO_WINDOW;
+}
+
+int gorilla_iter_next(gorilla_iter_t* iter, int64_t* timestamp_ms, double* value)
+{
+    if (iter->remaining == 0)
+    {
+        return 0;
+    }
+    iter->remaining--;
+
+    if (iter->read++ == 0)
+    {
+        iter->timestamp = (int64_t)read_bits(iter, TIMESTAMP_BITS);
+        iter->value_bits = read_bits(iter, VALUE_BITS);
+        *timestamp_ms = iter->timestamp;
+        *value = bits_double(iter->value_bits);
+        return 1;
+    }
+
+    int64_t dod;
+    if (read_bits(iter, 1) == 0)
+    {
+        dod = 0;
+    }
+    else if (read_bits(iter, 1) == 0)
+    {
+        dod = read_signed(iter, DOD_SMALL_BITS);
+    }
+    else if (read_bits(iter, 1) == 0)
+    {
+        dod = read_signed(iter, DOD_MEDIUM_BITS);
+    }
+    else if (read_bits(iter, 1) == 0)
+    {
+        dod = read_signed(iter, DOD_LARGE_BITS);
+    }
+    else
+    {
+        dod = read_signed(iter, DOD_HUGE_BITS);
+    }
+    iter->delta += dod;
+    iter->timestamp += iter->delta;
+
+    if (read_bits(iter, 1) == 1)
+    {
+        if (read_bits(iter, 1) == 1)
+        {
+            iter->leading = (uint8_t)read_bits(iter, LEADING_BITS);
+            int significant = (int)read_bits(iter, LENGTH_BITS);
+            if (significant == 0)
+            {
+                significant = VALUE_BITS;
+            }
+            iter->trailing = (uint8_t)(VALUE_BITS - iter->leading - significant);
+        }
+        int significant = VALUE_BITS - iter->leading - iter->trailing;
+        iter->value_bits ^= read_bits(iter, significant) << iter->trailing;
+    }
+
+    *timestamp_ms = iter->timestamp;
+    *value = bits_double(iter->value_bits);
+    return 1;
+}
@@ -0,0 +1,247 @@
+#include "governor.h"
+#include "self_metrics.h"
+#include "timing.h"
+#include <prom.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_LABELS 0
+#define COLLECTOR_LABELS 1
+#define MILLICORES_PER_CORE 1000.0
+
+// Grupos distintos que pueden regularse
+#define MAX_GOVERNED_COLLECTORS 16
+
+// Ciclos entre ajustes: el consumo se mide sobre toda la ventana y el efecto de un ajuste se ve en la siguiente
+#define ADJUST_TICKS 10
+
+// Peso de la última actualización en el costo promedio de cada grupo
+#define COST_SMOOTHING 0.3
+
+// Se acorta un intervalo solo por debajo de la mitad del presupuesto, y si lo previsto queda bajo el 80%
+#define TIGHTEN_BELOW 0.5
+#define TIGHTEN_LIMIT 0.8
+
+#define INTERVAL_FACTOR 2
+
+/** Etiqueta de collector_interval_seconds */
+static const char* collector_label[] = {"collector"};
+
+/** Estado de cada grupo, en el orden en que se consultó por primera vez; solo lo usa el hilo de recolección */
+static struct
+{
+    const char* collector;
+    unsigned int interval;       /**< Ciclos entre actualizaciones */
+    unsigned long long last_run; /**< Ciclo de la última actualización */
+    int has_run;                 /**< Ya se actualizó alguna vez */
+    double cost;                 /**< Segundos de CPU por actualización, promediados */
+    int has_cost;                /**< cost tiene al menos una medición */
+    prom_metric_sample_t* interval_sample;
+} collectors[MAX_GOVERNED_COLLECTORS];
+static size_t collector_count = 0;
+
+static int active = 0;
+static double budget_cores;
+static unsigned int tick_length;
+static unsigned long long tick = 0;
+static double window_start_wall;
+static double window_cost;
+
+/** Métricas del regulador; NULL hasta governor_init */
+static prom_gauge_t* interval_metric;
+static prom_metric_sample_t* usage_sample;
+
+/**
+ * @brief Crea un gauge en el collector de la autoinstrumentación; devuelve NULL si algo falla.
+ */
+static prom_gauge_t* add_gauge(const char* name, const char* help, size_t label_count, const char** labels)
+{
+    prom_gauge_t* gauge = prom_gauge_new(name, help, label_count, labels);
+    if (gauge == NULL)
+    {
+        return NULL;
+    }
+    prom_collector_t* collector =
+        prom_collector_registry_get_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, SELF_COLLECTOR);
+    int result = collector != NULL ? prom_collector_add_metric(collector, gauge)
+                                   : prom_collector_registry_register_metric(gauge);
+    if (result != SUCCESS)
+    {
+        prom_gauge_destroy(gauge);
+        return NULL;
+    }
+    return gauge;
+}
+
+int governor_init(unsigned int budget_millicores, unsigned int tick_seconds)
+{
+    interval_metric = add_gauge("collector_interval_seconds", "Effective update interval of each group of metrics",
+                                COLLECTOR_LABELS, collector_label);
+    prom_gauge_t* usage_metric =
+        add_gauge("cpu_budget_usage_ratio", "Collector CPU time over the configured CPU budget", NO_LABELS, NULL);
+    usage_sample = usage_metric != NULL ? prom_metric_sample_from_labels(usage_metric, NULL) : NULL;
+    if (interval_metric == NULL || usage_sample == NULL)
+    {
+        fprintf(stderr, "Error creating CPU budget metrics\n");
+        return ERROR;
+    }
+
+    budget_cores = budget_millicores / MILLICORES_PER_CORE;
+    tick_length = tick_seconds;
+    window_start_wall = timing_now();
+    active = 1;
+    return SUCCESS;
+}
+
+/**
+ * @brief Devuelve el índice del grupo en la tabla, agregándolo la primera vez; -1 si la tabla está llena.
+ */
+static int collector_index(const char* collector)
+{
+    for (size_t i = 0; i < collector_count; i++)
+    {
+        if (collectors[i].collector == collector || strcmp(collectors[i].collector, collector) == 0)
+        {
+            return (int)i;
+        }
+    }
+    if (collector_count == MAX_GOVERNED_COLLECTORS)
+    {
+        return ERROR;
+    }
+    const char* labels[] = {collector};
+    memset(&collectors[collector_count], 0, sizeof(collectors[collector_count]));
+    collectors[collector_count].collector = collector;
+    collectors[collector_count].interval = 1;
+    collectors[collector_count].interval_sample = prom_metric_sample_from_labels(interval_metric, labels);
+    if (collectors[collector_count].interval_sample != NULL)
+    {
+        prom_metric_sample_set(collectors[collector_count].interval_sample, (double)tick_length);
+    }
+    return (int)collector_count++;
+}
+
+int governor_collector_due(const char* collector)
+{
+    if (!active)
+    {
+        return 1;
+    }
+    int i = collector_index(collector);
+    if (i == ERROR)
+    {
+        return 1;
+    }
+    if (collectors[i].has_run && tick - collectors[i].last_run < collectors[i].interval)
+    {
+        return 0;
+    }
+    collectors[i].last_run = tick;
+    collectors[i].has_run = 1;
+    return 1;
+}
+
+void governor_collector_done(const char* collector, double cpu_seconds)
+{
+    if (!active)
+    {
+        return;
+    }
+    int i = collector_index(collector);
+    if (i == ERROR)
+    {
+        return;
+    }
+    collectors[i].cost = collectors[i].has_cost
+                             ? collectors[i].cost * (1 - COST_SMOOTHING) + cpu_seconds * COST_SMOOTHING
+                             : cpu_seconds;
+    collectors[i].has_cost = 1;
+    window_cost += cpu_seconds;
+}
+
+/**
+ * @brief Cambia el intervalo de un grupo y lo publica.
+ */
+static void set_interval(size_t i, unsigned int interval)
+{
+    collectors[i].interval = interval;
+    if (collectors[i].interval_sample != NULL)
+    {
+        prom_metric_sample_set(collectors[i].interval_sample, (double)interval * tick_length);
+    }
+}
+
+/**
+ * @brief Estira el grupo más caro si el consumo supera el presupuesto, o acorta el más barato si sobra holgura.
+ * @param usage Núcleos de CPU consumidos por los grupos en la última ventana.
+ */
+static void adjust_intervals(double usage)
+{
+    int chosen = ERROR;
+    if (usage > budget_cores)
+    {
+        // El más caro por segundo entre los que todavía pueden estirarse
+        double highest = 0;
+        for (size_t i = 0; i < collector_count; i++)
+        {
+            double rate = collectors[i].cost / (collectors[i].interval * tick_length);
+            if (collectors[i].has_cost && collectors[i].interval < GOVERNOR_MAX_INTERVAL_TICKS && rate > highest)
+            {
+                highest = rate;
+                chosen = (int)i;
+            }
+        }
+        if (chosen != ERROR)
+        {
+            unsigned int interval = collectors[chosen].interval * INTERVAL_FACTOR;
+            set_interval((size_t)chosen, interval < GOVERNOR_MAX_INTERVAL_TICKS ? interval
+                                                                                : GOVERNOR_MAX_INTERVAL_TICKS);
+        }
+    }
+    else if (usage < budget_cores * TIGHTEN_BELOW)
+    {
+        // Reducir el intervalo a la mitad duplica las actualizaciones: agrega costo / intervalo por segundo
+        double lowest = 0;
+        for (size_t i = 0; i < collector_count; i++)
+        {
+            double extra = collectors[i].cost / (collectors[i].interval * tick_length);
+            if (collectors[i].interval > 1 && (chosen == ERROR || extra < lowest))
+            {
+                lowest = extra;
+                chosen = (int)i;
+            }
+        }
+        if (chosen != ERROR && usage + lowest <= budget_cores * TIGHTEN_LIMIT)
+        {
+            set_interval((size_t)chosen, collectors[chosen].interval / INTERVAL_FACTOR);
+        }
+    }
+}
+
+void governor_tick(void)
+{
+    if (!active)
+    {
+        return;
+    }
+    tick++;
+    if (tick % ADJUST_TICKS != 0)
+    {
+        return;
+    }
+
+    double wall = timing_now();
+    if (wall <= window_start_wall)
+    {
+        return;
+    }
+    double usage = window_cost / (wall - window_start_wall);
+    window_start_wall = wall;
+    window_cost = 0;
+
+    prom_metric_sample_set(usage_sample, usage / budget_cores);
+    adjust_intervals(usage);
+}
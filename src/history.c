@@ -0,0 +1,70 @@
+#include "history.h"
+#include "series.h"
+#include <pthread.h>
+
+/**
+ * @brief Buffer circular de una serie.
+ */
+typedef struct
+{
+    history_sample_t samples[HISTORY_CAPACITY]; /**< Muestras; las más antiguas se sobrescriben. */
+    size_t next;                                /**< Posición de la próxima escritura. */
+    size_t count;                               /**< Muestras válidas, hasta HISTORY_CAPACITY. */
+} history_ring_t;
+
+/** Un buffer por serie, preasignado */
+static history_ring_t history_rings[MAX_SERIES];
+
+/** Protege los buffers: el colector escribe mientras los hilos HTTP consultan */
+static pthread_mutex_t history_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void history_record(void)
+{
+    size_t count = series_count();
+
+    pthread_mutex_lock(&history_lock);
+    for (size_t i = 0; i < count; i++)
+    {
+        const series_t* series = series_get(i);
+        history_ring_t* ring = &history_rings[i];
+
+        // Sin lectura nueva desde el ciclo anterior (o ninguna todavía): no hay nada que agregar
+        size_t last = (ring->next + HISTORY_CAPACITY - 1) % HISTORY_CAPACITY;
+        if (series->timestamp_ms == 0 || (ring->count > 0 && ring->samples[last].timestamp_ms >= series->timestamp_ms))
+        {
+            continue;
+        }
+
+        ring->samples[ring->next].timestamp_ms = series->timestamp_ms;
+        ring->samples[ring->next].value = series->value;
+        ring->next = (ring->next + 1) % HISTORY_CAPACITY;
+        if (ring->count < HISTORY_CAPACITY)
+        {
+            ring->count++;
+        }
+    }
+    pthread_mutex_unlock(&history_lock);
+}
+
+size_t history_query(size_t series_index, long long since_ms, history_sample_t* out)
+{
+    if (series_index >= MAX_SERIES)
+    {
+        return 0;
+    }
+
+    size_t copied = 0;
+    pthread_mutex_lock(&history_lock);
+    const history_ring_t* ring = &history_rings[series_index];
+    size_t oldest = (ring->next + HISTORY_CAPACITY - ring->count) % HISTORY_CAPACITY;
+    for (size_t i = 0; i < ring->count; i++)
+    {
+        const history_sample_t* sample = &ring->samples[(oldest + i) % HISTORY_CAPACITY];
+        if (sample->timestamp_ms > since_ms)
+        {
+            out[copied++] = *sample;
+        }
+    }
+    pthread_mutex_unlock(&history_lock);
+    return copied;
+}
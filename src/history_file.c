@@ -0,0 +1,409 @@
+#include "history_file.h"
+#include "timing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define HISTORY_FILE_MODE 0644
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define FIRST_SEQUENCE 1
+#define INITIAL_FOUND_CAPACITY 1024
+#define GROWTH_FACTOR 2
+
+/**
+ * @brief Bloque válido encontrado durante la recuperación.
+ */
+typedef struct
+{
+    size_t slot;       /**< Primera ranura del bloque. */
+    size_t slots;      /**< Ranuras ocupadas. */
+    uint64_t sequence; /**< Número de secuencia. */
+    int keep;          /**< Distinto de cero si es coherente con el orden de escritura. */
+} found_block_t;
+
+/** Inicio del mapeo, NULL si no hay archivo abierto */
+static uint8_t* file_base = NULL;
+
+/** Inicio de la zona de datos dentro del mapeo */
+static uint8_t* file_data = NULL;
+
+/** Ranuras de la zona de datos */
+static size_t file_slot_total = 0;
+
+/** Ranura donde se escribe el próximo bloque */
+static size_t file_head = 0;
+
+/** Número de secuencia del próximo bloque */
+static uint64_t file_next_sequence = FIRST_SEQUENCE;
+
+/** Rango de bytes del mapeo escritos desde la última sincronización; vacío si begin == end */
+static size_t dirty_begin = 0;
+static size_t dirty_end = 0;
+
+/** Momento de la última sincronización (CLOCK_MONOTONIC, segundos) */
+static time_t last_sync = 0;
+
+uint64_t history_file_hash(const char* name)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (const unsigned char* p = (const unsigned char*)name; *p != '\0'; p++)
+    {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static size_t slots_for(size_t data_size)
+{
+    return (sizeof(history_file_block_t) + data_size + HISTORY_FILE_SLOT_SIZE - 1) / HISTORY_FILE_SLOT_SIZE;
+}
+
+static history_file_block_t* slot_block(size_t slot)
+{
+    return (history_file_block_t*)(file_data + slot * HISTORY_FILE_SLOT_SIZE);
+}
+
+static void mark_dirty(const void* address, size_t length)
+{
+    size_t begin = (size_t)((const uint8_t*)address - file_base);
+    size_t end = begin + length;
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = begin;
+        dirty_end = end;
+        return;
+    }
+    dirty_begin = begin < dirty_begin ? begin : dirty_begin;
+    dirty_end = end > dirty_end ? end : dirty_end;
+}
+
+/**
+ * @brief CRC-32 del bloque desde sequence hasta el final del flujo de bits.
+ */
+static uint32_t block_checksum(const history_file_block_t* block)
+{
+    size_t covered = sizeof(*block) - offsetof(history_file_block_t, sequence);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef*)&block->sequence, (uInt)covered);
+    crc = crc32(crc, (const Bytef*)(block + 1), (uInt)block->data_size);
+    return (uint32_t)crc;
+}
+
+/**
+ * @brief Verifica que en la ranura empiece un bloque completo con su CRC correcto.
+ */
+static int block_is_valid(size_t slot)
+{
+    const history_file_block_t* block = slot_block(slot);
+    if (block->magic != HISTORY_FILE_BLOCK_MAGIC || block->sequence < FIRST_SEQUENCE || block->sample_count == 0 ||
+        block->sample_count > GORILLA_CHUNK_SAMPLES || block->data_size == 0 ||
+        block->first_timestamp > block->last_timestamp)
+    {
+        return BOOL_FALSE;
+    }
+    // Los campos se comparan antes de sumar para no desbordar con valores basura
+    if (block->data_size > file_slot_total * HISTORY_FILE_SLOT_SIZE ||
+        slots_for(block->data_size) > file_slot_total - slot)
+    {
+        return BOOL_FALSE;
+    }
+    return block_checksum(block) == block->checksum;
+}
+
+static int compare_sequence(const void* a, const void* b)
+{
+    uint64_t left = ((const found_block_t*)a)->sequence;
+    uint64_t right = ((const found_block_t*)b)->sequence;
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Recorre la zona de datos, entrega los bloques válidos en orden y ubica la posición de escritura.
+ */
+static int recover(history_file_visitor_t visitor, void* ctx)
+{
+    size_t capacity = INITIAL_FOUND_CAPACITY;
+    size_t count = 0;
+    found_block_t* found = malloc(capacity * sizeof(found_block_t));
+    if (found == NULL)
+    {
+        return ERROR;
+    }
+
+    size_t slot = 0;
+    while (slot < file_slot_total)
+    {
+        if (!block_is_valid(slot))
+        {
+            slot++;
+            continue;
+        }
+        if (count == capacity)
+        {
+            capacity *= GROWTH_FACTOR;
+            found_block_t* grown = realloc(found, capacity * sizeof(found_block_t));
+            if (grown == NULL)
+            {
+                free(found);
+                return ERROR;
+            }
+            found = grown;
+        }
+        const history_file_block_t* block = slot_block(slot);
+        found[count].slot = slot;
+        found[count].slots = slots_for(block->data_size);
+        found[count].sequence = block->sequence;
+        found[count].keep = BOOL_FALSE;
+        count++;
+        slot += slots_for(block->data_size);
+    }
+
+    if (count > 0)
+    {
+        qsort(found, count, sizeof(found_block_t), compare_sequence);
+        const found_block_t* newest = &found[count - 1];
+        file_head = newest->slot + newest->slots;
+        file_next_sequence = newest->sequence + 1;
+
+        // Hacia atrás desde la posición de escritura los bloques deben aparecer con secuencias decrecientes y sin
+        // solaparse; cualquier otro bloque válido es un resto que el orden de escritura ya no explica
+        size_t reached = 0;
+        for (size_t i = count; i-- > 0;)
+        {
+            size_t end = found[i].slot + found[i].slots;
+            size_t distance = (file_head + file_slot_total - end) % file_slot_total;
+            if (i == count - 1 || (distance >= reached && distance + found[i].slots <= file_slot_total))
+            {
+                found[i].keep = BOOL_TRUE;
+                reached = distance + found[i].slots;
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (found[i].keep)
+            {
+                history_file_block_t* block = slot_block(found[i].slot);
+                visitor(block, (uint8_t*)(block + 1), ctx);
+            }
+        }
+    }
+    free(found);
+
+    // Truncar: un bloque a medio escribir en la posición de escritura se invalida para que no reaparezca
+    if (file_head < file_slot_total && slot_block(file_head)->magic == HISTORY_FILE_BLOCK_MAGIC &&
+        !block_is_valid(file_head))
+    {
+        slot_block(file_head)->magic = 0;
+        mark_dirty(slot_block(file_head), sizeof(uint32_t));
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Indica si el contenido del archivo puede descartarse: está vacío, lleva el magic del historial (otra versión
+ * o tamaño) o su encabezado está en cero (una inicialización interrumpida antes de escribir el magic).
+ */
+static int can_reinitialize(int fd)
+{
+    struct stat st;
+    history_file_header_t header;
+    if (fstat(fd, &st) != SUCCESS)
+    {
+        return BOOL_FALSE;
+    }
+    if (st.st_size == 0)
+    {
+        return BOOL_TRUE;
+    }
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+    {
+        return BOOL_FALSE;
+    }
+    if (header.magic == HISTORY_FILE_MAGIC)
+    {
+        return BOOL_TRUE;
+    }
+    const uint8_t* bytes = (const uint8_t*)&header;
+    for (size_t i = 0; i < sizeof(header); i++)
+    {
+        if (bytes[i] != 0)
+        {
+            return BOOL_FALSE;
+        }
+    }
+    return BOOL_TRUE;
+}
+
+/**
+ * @brief Verifica que el archivo abierto tenga este formato y el tamaño pedido.
+ */
+static int header_matches(int fd, size_t size)
+{
+    struct stat st;
+    history_file_header_t header;
+    if (fstat(fd, &st) != SUCCESS || (size_t)st.st_size != size ||
+        pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+    {
+        return BOOL_FALSE;
+    }
+    return header.magic == HISTORY_FILE_MAGIC && header.version == HISTORY_FILE_VERSION &&
+           header.slot_size == HISTORY_FILE_SLOT_SIZE && header.block_header_size == sizeof(history_file_block_t) &&
+           header.file_size == size && header.data_offset == HISTORY_FILE_HEADER_SIZE;
+}
+
+int history_file_open(const char* path, size_t size, history_file_visitor_t visitor, void* ctx)
+{
+    if (size < HISTORY_FILE_MIN_SIZE)
+    {
+        fprintf(stderr, "History file size must be at least %d bytes\n", HISTORY_FILE_MIN_SIZE);
+        return ERROR;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, HISTORY_FILE_MODE);
+    if (fd < SUCCESS)
+    {
+        fprintf(stderr, "Error opening history file %s: %s\n", path, strerror(errno));
+        return ERROR;
+    }
+
+    int reuse = header_matches(fd, size);
+    if (!reuse)
+    {
+        if (!can_reinitialize(fd))
+        {
+            fprintf(stderr, "Refusing to overwrite %s: not a history file\n", path);
+            close(fd);
+            return ERROR;
+        }
+        // Otra versión o tamaño: se descarta el contenido; ftruncate deja la zona de datos en cero
+        if (ftruncate(fd, 0) != SUCCESS || ftruncate(fd, (off_t)size) != SUCCESS)
+        {
+            fprintf(stderr, "Error sizing history file %s: %s\n", path, strerror(errno));
+            close(fd);
+            return ERROR;
+        }
+    }
+
+    uint8_t* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "Error mapping history file %s: %s\n", path, strerror(errno));
+        return ERROR;
+    }
+
+    file_base = base;
+    file_data = base + HISTORY_FILE_HEADER_SIZE;
+    file_slot_total = (size - HISTORY_FILE_HEADER_SIZE) / HISTORY_FILE_SLOT_SIZE;
+    file_head = 0;
+    file_next_sequence = FIRST_SEQUENCE;
+    last_sync = (time_t)timing_now();
+
+    if (!reuse)
+    {
+        history_file_header_t* header = (history_file_header_t*)base;
+        header->version = HISTORY_FILE_VERSION;
+        header->slot_size = HISTORY_FILE_SLOT_SIZE;
+        header->block_header_size = sizeof(history_file_block_t);
+        header->file_size = size;
+        header->data_offset = HISTORY_FILE_HEADER_SIZE;
+        header->magic = HISTORY_FILE_MAGIC;
+        msync(base, HISTORY_FILE_HEADER_SIZE, MS_SYNC);
+        return SUCCESS;
+    }
+
+    if (recover(visitor, ctx) != SUCCESS)
+    {
+        fprintf(stderr, "Error recovering history file %s\n", path);
+        munmap(base, size);
+        file_base = NULL;
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+int history_file_active(void)
+{
+    return file_base != NULL;
+}
+
+uint8_t* history_file_append(uint64_t series_hash, const gorilla_chunk_t* chunk, uint64_t* sequence)
+{
+    if (file_base == NULL)
+    {
+        return NULL;
+    }
+
+    size_t data_size = gorilla_chunk_size(chunk);
+    size_t slots = slots_for(data_size);
+    if (file_head + slots > file_slot_total)
+    {
+        // El bloque no cabe antes del final: las ranuras sobrantes se limpian para que sus bloques viejos no queden
+        // fuera del orden de escritura, y se sigue desde el principio
+        size_t tail = (file_slot_total - file_head) * HISTORY_FILE_SLOT_SIZE;
+        memset(slot_block(file_head), 0, tail);
+        mark_dirty(slot_block(file_head), tail);
+        file_head = 0;
+    }
+
+    history_file_block_t* block = slot_block(file_head);
+    block->magic = 0;
+    block->sequence = file_next_sequence;
+    block->series_hash = series_hash;
+    block->first_timestamp = chunk->first_timestamp;
+    block->last_timestamp = chunk->last_timestamp;
+    block->sample_count = chunk->count;
+    block->data_size = (uint32_t)data_size;
+    memcpy(block + 1, chunk->data, data_size);
+    block->checksum = block_checksum(block);
+    block->magic = HISTORY_FILE_BLOCK_MAGIC;
+    mark_dirty(block, slots * HISTORY_FILE_SLOT_SIZE);
+
+    *sequence = file_next_sequence++;
+    file_head += slots;
+    return (uint8_t*)(block + 1);
+}
+
+int history_file_block_intact(const uint8_t* data, uint64_t sequence)
+{
+    const history_file_block_t* block = (const history_file_block_t*)data - 1;
+    return block->magic == HISTORY_FILE_BLOCK_MAGIC && block->sequence == sequence;
+}
+
+void history_file_sync(void)
+{
+    if (file_base == NULL || dirty_begin == dirty_end)
+    {
+        return;
+    }
+    time_t now = (time_t)timing_now();
+    if (now - last_sync < HISTORY_FILE_SYNC_INTERVAL)
+    {
+        return;
+    }
+
+    // msync exige una dirección alineada a página
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = dirty_begin / page * page;
+    if (msync(file_base + begin, dirty_end - begin, MS_SYNC) != SUCCESS)
+    {
+        fprintf(stderr, "Error syncing history file: %s\n", strerror(errno));
+    }
+    dirty_begin = 0;
+    dirty_end = 0;
+    last_sync = now;
+}
@@ -3,8 +3,23 @@
  * @brief Entry point of the system - Sistema completo de monitoreo de métricas del sistema
  */
 
+#include "chunk_store.h"
+#include "collector_runner.h"
+#include "config.h"
 #include "expose_metrics.h"
-#include <pthread.h> // Required for thread usage
+#include "governor.h"
+#include "history.h"
+#include "microburst.h"
+#include "range_api.h"
+#include "remote_write.h"
+#include "rollup.h"
+#include "self_metrics.h"
+#include "shm_export.h"
+#include "stream_api.h"
+#include "subsample.h"
+#include "timing.h"
+#include "udp_export.h"
+#include <signal.h>
 #include <stdbool.h>
 
 /**
@@ -13,27 +28,54 @@
 #define SLEEP_TIME 1
 
 /**
- * @brief Constante para representar el valor cero.
- *
- * Se utiliza para mejorar la legibilidad en comparaciones.
+ * @brief Milisegundos en un segundo.
+ */
+#define MILLISECONDS_PER_SECOND 1000LL
+
+/**
+ * @brief Valor devuelto por config_parse_args cuando se pidió la ayuda.
+ */
+#define HELP_REQUESTED 1
+
+/**
+ * @brief Bytes en un MiB, para el tamaño del archivo de historial.
  */
-#define ZERO 0
+#define BYTES_PER_MB (1024 * 1024)
+
+/** Se pone en cero al recibir SIGTERM o SIGINT para terminar el bucle y guardar el estado */
+static volatile sig_atomic_t running = 1;
+
+static void handle_termination(int signal_number)
+{
+    (void)signal_number;
+    running = 0;
+}
 
 /**
  * @brief Función principal del sistema de monitoreo.
  *
- * Inicializa los recursos, crea el hilo HTTP para exponer métricas
+ * Lee la configuración, inicializa los recursos, inicia el servidor HTTP para exponer métricas
  * y entra en un bucle de actualización periódica.
  *
- * @param argc Cantidad de argumentos de línea de comandos (no utilizado).
- * @param argv Lista de argumentos de línea de comandos (no utilizado).
+ * @param argc Cantidad de argumentos de línea de comandos.
+ * @param argv Lista de argumentos de línea de comandos (ver config_print_usage).
  * @return EXIT_SUCCESS si finaliza correctamente, EXIT_FAILURE en caso de error.
  */
 int main(int argc, char* argv[])
 {
-    // Suprimir warnings de parámetros no utilizados
-    (void)argc;
-    (void)argv;
+    monitor_config_t config;
+    config_set_defaults(&config);
+    int parsed = config_parse_args(&config, argc, argv);
+    if (parsed == HELP_REQUESTED)
+    {
+        config_print_usage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+    if (parsed != 0)
+    {
+        config_print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
 
     printf("=== Sistema de Monitoreo de Métricas del Sistema ===\n");
     printf("Iniciando monitoreo de:\n");
@@ -43,43 +85,173 @@ int main(int argc, char* argv[])
     printf("- Network metrics (bandwidth, packet rates, errors)\n");
     printf("- Process statistics (total, running, sleeping, stopped, zombie)\n");
     printf("- System performance (context switches, interrupts, process creation)\n");
-    printf("Métricas expuestas en: http://localhost:8000/metrics\n");
+    printf("Métricas expuestas en: http://localhost:%u/metrics\n", config.http_port);
     printf("================================================\n\n");
 
     // Initialize metrics
     init_metrics();
 
-    // Create a thread to expose metrics via HTTP
-    pthread_t tid;
-    if (pthread_create(&tid, NULL, expose_metrics, NULL) != ZERO)
+    // Histogramas con los tiempos del propio agente, para alertar cuando él mismo se vuelve lento
+    if (self_metrics_init() != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Cada grupo se actualiza en su propio hilo, para que una lectura bloqueada de /proc no detenga a los demás
+    if (collector_runner_init(config.collector_deadline_ms) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Estirar los intervalos de los grupos más caros cuando el agente se pasa de su presupuesto de CPU
+    if (config.cpu_budget_millicores > 0 && governor_init(config.cpu_budget_millicores, SLEEP_TIME) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Distribución de CPU, cola de ejecución y red dentro de cada ciclo, para ver las ráfagas que el promedio esconde
+    if (config.subsample_hz > 0 && subsample_init(config.subsample_hz, config.subsample_window) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Picos de tasa y ráfagas de milisegundos en las interfaces pedidas, que ni el muestreo por ciclo llega a ver
+    if (config.microburst_interfaces != NULL &&
+        microburst_init(config.microburst_interfaces, config.microburst_interval_ms, config.microburst_threshold,
+                        config.microburst_cpu) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Reanudar las tasas con las lecturas de la ejecución anterior, si son de este arranque del sistema
+    if (config.state_file_path != NULL)
+    {
+        rate_state_load(config.state_file_path);
+    }
+
+    // Terminar ordenadamente para guardar el estado; sin SA_RESTART, la espera vuelve en cuanto llega la señal
+    struct sigaction termination;
+    memset(&termination, 0, sizeof(termination));
+    termination.sa_handler = handle_termination;
+    sigemptyset(&termination.sa_mask);
+    sigaction(SIGTERM, &termination, NULL);
+    sigaction(SIGINT, &termination, NULL);
+
+    // Publicar los valores en memoria compartida para lectores locales que sondean con alta frecuencia
+    if (config.shm_export_path != NULL && shm_export_init(config.shm_export_path) != 0)
     {
-        fprintf(stderr, "Error creating HTTP server thread\n");
         return EXIT_FAILURE;
     }
 
-    printf("HTTP server started on port 8000\n");
+    // Historial comprimido de varias horas, alimentado con las mismas lecturas que el historial reciente
+    if (chunk_store_init(config.history_hours) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (config.history_file_path != NULL &&
+        chunk_store_open_file(config.history_file_path, (size_t)config.history_file_mb * BYTES_PER_MB) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Agregados de 10 s y 1 min para consultas de rango con baja resolución
+    if (rollup_init() != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Enviar las series a un receptor remote_write, para hosts que Prometheus no puede scrapear
+    if (config.remote_write_url != NULL &&
+        remote_write_init(config.remote_write_url, config.remote_write_interval, config.remote_write_queue) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Registros StatsD o de InfluxDB por UDP para los pipelines que los ingieren
+    if (config.udp_target != NULL && udp_export_init(config.udp_target, config.udp_format, config.udp_mtu) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // El historial reciente se consulta en el mismo servidor HTTP
+    if (range_api_register() != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Los tableros reciben por /stream solo las series que cambiaron en cada ciclo
+    if (stream_api_register(config.stream_queue) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Start the HTTP server; microhttpd serves connections on its own threads
+    if (expose_metrics(&config) == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("HTTP server started on port %u (%s mode)\n", config.http_port,
+           config.http_mode == HTTP_MODE_EPOLL ? "epoll" : "select");
     printf("Starting metrics collection loop...\n\n");
 
+    double last_state_save = timing_now();
+    double next_tick = timing_now();
+
     // Main loop to update metrics every second
-    while (true)
+    while (running)
     {
-        printf("--- Updating metrics at %ld ---\n", time(NULL));
+        self_metrics_tick_started(next_tick);
+        printf("--- Updating metrics at %lld ---\n", timing_wall_ms() / MILLISECONDS_PER_SECOND);
 
         // Actualizar métricas básicas
-        update_cpu_gauge();
-        update_memory_gauges();
+        collector_run(CPU_COLLECTOR, update_cpu_gauge);
+        collector_run(MEMORY_COLLECTOR, update_memory_gauges);
 
         // Actualizar métricas de I/O y red
-        update_disk_metrics();
-        update_network_metrics();
+        collector_run(DISK_COLLECTOR, update_disk_metrics);
+        collector_run(NETWORK_COLLECTOR, update_network_metrics);
 
         // Actualizar métricas de procesos y rendimiento del sistema
-        update_process_metrics();
-        update_context_metrics();
+        collector_run(PROCESSES_COLLECTOR, update_process_metrics);
+        collector_run(CONTEXT_COLLECTOR, update_context_metrics);
+        microburst_publish();
+
+        history_record();
+        chunk_store_record();
+        rollup_record();
+        remote_write_record();
+        udp_export_publish();
+        stream_api_publish();
+        shm_export_publish(get_read_timestamp_ms());
+
+        // Publicar el snapshot: los scrapes hasta el próximo tick comparten el render y su versión comprimida
+        promhttp_snapshot_tick();
 
+        // Guardar el estado también periódicamente, por si el proceso termina sin pasar por la señal
+        if (config.state_file_path != NULL && timing_now() - last_state_save >= RATE_STATE_SAVE_INTERVAL)
+        {
+            rate_state_save(config.state_file_path);
+            last_state_save = timing_now();
+        }
+
+        governor_tick();
         printf("--- Metrics update completed ---\n\n");
 
-        sleep(SLEEP_TIME);
+        // El próximo ciclo se programa desde el anterior, como en los hilos de muestreo, para que tick_lag cuente todo
+        // el retraso y no solo el de la espera; los ciclos perdidos por completo se saltan en vez de correr seguidos
+        next_tick += SLEEP_TIME;
+        double now = timing_now();
+        while (now - next_tick >= SLEEP_TIME)
+        {
+            next_tick += SLEEP_TIME;
+        }
+        timing_sleep_until(next_tick);
+    }
+
+    if (config.state_file_path != NULL && rate_state_save(config.state_file_path) == 0)
+    {
+        printf("Rate state saved to %s\n", config.state_file_path);
     }
 
     return EXIT_SUCCESS;
@@ -1,6 +1,8 @@
 #include "metrics.h"
+#include "timing.h"
 #include <ctype.h>
 #include <dirent.h>
+#include <time.h>
 
 // Definicions de variables/constantes
 #define KILOBYTES_TO_BYTES 1024
@@ -756,4 +758,9 @@ void calculate_system_performance_metrics(context_stats_t* current_context, cont
     printf("System Performance - Context switches/s: %.*f, Process creation/s: %.*f, Load ratio: %.*f\n",
            PRINTF_DECIMAL_PRECISION, metrics->context_switch_rate, PRINTF_DECIMAL_PRECISION,
            metrics->process_creation_rate, PRINTF_RATIO_PRECISION, metrics->process_load_ratio);
-}
\ No newline at end of file
+}
+
+long long get_read_timestamp_ms(void)
+{
+    return timing_wall_ms();
+}
@@ -0,0 +1,163 @@
+#include "metrics_shm.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define SEQUENCE_WRITING 1u
+#define MAX_READ_ATTEMPTS 10000
+
+/**
+ * @brief Redondea un desplazamiento hacia arriba a METRICS_SHM_ALIGNMENT.
+ */
+static size_t align_offset(size_t offset)
+{
+    return (offset + METRICS_SHM_ALIGNMENT - 1) / METRICS_SHM_ALIGNMENT * METRICS_SHM_ALIGNMENT;
+}
+
+size_t metrics_shm_layout(size_t metric_count, size_t* descriptors_offset, size_t* values_offset)
+{
+    size_t descriptors = align_offset(sizeof(metrics_shm_header_t));
+    size_t values = align_offset(descriptors + metric_count * sizeof(metrics_shm_descriptor_t));
+    if (descriptors_offset != NULL)
+    {
+        *descriptors_offset = descriptors;
+    }
+    if (values_offset != NULL)
+    {
+        *values_offset = values;
+    }
+    return values + metric_count * sizeof(double);
+}
+
+/**
+ * @brief Verifica que el encabezado corresponda a este formato y que el diseño quepa en el mapeo.
+ */
+static int header_is_valid(const metrics_shm_header_t* header, size_t size)
+{
+    // El escritor publica magic al final de la inicialización
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != METRICS_SHM_MAGIC ||
+        header->version != METRICS_SHM_VERSION || header->header_size != sizeof(metrics_shm_header_t) ||
+        header->descriptor_size != sizeof(metrics_shm_descriptor_t))
+    {
+        return BOOL_FALSE;
+    }
+
+    size_t descriptors_offset;
+    size_t values_offset;
+    size_t total_size = metrics_shm_layout(header->metric_count, &descriptors_offset, &values_offset);
+    return header->descriptors_offset == descriptors_offset && header->values_offset == values_offset &&
+           header->total_size == total_size && total_size <= size;
+}
+
+int metrics_shm_open(metrics_shm_reader_t* reader, const char* path)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < SUCCESS)
+    {
+        return METRICS_SHM_ERROR;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != SUCCESS || (size_t)st.st_size < sizeof(metrics_shm_header_t))
+    {
+        close(fd);
+        return METRICS_SHM_ERROR;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return METRICS_SHM_ERROR;
+    }
+
+    const metrics_shm_header_t* header = (const metrics_shm_header_t*)base;
+    if (!header_is_valid(header, size))
+    {
+        munmap(base, size);
+        return METRICS_SHM_ERROR;
+    }
+
+    reader->base = base;
+    reader->size = size;
+    reader->header = header;
+    reader->descriptors = (const metrics_shm_descriptor_t*)((const char*)base + header->descriptors_offset);
+    reader->values = (const double*)((const char*)base + header->values_offset);
+    reader->device = st.st_dev;
+    reader->inode = st.st_ino;
+    return METRICS_SHM_OK;
+}
+
+size_t metrics_shm_count(const metrics_shm_reader_t* reader)
+{
+    return reader->header != NULL ? reader->header->metric_count : 0;
+}
+
+const char* metrics_shm_name(const metrics_shm_reader_t* reader, size_t index)
+{
+    return index < metrics_shm_count(reader) ? reader->descriptors[index].name : NULL;
+}
+
+int metrics_shm_read(const metrics_shm_reader_t* reader, double* values, int64_t* timestamp_ms, uint64_t* sequence)
+{
+    const metrics_shm_header_t* header = reader->header;
+    size_t count = metrics_shm_count(reader);
+
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+    {
+        uint64_t begin = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (begin & SEQUENCE_WRITING)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            __atomic_load(&reader->values[i], &values[i], __ATOMIC_RELAXED);
+        }
+        int64_t stamp = __atomic_load_n(&header->timestamp_ms, __ATOMIC_RELAXED);
+
+        // Las copias anteriores no pueden reordenarse después de la segunda lectura del contador
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == begin)
+        {
+            if (timestamp_ms != NULL)
+            {
+                *timestamp_ms = stamp;
+            }
+            if (sequence != NULL)
+            {
+                *sequence = begin;
+            }
+            return METRICS_SHM_OK;
+        }
+    }
+    return METRICS_SHM_BUSY;
+}
+
+int metrics_shm_is_current(const metrics_shm_reader_t* reader, const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) != SUCCESS)
+    {
+        return BOOL_FALSE;
+    }
+    return st.st_dev == reader->device && st.st_ino == reader->inode ? BOOL_TRUE : BOOL_FALSE;
+}
+
+void metrics_shm_close(metrics_shm_reader_t* reader)
+{
+    if (reader->base != NULL)
+    {
+        munmap((void*)reader->base, reader->size);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
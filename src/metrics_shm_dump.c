@@ -0,0 +1,77 @@
+/**
+ * @file metrics_shm_dump.c
+ * @brief Herramienta que imprime una instantánea del segmento de memoria compartida publicado por el monitor.
+ *
+ * Uso: metrics-shm-dump [ruta]. Sin ruta se usa METRICS_SHM_DEFAULT_PATH.
+ */
+
+#include "metrics_shm.h"
+#include "value_format.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PATH_ARGUMENT 1
+#define MAX_ARGUMENTS 2
+
+/**
+ * @brief Imprime un valor con la menor precisión que lo reproduce exactamente.
+ */
+static void print_value(const char* name, double value)
+{
+    char buffer[VALUE_FORMAT_BUFFER_SIZE];
+    value_format(value, buffer, sizeof(buffer));
+    printf("%s %s\n", name, buffer);
+}
+
+/**
+ * @brief Función principal de la herramienta.
+ * @param argc Cantidad de argumentos de línea de comandos.
+ * @param argv Lista de argumentos: opcionalmente la ruta del segmento.
+ * @return EXIT_SUCCESS si se imprimió la instantánea, EXIT_FAILURE en caso de error.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc > MAX_ARGUMENTS)
+    {
+        fprintf(stderr, "Uso: %s [ruta]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argc == MAX_ARGUMENTS ? argv[PATH_ARGUMENT] : METRICS_SHM_DEFAULT_PATH;
+
+    metrics_shm_reader_t reader;
+    if (metrics_shm_open(&reader, path) != METRICS_SHM_OK)
+    {
+        fprintf(stderr, "Error opening metrics segment %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    size_t count = metrics_shm_count(&reader);
+    double* values = malloc((count > 0 ? count : 1) * sizeof(double));
+    if (values == NULL)
+    {
+        fprintf(stderr, "Error allocating memory\n");
+        metrics_shm_close(&reader);
+        return EXIT_FAILURE;
+    }
+
+    int64_t timestamp_ms;
+    uint64_t sequence;
+    if (metrics_shm_read(&reader, values, &timestamp_ms, &sequence) != METRICS_SHM_OK)
+    {
+        fprintf(stderr, "Segment %s is being updated continuously, try again\n", path);
+        free(values);
+        metrics_shm_close(&reader);
+        return EXIT_FAILURE;
+    }
+
+    printf("# sequence %" PRIu64 " timestamp_ms %" PRId64 "\n", sequence, timestamp_ms);
+    for (size_t i = 0; i < count; i++)
+    {
+        print_value(metrics_shm_name(&reader, i), values[i]);
+    }
+
+    free(values);
+    metrics_shm_close(&reader);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,385 @@
+#define _GNU_SOURCE // pthread_attr_setaffinity_np y CPU_SET
+#include "microburst.h"
+#include "collector_runner.h"
+#include "expose_metrics.h"
+#include "timing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <prom.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_FD -1
+#define INTERFACE_LABELS 1
+#define MAX_MICROBURST_INTERFACES 8
+#define INTERFACE_NAME_SIZE 32
+#define PATH_BUFFER_SIZE 128
+#define COUNTER_BUFFER_SIZE 32
+#define NANOSECONDS_PER_MILLISECOND 1000000LL
+#define BASE_10 10
+
+// Umbral por defecto respecto de la velocidad del enlace, que sysfs informa en Mbit/s
+#define DEFAULT_THRESHOLD_FRACTION 0.8
+#define BYTES_PER_MEGABIT (1000000.0 / 8.0)
+#define NO_THRESHOLD UINT64_MAX
+
+// Ráfagas por intervalo: 1, 2, 4, ... 128
+#define BURSTS_BUCKET_START 1.0
+#define BURSTS_BUCKET_FACTOR 2.0
+#define BURSTS_BUCKET_COUNT 8
+
+/** Un sentido de una interfaz: su contador y lo acumulado en el intervalo */
+typedef struct
+{
+    int fd;              /**< Descriptor de rx_bytes o tx_bytes, abierto al inicio */
+    uint64_t previous;   /**< Lectura anterior del contador */
+    int in_burst;        /**< La lectura anterior ya superaba el umbral */
+    uint64_t peak;       /**< Tasa más alta del intervalo en bytes/s; atómico, el ciclo lo reinicia */
+    uint64_t bursts;     /**< Ráfagas empezadas en el intervalo; atómico, el ciclo lo reinicia */
+    prom_metric_sample_t* peak_sample;
+    prom_metric_sample_histogram_t* bursts_sample;
+} direction_t;
+
+typedef struct
+{
+    char name[INTERFACE_NAME_SIZE];
+    uint64_t threshold; /**< Tasa en bytes/s a partir de la cual una lectura es parte de una ráfaga */
+    direction_t rx;
+    direction_t tx;
+} burst_interface_t;
+
+static burst_interface_t interfaces[MAX_MICROBURST_INTERFACES];
+static size_t interface_count = 0;
+static long long period_ns;
+
+static const char* interface_label[] = {"interface"};
+
+/** Métricas del grupo network; NULL hasta microburst_init */
+static prom_gauge_t* rx_peak_metric;
+static prom_gauge_t* tx_peak_metric;
+static prom_histogram_t* rx_bursts_metric;
+static prom_histogram_t* tx_bursts_metric;
+
+/**
+ * @brief Relee un contador de sysfs; el búfer está en la pila, no se reserva memoria.
+ */
+static int read_counter(int fd, uint64_t* value)
+{
+    char buffer[COUNTER_BUFFER_SIZE];
+    ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (length <= 0)
+    {
+        return ERROR;
+    }
+    buffer[length] = '\0';
+    *value = strtoull(buffer, NULL, BASE_10);
+    return SUCCESS;
+}
+
+/**
+ * @brief Lee un sentido de una interfaz y acumula su tasa desde la lectura anterior.
+ */
+static void sample_direction(direction_t* direction, uint64_t threshold, long long elapsed_ns)
+{
+    uint64_t value;
+    if (read_counter(direction->fd, &value) != SUCCESS)
+    {
+        return;
+    }
+
+    // Un contador que retrocede (la interfaz se recreó) solo reinicia la referencia
+    if (elapsed_ns > 0 && value >= direction->previous)
+    {
+        uint64_t rate = (uint64_t)((double)(value - direction->previous) * TIMING_NANOSECONDS_PER_SECOND / elapsed_ns);
+
+        // El ciclo puede haber puesto el pico en cero entre la carga y el reemplazo; entonces se reintenta
+        uint64_t peak = __atomic_load_n(&direction->peak, __ATOMIC_RELAXED);
+        while (rate > peak &&
+               !__atomic_compare_exchange_n(&direction->peak, &peak, rate, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        }
+
+        if (rate > threshold)
+        {
+            if (!direction->in_burst)
+            {
+                __atomic_fetch_add(&direction->bursts, 1, __ATOMIC_RELAXED);
+            }
+            direction->in_burst = 1;
+        }
+        else
+        {
+            direction->in_burst = 0;
+        }
+    }
+    direction->previous = value;
+}
+
+/**
+ * @brief Hilo de muestreo: lee todas las interfaces en instantes fijos de CLOCK_MONOTONIC.
+ */
+static void* sampler_thread(void* arg)
+{
+    (void)arg;
+    for (size_t i = 0; i < interface_count; i++)
+    {
+        read_counter(interfaces[i].rx.fd, &interfaces[i].rx.previous);
+        read_counter(interfaces[i].tx.fd, &interfaces[i].tx.previous);
+    }
+    long long previous_ns = timing_clock_ns(CLOCK_MONOTONIC);
+    long long next_ns = previous_ns;
+
+    while (1)
+    {
+        next_ns += period_ns;
+        struct timespec next = {(time_t)(next_ns / TIMING_NANOSECONDS_PER_SECOND),
+                                (long)(next_ns % TIMING_NANOSECONDS_PER_SECOND)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        long long now_ns = timing_clock_ns(CLOCK_MONOTONIC);
+        for (size_t i = 0; i < interface_count; i++)
+        {
+            sample_direction(&interfaces[i].rx, interfaces[i].threshold, now_ns - previous_ns);
+            sample_direction(&interfaces[i].tx, interfaces[i].threshold, now_ns - previous_ns);
+        }
+        previous_ns = now_ns;
+
+        // Si el hilo se atrasó no se recuperan las lecturas perdidas: se sigue desde ahora
+        if (now_ns > next_ns + period_ns)
+        {
+            next_ns = now_ns;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Abre un archivo de estadísticas de la interfaz.
+ */
+static int open_statistic(const char* interface, const char* statistic)
+{
+    char path[PATH_BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/statistics/%s", interface, statistic);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == NO_FD)
+    {
+        fprintf(stderr, "Error opening %s: %s\n", path, strerror(errno));
+    }
+    return fd;
+}
+
+/**
+ * @brief Umbral de ráfaga en bytes/s: el indicado, o una fracción de la velocidad del enlace si se conoce.
+ */
+static uint64_t burst_threshold(const char* interface, unsigned int threshold_mbps)
+{
+    if (threshold_mbps > 0)
+    {
+        return (uint64_t)(threshold_mbps * BYTES_PER_MEGABIT);
+    }
+
+    char path[PATH_BUFFER_SIZE];
+    char buffer[COUNTER_BUFFER_SIZE];
+    long speed_mbps = 0;
+    snprintf(path, sizeof(path), "/sys/class/net/%s/speed", interface);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd != NO_FD)
+    {
+        ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+        if (length > 0)
+        {
+            buffer[length] = '\0';
+            speed_mbps = strtol(buffer, NULL, BASE_10);
+        }
+        close(fd);
+    }
+    if (speed_mbps <= 0)
+    {
+        fprintf(stderr, "Warning: Link speed of %s is unknown, only its peak rates are published\n", interface);
+        return NO_THRESHOLD;
+    }
+    return (uint64_t)(speed_mbps * BYTES_PER_MEGABIT * DEFAULT_THRESHOLD_FRACTION);
+}
+
+/**
+ * @brief Crea un gauge con la etiqueta interface; devuelve NULL si algo falla.
+ */
+static prom_gauge_t* add_gauge(const char* name, const char* help)
+{
+    prom_gauge_t* gauge = prom_gauge_new(name, help, INTERFACE_LABELS, interface_label);
+    if (gauge != NULL && collector_runner_add_sampled_metric(NETWORK_COLLECTOR, gauge) != SUCCESS)
+    {
+        prom_gauge_destroy(gauge);
+        return NULL;
+    }
+    return gauge;
+}
+
+/**
+ * @brief Crea un histograma de ráfagas con la etiqueta interface; devuelve NULL si algo falla.
+ */
+static prom_histogram_t* add_histogram(const char* name, const char* help)
+{
+    prom_histogram_buckets_t* buckets =
+        prom_histogram_buckets_exponential(BURSTS_BUCKET_START, BURSTS_BUCKET_FACTOR, BURSTS_BUCKET_COUNT);
+    if (buckets == NULL)
+    {
+        return NULL;
+    }
+    prom_histogram_t* histogram = prom_histogram_new(name, help, buckets, INTERFACE_LABELS, interface_label);
+    if (histogram != NULL && collector_runner_add_sampled_metric(NETWORK_COLLECTOR, histogram) != SUCCESS)
+    {
+        prom_histogram_destroy(histogram);
+        return NULL;
+    }
+    return histogram;
+}
+
+/**
+ * @brief Abre los contadores de una interfaz y resuelve sus muestras.
+ */
+static int add_interface(const char* name, unsigned int threshold_mbps)
+{
+    if (interface_count == MAX_MICROBURST_INTERFACES)
+    {
+        fprintf(stderr, "Error: At most %d interfaces can be sampled for microbursts\n", MAX_MICROBURST_INTERFACES);
+        return ERROR;
+    }
+    if (strlen(name) == 0 || strlen(name) >= INTERFACE_NAME_SIZE || strchr(name, '/') != NULL)
+    {
+        fprintf(stderr, "Error: Invalid interface name '%s'\n", name);
+        return ERROR;
+    }
+
+    burst_interface_t* interface = &interfaces[interface_count];
+    memset(interface, 0, sizeof(*interface));
+    strcpy(interface->name, name);
+    interface->rx.fd = open_statistic(name, "rx_bytes");
+    interface->tx.fd = open_statistic(name, "tx_bytes");
+    if (interface->rx.fd == NO_FD || interface->tx.fd == NO_FD)
+    {
+        if (interface->rx.fd != NO_FD)
+        {
+            close(interface->rx.fd);
+        }
+        if (interface->tx.fd != NO_FD)
+        {
+            close(interface->tx.fd);
+        }
+        return ERROR;
+    }
+    interface->threshold = burst_threshold(name, threshold_mbps);
+
+    const char* labels[] = {interface->name};
+    interface->rx.peak_sample = prom_metric_sample_from_labels(rx_peak_metric, labels);
+    interface->tx.peak_sample = prom_metric_sample_from_labels(tx_peak_metric, labels);
+    if (interface->rx.peak_sample == NULL || interface->tx.peak_sample == NULL)
+    {
+        fprintf(stderr, "Error creating microburst metrics for %s\n", name);
+        return ERROR;
+    }
+
+    // Sin umbral no hay ráfagas que contar: la interfaz no tiene muestras en los histogramas
+    if (interface->threshold != NO_THRESHOLD)
+    {
+        interface->rx.bursts_sample = prom_metric_sample_histogram_from_labels(rx_bursts_metric, labels);
+        interface->tx.bursts_sample = prom_metric_sample_histogram_from_labels(tx_bursts_metric, labels);
+        if (interface->rx.bursts_sample == NULL || interface->tx.bursts_sample == NULL)
+        {
+            fprintf(stderr, "Error creating microburst metrics for %s\n", name);
+            return ERROR;
+        }
+    }
+    interface_count++;
+    return SUCCESS;
+}
+
+int microburst_init(const char* interface_list, unsigned int interval_ms, unsigned int threshold_mbps, int cpu)
+{
+    rx_peak_metric = add_gauge("network_rx_peak_rate_bps",
+                               "Highest receive rate in bytes per second between two microburst samples");
+    tx_peak_metric = add_gauge("network_tx_peak_rate_bps",
+                               "Highest transmit rate in bytes per second between two microburst samples");
+    rx_bursts_metric = add_histogram("network_rx_microbursts", "Receive bursts above the threshold per interval");
+    tx_bursts_metric = add_histogram("network_tx_microbursts", "Transmit bursts above the threshold per interval");
+    if (rx_peak_metric == NULL || tx_peak_metric == NULL || rx_bursts_metric == NULL || tx_bursts_metric == NULL)
+    {
+        fprintf(stderr, "Error creating microburst metrics\n");
+        return ERROR;
+    }
+
+    char* list = strdup(interface_list);
+    if (list == NULL)
+    {
+        return ERROR;
+    }
+    char* saveptr = NULL;
+    for (char* name = strtok_r(list, ",", &saveptr); name != NULL; name = strtok_r(NULL, ",", &saveptr))
+    {
+        if (add_interface(name, threshold_mbps) != SUCCESS)
+        {
+            free(list);
+            return ERROR;
+        }
+    }
+    free(list);
+    if (interface_count == 0)
+    {
+        fprintf(stderr, "Error: No interfaces to sample for microbursts\n");
+        return ERROR;
+    }
+
+    period_ns = (long long)interval_ms * NANOSECONDS_PER_MILLISECOND;
+
+    // Fijar el hilo antes de crearlo: una CPU inválida se informa al arrancar y no en silencio más tarde
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (cpu != MICROBURST_NO_CPU)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+    pthread_t thread;
+    int result = pthread_create(&thread, &attr, sampler_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (result != SUCCESS)
+    {
+        fprintf(stderr, "Error starting microburst sampling thread: %s\n", strerror(result));
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Publica y reinicia lo acumulado en un sentido de una interfaz.
+ */
+static void publish_direction(direction_t* direction)
+{
+    uint64_t peak = __atomic_exchange_n(&direction->peak, 0, __ATOMIC_RELAXED);
+    uint64_t bursts = __atomic_exchange_n(&direction->bursts, 0, __ATOMIC_RELAXED);
+    prom_metric_sample_set(direction->peak_sample, (double)peak);
+    if (direction->bursts_sample != NULL)
+    {
+        prom_metric_sample_histogram_observe(direction->bursts_sample, (double)bursts);
+    }
+}
+
+void microburst_publish(void)
+{
+    for (size_t i = 0; i < interface_count; i++)
+    {
+        publish_direction(&interfaces[i].rx);
+        publish_direction(&interfaces[i].tx);
+    }
+}
@@ -0,0 +1,289 @@
+#include "range_api.h"
+#include "chunk_store.h"
+#include "history.h"
+#include "rollup.h"
+#include "series.h"
+#include "value_format.h"
+#include <errno.h>
+#include <limits.h>
+#include <promhttp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_SINCE 0
+#define RAW_STEP 0
+#define MILLISECONDS_PER_SECOND 1000
+#define INITIAL_BODY_SIZE 4096
+#define GROWTH_FACTOR 2
+#define JSON_CONTENT_TYPE "application/json"
+
+/**
+ * @brief Cuerpo JSON que crece a medida que se escribe.
+ */
+typedef struct
+{
+    char* data;      /**< Texto escrito, terminado en '\0'. */
+    size_t len;      /**< Caracteres escritos. */
+    size_t capacity; /**< Bytes reservados. */
+    int failed;      /**< Distinto de cero si no hubo memoria; las escrituras siguientes se ignoran. */
+} json_body_t;
+
+/**
+ * @brief Agrega texto con formato al cuerpo, agrandándolo si hace falta.
+ */
+static void json_append(json_body_t* body, const char* format, ...)
+{
+    while (!body->failed)
+    {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(body->data + body->len, body->capacity - body->len, format, args);
+        va_end(args);
+        if (written < 0)
+        {
+            body->failed = 1;
+            return;
+        }
+        if ((size_t)written < body->capacity - body->len)
+        {
+            body->len += (size_t)written;
+            return;
+        }
+        size_t capacity = body->capacity * GROWTH_FACTOR;
+        while (capacity - body->len <= (size_t)written)
+        {
+            capacity *= GROWTH_FACTOR;
+        }
+        char* data = realloc(body->data, capacity);
+        if (data == NULL)
+        {
+            body->failed = 1;
+            return;
+        }
+        body->data = data;
+        body->capacity = capacity;
+    }
+}
+
+/**
+ * @brief Agrega un punto [segundos, "valor"] a un arreglo de valores.
+ */
+static void json_append_point(json_body_t* body, int first, long long timestamp_ms, double value)
+{
+    char text[VALUE_FORMAT_BUFFER_SIZE];
+    value_format(value, text, sizeof(text));
+    json_append(body, "%s[%lld.%03lld,\"%s\"]", first ? "" : ",", timestamp_ms / MILLISECONDS_PER_SECOND,
+                timestamp_ms % MILLISECONDS_PER_SECOND, text);
+}
+
+/**
+ * @brief Encola una respuesta JSON; si must_free es distinto de cero, microhttpd libera body al terminar.
+ */
+static enum MHD_Result queue_json(struct MHD_Connection* connection, unsigned int status, char* body, int must_free)
+{
+    struct MHD_Response* response = MHD_create_response_from_buffer(
+        strlen(body), body, must_free ? MHD_RESPMEM_MUST_FREE : MHD_RESPMEM_PERSISTENT);
+    if (response == NULL)
+    {
+        if (must_free)
+        {
+            free(body);
+        }
+        return MHD_NO;
+    }
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, JSON_CONTENT_TYPE);
+    enum MHD_Result ret = MHD_queue_response(connection, status, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+/**
+ * @brief Busca una serie por nombre en la tabla de series.
+ * @return Índice de la serie, o -1 si no existe.
+ */
+static long find_series(const char* name)
+{
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(series_get(i)->name, name) == 0)
+        {
+            return (long)i;
+        }
+    }
+    return ERROR;
+}
+
+/**
+ * @brief Interpreta un parámetro en segundos (admite decimales) como milisegundos; ausente vale default_ms.
+ */
+static int parse_seconds(const char* text, long long default_ms, long long* value_ms)
+{
+    if (text == NULL)
+    {
+        *value_ms = default_ms;
+        return SUCCESS;
+    }
+    char* end = NULL;
+    errno = 0;
+    double seconds = strtod(text, &end);
+    if (errno != 0 || end == text || *end != '\0' || !(seconds >= 0.0) || seconds > (double)(1LL << 52))
+    {
+        return ERROR;
+    }
+    *value_ms = (long long)(seconds * MILLISECONDS_PER_SECOND);
+    return SUCCESS;
+}
+
+/**
+ * @brief Estado del recorrido de muestras crudas del almacén comprimido.
+ */
+typedef struct
+{
+    json_body_t* body; /**< Cuerpo en construcción. */
+    int first;         /**< Distinto de cero hasta escribir el primer punto. */
+} raw_scan_t;
+
+static void append_raw_sample(long long timestamp_ms, double value, void* ctx)
+{
+    raw_scan_t* scan = (raw_scan_t*)ctx;
+    json_append_point(scan->body, scan->first, timestamp_ms, value);
+    scan->first = 0;
+}
+
+/**
+ * @brief Escribe las muestras crudas: del almacén comprimido si está activo, si no del historial reciente.
+ */
+static int append_raw(json_body_t* body, size_t index, long long since_ms)
+{
+    json_append(body, "\"resolution\":\"raw\",\"result\":[{\"metric\":{\"__name__\":\"%s\"},\"values\":[",
+                series_get(index)->name);
+    if (chunk_store_enabled())
+    {
+        raw_scan_t scan = {body, 1};
+        chunk_store_scan(index, since_ms, LLONG_MAX, append_raw_sample, &scan);
+    }
+    else
+    {
+        history_sample_t* samples = malloc(HISTORY_CAPACITY * sizeof(history_sample_t));
+        if (samples == NULL)
+        {
+            return ERROR;
+        }
+        size_t count = history_query(index, since_ms, samples);
+        for (size_t i = 0; i < count; i++)
+        {
+            json_append_point(body, i == 0, samples[i].timestamp_ms, samples[i].value);
+        }
+        free(samples);
+    }
+    json_append(body, "]}]");
+    return SUCCESS;
+}
+
+/**
+ * @brief Escribe los intervalos de un nivel como cuatro series, una por agregado (min, max, avg y last).
+ */
+static int append_rollup(json_body_t* body, size_t index, rollup_tier_t tier, long long since_ms)
+{
+    static const char* aggregations[] = {"min", "max", "avg", "last"};
+    const size_t aggregation_count = sizeof(aggregations) / sizeof(aggregations[0]);
+
+    rollup_bucket_t* buckets = malloc(rollup_tier_capacity(tier) * sizeof(rollup_bucket_t));
+    if (buckets == NULL)
+    {
+        return ERROR;
+    }
+    size_t count = rollup_query(index, tier, since_ms, buckets);
+
+    json_append(body, "\"resolution\":\"%llds\",\"result\":[",
+                rollup_tier_width_ms(tier) / MILLISECONDS_PER_SECOND);
+    for (size_t a = 0; a < aggregation_count; a++)
+    {
+        json_append(body, "%s{\"metric\":{\"__name__\":\"%s\",\"rollup\":\"%s\"},\"values\":[", a > 0 ? "," : "",
+                    series_get(index)->name, aggregations[a]);
+        for (size_t i = 0; i < count; i++)
+        {
+            const rollup_bucket_t* bucket = &buckets[i];
+            double values[] = {bucket->min, bucket->max, bucket->sum / bucket->count, bucket->last};
+            json_append_point(body, i == 0, bucket->start_ms, values[a]);
+        }
+        json_append(body, "]}");
+    }
+    json_append(body, "]");
+    free(buckets);
+    return SUCCESS;
+}
+
+static enum MHD_Result range_handler(struct MHD_Connection* connection, void* cls)
+{
+    (void)cls;
+
+    const char* metric = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "metric");
+    const char* since = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "since");
+    const char* step = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "step");
+    if (metric == NULL)
+    {
+        return queue_json(connection, MHD_HTTP_BAD_REQUEST,
+                          "{\"status\":\"error\",\"errorType\":\"bad_data\",\"error\":\"missing metric\"}", 0);
+    }
+    long long since_ms;
+    long long step_ms;
+    if (parse_seconds(since, NO_SINCE, &since_ms) != SUCCESS || parse_seconds(step, RAW_STEP, &step_ms) != SUCCESS)
+    {
+        return queue_json(connection, MHD_HTTP_BAD_REQUEST,
+                          "{\"status\":\"error\",\"errorType\":\"bad_data\",\"error\":\"invalid since or step\"}",
+                          0);
+    }
+    long index = find_series(metric);
+    if (index == ERROR)
+    {
+        return queue_json(connection, MHD_HTTP_NOT_FOUND,
+                          "{\"status\":\"error\",\"errorType\":\"not_found\",\"error\":\"unknown metric\"}", 0);
+    }
+
+    json_body_t body = {malloc(INITIAL_BODY_SIZE), 0, INITIAL_BODY_SIZE, 0};
+    if (body.data == NULL)
+    {
+        return MHD_NO;
+    }
+    body.data[0] = '\0';
+    json_append(&body, "{\"status\":\"success\",\"data\":{\"resultType\":\"matrix\",");
+
+    // El nivel más grueso cuyo intervalo no supera el paso pedido; con pasos menores a 10 s, las muestras crudas
+    int result = ERROR;
+    if (step_ms >= rollup_tier_width_ms(ROLLUP_TIER_1M))
+    {
+        result = append_rollup(&body, (size_t)index, ROLLUP_TIER_1M, since_ms);
+    }
+    else if (step_ms >= rollup_tier_width_ms(ROLLUP_TIER_10S))
+    {
+        result = append_rollup(&body, (size_t)index, ROLLUP_TIER_10S, since_ms);
+    }
+    else
+    {
+        result = append_raw(&body, (size_t)index, since_ms);
+    }
+    json_append(&body, "}}");
+
+    if (result != SUCCESS || body.failed)
+    {
+        free(body.data);
+        return MHD_NO;
+    }
+    return queue_json(connection, MHD_HTTP_OK, body.data, 1);
+}
+
+int range_api_register(void)
+{
+    if (promhttp_register_route(RANGE_API_URL, range_handler, NULL) != SUCCESS)
+    {
+        fprintf(stderr, "Error registering %s\n", RANGE_API_URL);
+        return ERROR;
+    }
+    return SUCCESS;
+}
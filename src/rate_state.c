@@ -0,0 +1,136 @@
+#include "rate_state.h"
+#include "timing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define STATE_FILE_MODE 0644
+#define TEMP_SUFFIX ".tmp"
+#define PATH_SIZE 256
+#define BOOT_ID_PATH "/proc/sys/kernel/random/boot_id"
+
+/**
+ * @brief Contenido del archivo de estado.
+ */
+typedef struct
+{
+    uint32_t magic;                         /**< RATE_STATE_MAGIC. */
+    uint32_t version;                       /**< RATE_STATE_VERSION. */
+    uint32_t size;                          /**< sizeof(rate_state_file_t); cambia si cambian las estructuras. */
+    uint32_t reserved;                      /**< Sin uso, en cero. */
+    char boot_id[RATE_STATE_BOOT_ID_SIZE];  /**< Boot id del kernel cuando se guardó. */
+    double saved_at;                        /**< Momento de la escritura (CLOCK_MONOTONIC). */
+    rate_state_t state;                     /**< Lecturas anteriores. */
+} rate_state_file_t;
+
+/** Lecturas anteriores de este proceso */
+static rate_state_t rate_state;
+
+/** Copia ligada al hilo con rate_state_bind, o NULL para usar el estado del proceso */
+static __thread rate_state_t* bound_state = NULL;
+
+rate_state_t* rate_state_get(void)
+{
+    return bound_state != NULL ? bound_state : &rate_state;
+}
+
+void rate_state_bind(rate_state_t* state)
+{
+    bound_state = state;
+}
+
+/**
+ * @brief Lee el boot id del kernel, sin el salto de línea final.
+ */
+static int read_boot_id(char* boot_id)
+{
+    FILE* fp = fopen(BOOT_ID_PATH, "r");
+    if (fp == NULL)
+    {
+        return ERROR;
+    }
+    int result = fgets(boot_id, RATE_STATE_BOOT_ID_SIZE, fp) != NULL ? SUCCESS : ERROR;
+    fclose(fp);
+    boot_id[strcspn(boot_id, "\n")] = '\0';
+    return result;
+}
+
+int rate_state_load(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return ERROR;
+    }
+    rate_state_file_t saved;
+    size_t read = fread(&saved, sizeof(saved), 1, fp);
+    fclose(fp);
+
+    char boot_id[RATE_STATE_BOOT_ID_SIZE] = {0};
+    if (read != 1 || saved.magic != RATE_STATE_MAGIC || saved.version != RATE_STATE_VERSION ||
+        saved.size != sizeof(saved) || read_boot_id(boot_id) != SUCCESS)
+    {
+        fprintf(stderr, "Ignoring state file %s: unreadable or different format\n", path);
+        return ERROR;
+    }
+
+    // Las marcas monótonas de otro arranque no son comparables con las de este
+    saved.boot_id[RATE_STATE_BOOT_ID_SIZE - 1] = '\0';
+    if (strcmp(saved.boot_id, boot_id) != SUCCESS)
+    {
+        printf("Ignoring state file %s: saved before the last reboot\n", path);
+        return ERROR;
+    }
+    double age = timing_now() - saved.saved_at;
+    if (age < 0 || age > RATE_STATE_MAX_AGE)
+    {
+        printf("Ignoring state file %s: saved %.0f seconds ago\n", path, age);
+        return ERROR;
+    }
+
+    rate_state = saved.state;
+    printf("Restored rate state from %s (saved %.0f seconds ago)\n", path, age);
+    return SUCCESS;
+}
+
+int rate_state_save(const char* path)
+{
+    char temp_path[PATH_SIZE];
+    if (snprintf(temp_path, sizeof(temp_path), "%s%s", path, TEMP_SUFFIX) >= (int)sizeof(temp_path))
+    {
+        fprintf(stderr, "State file path too long: %s\n", path);
+        return ERROR;
+    }
+
+    rate_state_file_t saved;
+    memset(&saved, 0, sizeof(saved));
+    saved.magic = RATE_STATE_MAGIC;
+    saved.version = RATE_STATE_VERSION;
+    saved.size = sizeof(saved);
+    if (read_boot_id(saved.boot_id) != SUCCESS)
+    {
+        fprintf(stderr, "Error reading %s\n", BOOT_ID_PATH);
+        return ERROR;
+    }
+    saved.saved_at = timing_now();
+    saved.state = rate_state;
+
+    // El archivo completo se escribe aparte y se renombra: un corte a mitad de camino deja el estado anterior
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, STATE_FILE_MODE);
+    if (fd < SUCCESS)
+    {
+        fprintf(stderr, "Error creating state file %s: %s\n", temp_path, strerror(errno));
+        return ERROR;
+    }
+    ssize_t written = write(fd, &saved, sizeof(saved));
+    int closed = close(fd);
+    if (written != (ssize_t)sizeof(saved) || closed != SUCCESS || rename(temp_path, path) != SUCCESS)
+    {
+        fprintf(stderr, "Error writing state file %s: %s\n", path, strerror(errno));
+        unlink(temp_path);
+        return ERROR;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,781 @@
+#include "remote_write.h"
+#include "series.h"
+#include "snappy.h"
+#include "timing.h"
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define NO_SOCKET -1
+#define NO_TIMESTAMP 0
+#define URL_SCHEME "http://"
+#define DEFAULT_HTTP_PORT "80"
+#define DEFAULT_PATH "/"
+#define HOST_SIZE 256
+#define PORT_SIZE 8
+#define PATH_SIZE 512
+#define REQUEST_HEADER_SIZE 1024
+#define RESPONSE_BUFFER_SIZE 4096
+#define SOCKET_TIMEOUT_SECONDS 10
+// Holgura del lote por serie sobre una lectura por segundo
+#define PENDING_SLACK 2
+#define INITIAL_BUFFER_SIZE 4096
+#define GROWTH_FACTOR 2
+#define INITIAL_BACKOFF_MS 500
+#define MAX_BACKOFF_MS 60000
+#define MILLISECONDS_PER_SECOND 1000
+#define NANOSECONDS_PER_MILLISECOND 1000000L
+#define HTTP_OK_MIN 200
+#define HTTP_OK_MAX 299
+#define HTTP_CLIENT_ERROR_MIN 400
+#define HTTP_CLIENT_ERROR_MAX 499
+#define HTTP_TOO_MANY_REQUESTS 429
+#define HTTP_NO_CONTENT 204
+#define HTTP_NOT_MODIFIED 304
+#define DECIMAL_BASE 10
+
+// Números de campo y tipos de cable de prometheus.WriteRequest (remote.proto / types.proto)
+#define WIRE_VARINT 0
+#define WIRE_FIXED64 1
+#define WIRE_LENGTH_DELIMITED 2
+#define FIELD_WRITE_REQUEST_TIMESERIES 1
+#define FIELD_TIMESERIES_LABELS 1
+#define FIELD_TIMESERIES_SAMPLES 2
+#define FIELD_LABEL_NAME 1
+#define FIELD_LABEL_VALUE 2
+#define FIELD_SAMPLE_VALUE 1
+#define FIELD_SAMPLE_TIMESTAMP 2
+#define TAG_SHIFT 3
+#define VARINT_CONTINUE 0x80
+#define VARINT_SHIFT 7
+#define FIXED64_BYTES 8
+#define BITS_PER_BYTE 8
+#define BOOT_ID_PATH "/proc/sys/kernel/random/boot_id"
+#define BOOT_ID_SIZE 64
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define XORSHIFT_A 13
+#define XORSHIFT_B 7
+#define XORSHIFT_C 17
+
+/**
+ * @brief Búfer de bytes que crece a medida que se escribe.
+ */
+typedef struct
+{
+    uint8_t* data;   /**< Bytes escritos. */
+    size_t len;      /**< Bytes usados. */
+    size_t capacity; /**< Bytes reservados. */
+    int failed;      /**< Distinto de cero si no hubo memoria; las escrituras siguientes se ignoran. */
+} byte_buffer_t;
+
+/**
+ * @brief Lote comprimido listo para enviar.
+ */
+typedef struct
+{
+    uint8_t* data;  /**< WriteRequest comprimido con Snappy. */
+    size_t size;    /**< Bytes de data. */
+    size_t samples; /**< Muestras del lote. */
+} batch_t;
+
+/**
+ * @brief Lecturas de una serie acumuladas en el lote abierto.
+ */
+typedef struct
+{
+    double* values;          /**< Valores. */
+    long long* timestamps;   /**< Marcas de tiempo (ms). */
+    size_t count;            /**< Lecturas acumuladas. */
+    long long last_recorded; /**< Marca de tiempo de la última lectura agregada. */
+} pending_series_t;
+
+/** Receptor */
+static char endpoint_host[HOST_SIZE];
+static char endpoint_port[PORT_SIZE];
+static char endpoint_path[PATH_SIZE];
+
+/** Valor de la etiqueta instance */
+static char instance_label[HOST_SIZE];
+
+/** Lecturas del lote abierto por serie, NULL si el envío no está activo */
+static pending_series_t* pending = NULL;
+
+/** Series con lecturas en el lote y capacidad por serie */
+static size_t pending_series_total = 0;
+static size_t pending_capacity = 0;
+
+/** Segundos por lote y momento (CLOCK_MONOTONIC, segundos) en que se abrió el lote actual */
+static double batch_interval = 0;
+static double batch_opened = 0;
+
+/** Cola de lotes por enviar, del más antiguo al más reciente desde queue_first */
+static batch_t* queue = NULL;
+static size_t queue_capacity = 0;
+static size_t queue_first = 0;
+static size_t queue_count = 0;
+
+/** Lotes descartados por cola llena o rechazo permanente del receptor */
+static unsigned long long dropped_batches = 0;
+
+/** Estado del generador de la variación de espera; distinto en cada host y proceso, solo lo usa el hilo emisor */
+static uint64_t jitter_state = 0;
+
+/** Protege la cola: el colector agrega lotes mientras el hilo emisor los consume */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Separa una URL http://host[:puerto][/ruta]; un host IPv6 va entre corchetes.
+ */
+static int parse_url(const char* url)
+{
+    size_t scheme_length = strlen(URL_SCHEME);
+    if (strncmp(url, URL_SCHEME, scheme_length) != SUCCESS)
+    {
+        fprintf(stderr, "Invalid remote write URL '%s': only http:// is supported\n", url);
+        return ERROR;
+    }
+    const char* authority = url + scheme_length;
+    const char* path = strchr(authority, '/');
+    size_t authority_length = path != NULL ? (size_t)(path - authority) : strlen(authority);
+
+    const char* host = authority;
+    size_t host_length = authority_length;
+    const char* port = NULL;
+    if (*authority == '[')
+    {
+        const char* close = memchr(authority, ']', authority_length);
+        if (close == NULL)
+        {
+            fprintf(stderr, "Invalid remote write URL '%s': unterminated IPv6 address\n", url);
+            return ERROR;
+        }
+        host = authority + 1;
+        host_length = (size_t)(close - host);
+        port = close + 1 < authority + authority_length && close[1] == ':' ? close + 2 : NULL;
+    }
+    else
+    {
+        const char* colon = memchr(authority, ':', authority_length);
+        if (colon != NULL)
+        {
+            host_length = (size_t)(colon - authority);
+            port = colon + 1;
+        }
+    }
+    size_t port_length = port != NULL ? (size_t)(authority + authority_length - port) : 0;
+
+    if (host_length == 0 || host_length >= sizeof(endpoint_host) || port_length >= sizeof(endpoint_port) ||
+        (port != NULL && port_length == 0) || (path != NULL && strlen(path) >= sizeof(endpoint_path)))
+    {
+        fprintf(stderr, "Invalid remote write URL '%s'\n", url);
+        return ERROR;
+    }
+    memcpy(endpoint_host, host, host_length);
+    endpoint_host[host_length] = '\0';
+    if (port != NULL)
+    {
+        memcpy(endpoint_port, port, port_length);
+        endpoint_port[port_length] = '\0';
+    }
+    else
+    {
+        strcpy(endpoint_port, DEFAULT_HTTP_PORT);
+    }
+    strcpy(endpoint_path, path != NULL ? path : DEFAULT_PATH);
+    return SUCCESS;
+}
+
+static void buffer_reserve(byte_buffer_t* buffer, size_t extra)
+{
+    if (buffer->failed || buffer->len + extra <= buffer->capacity)
+    {
+        return;
+    }
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : INITIAL_BUFFER_SIZE;
+    while (capacity < buffer->len + extra)
+    {
+        capacity *= GROWTH_FACTOR;
+    }
+    uint8_t* data = realloc(buffer->data, capacity);
+    if (data == NULL)
+    {
+        buffer->failed = BOOL_TRUE;
+        return;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+}
+
+static size_t varint_size(uint64_t value)
+{
+    size_t size = 1;
+    while (value >= VARINT_CONTINUE)
+    {
+        value >>= VARINT_SHIFT;
+        size++;
+    }
+    return size;
+}
+
+static void put_varint(byte_buffer_t* buffer, uint64_t value)
+{
+    buffer_reserve(buffer, varint_size(value));
+    if (buffer->failed)
+    {
+        return;
+    }
+    while (value >= VARINT_CONTINUE)
+    {
+        buffer->data[buffer->len++] = (uint8_t)(value | VARINT_CONTINUE);
+        value >>= VARINT_SHIFT;
+    }
+    buffer->data[buffer->len++] = (uint8_t)value;
+}
+
+static void put_tag(byte_buffer_t* buffer, unsigned int field, unsigned int wire_type)
+{
+    put_varint(buffer, (uint64_t)(field << TAG_SHIFT | wire_type));
+}
+
+static void put_bytes(byte_buffer_t* buffer, const void* bytes, size_t length)
+{
+    buffer_reserve(buffer, length);
+    if (buffer->failed)
+    {
+        return;
+    }
+    memcpy(buffer->data + buffer->len, bytes, length);
+    buffer->len += length;
+}
+
+/**
+ * @brief Escribe un double como fixed64 little endian, independientemente del orden de bytes del host.
+ */
+static void put_double(byte_buffer_t* buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t bytes[FIXED64_BYTES];
+    for (int i = 0; i < FIXED64_BYTES; i++)
+    {
+        bytes[i] = (uint8_t)(bits >> (i * BITS_PER_BYTE));
+    }
+    put_bytes(buffer, bytes, sizeof(bytes));
+}
+
+/**
+ * @brief Tamaño de un campo length-delimited de un byte de tag con contenido de length bytes.
+ */
+static size_t field_size(size_t length)
+{
+    return 1 + varint_size(length) + length;
+}
+
+static size_t label_size(const char* name, const char* value)
+{
+    return field_size(strlen(name)) + field_size(strlen(value));
+}
+
+static size_t sample_size(long long timestamp_ms)
+{
+    return 1 + FIXED64_BYTES + 1 + varint_size((uint64_t)timestamp_ms);
+}
+
+static void put_label(byte_buffer_t* buffer, const char* name, const char* value)
+{
+    put_tag(buffer, FIELD_TIMESERIES_LABELS, WIRE_LENGTH_DELIMITED);
+    put_varint(buffer, label_size(name, value));
+    put_tag(buffer, FIELD_LABEL_NAME, WIRE_LENGTH_DELIMITED);
+    put_varint(buffer, strlen(name));
+    put_bytes(buffer, name, strlen(name));
+    put_tag(buffer, FIELD_LABEL_VALUE, WIRE_LENGTH_DELIMITED);
+    put_varint(buffer, strlen(value));
+    put_bytes(buffer, value, strlen(value));
+}
+
+/**
+ * @brief Codifica una TimeSeries con sus etiquetas, ordenadas por nombre, y las lecturas acumuladas.
+ */
+static void put_timeseries(byte_buffer_t* buffer, const char* name, const pending_series_t* series)
+{
+    const char* label_names[] = {"__name__", "instance", "job"};
+    const char* label_values[] = {name, instance_label, REMOTE_WRITE_JOB};
+    const size_t label_count = sizeof(label_names) / sizeof(label_names[0]);
+
+    // Los tamaños se calculan antes para escribir cada mensaje anidado de una sola pasada
+    size_t size = 0;
+    for (size_t i = 0; i < label_count; i++)
+    {
+        size += field_size(label_size(label_names[i], label_values[i]));
+    }
+    for (size_t i = 0; i < series->count; i++)
+    {
+        size += field_size(sample_size(series->timestamps[i]));
+    }
+
+    put_tag(buffer, FIELD_WRITE_REQUEST_TIMESERIES, WIRE_LENGTH_DELIMITED);
+    put_varint(buffer, size);
+    for (size_t i = 0; i < label_count; i++)
+    {
+        put_label(buffer, label_names[i], label_values[i]);
+    }
+    for (size_t i = 0; i < series->count; i++)
+    {
+        put_tag(buffer, FIELD_TIMESERIES_SAMPLES, WIRE_LENGTH_DELIMITED);
+        put_varint(buffer, sample_size(series->timestamps[i]));
+        put_tag(buffer, FIELD_SAMPLE_VALUE, WIRE_FIXED64);
+        put_double(buffer, series->values[i]);
+        put_tag(buffer, FIELD_SAMPLE_TIMESTAMP, WIRE_VARINT);
+        put_varint(buffer, (uint64_t)series->timestamps[i]);
+    }
+}
+
+/**
+ * @brief Encola un lote; con la cola llena descarta el más antiguo. El hilo emisor ya tiene el que está enviando.
+ */
+static void enqueue_batch(const batch_t* batch)
+{
+    pthread_mutex_lock(&queue_lock);
+    if (queue_count == queue_capacity)
+    {
+        free(queue[queue_first].data);
+        queue_first = (queue_first + 1) % queue_capacity;
+        queue_count--;
+        dropped_batches++;
+        fprintf(stderr, "Remote write queue full, dropped oldest batch (%llu dropped so far)\n", dropped_batches);
+    }
+    queue[(queue_first + queue_count) % queue_capacity] = *batch;
+    queue_count++;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+/**
+ * @brief Codifica y comprime las lecturas acumuladas y deja el lote abierto vacío.
+ */
+static void seal_batch(void)
+{
+    byte_buffer_t request = {NULL, 0, 0, BOOL_FALSE};
+    size_t samples = 0;
+    for (size_t i = 0; i < pending_series_total; i++)
+    {
+        if (pending[i].count > 0)
+        {
+            put_timeseries(&request, series_get(i)->name, &pending[i]);
+            samples += pending[i].count;
+            pending[i].count = 0;
+        }
+    }
+    batch_opened = timing_now();
+    if (samples == 0 || request.failed)
+    {
+        free(request.data);
+        return;
+    }
+
+    batch_t batch = {malloc(snappy_max_compressed_length(request.len)), 0, samples};
+    if (batch.data == NULL)
+    {
+        fprintf(stderr, "Error allocating remote write batch\n");
+        free(request.data);
+        return;
+    }
+    batch.size = snappy_compress(request.data, request.len, batch.data);
+    free(request.data);
+    enqueue_batch(&batch);
+}
+
+void remote_write_record(void)
+{
+    if (pending == NULL)
+    {
+        return;
+    }
+
+    int full = BOOL_FALSE;
+    for (size_t i = 0; i < pending_series_total; i++)
+    {
+        const series_t* series = series_get(i);
+        pending_series_t* batch_series = &pending[i];
+        if (series->timestamp_ms == NO_TIMESTAMP || series->timestamp_ms <= batch_series->last_recorded)
+        {
+            continue;
+        }
+        batch_series->values[batch_series->count] = series->value;
+        batch_series->timestamps[batch_series->count] = series->timestamp_ms;
+        batch_series->count++;
+        batch_series->last_recorded = series->timestamp_ms;
+        full = full || batch_series->count == pending_capacity;
+    }
+
+    if (full || timing_now() - batch_opened >= batch_interval)
+    {
+        seal_batch();
+    }
+}
+
+static int connect_endpoint(void)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses = NULL;
+    int resolved = getaddrinfo(endpoint_host, endpoint_port, &hints, &addresses);
+    if (resolved != SUCCESS)
+    {
+        fprintf(stderr, "Error resolving remote write host %s: %s\n", endpoint_host, gai_strerror(resolved));
+        return NO_SOCKET;
+    }
+
+    int fd = NO_SOCKET;
+    for (struct addrinfo* address = addresses; address != NULL && fd == NO_SOCKET; address = address->ai_next)
+    {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd == NO_SOCKET)
+        {
+            continue;
+        }
+        struct timeval timeout = {SOCKET_TIMEOUT_SECONDS, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != SUCCESS)
+        {
+            close(fd);
+            fd = NO_SOCKET;
+        }
+    }
+    freeaddrinfo(addresses);
+    return fd;
+}
+
+static int send_all(int fd, const void* data, size_t length)
+{
+    const uint8_t* bytes = data;
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return ERROR;
+        }
+        bytes += sent;
+        length -= (size_t)sent;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Lee la respuesta y descarta el cuerpo; indica si la conexión puede reutilizarse.
+ * @return Código de estado HTTP, o -1 si la respuesta no llegó completa.
+ */
+static int read_response(int fd, int* keep_alive)
+{
+    char buffer[RESPONSE_BUFFER_SIZE];
+    size_t used = 0;
+    char* headers_end = NULL;
+    while (headers_end == NULL)
+    {
+        if (used == sizeof(buffer) - 1)
+        {
+            return ERROR;
+        }
+        ssize_t received = recv(fd, buffer + used, sizeof(buffer) - 1 - used, 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            return ERROR;
+        }
+        used += (size_t)received;
+        buffer[used] = '\0';
+        headers_end = strstr(buffer, "\r\n\r\n");
+    }
+
+    int status;
+    if (sscanf(buffer, "HTTP/%*d.%*d %d", &status) != 1)
+    {
+        return ERROR;
+    }
+
+    // Sin Content-Length (ni 204/304) el cuerpo termina al cerrar la conexión; chunked tampoco se interpreta
+    long long content_length = -1;
+    *keep_alive = BOOL_TRUE;
+    *headers_end = '\0';
+    for (char* line = strstr(buffer, "\r\n"); line != NULL; line = strstr(line, "\r\n"))
+    {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", strlen("Content-Length:")) == SUCCESS)
+        {
+            content_length = strtoll(line + strlen("Content-Length:"), NULL, DECIMAL_BASE);
+        }
+        else if (strncasecmp(line, "Connection: close", strlen("Connection: close")) == SUCCESS ||
+                 strncasecmp(line, "Transfer-Encoding:", strlen("Transfer-Encoding:")) == SUCCESS)
+        {
+            *keep_alive = BOOL_FALSE;
+        }
+    }
+    if (status == HTTP_NO_CONTENT || status == HTTP_NOT_MODIFIED)
+    {
+        content_length = 0;
+    }
+    if (content_length < 0)
+    {
+        *keep_alive = BOOL_FALSE;
+        return status;
+    }
+
+    long long remaining = content_length - (long long)(used - (size_t)(headers_end + 4 - buffer));
+    while (remaining > 0)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            *keep_alive = BOOL_FALSE;
+            break;
+        }
+        remaining -= received;
+    }
+    return status;
+}
+
+/**
+ * @brief Envía un lote por la conexión persistente, abriéndola si hace falta.
+ * @return Código de estado HTTP, o -1 ante un error de red.
+ */
+static int post_batch(int* fd, const batch_t* batch)
+{
+    char header[REQUEST_HEADER_SIZE];
+    int header_length = snprintf(header, sizeof(header),
+                                 "POST %s HTTP/1.1\r\n"
+                                 "Host: %s%s%s:%s\r\n"
+                                 "User-Agent: " REMOTE_WRITE_JOB "\r\n"
+                                 "Content-Type: application/x-protobuf\r\n"
+                                 "Content-Encoding: snappy\r\n"
+                                 "X-Prometheus-Remote-Write-Version: " REMOTE_WRITE_PROTOCOL_VERSION "\r\n"
+                                 "Content-Length: %zu\r\n"
+                                 "\r\n",
+                                 endpoint_path, strchr(endpoint_host, ':') != NULL ? "[" : "", endpoint_host,
+                                 strchr(endpoint_host, ':') != NULL ? "]" : "", endpoint_port, batch->size);
+
+    // Una conexión reutilizada pudo cerrarse del otro lado: se reintenta una vez con una nueva
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        int reused = *fd != NO_SOCKET;
+        if (*fd == NO_SOCKET && (*fd = connect_endpoint()) == NO_SOCKET)
+        {
+            return ERROR;
+        }
+        int keep_alive = BOOL_FALSE;
+        int status = ERROR;
+        if (send_all(*fd, header, (size_t)header_length) == SUCCESS &&
+            send_all(*fd, batch->data, batch->size) == SUCCESS)
+        {
+            status = read_response(*fd, &keep_alive);
+        }
+        if (status == ERROR || !keep_alive)
+        {
+            close(*fd);
+            *fd = NO_SOCKET;
+        }
+        if (status != ERROR || !reused)
+        {
+            return status;
+        }
+    }
+    return ERROR;
+}
+
+static void sleep_ms(long long milliseconds)
+{
+    struct timespec delay = {milliseconds / MILLISECONDS_PER_SECOND,
+                             (milliseconds % MILLISECONDS_PER_SECOND) * NANOSECONDS_PER_MILLISECOND};
+    while (nanosleep(&delay, &delay) != SUCCESS && errno == EINTR)
+    {
+    }
+}
+
+/**
+ * @brief Mezcla una cadena en un hash FNV-1a.
+ */
+static uint64_t hash_string(uint64_t hash, const char* text)
+{
+    for (const char* c = text; *c != '\0'; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Siembra la variación de espera con el boot id, el hostname, el pid y el reloj, de modo que agentes
+ * arrancados a la vez no reintenten al mismo ritmo.
+ */
+static void seed_jitter(void)
+{
+    char boot_id[BOOT_ID_SIZE] = {0};
+    FILE* fp = fopen(BOOT_ID_PATH, "r");
+    if (fp != NULL)
+    {
+        if (fgets(boot_id, sizeof(boot_id), fp) == NULL)
+        {
+            boot_id[0] = '\0';
+        }
+        fclose(fp);
+    }
+    uint64_t hash = hash_string(hash_string(FNV_OFFSET_BASIS, boot_id), instance_label);
+    hash = (hash ^ (uint64_t)getpid()) * FNV_PRIME;
+    hash = (hash ^ (uint64_t)timing_clock_ns(CLOCK_MONOTONIC)) * FNV_PRIME;
+    jitter_state = hash != 0 ? hash : FNV_OFFSET_BASIS;
+}
+
+/**
+ * @brief Siguiente valor del generador xorshift64 de la variación de espera.
+ */
+static uint64_t next_jitter(void)
+{
+    jitter_state ^= jitter_state << XORSHIFT_A;
+    jitter_state ^= jitter_state >> XORSHIFT_B;
+    jitter_state ^= jitter_state << XORSHIFT_C;
+    return jitter_state;
+}
+
+/**
+ * @brief Hilo emisor: envía los lotes en orden, reintentando el actual hasta que el receptor lo acepte o rechace.
+ */
+static void* sender_thread(void* arg)
+{
+    (void)arg;
+    int fd = NO_SOCKET;
+    long long backoff_ms = INITIAL_BACKOFF_MS;
+    int failing = BOOL_FALSE;
+
+    while (BOOL_TRUE)
+    {
+        pthread_mutex_lock(&queue_lock);
+        while (queue_count == 0)
+        {
+            pthread_cond_wait(&queue_ready, &queue_lock);
+        }
+        batch_t batch = queue[queue_first];
+        queue_first = (queue_first + 1) % queue_capacity;
+        queue_count--;
+        pthread_mutex_unlock(&queue_lock);
+
+        while (BOOL_TRUE)
+        {
+            int status = post_batch(&fd, &batch);
+            if (status >= HTTP_OK_MIN && status <= HTTP_OK_MAX)
+            {
+                if (failing)
+                {
+                    fprintf(stderr, "Remote write recovered\n");
+                    failing = BOOL_FALSE;
+                }
+                backoff_ms = INITIAL_BACKOFF_MS;
+                break;
+            }
+            if (status >= HTTP_CLIENT_ERROR_MIN && status <= HTTP_CLIENT_ERROR_MAX &&
+                status != HTTP_TOO_MANY_REQUESTS)
+            {
+                // El receptor no va a aceptar este lote aunque se reintente
+                fprintf(stderr, "Remote write rejected a batch of %zu samples with status %d\n", batch.samples,
+                        status);
+                pthread_mutex_lock(&queue_lock);
+                dropped_batches++;
+                pthread_mutex_unlock(&queue_lock);
+                break;
+            }
+
+            if (!failing)
+            {
+                if (status == ERROR)
+                {
+                    fprintf(stderr, "Remote write to %s:%s failed (network error), retrying with backoff\n",
+                            endpoint_host, endpoint_port);
+                }
+                else
+                {
+                    fprintf(stderr, "Remote write to %s:%s failed (status %d), retrying with backoff\n",
+                            endpoint_host, endpoint_port, status);
+                }
+                failing = BOOL_TRUE;
+            }
+            // Espera exponencial con variación aleatoria para no sincronizar reintentos de muchos hosts
+            sleep_ms(backoff_ms / 2 + (long long)(next_jitter() % (uint64_t)(backoff_ms / 2 + 1)));
+            backoff_ms = backoff_ms * GROWTH_FACTOR > MAX_BACKOFF_MS ? MAX_BACKOFF_MS : backoff_ms * GROWTH_FACTOR;
+        }
+        free(batch.data);
+    }
+    return NULL;
+}
+
+int remote_write_init(const char* url, unsigned int interval_seconds, unsigned int queue_batches)
+{
+    if (parse_url(url) != SUCCESS)
+    {
+        return ERROR;
+    }
+    if (gethostname(instance_label, sizeof(instance_label) - 1) != SUCCESS)
+    {
+        strcpy(instance_label, "localhost");
+    }
+    seed_jitter();
+
+    pending_series_total = series_count();
+    pending_capacity = (size_t)interval_seconds * PENDING_SLACK;
+    pending = calloc(pending_series_total > 0 ? pending_series_total : 1, sizeof(pending_series_t));
+    queue = calloc(queue_batches, sizeof(batch_t));
+    if (pending == NULL || queue == NULL)
+    {
+        fprintf(stderr, "Error allocating remote write buffers\n");
+        return ERROR;
+    }
+    for (size_t i = 0; i < pending_series_total; i++)
+    {
+        pending[i].values = malloc(pending_capacity * sizeof(double));
+        pending[i].timestamps = malloc(pending_capacity * sizeof(long long));
+        if (pending[i].values == NULL || pending[i].timestamps == NULL)
+        {
+            fprintf(stderr, "Error allocating remote write buffers\n");
+            return ERROR;
+        }
+    }
+    queue_capacity = queue_batches;
+    batch_interval = interval_seconds;
+    batch_opened = timing_now();
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sender_thread, NULL) != SUCCESS)
+    {
+        fprintf(stderr, "Error starting remote write thread\n");
+        return ERROR;
+    }
+    pthread_detach(thread);
+    return SUCCESS;
+}
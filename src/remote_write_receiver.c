@@ -0,0 +1,442 @@
+/**
+ * @file remote_write_receiver.c
+ * @brief Receptor remote_write mínimo para probar el envío del monitor sin un Prometheus real.
+ *
+ * Atiende POST de a una conexión por vez (con keep-alive), descomprime el cuerpo Snappy, decodifica el WriteRequest
+ * y responde 204. Imprime un resumen por lote y, con --verbose, cada muestra. --fail-every N responde 503 a una de
+ * cada N peticiones para ejercitar los reintentos.
+ *
+ * Uso: remote-write-receiver [--port N] [--fail-every N] [--verbose]
+ */
+
+#include "snappy.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define DEFAULT_PORT 9201
+#define LISTEN_BACKLOG 16
+#define HEADER_BUFFER_SIZE 8192
+#define MAX_BODY_SIZE (64 * 1024 * 1024)
+#define NAME_SIZE 256
+#define DECIMAL_BASE 10
+#define WIRE_VARINT 0
+#define WIRE_FIXED64 1
+#define WIRE_LENGTH_DELIMITED 2
+#define WIRE_FIXED32 5
+#define TAG_SHIFT 3
+#define WIRE_TYPE_MASK 0x7
+#define VARINT_MASK 0x7f
+#define VARINT_CONTINUE 0x80
+#define VARINT_SHIFT 7
+#define MAX_VARINT_SHIFT 63
+#define FIXED64_BYTES 8
+#define FIXED32_BYTES 4
+#define BITS_PER_BYTE 8
+#define FIELD_TIMESERIES 1
+#define FIELD_LABELS 1
+#define FIELD_SAMPLES 2
+#define FIELD_NAME 1
+#define FIELD_VALUE 2
+
+/**
+ * @brief Lector de un mensaje protobuf.
+ */
+typedef struct
+{
+    const uint8_t* data; /**< Próximo byte. */
+    const uint8_t* end;  /**< Fin del mensaje. */
+} proto_reader_t;
+
+/**
+ * @brief Totales de un WriteRequest.
+ */
+typedef struct
+{
+    size_t series;  /**< TimeSeries. */
+    size_t samples; /**< Muestras. */
+} write_summary_t;
+
+static int verbose = BOOL_FALSE;
+
+static int read_varint(proto_reader_t* reader, uint64_t* value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift <= MAX_VARINT_SHIFT && reader->data < reader->end; shift += VARINT_SHIFT)
+    {
+        uint8_t byte = *reader->data++;
+        result |= (uint64_t)(byte & VARINT_MASK) << shift;
+        if ((byte & VARINT_CONTINUE) == 0)
+        {
+            *value = result;
+            return SUCCESS;
+        }
+    }
+    return ERROR;
+}
+
+/**
+ * @brief Lee el próximo campo; para los length-delimited deja en sub el contenido.
+ */
+static int read_field(proto_reader_t* reader, unsigned int* field, unsigned int* wire_type, uint64_t* value,
+                      proto_reader_t* sub)
+{
+    uint64_t tag;
+    if (read_varint(reader, &tag) != SUCCESS)
+    {
+        return ERROR;
+    }
+    *field = (unsigned int)(tag >> TAG_SHIFT);
+    *wire_type = (unsigned int)(tag & WIRE_TYPE_MASK);
+    switch (*wire_type)
+    {
+    case WIRE_VARINT:
+        return read_varint(reader, value);
+    case WIRE_FIXED64:
+    case WIRE_FIXED32:
+    {
+        int bytes = *wire_type == WIRE_FIXED64 ? FIXED64_BYTES : FIXED32_BYTES;
+        if (reader->end - reader->data < bytes)
+        {
+            return ERROR;
+        }
+        *value = 0;
+        for (int i = 0; i < bytes; i++)
+        {
+            *value |= (uint64_t)reader->data[i] << (i * BITS_PER_BYTE);
+        }
+        reader->data += bytes;
+        return SUCCESS;
+    }
+    case WIRE_LENGTH_DELIMITED:
+        if (read_varint(reader, value) != SUCCESS || *value > (uint64_t)(reader->end - reader->data))
+        {
+            return ERROR;
+        }
+        sub->data = reader->data;
+        sub->end = reader->data + *value;
+        reader->data += *value;
+        return SUCCESS;
+    default:
+        return ERROR;
+    }
+}
+
+/**
+ * @brief Decodifica un Label y, si es __name__, copia su valor.
+ */
+static int decode_label(proto_reader_t reader, char* name, size_t name_size)
+{
+    char key[NAME_SIZE] = "";
+    char value[NAME_SIZE] = "";
+    while (reader.data < reader.end)
+    {
+        unsigned int field;
+        unsigned int wire_type;
+        uint64_t length;
+        proto_reader_t text;
+        if (read_field(&reader, &field, &wire_type, &length, &text) != SUCCESS)
+        {
+            return ERROR;
+        }
+        if (wire_type == WIRE_LENGTH_DELIMITED && (field == FIELD_NAME || field == FIELD_VALUE))
+        {
+            char* target = field == FIELD_NAME ? key : value;
+            size_t copied = length < NAME_SIZE - 1 ? (size_t)length : NAME_SIZE - 1;
+            memcpy(target, text.data, copied);
+            target[copied] = '\0';
+        }
+    }
+    if (strcmp(key, "__name__") == SUCCESS)
+    {
+        snprintf(name, name_size, "%s", value);
+    }
+    return SUCCESS;
+}
+
+static int decode_timeseries(proto_reader_t reader, write_summary_t* summary)
+{
+    char name[NAME_SIZE] = "";
+    proto_reader_t samples_start = reader;
+
+    // Primero las etiquetas, para imprimir las muestras con el nombre aunque vengan antes en el mensaje
+    while (reader.data < reader.end)
+    {
+        unsigned int field;
+        unsigned int wire_type;
+        uint64_t value;
+        proto_reader_t sub;
+        if (read_field(&reader, &field, &wire_type, &value, &sub) != SUCCESS)
+        {
+            return ERROR;
+        }
+        if (field == FIELD_LABELS && wire_type == WIRE_LENGTH_DELIMITED &&
+            decode_label(sub, name, sizeof(name)) != SUCCESS)
+        {
+            return ERROR;
+        }
+    }
+
+    reader = samples_start;
+    while (reader.data < reader.end)
+    {
+        unsigned int field;
+        unsigned int wire_type;
+        uint64_t value;
+        proto_reader_t sample;
+        if (read_field(&reader, &field, &wire_type, &value, &sample) != SUCCESS)
+        {
+            return ERROR;
+        }
+        if (field != FIELD_SAMPLES || wire_type != WIRE_LENGTH_DELIMITED)
+        {
+            continue;
+        }
+        double sample_value = 0;
+        int64_t timestamp = 0;
+        while (sample.data < sample.end)
+        {
+            unsigned int sample_field;
+            unsigned int sample_wire;
+            uint64_t raw;
+            proto_reader_t unused;
+            if (read_field(&sample, &sample_field, &sample_wire, &raw, &unused) != SUCCESS)
+            {
+                return ERROR;
+            }
+            if (sample_field == FIELD_NAME && sample_wire == WIRE_FIXED64)
+            {
+                memcpy(&sample_value, &raw, sizeof(sample_value));
+            }
+            else if (sample_field == FIELD_VALUE && sample_wire == WIRE_VARINT)
+            {
+                timestamp = (int64_t)raw;
+            }
+        }
+        if (verbose)
+        {
+            printf("  %s %.17g %lld\n", name, sample_value, (long long)timestamp);
+        }
+        summary->samples++;
+    }
+    summary->series++;
+    return SUCCESS;
+}
+
+static int decode_write_request(const uint8_t* data, size_t length, write_summary_t* summary)
+{
+    proto_reader_t reader = {data, data + length};
+    while (reader.data < reader.end)
+    {
+        unsigned int field;
+        unsigned int wire_type;
+        uint64_t value;
+        proto_reader_t sub;
+        if (read_field(&reader, &field, &wire_type, &value, &sub) != SUCCESS)
+        {
+            return ERROR;
+        }
+        if (field == FIELD_TIMESERIES && wire_type == WIRE_LENGTH_DELIMITED &&
+            decode_timeseries(sub, summary) != SUCCESS)
+        {
+            return ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
+static int send_text(int fd, const char* text)
+{
+    size_t length = strlen(text);
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, text, length, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return ERROR;
+        }
+        text += sent;
+        length -= (size_t)sent;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief Procesa el cuerpo de una petición y devuelve la respuesta HTTP a enviar.
+ */
+static const char* handle_body(const uint8_t* body, size_t length, unsigned long request_number)
+{
+    size_t raw_length;
+    uint8_t* raw = NULL;
+    write_summary_t summary = {0, 0};
+    if (snappy_uncompressed_length(body, length, &raw_length) != SNAPPY_OK || raw_length > MAX_BODY_SIZE ||
+        (raw = malloc(raw_length > 0 ? raw_length : 1)) == NULL ||
+        snappy_uncompress(body, length, raw, raw_length) != SNAPPY_OK ||
+        decode_write_request(raw, raw_length, &summary) != SUCCESS)
+    {
+        free(raw);
+        fprintf(stderr, "request %lu: invalid snappy or protobuf body (%zu bytes)\n", request_number, length);
+        return "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+    }
+    free(raw);
+    printf("request %lu: %zu series, %zu samples, %zu bytes (%zu uncompressed)\n", request_number, summary.series,
+           summary.samples, length, raw_length);
+    fflush(stdout);
+    return "HTTP/1.1 204 No Content\r\n\r\n";
+}
+
+/**
+ * @brief Atiende las peticiones de una conexión hasta que el cliente la cierre.
+ */
+static void serve_connection(int fd, unsigned int fail_every, unsigned long* request_number)
+{
+    char header[HEADER_BUFFER_SIZE] = "";
+    size_t used = 0;
+    while (BOOL_TRUE)
+    {
+        char* end = NULL;
+        while ((end = strstr(header, "\r\n\r\n")) == NULL)
+        {
+            if (used == sizeof(header) - 1)
+            {
+                return;
+            }
+            ssize_t received = recv(fd, header + used, sizeof(header) - 1 - used, 0);
+            if (received <= 0)
+            {
+                return;
+            }
+            used += (size_t)received;
+            header[used] = '\0';
+        }
+
+        size_t header_length = (size_t)(end + 4 - header);
+        long long content_length = 0;
+        for (char* line = strstr(header, "\r\n"); line != NULL && line < end; line = strstr(line + 2, "\r\n"))
+        {
+            if (strncasecmp(line + 2, "Content-Length:", strlen("Content-Length:")) == SUCCESS)
+            {
+                content_length = strtoll(line + 2 + strlen("Content-Length:"), NULL, DECIMAL_BASE);
+            }
+        }
+        if (content_length < 0 || content_length > MAX_BODY_SIZE)
+        {
+            send_text(fd, "HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        uint8_t* body = malloc((size_t)content_length + 1);
+        if (body == NULL)
+        {
+            return;
+        }
+        size_t have = used - header_length < (size_t)content_length ? used - header_length : (size_t)content_length;
+        memcpy(body, header + header_length, have);
+        while (have < (size_t)content_length)
+        {
+            ssize_t received = recv(fd, body + have, (size_t)content_length - have, 0);
+            if (received <= 0)
+            {
+                free(body);
+                return;
+            }
+            have += (size_t)received;
+        }
+
+        // Lo que sobre del encabezado leído pertenece a la petición siguiente
+        size_t consumed = header_length + have;
+        size_t leftover = used > consumed ? used - consumed : 0;
+        memmove(header, header + consumed, leftover);
+        used = leftover;
+        header[used] = '\0';
+
+        (*request_number)++;
+        const char* response;
+        if (fail_every > 0 && *request_number % fail_every == 0)
+        {
+            printf("request %lu: injected failure\n", *request_number);
+            fflush(stdout);
+            response = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+        }
+        else
+        {
+            response = handle_body(body, (size_t)content_length, *request_number);
+        }
+        free(body);
+        if (send_text(fd, response) != SUCCESS)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Función principal del receptor.
+ * @param argc Cantidad de argumentos de línea de comandos.
+ * @param argv Lista de argumentos (ver el uso al principio del archivo).
+ * @return EXIT_FAILURE si no pudo escuchar; en otro caso no termina.
+ */
+int main(int argc, char* argv[])
+{
+    unsigned int port = DEFAULT_PORT;
+    unsigned int fail_every = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--port") == SUCCESS && i + 1 < argc)
+        {
+            port = (unsigned int)strtoul(argv[++i], NULL, DECIMAL_BASE);
+        }
+        else if (strcmp(argv[i], "--fail-every") == SUCCESS && i + 1 < argc)
+        {
+            fail_every = (unsigned int)strtoul(argv[++i], NULL, DECIMAL_BASE);
+        }
+        else if (strcmp(argv[i], "--verbose") == SUCCESS)
+        {
+            verbose = BOOL_TRUE;
+        }
+        else
+        {
+            fprintf(stderr, "Uso: %s [--port N] [--fail-every N] [--verbose]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+    if (listen_fd < SUCCESS || bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) != SUCCESS ||
+        listen(listen_fd, LISTEN_BACKLOG) != SUCCESS)
+    {
+        perror("Error listening");
+        return EXIT_FAILURE;
+    }
+    printf("Listening on http://127.0.0.1:%u\n", port);
+    fflush(stdout);
+
+    unsigned long request_number = 0;
+    while (BOOL_TRUE)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < SUCCESS)
+        {
+            continue;
+        }
+        serve_connection(fd, fail_every, &request_number);
+        close(fd);
+    }
+}
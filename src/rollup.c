@@ -0,0 +1,145 @@
+#include "rollup.h"
+#include "series.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_TIMESTAMP 0
+
+/**
+ * @brief Anillo de intervalos de una serie en un nivel.
+ */
+typedef struct
+{
+    rollup_bucket_t* buckets; /**< Intervalos; el más reciente está abierto. */
+    size_t next;              /**< Posición del próximo intervalo. */
+    size_t count;             /**< Intervalos válidos. */
+} rollup_ring_t;
+
+/** Ancho de los intervalos de cada nivel en milisegundos */
+static const long long rollup_widths_ms[ROLLUP_TIER_COUNT] = {10 * 1000, 60 * 1000};
+
+/** Intervalos por serie de cada nivel: 6 horas de 10 s y 24 horas de 1 min */
+static const size_t rollup_capacities[ROLLUP_TIER_COUNT] = {6 * 360, 24 * 60};
+
+/** Anillos de cada nivel y serie */
+static rollup_ring_t rollup_rings[ROLLUP_TIER_COUNT][MAX_SERIES];
+
+/** Marca de tiempo de la última lectura agregada de cada serie */
+static long long rollup_last_timestamp[MAX_SERIES];
+
+/** Series con anillos reservados */
+static size_t rollup_series_total = 0;
+
+/** Protege los anillos: el colector escribe mientras los hilos HTTP consultan */
+static pthread_mutex_t rollup_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int rollup_init(void)
+{
+    size_t count = series_count();
+    for (int tier = 0; tier < ROLLUP_TIER_COUNT; tier++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            rollup_rings[tier][i].buckets = calloc(rollup_capacities[tier], sizeof(rollup_bucket_t));
+            if (rollup_rings[tier][i].buckets == NULL)
+            {
+                fprintf(stderr, "Error allocating rollup tiers\n");
+                return ERROR;
+            }
+        }
+    }
+    rollup_series_total = count;
+    return SUCCESS;
+}
+
+/**
+ * @brief Suma una lectura al intervalo abierto, o abre uno nuevo si la lectura cae fuera de él.
+ */
+static void ring_add(rollup_ring_t* ring, size_t capacity, long long width_ms, long long timestamp_ms, double value)
+{
+    long long start = timestamp_ms - timestamp_ms % width_ms;
+    rollup_bucket_t* bucket = &ring->buckets[(ring->next + capacity - 1) % capacity];
+    if (ring->count > 0 && bucket->start_ms == start)
+    {
+        if (value < bucket->min)
+        {
+            bucket->min = value;
+        }
+        if (value > bucket->max)
+        {
+            bucket->max = value;
+        }
+        bucket->sum += value;
+        bucket->last = value;
+        bucket->count++;
+        return;
+    }
+
+    bucket = &ring->buckets[ring->next];
+    bucket->start_ms = start;
+    bucket->min = value;
+    bucket->max = value;
+    bucket->sum = value;
+    bucket->last = value;
+    bucket->count = 1;
+    ring->next = (ring->next + 1) % capacity;
+    if (ring->count < capacity)
+    {
+        ring->count++;
+    }
+}
+
+void rollup_record(void)
+{
+    pthread_mutex_lock(&rollup_lock);
+    for (size_t i = 0; i < rollup_series_total; i++)
+    {
+        const series_t* series = series_get(i);
+        if (series->timestamp_ms == NO_TIMESTAMP || series->timestamp_ms <= rollup_last_timestamp[i])
+        {
+            continue;
+        }
+        for (int tier = 0; tier < ROLLUP_TIER_COUNT; tier++)
+        {
+            ring_add(&rollup_rings[tier][i], rollup_capacities[tier], rollup_widths_ms[tier], series->timestamp_ms,
+                     series->value);
+        }
+        rollup_last_timestamp[i] = series->timestamp_ms;
+    }
+    pthread_mutex_unlock(&rollup_lock);
+}
+
+long long rollup_tier_width_ms(rollup_tier_t tier)
+{
+    return rollup_widths_ms[tier];
+}
+
+size_t rollup_tier_capacity(rollup_tier_t tier)
+{
+    return rollup_capacities[tier];
+}
+
+size_t rollup_query(size_t series_index, rollup_tier_t tier, long long since_ms, rollup_bucket_t* out)
+{
+    size_t copied = 0;
+    pthread_mutex_lock(&rollup_lock);
+    if (series_index < rollup_series_total)
+    {
+        const rollup_ring_t* ring = &rollup_rings[tier][series_index];
+        size_t capacity = rollup_capacities[tier];
+        size_t oldest = (ring->next + capacity - ring->count) % capacity;
+        for (size_t i = 0; i < ring->count; i++)
+        {
+            const rollup_bucket_t* bucket = &ring->buckets[(oldest + i) % capacity];
+            if (bucket->start_ms + rollup_widths_ms[tier] > since_ms)
+            {
+                out[copied++] = *bucket;
+            }
+        }
+    }
+    pthread_mutex_unlock(&rollup_lock);
+    return copied;
+}
@@ -0,0 +1,179 @@
+#include "self_metrics.h"
+#include "timing.h"
+#include <prom.h>
+#include <promhttp.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_LABELS 0
+#define COLLECTOR_LABELS 1
+
+// Límites de los buckets: duraciones de 100 µs a ~0,8 s, cuerpos de 1 kB a ~1 MB y retrasos de 1 ms a ~2 s. Los
+// tamaños parten de 1000 y no de 1024 porque la etiqueta le se imprime con 6 cifras y 2^20 no saldría exacto.
+#define DURATION_BUCKET_START 0.0001
+#define DURATION_BUCKET_COUNT 14
+#define BYTES_BUCKET_START 1000.0
+#define BYTES_BUCKET_COUNT 11
+#define LAG_BUCKET_START 0.001
+#define LAG_BUCKET_COUNT 12
+#define BUCKET_FACTOR 2.0
+
+// Grupos distintos que pueden medirse con collector_duration_seconds
+#define MAX_TIMED_COLLECTORS 16
+
+/** Etiqueta de collector_duration_seconds */
+static const char* collector_label[] = {"collector"};
+
+/** Histogramas de la autoinstrumentación; NULL hasta self_metrics_init */
+static prom_histogram_t* collector_duration_metric;
+static prom_histogram_t* scrape_render_metric;
+static prom_histogram_t* scrape_bytes_metric;
+static prom_histogram_t* tick_lag_metric;
+
+/**
+ * Muestras de los histogramas resueltas una sola vez: observarlas directamente evita armar la etiqueta y tomar el
+ * lock de la métrica en cada medición.
+ */
+static prom_metric_sample_histogram_t* scrape_render_sample;
+static prom_metric_sample_histogram_t* scrape_bytes_sample;
+static prom_metric_sample_histogram_t* tick_lag_sample;
+
+/** Muestra de collector_duration_seconds de cada grupo, en el orden en que se midieron por primera vez */
+static struct
+{
+    const char* collector;
+    prom_metric_sample_histogram_t* sample;
+} collector_samples[MAX_TIMED_COLLECTORS];
+static size_t collector_sample_count = 0;
+
+/**
+ * @brief Observador de promhttp: se llama en el hilo del servidor que hizo el render.
+ */
+static void observe_render(double seconds, size_t bytes)
+{
+    prom_metric_sample_histogram_observe(scrape_render_sample, seconds);
+    prom_metric_sample_histogram_observe(scrape_bytes_sample, (double)bytes);
+}
+
+/**
+ * @brief Crea un histograma y lo agrega al collector; devuelve NULL si algo falla.
+ */
+static prom_histogram_t* add_histogram(prom_collector_t* collector, const char* name, const char* help,
+                                       prom_histogram_buckets_t* buckets, size_t label_count, const char** labels)
+{
+    if (buckets == NULL)
+    {
+        return NULL;
+    }
+    prom_histogram_t* histogram = prom_histogram_new(name, help, buckets, label_count, labels);
+    if (histogram == NULL)
+    {
+        return NULL;
+    }
+    if (prom_collector_add_metric(collector, histogram) != SUCCESS)
+    {
+        prom_histogram_destroy(histogram);
+        return NULL;
+    }
+    return histogram;
+}
+
+int self_metrics_init(void)
+{
+    prom_collector_t* collector = prom_collector_new(SELF_COLLECTOR);
+    if (collector == NULL ||
+        prom_collector_registry_register_collector(PROM_COLLECTOR_REGISTRY_DEFAULT, collector) != SUCCESS)
+    {
+        fprintf(stderr, "Error registering %s collector\n", SELF_COLLECTOR);
+        if (collector != NULL)
+        {
+            prom_collector_destroy(collector);
+        }
+        return ERROR;
+    }
+
+    // Una vez registrado, el collector libera los histogramas que ya se le agregaron
+    collector_duration_metric = add_histogram(
+        collector, "collector_duration_seconds", "Time spent updating each group of metrics",
+        prom_histogram_buckets_exponential(DURATION_BUCKET_START, BUCKET_FACTOR, DURATION_BUCKET_COUNT),
+        COLLECTOR_LABELS, collector_label);
+    scrape_render_metric = add_histogram(
+        collector, "scrape_render_seconds", "Time spent rendering the metrics for a scrape",
+        prom_histogram_buckets_exponential(DURATION_BUCKET_START, BUCKET_FACTOR, DURATION_BUCKET_COUNT), NO_LABELS,
+        NULL);
+    scrape_bytes_metric = add_histogram(
+        collector, "scrape_bytes", "Size of the rendered metrics before compression",
+        prom_histogram_buckets_exponential(BYTES_BUCKET_START, BUCKET_FACTOR, BYTES_BUCKET_COUNT), NO_LABELS, NULL);
+    tick_lag_metric = add_histogram(
+        collector, "tick_lag_seconds", "Delay between the scheduled and the actual start of a collection tick",
+        prom_histogram_buckets_exponential(LAG_BUCKET_START, BUCKET_FACTOR, LAG_BUCKET_COUNT), NO_LABELS, NULL);
+    if (collector_duration_metric == NULL || scrape_render_metric == NULL || scrape_bytes_metric == NULL ||
+        tick_lag_metric == NULL)
+    {
+        fprintf(stderr, "Error creating self-instrumentation histograms\n");
+        return ERROR;
+    }
+    scrape_render_sample = prom_metric_sample_histogram_from_labels(scrape_render_metric, NULL);
+    scrape_bytes_sample = prom_metric_sample_histogram_from_labels(scrape_bytes_metric, NULL);
+    tick_lag_sample = prom_metric_sample_histogram_from_labels(tick_lag_metric, NULL);
+    if (scrape_render_sample == NULL || scrape_bytes_sample == NULL || tick_lag_sample == NULL)
+    {
+        fprintf(stderr, "Error creating self-instrumentation histograms\n");
+        return ERROR;
+    }
+
+    promhttp_set_render_observer(observe_render);
+    return SUCCESS;
+}
+
+/**
+ * @brief Devuelve la muestra de collector_duration_seconds del grupo, creándola la primera vez.
+ *
+ * La tabla no se protege: solo el hilo de recolección mide grupos.
+ */
+static prom_metric_sample_histogram_t* collector_sample(const char* collector)
+{
+    for (size_t i = 0; i < collector_sample_count; i++)
+    {
+        if (collector_samples[i].collector == collector || strcmp(collector_samples[i].collector, collector) == 0)
+        {
+            return collector_samples[i].sample;
+        }
+    }
+    const char* labels[] = {collector};
+    prom_metric_sample_histogram_t* sample =
+        prom_metric_sample_histogram_from_labels(collector_duration_metric, labels);
+    if (sample != NULL && collector_sample_count < MAX_TIMED_COLLECTORS)
+    {
+        collector_samples[collector_sample_count].collector = collector;
+        collector_samples[collector_sample_count].sample = sample;
+        collector_sample_count++;
+    }
+    return sample;
+}
+
+void self_metrics_collector_done(const char* collector, double start)
+{
+    if (collector_duration_metric == NULL)
+    {
+        return;
+    }
+    double elapsed = timing_now() - start;
+    prom_metric_sample_histogram_t* sample = collector_sample(collector);
+    if (sample != NULL)
+    {
+        prom_metric_sample_histogram_observe(sample, elapsed);
+    }
+}
+
+void self_metrics_tick_started(double scheduled)
+{
+    if (tick_lag_sample == NULL)
+    {
+        return;
+    }
+    double lag = timing_now() - scheduled;
+    prom_metric_sample_histogram_observe(tick_lag_sample, lag > 0 ? lag : 0);
+}
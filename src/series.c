@@ -0,0 +1,98 @@
+#include "series.h"
+#include <stdio.h>
+
+#define NO_LABELS 0
+#define NO_TIMESTAMP 0
+#define ZERO_VALUE_DOUBLE 0.0
+
+/** Tabla de series, en orden de registro */
+static series_t series_table[MAX_SERIES];
+
+/** Cantidad de series registradas */
+static size_t series_total = 0;
+
+/** Lote donde se acumulan los series_set del hilo, o NULL si se publican directamente */
+static __thread series_batch_t* deferred_batch = NULL;
+
+prom_gauge_t* series_gauge_new(const char* name, const char* help)
+{
+    if (series_total == MAX_SERIES)
+    {
+        fprintf(stderr, "Error: series table full, cannot register %s\n", name);
+        return NULL;
+    }
+
+    prom_gauge_t* gauge = prom_gauge_new(name, help, NO_LABELS, NULL);
+    if (gauge == NULL)
+    {
+        return NULL;
+    }
+
+    series_t* series = &series_table[series_total++];
+    series->gauge = gauge;
+    series->name = name;
+    series->help = help;
+    series->value = ZERO_VALUE_DOUBLE;
+    series->timestamp_ms = NO_TIMESTAMP;
+    return gauge;
+}
+
+void series_set(prom_gauge_t* gauge, double value, long long timestamp_ms)
+{
+    if (deferred_batch != NULL)
+    {
+        size_t i = 0;
+        while (i < deferred_batch->count && deferred_batch->updates[i].gauge != gauge)
+        {
+            i++;
+        }
+        if (i == MAX_SERIES)
+        {
+            return;
+        }
+        deferred_batch->updates[i].gauge = gauge;
+        deferred_batch->updates[i].value = value;
+        deferred_batch->updates[i].timestamp_ms = timestamp_ms;
+        if (i == deferred_batch->count)
+        {
+            deferred_batch->count++;
+        }
+        return;
+    }
+
+    prom_gauge_set_with_timestamp(gauge, value, timestamp_ms, NULL);
+
+    // La tabla es pequeña; una búsqueda lineal por puntero es más barata que mantener un índice por métrica
+    for (size_t i = 0; i < series_total; i++)
+    {
+        if (series_table[i].gauge == gauge)
+        {
+            series_table[i].value = value;
+            series_table[i].timestamp_ms = timestamp_ms;
+            return;
+        }
+    }
+}
+
+void series_defer(series_batch_t* batch)
+{
+    deferred_batch = batch;
+}
+
+void series_apply(const series_batch_t* batch)
+{
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        series_set(batch->updates[i].gauge, batch->updates[i].value, batch->updates[i].timestamp_ms);
+    }
+}
+
+size_t series_count(void)
+{
+    return series_total;
+}
+
+const series_t* series_get(size_t index)
+{
+    return index < series_total ? &series_table[index] : NULL;
+}
@@ -0,0 +1,113 @@
+#include "shm_export.h"
+#include "metrics_shm.h"
+#include "series.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define SEGMENT_FILE_MODE 0644
+#define TEMP_SUFFIX ".tmp"
+#define PATH_SIZE 256
+
+/** Encabezado del segmento publicado, NULL si la exportación no está activa */
+static metrics_shm_header_t* shm_header = NULL;
+
+/** Arreglo de valores del segmento publicado */
+static double* shm_values = NULL;
+
+int shm_export_init(const char* path)
+{
+    char temp_path[PATH_SIZE];
+    if (snprintf(temp_path, sizeof(temp_path), "%s%s", path, TEMP_SUFFIX) >= (int)sizeof(temp_path))
+    {
+        fprintf(stderr, "Shared memory path too long: %s\n", path);
+        return ERROR;
+    }
+
+    size_t count = series_count();
+    size_t descriptors_offset;
+    size_t values_offset;
+    size_t size = metrics_shm_layout(count, &descriptors_offset, &values_offset);
+
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, SEGMENT_FILE_MODE);
+    if (fd < SUCCESS)
+    {
+        fprintf(stderr, "Error creating shared memory segment %s: %s\n", temp_path, strerror(errno));
+        return ERROR;
+    }
+    if (ftruncate(fd, (off_t)size) != SUCCESS)
+    {
+        fprintf(stderr, "Error sizing shared memory segment %s: %s\n", temp_path, strerror(errno));
+        close(fd);
+        unlink(temp_path);
+        return ERROR;
+    }
+    char* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "Error mapping shared memory segment %s: %s\n", temp_path, strerror(errno));
+        unlink(temp_path);
+        return ERROR;
+    }
+
+    // ftruncate deja el archivo en cero: los campos reservados y el contador ya están inicializados
+    metrics_shm_header_t* header = (metrics_shm_header_t*)base;
+    header->version = METRICS_SHM_VERSION;
+    header->header_size = sizeof(metrics_shm_header_t);
+    header->descriptor_size = sizeof(metrics_shm_descriptor_t);
+    header->metric_count = (uint32_t)count;
+    header->descriptors_offset = descriptors_offset;
+    header->values_offset = values_offset;
+    header->total_size = size;
+
+    metrics_shm_descriptor_t* descriptors = (metrics_shm_descriptor_t*)(base + descriptors_offset);
+    for (size_t i = 0; i < count; i++)
+    {
+        const series_t* series = series_get(i);
+        strncpy(descriptors[i].name, series->name, METRICS_SHM_NAME_SIZE - 1);
+        descriptors[i].type = METRICS_SHM_TYPE_GAUGE;
+    }
+    __atomic_store_n(&header->magic, METRICS_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    if (rename(temp_path, path) != SUCCESS)
+    {
+        fprintf(stderr, "Error publishing shared memory segment %s: %s\n", path, strerror(errno));
+        munmap(base, size);
+        unlink(temp_path);
+        return ERROR;
+    }
+
+    shm_header = header;
+    shm_values = (double*)(base + values_offset);
+    return SUCCESS;
+}
+
+void shm_export_publish(long long timestamp_ms)
+{
+    if (shm_header == NULL)
+    {
+        return;
+    }
+
+    // Único escritor: el contador solo cambia aquí, así que puede leerse sin sincronización
+    uint64_t sequence = shm_header->sequence;
+    __atomic_store_n(&shm_header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    size_t count = shm_header->metric_count;
+    for (size_t i = 0; i < count; i++)
+    {
+        double value = series_get(i)->value;
+        __atomic_store(&shm_values[i], &value, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&shm_header->timestamp_ms, (int64_t)timestamp_ms, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&shm_header->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
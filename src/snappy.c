@@ -0,0 +1,289 @@
+#include "snappy.h"
+#include <string.h>
+
+#define FRAGMENT_SIZE 65536
+#define HASH_BITS 14
+#define HASH_MULTIPLIER 0x1e35a7bdu
+#define MIN_MATCH 4
+#define MAX_COPY_LENGTH 64
+// Una copia de más de 64 bytes se parte dejando al menos MIN_MATCH para la última
+#define SPLIT_COPY_LENGTH 60
+#define MAX_INLINE_LITERAL 60
+#define MAX_SHORT_COPY_LENGTH 11
+#define MAX_SHORT_COPY_OFFSET 2048
+#define SKIP_SHIFT 5
+#define MAX_VARINT32_BYTES 5
+#define VARINT_MASK 0x7f
+#define VARINT_CONTINUE 0x80
+#define VARINT_SHIFT 7
+#define BYTE_MASK 0xff
+#define BITS_PER_BYTE 8
+#define TAG_TYPE_MASK 0x3
+#define TAG_LITERAL 0
+#define TAG_COPY_1 1
+#define TAG_COPY_2 2
+#define TAG_COPY_4 3
+#define TAG_SHIFT 2
+#define COPY_1_LENGTH_MASK 0x7
+#define COPY_1_OFFSET_SHIFT 5
+
+static uint32_t load32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(uint32_t v)
+{
+    return (v * HASH_MULTIPLIER) >> (32 - HASH_BITS);
+}
+
+static uint8_t* put_varint(uint8_t* out, size_t value)
+{
+    while (value >= VARINT_CONTINUE)
+    {
+        *out++ = (uint8_t)(value | VARINT_CONTINUE);
+        value >>= VARINT_SHIFT;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static uint8_t* emit_literal(uint8_t* out, const uint8_t* literal, size_t length)
+{
+    size_t n = length - 1;
+    if (n < MAX_INLINE_LITERAL)
+    {
+        *out++ = (uint8_t)(n << TAG_SHIFT | TAG_LITERAL);
+    }
+    else
+    {
+        // 60..63 indican que el largo menos uno sigue en 1..4 bytes little endian
+        int bytes = 0;
+        for (size_t rest = n; rest > 0; rest >>= BITS_PER_BYTE)
+        {
+            bytes++;
+        }
+        *out++ = (uint8_t)((MAX_INLINE_LITERAL - 1 + bytes) << TAG_SHIFT | TAG_LITERAL);
+        for (int i = 0; i < bytes; i++)
+        {
+            *out++ = (uint8_t)(n >> (i * BITS_PER_BYTE));
+        }
+    }
+    memcpy(out, literal, length);
+    return out + length;
+}
+
+/**
+ * @brief Escribe una copia de hasta 64 bytes, con desplazamiento de 1 byte si entra.
+ */
+static uint8_t* emit_short_copy(uint8_t* out, size_t offset, size_t length)
+{
+    if (length >= MIN_MATCH && length <= MAX_SHORT_COPY_LENGTH && offset < MAX_SHORT_COPY_OFFSET)
+    {
+        *out++ = (uint8_t)(TAG_COPY_1 | (length - MIN_MATCH) << TAG_SHIFT | (offset >> BITS_PER_BYTE)
+                                                                                << COPY_1_OFFSET_SHIFT);
+        *out++ = (uint8_t)(offset & BYTE_MASK);
+        return out;
+    }
+    *out++ = (uint8_t)(TAG_COPY_2 | (length - 1) << TAG_SHIFT);
+    *out++ = (uint8_t)(offset & BYTE_MASK);
+    *out++ = (uint8_t)(offset >> BITS_PER_BYTE);
+    return out;
+}
+
+static uint8_t* emit_copy(uint8_t* out, size_t offset, size_t length)
+{
+    while (length >= MAX_COPY_LENGTH + MIN_MATCH)
+    {
+        out = emit_short_copy(out, offset, MAX_COPY_LENGTH);
+        length -= MAX_COPY_LENGTH;
+    }
+    if (length > MAX_COPY_LENGTH)
+    {
+        out = emit_short_copy(out, offset, SPLIT_COPY_LENGTH);
+        length -= SPLIT_COPY_LENGTH;
+    }
+    return emit_short_copy(out, offset, length);
+}
+
+/**
+ * @brief Comprime un fragmento de hasta 64 KiB; las copias nunca lo cruzan, así que los desplazamientos caben en 16
+ * bits.
+ */
+static uint8_t* compress_fragment(const uint8_t* input, size_t length, uint8_t* out, uint16_t* table)
+{
+    size_t literal_start = 0;
+    if (length >= MIN_MATCH)
+    {
+        memset(table, 0, sizeof(uint16_t) << HASH_BITS);
+        size_t ip = 0;
+        while (ip + MIN_MATCH <= length)
+        {
+            uint32_t bytes = load32(input + ip);
+            uint32_t h = hash4(bytes);
+            size_t candidate = table[h];
+            table[h] = (uint16_t)ip;
+            if (candidate >= ip || load32(input + candidate) != bytes)
+            {
+                // Sin coincidencias el paso crece, para no gastar tiempo en datos incompresibles
+                ip += 1 + ((ip - literal_start) >> SKIP_SHIFT);
+                continue;
+            }
+
+            if (ip > literal_start)
+            {
+                out = emit_literal(out, input + literal_start, ip - literal_start);
+            }
+            size_t match = MIN_MATCH;
+            while (ip + match < length && input[candidate + match] == input[ip + match])
+            {
+                match++;
+            }
+            out = emit_copy(out, ip - candidate, match);
+            ip += match;
+            literal_start = ip;
+        }
+    }
+    if (literal_start < length)
+    {
+        out = emit_literal(out, input + literal_start, length - literal_start);
+    }
+    return out;
+}
+
+size_t snappy_max_compressed_length(size_t length)
+{
+    return 32 + length + length / 6;
+}
+
+size_t snappy_compress(const uint8_t* input, size_t length, uint8_t* output)
+{
+    uint16_t table[1 << HASH_BITS];
+    uint8_t* out = put_varint(output, length);
+    for (size_t offset = 0; offset < length; offset += FRAGMENT_SIZE)
+    {
+        size_t fragment = length - offset < FRAGMENT_SIZE ? length - offset : FRAGMENT_SIZE;
+        out = compress_fragment(input + offset, fragment, out, table);
+    }
+    return (size_t)(out - output);
+}
+
+/**
+ * @brief Lee un varint de hasta 32 bits; devuelve los bytes consumidos o 0 si es inválido.
+ */
+static size_t read_varint(const uint8_t* input, size_t length, size_t* value)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < length && i < MAX_VARINT32_BYTES; i++)
+    {
+        result |= (size_t)(input[i] & VARINT_MASK) << (i * VARINT_SHIFT);
+        if ((input[i] & VARINT_CONTINUE) == 0)
+        {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+int snappy_uncompressed_length(const uint8_t* input, size_t length, size_t* uncompressed)
+{
+    return read_varint(input, length, uncompressed) > 0 ? SNAPPY_OK : SNAPPY_ERROR;
+}
+
+/**
+ * @brief Lee un entero little endian de bytes bytes.
+ */
+static size_t read_le(const uint8_t* input, int bytes)
+{
+    size_t value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= (size_t)input[i] << (i * BITS_PER_BYTE);
+    }
+    return value;
+}
+
+int snappy_uncompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity)
+{
+    size_t expected;
+    size_t ip = read_varint(input, length, &expected);
+    if (ip == 0 || expected > capacity)
+    {
+        return SNAPPY_ERROR;
+    }
+
+    size_t op = 0;
+    while (ip < length)
+    {
+        uint8_t tag = input[ip++];
+        size_t copy_length;
+        size_t offset;
+        switch (tag & TAG_TYPE_MASK)
+        {
+        case TAG_LITERAL:
+        {
+            size_t literal = (size_t)(tag >> TAG_SHIFT) + 1;
+            if (literal > MAX_INLINE_LITERAL)
+            {
+                int bytes = (int)literal - MAX_INLINE_LITERAL;
+                if (length - ip < (size_t)bytes)
+                {
+                    return SNAPPY_ERROR;
+                }
+                literal = read_le(input + ip, bytes) + 1;
+                ip += (size_t)bytes;
+            }
+            if (literal > length - ip || literal > expected - op)
+            {
+                return SNAPPY_ERROR;
+            }
+            memcpy(output + op, input + ip, literal);
+            ip += literal;
+            op += literal;
+            continue;
+        }
+        case TAG_COPY_1:
+            if (length - ip < 1)
+            {
+                return SNAPPY_ERROR;
+            }
+            copy_length = ((tag >> TAG_SHIFT) & COPY_1_LENGTH_MASK) + MIN_MATCH;
+            offset = (size_t)(tag >> COPY_1_OFFSET_SHIFT) << BITS_PER_BYTE | input[ip];
+            ip += 1;
+            break;
+        case TAG_COPY_2:
+            if (length - ip < 2)
+            {
+                return SNAPPY_ERROR;
+            }
+            copy_length = (size_t)(tag >> TAG_SHIFT) + 1;
+            offset = read_le(input + ip, 2);
+            ip += 2;
+            break;
+        default:
+            if (length - ip < 4)
+            {
+                return SNAPPY_ERROR;
+            }
+            copy_length = (size_t)(tag >> TAG_SHIFT) + 1;
+            offset = read_le(input + ip, 4);
+            ip += 4;
+            break;
+        }
+
+        if (offset == 0 || offset > op || copy_length > expected - op)
+        {
+            return SNAPPY_ERROR;
+        }
+        // Byte a byte: la copia puede solaparse con lo que está escribiendo (repeticiones)
+        for (size_t i = 0; i < copy_length; i++)
+        {
+            output[op + i] = output[op - offset + i];
+        }
+        op += copy_length;
+    }
+    return op == expected ? SNAPPY_OK : SNAPPY_ERROR;
+}
@@ -0,0 +1,395 @@
+#include "stream_api.h"
+#include "series.h"
+#include "value_format.h"
+#include <math.h>
+#include <pthread.h>
+#include <promhttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define MILLISECONDS_PER_SECOND 1000
+// Texto de una serie en un evento: nombre, valor y separadores
+#define SERIES_TEXT_SIZE 192
+#define EVENT_HEADER_SIZE 128
+#define EVENT_TRAILER "}}\n\n"
+#define EVENT_BUFFER_SIZE (EVENT_HEADER_SIZE + MAX_SERIES * SERIES_TEXT_SIZE + sizeof(EVENT_TRAILER))
+// Bloque que microhttpd pide al leer la respuesta
+#define READ_BLOCK_SIZE 4096
+// Milisegundos que el navegador espera antes de reconectarse
+#define RECONNECT_FIELD "retry: 1000\n"
+#define EVENT_STREAM_CONTENT_TYPE "text/event-stream"
+
+/**
+ * @brief Evento ya formateado, compartido por las colas de todos los clientes.
+ */
+typedef struct
+{
+    size_t references; /**< Colas y lecturas en curso que lo usan; se libera al llegar a cero. */
+    size_t length;     /**< Bytes de text. */
+    char text[];       /**< Evento SSE completo, terminado en línea vacía. */
+} stream_event_t;
+
+/**
+ * @brief Un cliente conectado al endpoint.
+ */
+typedef struct stream_client
+{
+    struct MHD_Connection* connection; /**< Conexión del cliente. */
+    stream_event_t** queue;            /**< Eventos pendientes, del más antiguo al más reciente desde first. */
+    size_t first;                      /**< Posición del evento más antiguo. */
+    size_t count;                      /**< Eventos pendientes. */
+    stream_event_t* current;           /**< Evento que se está enviando, NULL si ninguno. */
+    size_t offset;                     /**< Bytes de current ya enviados. */
+    int suspended;                     /**< Distinto de cero si la conexión está suspendida esperando eventos. */
+    int dropped;                       /**< Distinto de cero si se lo desconecta por no leer a tiempo. */
+    struct stream_client* next;        /**< Siguiente cliente de la lista. */
+} stream_client_t;
+
+/** Eventos por cola de cliente */
+static size_t queue_capacity = 0;
+
+/** Clientes conectados */
+static stream_client_t* clients = NULL;
+static size_t client_count = 0;
+
+/** Último valor enviado por serie, para armar los deltas y el snapshot de los clientes nuevos */
+static double last_values[MAX_SERIES];
+static long long last_timestamps[MAX_SERIES];
+
+/** Número del próximo evento, en el campo id */
+static unsigned long long next_event_id = 1;
+
+/** Texto del evento en armado; solo lo usa quien tiene stream_lock */
+static char event_buffer[EVENT_BUFFER_SIZE];
+
+/** Protege los clientes, sus colas y los últimos valores: el colector publica mientras microhttpd lee */
+static pthread_mutex_t stream_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Indica si el valor cambió respecto del último enviado; NaN se considera igual a NaN.
+ */
+static int value_changed(double previous, double current)
+{
+    if (isnan(previous) || isnan(current))
+    {
+        return isnan(previous) != isnan(current);
+    }
+    return previous != current;
+}
+
+/**
+ * @brief Arma un evento con los últimos valores de las series marcadas en include, o NULL si no hay memoria.
+ *
+ * Se llama con stream_lock tomado. El snapshot indica además al navegador cuánto esperar antes de reconectarse.
+ */
+static stream_event_t* build_event(int snapshot, const int* include, long long timestamp_ms)
+{
+    int written = snprintf(event_buffer, EVENT_HEADER_SIZE,
+                           "%sid: %llu\nevent: %s\ndata: {\"timestamp\":%lld.%03lld,\"values\":{",
+                           snapshot ? RECONNECT_FIELD : "", next_event_id++, snapshot ? "snapshot" : "update",
+                           timestamp_ms / MILLISECONDS_PER_SECOND, timestamp_ms % MILLISECONDS_PER_SECOND);
+    size_t length = (size_t)written;
+
+    int first = BOOL_TRUE;
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!include[i])
+        {
+            continue;
+        }
+        char value[VALUE_FORMAT_BUFFER_SIZE];
+        value_format(last_values[i], value, sizeof(value));
+        written = snprintf(event_buffer + length, SERIES_TEXT_SIZE, "%s\"%s\":\"%s\"", first ? "" : ",",
+                           series_get(i)->name, value);
+        // Un nombre que no entra en su lugar reservado se omite antes que cortar el JSON
+        if (written > 0 && written < SERIES_TEXT_SIZE)
+        {
+            length += (size_t)written;
+            first = BOOL_FALSE;
+        }
+    }
+    memcpy(event_buffer + length, EVENT_TRAILER, strlen(EVENT_TRAILER));
+    length += strlen(EVENT_TRAILER);
+
+    stream_event_t* event = malloc(sizeof(stream_event_t) + length);
+    if (event == NULL)
+    {
+        return NULL;
+    }
+    event->references = 0;
+    event->length = length;
+    memcpy(event->text, event_buffer, length);
+    return event;
+}
+
+/**
+ * @brief Suelta una referencia a un evento; se llama con stream_lock tomado.
+ */
+static void release_event(stream_event_t* event)
+{
+    if (--event->references == 0)
+    {
+        free(event);
+    }
+}
+
+/**
+ * @brief Descarta los eventos pendientes de un cliente; se llama con stream_lock tomado.
+ */
+static void clear_queue(stream_client_t* client)
+{
+    for (; client->count > 0; client->count--)
+    {
+        release_event(client->queue[client->first]);
+        client->first = (client->first + 1) % queue_capacity;
+    }
+    if (client->current != NULL)
+    {
+        release_event(client->current);
+        client->current = NULL;
+    }
+}
+
+/**
+ * @brief Encola un evento para un cliente, o lo marca para desconectar si su cola está llena.
+ *
+ * Se llama con stream_lock tomado. Una conexión suspendida se reanuda para que envíe el evento o se cierre.
+ */
+static void enqueue_event(stream_client_t* client, stream_event_t* event)
+{
+    if (client->dropped)
+    {
+        return;
+    }
+    if (client->count == queue_capacity)
+    {
+        client->dropped = BOOL_TRUE;
+        clear_queue(client);
+    }
+    else
+    {
+        event->references++;
+        client->queue[(client->first + client->count) % queue_capacity] = event;
+        client->count++;
+    }
+    if (client->suspended)
+    {
+        client->suspended = BOOL_FALSE;
+        MHD_resume_connection(client->connection);
+    }
+}
+
+/**
+ * @brief Entrega a microhttpd los eventos pendientes del cliente; sin eventos, suspende la conexión.
+ */
+static ssize_t stream_reader(void* cls, uint64_t position, char* buffer, size_t max)
+{
+    (void)position;
+    stream_client_t* client = cls;
+    size_t written = 0;
+
+    pthread_mutex_lock(&stream_lock);
+    while (written < max && !client->dropped)
+    {
+        if (client->current == NULL)
+        {
+            if (client->count == 0)
+            {
+                break;
+            }
+            client->current = client->queue[client->first];
+            client->first = (client->first + 1) % queue_capacity;
+            client->count--;
+            client->offset = 0;
+        }
+        size_t chunk = client->current->length - client->offset;
+        if (chunk > max - written)
+        {
+            chunk = max - written;
+        }
+        memcpy(buffer + written, client->current->text + client->offset, chunk);
+        written += chunk;
+        client->offset += chunk;
+        if (client->offset == client->current->length)
+        {
+            release_event(client->current);
+            client->current = NULL;
+        }
+    }
+
+    ssize_t result = (ssize_t)written;
+    if (client->dropped)
+    {
+        result = MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+    else if (written == 0)
+    {
+        // Se suspende con el lock tomado para que enqueue_event nunca reanude antes de la suspensión
+        client->suspended = BOOL_TRUE;
+        MHD_suspend_connection(client->connection);
+    }
+    pthread_mutex_unlock(&stream_lock);
+    return result;
+}
+
+/**
+ * @brief Quita al cliente de la lista cuando microhttpd cierra la conexión.
+ */
+static void stream_free(void* cls)
+{
+    stream_client_t* client = cls;
+
+    pthread_mutex_lock(&stream_lock);
+    for (stream_client_t** link = &clients; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == client)
+        {
+            *link = client->next;
+            client_count--;
+            break;
+        }
+    }
+    clear_queue(client);
+    pthread_mutex_unlock(&stream_lock);
+
+    free(client->queue);
+    free(client);
+}
+
+/**
+ * @brief Responde un error de texto plano.
+ */
+static enum MHD_Result queue_error(struct MHD_Connection* connection, unsigned int status, const char* text)
+{
+    struct MHD_Response* response =
+        MHD_create_response_from_buffer(strlen(text), (void*)text, MHD_RESPMEM_PERSISTENT);
+    if (response == NULL)
+    {
+        return MHD_NO;
+    }
+    enum MHD_Result ret = MHD_queue_response(connection, status, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+static enum MHD_Result stream_handler(struct MHD_Connection* connection, void* cls)
+{
+    (void)cls;
+
+    stream_client_t* client = calloc(1, sizeof(stream_client_t));
+    stream_event_t** queue = calloc(queue_capacity, sizeof(stream_event_t*));
+    if (client == NULL || queue == NULL)
+    {
+        free(client);
+        free(queue);
+        return MHD_NO;
+    }
+    client->connection = connection;
+    client->queue = queue;
+
+    // El cliente nuevo empieza con todas las series que ya tienen lectura
+    int include[MAX_SERIES] = {BOOL_FALSE};
+    long long timestamp_ms = 0;
+    pthread_mutex_lock(&stream_lock);
+    if (client_count >= STREAM_MAX_CLIENTS)
+    {
+        pthread_mutex_unlock(&stream_lock);
+        free(queue);
+        free(client);
+        return queue_error(connection, MHD_HTTP_SERVICE_UNAVAILABLE, "Too many stream clients\n");
+    }
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        include[i] = last_timestamps[i] != 0;
+        if (last_timestamps[i] > timestamp_ms)
+        {
+            timestamp_ms = last_timestamps[i];
+        }
+    }
+    stream_event_t* snapshot = build_event(BOOL_TRUE, include, timestamp_ms);
+    if (snapshot == NULL)
+    {
+        pthread_mutex_unlock(&stream_lock);
+        free(queue);
+        free(client);
+        return MHD_NO;
+    }
+    enqueue_event(client, snapshot);
+    client->next = clients;
+    clients = client;
+    client_count++;
+    pthread_mutex_unlock(&stream_lock);
+
+    struct MHD_Response* response =
+        MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, READ_BLOCK_SIZE, stream_reader, client, stream_free);
+    if (response == NULL)
+    {
+        stream_free(client);
+        return MHD_NO;
+    }
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, EVENT_STREAM_CONTENT_TYPE);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CACHE_CONTROL, "no-cache");
+    enum MHD_Result ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+int stream_api_register(unsigned int queue_events)
+{
+    queue_capacity = queue_events;
+    if (promhttp_register_route(STREAM_API_URL, stream_handler, NULL) != SUCCESS)
+    {
+        fprintf(stderr, "Error registering %s\n", STREAM_API_URL);
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+void stream_api_publish(void)
+{
+    int include[MAX_SERIES] = {BOOL_FALSE};
+    int changed = BOOL_FALSE;
+    long long timestamp_ms = 0;
+
+    pthread_mutex_lock(&stream_lock);
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        const series_t* series = series_get(i);
+        if (series->timestamp_ms == 0 || series->timestamp_ms == last_timestamps[i])
+        {
+            continue;
+        }
+        include[i] = last_timestamps[i] == 0 || value_changed(last_values[i], series->value);
+        changed |= include[i];
+        last_values[i] = series->value;
+        last_timestamps[i] = series->timestamp_ms;
+        if (series->timestamp_ms > timestamp_ms)
+        {
+            timestamp_ms = series->timestamp_ms;
+        }
+    }
+
+    // Sin clientes los últimos valores se siguen actualizando para el snapshot, pero no se arma el evento
+    if (changed && clients != NULL)
+    {
+        stream_event_t* event = build_event(BOOL_FALSE, include, timestamp_ms);
+        if (event != NULL)
+        {
+            event->references++;
+            for (stream_client_t* client = clients; client != NULL; client = client->next)
+            {
+                enqueue_event(client, event);
+            }
+            release_event(event);
+        }
+    }
+    pthread_mutex_unlock(&stream_lock);
+}
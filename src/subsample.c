@@ -0,0 +1,296 @@
+#include "subsample.h"
+#include "collector_runner.h"
+#include "expose_metrics.h"
+#include "timing.h"
+#include <fcntl.h>
+#include <prom.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define NO_FD -1
+#define NO_LABELS 0
+#define PERCENTAGE_MULTIPLIER 100.0
+#define CPU_STAT_FIELDS_REQUIRED 8
+#define NET_DEV_FIELDS_REQUIRED 2
+#define INTERFACE_NAME_SIZE 32
+
+// La línea "cpu" es la primera de /proc/stat; /proc/net/dev tiene una línea de ~120 bytes por interfaz
+#define STAT_BUFFER_SIZE 256
+#define LOADAVG_BUFFER_SIZE 128
+#define NET_DEV_BUFFER_SIZE 16384
+
+// Los cuantiles cubren el último intervalo de exposición, descartado en cuartos
+#define DISTRIBUTION_AGE_BUCKETS 4
+#define DISTRIBUTION_RELATIVE_ACCURACY 0.01
+
+/** Mínimo, mediana, p99 y máximo de las lecturas del intervalo */
+static const double distribution_quantiles[] = {0.0, 0.5, 0.99, 1.0};
+
+/** Archivos abiertos una sola vez y releídos con pread; NO_FD si la fuente no está disponible */
+static int stat_fd = NO_FD;
+static int loadavg_fd = NO_FD;
+static int net_dev_fd = NO_FD;
+static char interface_name[INTERFACE_NAME_SIZE];
+
+/** Muestras de los summaries, observadas directamente desde el hilo de muestreo */
+static prom_metric_sample_summary_t* cpu_sample;
+static prom_metric_sample_summary_t* running_sample;
+static prom_metric_sample_summary_t* rx_rate_sample;
+static prom_metric_sample_summary_t* tx_rate_sample;
+
+static long long period_ns;
+
+/**
+ * @brief Abre un archivo de /proc para releerlo en cada muestra; avisa y devuelve NO_FD si no existe.
+ */
+static int open_source(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == NO_FD)
+    {
+        fprintf(stderr, "Warning: Could not open %s, its sub-second distribution is disabled\n", path);
+    }
+    return fd;
+}
+
+/**
+ * @brief Relee un archivo abierto desde el principio y termina el texto con un nulo.
+ */
+static int read_source(int fd, char* buffer, size_t size)
+{
+    ssize_t length = pread(fd, buffer, size - 1, 0);
+    if (length <= 0)
+    {
+        return ERROR;
+    }
+    buffer[length] = '\0';
+    return SUCCESS;
+}
+
+/**
+ * @brief Crea un summary sin etiquetas, lo agrega al collector del grupo y devuelve su muestra, o NULL si falla.
+ */
+static prom_metric_sample_summary_t* add_distribution(const char* group, const char* name, const char* help,
+                                                      const prom_summary_options_t* options)
+{
+    prom_summary_t* summary = prom_summary_new(name, help, options, NO_LABELS, NULL);
+    if (summary == NULL)
+    {
+        return NULL;
+    }
+    if (collector_runner_add_sampled_metric(group, summary) != SUCCESS)
+    {
+        prom_summary_destroy(summary);
+        return NULL;
+    }
+    return prom_metric_sample_summary_from_labels(summary, NULL);
+}
+
+/**
+ * @brief Observa el uso de CPU entre esta lectura de /proc/stat y la anterior.
+ */
+static void sample_cpu(void)
+{
+    static unsigned long long prev_total = 0, prev_idle = 0;
+    static int have_previous = 0;
+    char buffer[STAT_BUFFER_SIZE];
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+
+    if (read_source(stat_fd, buffer, sizeof(buffer)) != SUCCESS ||
+        sscanf(buffer, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &system, &idle, &iowait, &irq,
+               &softirq, &steal) < CPU_STAT_FIELDS_REQUIRED)
+    {
+        return;
+    }
+    unsigned long long idle_total = idle + iowait;
+    unsigned long long total = idle_total + user + nice + system + irq + softirq + steal;
+
+    // Sin jiffies nuevos desde la lectura anterior no hay nada que medir; se espera a la próxima
+    if (have_previous && total > prev_total)
+    {
+        unsigned long long totald = total - prev_total;
+        unsigned long long idled = idle_total - prev_idle;
+        prom_metric_sample_summary_observe(cpu_sample,
+                                           ((double)(totald - idled) / totald) * PERCENTAGE_MULTIPLIER);
+    }
+    if (!have_previous || total > prev_total)
+    {
+        prev_total = total;
+        prev_idle = idle_total;
+        have_previous = 1;
+    }
+}
+
+/**
+ * @brief Observa los procesos en ejecución del cuarto campo de /proc/loadavg ("en ejecución/total").
+ */
+static void sample_run_queue(void)
+{
+    char buffer[LOADAVG_BUFFER_SIZE];
+    unsigned int running;
+
+    if (read_source(loadavg_fd, buffer, sizeof(buffer)) == SUCCESS &&
+        sscanf(buffer, "%*f %*f %*f %u/", &running) == 1)
+    {
+        prom_metric_sample_summary_observe(running_sample, (double)running);
+    }
+}
+
+/**
+ * @brief Observa las tasas de recepción y envío de la interfaz principal desde la lectura anterior.
+ */
+static void sample_network(double now)
+{
+    static unsigned long long prev_rx = 0, prev_tx = 0;
+    static double prev_time = 0;
+    static int have_previous = 0;
+    static char buffer[NET_DEV_BUFFER_SIZE];
+    size_t name_length = strlen(interface_name);
+    unsigned long long rx, tx;
+
+    if (read_source(net_dev_fd, buffer, sizeof(buffer)) != SUCCESS)
+    {
+        return;
+    }
+
+    // Buscar la línea "  nombre: rx_bytes ... tx_bytes ..." sin recorrer el resto de los campos
+    char* line = buffer;
+    while (line != NULL)
+    {
+        while (*line == ' ' || *line == '\t')
+        {
+            line++;
+        }
+        if (strncmp(line, interface_name, name_length) == 0 && line[name_length] == ':')
+        {
+            break;
+        }
+        line = strchr(line, '\n');
+        if (line != NULL)
+        {
+            line++;
+        }
+    }
+    if (line == NULL || sscanf(line + name_length + 1, "%llu %*u %*u %*u %*u %*u %*u %*u %llu", &rx, &tx) <
+                            NET_DEV_FIELDS_REQUIRED)
+    {
+        return;
+    }
+
+    // Un contador que retrocede (la interfaz se recreó) solo reinicia la referencia
+    double elapsed = now - prev_time;
+    if (have_previous && rx >= prev_rx && tx >= prev_tx && elapsed > 0)
+    {
+        prom_metric_sample_summary_observe(rx_rate_sample, (double)(rx - prev_rx) / elapsed);
+        prom_metric_sample_summary_observe(tx_rate_sample, (double)(tx - prev_tx) / elapsed);
+    }
+    prev_rx = rx;
+    prev_tx = tx;
+    prev_time = now;
+    have_previous = 1;
+}
+
+/**
+ * @brief Hilo de muestreo: lee las fuentes disponibles en instantes fijos de CLOCK_MONOTONIC.
+ */
+static void* sampler_thread(void* arg)
+{
+    (void)arg;
+    struct timespec next;
+    timing_monotonic(&next);
+
+    while (1)
+    {
+        if (stat_fd != NO_FD)
+        {
+            sample_cpu();
+        }
+        if (loadavg_fd != NO_FD)
+        {
+            sample_run_queue();
+        }
+        if (net_dev_fd != NO_FD)
+        {
+            sample_network(timing_now());
+        }
+
+        timing_add_ns(&next, period_ns);
+
+        // Si el hilo se atrasó no se recuperan las lecturas perdidas: se sigue desde ahora
+        struct timespec now;
+        timing_monotonic(&now);
+        if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+        {
+            next = now;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+int subsample_init(unsigned int rate_hz, unsigned int window_seconds)
+{
+    prom_summary_options_t options = {distribution_quantiles,
+                                      sizeof(distribution_quantiles) / sizeof(distribution_quantiles[0]),
+                                      DISTRIBUTION_RELATIVE_ACCURACY, (double)window_seconds,
+                                      DISTRIBUTION_AGE_BUCKETS};
+
+    stat_fd = open_source("/proc/stat");
+    loadavg_fd = open_source("/proc/loadavg");
+    net_dev_fd = open_source("/proc/net/dev");
+
+    // Copia propia del nombre: detect_primary_network_interface devuelve un búfer que el ciclo principal reescribe
+    const char* primary_interface = net_dev_fd != NO_FD ? detect_primary_network_interface() : NULL;
+    if (primary_interface == NULL && net_dev_fd != NO_FD)
+    {
+        close(net_dev_fd);
+        net_dev_fd = NO_FD;
+    }
+    if (primary_interface != NULL)
+    {
+        strncpy(interface_name, primary_interface, sizeof(interface_name) - 1);
+    }
+
+    if (stat_fd != NO_FD)
+    {
+        cpu_sample = add_distribution(CPU_COLLECTOR, "cpu_usage_percentage_distribution",
+                                      "CPU usage percentage sampled within the exposition interval", &options);
+    }
+    if (loadavg_fd != NO_FD)
+    {
+        running_sample = add_distribution(PROCESSES_COLLECTOR, "processes_running_distribution",
+                                          "Running processes sampled within the exposition interval", &options);
+    }
+    if (net_dev_fd != NO_FD)
+    {
+        rx_rate_sample = add_distribution(NETWORK_COLLECTOR, "network_rx_rate_bps_distribution",
+                                          "Network receive rate in bytes per second sampled within the exposition "
+                                          "interval",
+                                          &options);
+        tx_rate_sample = add_distribution(NETWORK_COLLECTOR, "network_tx_rate_bps_distribution",
+                                          "Network transmit rate in bytes per second sampled within the exposition "
+                                          "interval",
+                                          &options);
+    }
+    if ((stat_fd != NO_FD && cpu_sample == NULL) || (loadavg_fd != NO_FD && running_sample == NULL) ||
+        (net_dev_fd != NO_FD && (rx_rate_sample == NULL || tx_rate_sample == NULL)))
+    {
+        fprintf(stderr, "Error creating sub-second distributions\n");
+        return ERROR;
+    }
+
+    period_ns = TIMING_NANOSECONDS_PER_SECOND / rate_hz;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sampler_thread, NULL) != SUCCESS)
+    {
+        fprintf(stderr, "Error starting sub-second sampling thread\n");
+        return ERROR;
+    }
+    pthread_detach(thread);
+    return SUCCESS;
+}
@@ -0,0 +1,42 @@
+#include "timing.h"
+
+long long timing_clock_ns(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (long long)now.tv_sec * TIMING_NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+double timing_clock_seconds(clockid_t clock)
+{
+    return (double)timing_clock_ns(clock) / TIMING_NANOSECONDS_PER_SECOND;
+}
+
+double timing_now(void)
+{
+    return timing_clock_seconds(CLOCK_MONOTONIC);
+}
+
+void timing_monotonic(struct timespec* time)
+{
+    clock_gettime(CLOCK_MONOTONIC, time);
+}
+
+long long timing_wall_ms(void)
+{
+    return timing_clock_ns(CLOCK_REALTIME) / TIMING_NANOSECONDS_PER_MILLISECOND;
+}
+
+void timing_sleep_until(double when)
+{
+    long long ns = (long long)(when * TIMING_NANOSECONDS_PER_SECOND);
+    struct timespec target = {(time_t)(ns / TIMING_NANOSECONDS_PER_SECOND), (long)(ns % TIMING_NANOSECONDS_PER_SECOND)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL);
+}
+
+void timing_add_ns(struct timespec* time, long long ns)
+{
+    long long total = time->tv_nsec + ns;
+    time->tv_sec += (time_t)(total / TIMING_NANOSECONDS_PER_SECOND);
+    time->tv_nsec = (long)(total % TIMING_NANOSECONDS_PER_SECOND);
+}
@@ -0,0 +1,257 @@
+// sendmmsg es una extensión de Linux
+#define _GNU_SOURCE
+#include "udp_export.h"
+#include "series.h"
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define SUCCESS 0
+#define ERROR -1
+#define BOOL_TRUE 1
+#define BOOL_FALSE 0
+#define NO_SOCKET -1
+#define HOST_SIZE 256
+#define PORT_SIZE 8
+// Registro más largo posible: nombre, etiqueta host, valor con 17 dígitos y marca de tiempo en ns
+#define RECORD_SIZE 640
+#define IPV4_UDP_OVERHEAD (20 + 8)
+#define IPV6_UDP_OVERHEAD (40 + 8)
+#define NANOSECONDS_PER_MILLISECOND 1000000LL
+
+/** Socket conectado al destino, NO_SOCKET si el envío no está activo */
+static int udp_socket = NO_SOCKET;
+
+/** Formato de los registros y bytes útiles por datagrama */
+static udp_format_t record_format = UDP_FORMAT_STATSD;
+static size_t payload_size = 0;
+
+/** Valor de la etiqueta host del protocolo de líneas */
+static char host_tag[HOST_SIZE];
+
+/** Marca de tiempo de la última lectura enviada por serie */
+static long long last_sent[MAX_SERIES];
+
+/** Registros del ciclo, empaquetados: cada datagrama es un tramo contiguo del búfer */
+static char packets[MAX_SERIES * RECORD_SIZE];
+
+/** Un datagrama por registro en el peor caso */
+static struct iovec packet_iov[MAX_SERIES];
+static struct mmsghdr packet_msgs[MAX_SERIES];
+
+/** Datagramas que el socket no aceptó, para avisar solo cuando empiezan a perderse */
+static unsigned long long dropped_packets = 0;
+
+/**
+ * @brief Separa host:puerto; un host IPv6 va entre corchetes.
+ */
+static int parse_target(const char* target, char* host, char* port)
+{
+    const char* host_start = target;
+    const char* host_end;
+    const char* colon;
+    if (*target == '[')
+    {
+        host_start = target + 1;
+        host_end = strchr(host_start, ']');
+        colon = host_end != NULL && host_end[1] == ':' ? host_end + 1 : NULL;
+    }
+    else
+    {
+        colon = strrchr(target, ':');
+        host_end = colon;
+    }
+    if (host_end == NULL || colon == NULL || host_end == host_start || (size_t)(host_end - host_start) >= HOST_SIZE ||
+        colon[1] == '\0' || strlen(colon + 1) >= PORT_SIZE)
+    {
+        fprintf(stderr, "Invalid UDP target '%s' (expected host:port)\n", target);
+        return ERROR;
+    }
+    memcpy(host, host_start, (size_t)(host_end - host_start));
+    host[host_end - host_start] = '\0';
+    strcpy(port, colon + 1);
+    return SUCCESS;
+}
+
+int udp_export_init(const char* target, udp_format_t format, unsigned int mtu)
+{
+    char host[HOST_SIZE];
+    char port[PORT_SIZE];
+    if (parse_target(target, host, port) != SUCCESS)
+    {
+        return ERROR;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* addresses = NULL;
+    int resolved = getaddrinfo(host, port, &hints, &addresses);
+    if (resolved != SUCCESS)
+    {
+        fprintf(stderr, "Error resolving UDP target %s: %s\n", host, gai_strerror(resolved));
+        return ERROR;
+    }
+
+    // Conectado, los datagramas no llevan dirección y los errores ICMP del destino vuelven como errores del socket
+    for (struct addrinfo* address = addresses; address != NULL && udp_socket == NO_SOCKET; address = address->ai_next)
+    {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < SUCCESS)
+        {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != SUCCESS)
+        {
+            close(fd);
+            continue;
+        }
+        udp_socket = fd;
+        payload_size = mtu - (address->ai_family == AF_INET6 ? IPV6_UDP_OVERHEAD : IPV4_UDP_OVERHEAD);
+    }
+    freeaddrinfo(addresses);
+    if (udp_socket == NO_SOCKET)
+    {
+        fprintf(stderr, "Error connecting UDP socket to %s: %s\n", target, strerror(errno));
+        return ERROR;
+    }
+
+    if (gethostname(host_tag, sizeof(host_tag) - 1) != SUCCESS)
+    {
+        strcpy(host_tag, "localhost");
+    }
+    record_format = format;
+    return SUCCESS;
+}
+
+/**
+ * @brief Formatea la lectura de una serie y devuelve su largo, sin el salto de línea, o 0 si no se envía.
+ */
+static size_t format_record(const series_t* series, char* record)
+{
+    int length;
+    if (!isfinite(series->value))
+    {
+        return 0;
+    }
+    if (record_format == UDP_FORMAT_INFLUX)
+    {
+        length = snprintf(record, RECORD_SIZE, "%s,host=%s value=%.17g %lld", series->name, host_tag, series->value,
+                          series->timestamp_ms * NANOSECONDS_PER_MILLISECOND);
+    }
+    else if (series->value < 0)
+    {
+        // En StatsD un gauge con signo es un incremento: se fija en cero y se resta para enviar el valor absoluto
+        length = snprintf(record, RECORD_SIZE, "%s:0|g\n%s:%.17g|g", series->name, series->name, series->value);
+    }
+    else
+    {
+        length = snprintf(record, RECORD_SIZE, "%s:%.17g|g", series->name, series->value);
+    }
+    return length > 0 && length < RECORD_SIZE ? (size_t)length : 0;
+}
+
+void udp_export_publish(void)
+{
+    if (udp_socket == NO_SOCKET)
+    {
+        return;
+    }
+
+    size_t used = 0;
+    size_t packet_count = 0;
+    size_t packet_start = 0;
+    size_t count = series_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        const series_t* series = series_get(i);
+        if (series->timestamp_ms == 0 || series->timestamp_ms == last_sent[i])
+        {
+            continue;
+        }
+        last_sent[i] = series->timestamp_ms;
+
+        char record[RECORD_SIZE];
+        size_t length = format_record(series, record);
+        if (length == 0 || length > payload_size)
+        {
+            continue;
+        }
+
+        // Un registro que no entra en el datagrama abierto empieza uno nuevo; los registros nunca se cortan
+        size_t open_length = used - packet_start;
+        if (open_length > 0 && open_length + 1 + length > payload_size)
+        {
+            packet_iov[packet_count].iov_base = packets + packet_start;
+            packet_iov[packet_count].iov_len = open_length;
+            packet_count++;
+            packet_start = used;
+        }
+        if (used > packet_start)
+        {
+            packets[used++] = '\n';
+        }
+        memcpy(packets + used, record, length);
+        used += length;
+    }
+    if (used > packet_start)
+    {
+        packet_iov[packet_count].iov_base = packets + packet_start;
+        packet_iov[packet_count].iov_len = used - packet_start;
+        packet_count++;
+    }
+    if (packet_count == 0)
+    {
+        return;
+    }
+
+    memset(packet_msgs, 0, packet_count * sizeof(packet_msgs[0]));
+    for (size_t i = 0; i < packet_count; i++)
+    {
+        packet_msgs[i].msg_hdr.msg_iov = &packet_iov[i];
+        packet_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Normalmente una sola llamada envía el ciclo completo; se sigue solo si el núcleo aceptó una parte
+    size_t sent = 0;
+    int sending = BOOL_TRUE;
+    int refused = BOOL_FALSE;
+    while (sending && sent < packet_count)
+    {
+        int result = sendmmsg(udp_socket, packet_msgs + sent, (unsigned int)(packet_count - sent), 0);
+        if (result > 0)
+        {
+            sent += (size_t)result;
+        }
+        else if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (result < 0 && errno == ECONNREFUSED && !refused)
+        {
+            // Informa que nadie recibió un datagrama anterior; el error ya se consumió y el envío se reintenta
+            refused = BOOL_TRUE;
+        }
+        else
+        {
+            // Cola del socket llena o destino inalcanzable: no se bloquea el ciclo
+            if (dropped_packets == 0)
+            {
+                fprintf(stderr, "Error sending UDP metrics: %s\n", strerror(errno));
+            }
+            dropped_packets += packet_count - sent;
+            sending = BOOL_FALSE;
+        }
+    }
+    if (sent == packet_count && dropped_packets > 0)
+    {
+        fprintf(stderr, "UDP metrics delivery resumed (%llu datagrams dropped)\n", dropped_packets);
+        dropped_packets = 0;
+    }
+}
@@ -0,0 +1,18 @@
+#include "value_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MIN_PRECISION 15
+#define MAX_PRECISION 17
+
+void value_format(double value, char* buffer, size_t size)
+{
+    for (int precision = MIN_PRECISION; precision <= MAX_PRECISION; precision++)
+    {
+        snprintf(buffer, size, "%.*g", precision, value);
+        if (strtod(buffer, NULL) == value)
+        {
+            return;
+        }
+    }
+}